@@ -1013,6 +1013,16 @@ public:
     /// The name of the option that enables target material mode compilation.
     #define MDL_CG_DAG_OPTION_TARGET_MATERIAL_MODE "target_material_mode"
 
+    /// The name of the option to build material and function bodies on first access.
+    ///
+    /// The import entries of the compiled module must be restored when it is compiled. The
+    /// generated code DAG keeps the module and its import entries alive until it is destroyed.
+    /// Errors detected while building a body are not added to the messages of the generated code,
+    /// which do not change after compilation, but to the messages of a serialized DAG. Ignored if
+    /// local function calls are forbidden, because the errors for those are reported while
+    /// building the bodies.
+    #define MDL_CG_DAG_OPTION_LAZY_BODIES "lazy_bodies"
+
     /// Compile a module.
     /// \param      module  The module to compile.
     /// \returns            The generated code.
@@ -1048,12 +1058,38 @@ public:
 };
 
 
+/// A job of the JIT code generator, consisting of independent fragments.
+class ICode_generator_job
+{
+public:
+    /// Execute one fragment of the job.
+    ///
+    /// Fragments of the same job may be executed in parallel.
+    ///
+    /// \param index  the index of the fragment
+    virtual void execute_fragment(size_t index) = 0;
+};
+
+/// An interface for executing jobs of the JIT code generator on the thread pool of the
+/// application.
+class ICode_generator_job_executor : public
+    mi::base::Interface_declare<0x5a0e8b41,0x3c2d,0x4f6e,0x9b,0x17,0x2e,0x84,0xd0,0x6c,0x5f,0x93,
+    mi::base::IInterface>
+{
+public:
+    /// Execute all fragments of a job and wait until all of them are finished.
+    ///
+    /// \param job    the job
+    /// \param count  the number of fragments
+    virtual void execute(ICode_generator_job *job, size_t count) = 0;
+};
+
 /// An interface for handling different thread contexts inside the JIT code generator.
 ///
 /// When the code generator is used from different threads, every thread should have its own
 /// context. If no context is provided, the backend automatically creates one.
 class ICode_generator_thread_context : public
-    mi::base::Interface_declare<0xc60c7002,0xb9f6,0x4f22,0x8d,0x83,0xb6,0xa1,0x25,0x59,0xb8,0x6e,
+    mi::base::Interface_declare<0x08fa0bf8,0xe310,0x478a,0xb8,0xd7,0x8e,0xaa,0xc0,0x3f,0x61,0x95,
     mi::base::IInterface>
 {
 public:
@@ -1078,6 +1114,11 @@ public:
     ///       context is in use.
     ///
     virtual Options &access_options() = 0;
+
+    /// Set the executor used for parallel code generation in the next invocation.
+    ///
+    /// \param executor  the executor, or NULL to generate code in the calling thread only
+    virtual void set_job_executor(ICode_generator_job_executor *executor) = 0;
 };
 
 /// The JIT code generator interface.
@@ -1110,6 +1151,10 @@ class ICode_generator_jit : public
     /// The name of the option to set the optimization level of the JIT code generator.
     #define MDL_JIT_OPTION_OPT_LEVEL "jit_opt_level"
 
+    /// The name of the option to set the number of threads used for PTX code generation.
+    /// Only used if a job executor is set on the thread context.
+    #define MDL_JIT_OPTION_CODEGEN_THREADS "jit_codegen_threads"
+
     /// The name of the option to inline functions aggressively.
     #define MDL_JIT_OPTION_INLINE_AGGRESSIVELY "jit_inline_aggressively"
 
@@ -1759,13 +1804,17 @@ These options are specific to the MDL JIT code generator:
   Default: \c "2"
 
 \anchor mdl_option_jit_tex_lookup_call_mode
-- <b>jit_tex_lookup_call_mode</b>: Specifies the call mode for texture lookup functions on GPU.
+- <b>jit_tex_lookup_call_mode</b>: Specifies the call mode for texture lookup functions.
   Possible values:
   - \c "vtable": uses a table of texture function pointers provided via the res_data parameter
     of the generated functions (default)
   - \c "direct_call": the texture functions will be called directly (by name) in the PTX code
   - \c "optix_cp": the generated code will contain OptiX \c rtCallableProgramId variables for
     each texture function which you have to set in your application
+  - \c "native_inline": CPU only, if the built-in resource handler is used: lookups into
+    2D textures sample the flat mip pyramid provided by
+    mi::mdl::IResource_handler::tex_native_2d() directly in the generated code, other lookups
+    are handled as in \c "vtable" mode
 
 \anchor mdl_option_jit_lambda_return_mode
 - <b>jit_lambda_return_mode</b>: Selects how generated lambda functions return their results.
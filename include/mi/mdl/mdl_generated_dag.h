@@ -397,7 +397,7 @@ public:
 /// This object can be generated via ICode_generator_dag::compile() from a module
 /// loaded via IMDL::load_module().
 class IGenerated_code_dag : public
-    mi::base::Interface_declare<0x9dbfd12e,0x8207,0x4a47,0x8c,0x1f,0x5f,0x9a,0xc4,0x9b,0x00,0xf6,
+    mi::base::Interface_declare<0x5bd1f0c2,0x3e7a,0x4c58,0x9a,0x61,0x0e,0xd4,0x27,0xb3,0x8c,0x15,
     IGenerated_code>
 {
 public:
@@ -1135,6 +1135,16 @@ public:
     virtual DAG_node const *get_function_body(
         size_t function_index) const = 0;
 
+    /// Check if the body of the function at function_index was not built yet.
+    ///
+    /// Only possible for code compiled with MDL_CG_DAG_OPTION_LAZY_BODIES. Accessing the body or
+    /// the temporaries of the function builds it.
+    ///
+    /// \param function_index      The index of the function.
+    /// \returns                   True if the body will be built on first access.
+    virtual bool is_function_body_pending(
+        size_t function_index) const = 0;
+
     /// Get the property flag of the function at function_index.
     ///
     /// \param function_index  The index of the function.
@@ -1263,6 +1273,16 @@ public:
     virtual DAG_node const *get_material_value(
         size_t material_index) const = 0;
 
+    /// Check if the value of the material at material_index was not built yet.
+    ///
+    /// Only possible for code compiled with MDL_CG_DAG_OPTION_LAZY_BODIES. Accessing the value or
+    /// the temporaries of the material builds it.
+    ///
+    /// \param material_index      The index of the material.
+    /// \returns                   True if the value will be built on first access.
+    virtual bool is_material_value_pending(
+        size_t material_index) const = 0;
+
     /// Get the export flags of the material at material_index.
     ///
     /// \param material_index  The index of the material.
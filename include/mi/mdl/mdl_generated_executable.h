@@ -141,7 +141,7 @@ public:
 
 /// The base executable code interface.
 class IGenerated_code_executable : public
-    mi::base::Interface_declare<0x11c439a5,0x3eaf,0x4e48,0x8b,0xd3,0xb2,0x23,0x3e,0x6a,0x79,0x68,
+    mi::base::Interface_declare<0xf403845a,0x14a4,0x4554,0x92,0x1c,0xa6,0x70,0x95,0x60,0x80,0x55,
     IGenerated_code>
 {
 public:
@@ -202,6 +202,16 @@ public:
         PL_NUM_LANGUAGES
     };
 
+    /// The compilation phases for which the code generator records timings.
+    enum Compile_phase {
+        CP_DAG_TO_LLVM,      ///< Translation of the DAG into LLVM-IR, including finalization.
+        CP_OPTIMIZE,         ///< The LLVM optimization pass pipeline.
+        CP_CODEGEN,          ///< Target code generation (PTX, HLSL/GLSL, LLVM-IR, native).
+        CP_MATERIALIZE,      ///< ORC materialization of the native entry points.
+        CP_CACHE_LOOKUP,     ///< Lookup in the code cache.
+        CP_LAST = CP_CACHE_LOOKUP
+    };
+
     /// Helper type to describe a (read-only) data segment.
     struct Segment {
         char const          *name;   ///< The name of this data segment.
@@ -360,6 +370,13 @@ public:
     ///
     /// \return The state usage or 0, if the \p func_index was invalid.
     virtual State_usage get_function_state_usage(size_t func_index) const = 0;
+
+    /// Get the time spent in a compilation phase while this code was generated.
+    ///
+    /// \param phase  the compilation phase
+    ///
+    /// \return the time in seconds or 0.0 if the phase was not executed
+    virtual double get_compile_phase_time(Compile_phase phase) const = 0;
 };
 
 /// A handler for MDL runtime exceptions.
@@ -407,6 +424,21 @@ public:
 
     typedef mi::mdl::stdlib::Mbsdf_part Mbsdf_part;
 
+    /// One level of the mip pyramid of a #Native_texture_2d.
+    typedef struct {
+        float const *texels;  ///< width * height RGBA texels, stored row by row
+        int         width;    ///< the width of this level
+        int         height;   ///< the height of this level
+    } Native_texture_level;
+
+    /// A 2D texture in a flat layout that JIT compiled code can sample without calling
+    /// back into the resource handler, see the \c "native_inline" texture lookup call mode.
+    typedef struct {
+        Native_texture_level const *levels;      ///< the mip levels, finest level first
+        unsigned                   num_levels;   ///< the number of mip levels
+        float                      gamma;        ///< gamma applied after filtering level 0
+    } Native_texture_2d;
+
     /// Get the number of bytes that must be allocated for a resource object.
     virtual size_t get_data_size() const = 0;
 
@@ -440,6 +472,26 @@ public:
         void                 *data,
         IType_texture::Shape shape) = 0;
 
+    /// Get the flat representation of a 2D texture for inline sampling.
+    ///
+    /// \param tex_data  the read-only shared texture data pointer
+    ///
+    /// \return the flat texture, valid as long as \c tex_data, or \c NULL if the texture
+    ///         cannot be sampled inline (for instance, uv-tiles or animated textures); lookups
+    ///         into it are then handled by the tex_lookup_*_2d() functions
+    ///
+    /// The flat texture stores every texel of every mip level as four floats, i.e., it is an
+    /// additional copy of the texture data of 16 bytes per texel (plus one third for the mip
+    /// levels), independent of the pixel type of the original texture.
+    ///
+    /// The default implementation returns \c NULL, i.e., all lookups are handled by the
+    /// tex_lookup_*_2d() functions.
+    virtual Native_texture_2d const *tex_native_2d(
+        void const    *tex_data) const
+    {
+        return NULL;
+    }
+
     /// Handle tex::width(texture_2d, int2, float) and tex::height(texture_2d, int2, float)
     ///
     /// \param result    the result of tex::width and tex::height
@@ -1293,7 +1345,7 @@ public:
 /// code.
 /// If compiled for GPU execution only PTX code is provided.
 class IGenerated_code_lambda_function : public
-    mi::base::Interface_declare<0x7e100527,0x0ae6,0x46e3,0x83,0x7a,0x45,0x84,0x99,0x4f,0xe4,0x22,
+    mi::base::Interface_declare<0x951d9f43,0xeddd,0x4863,0xb9,0x74,0xeb,0x3e,0xa9,0xb7,0x53,0xc1,
     IGenerated_code_executable>
 {
 public:
@@ -1500,6 +1552,50 @@ public:
     ///
     /// \returns the resource index or 0 if the resource is unknown.
     virtual unsigned get_known_resource_index(unsigned tag) const = 0;
+
+    /// Run a compiled lambda function on the CPU for several states, one after the other.
+    ///
+    /// \param[in]  index          the index of the function to execute
+    /// \param[in]  count          the number of states
+    /// \param[out] results        the results will be written to, one per state
+    /// \param[in]  result_stride  the distance in bytes between two consecutive results
+    /// \param[in]  states         an array of \p count core states
+    /// \param[in]  tex_data       extra thread data for the texture handler
+    /// \param[in]  cap_args       the captured arguments block, if arguments were captured
+    ///
+    /// \returns false if execution was aborted by runtime error, true otherwise
+    ///
+    /// \note This is equivalent to calling run_generic() \p count times, but sets up the
+    ///       exception and resource handling state only once for all states. The generated code
+    ///       itself is not vectorized, only the per-call overhead is amortized.
+    virtual bool run_generic_multi(
+        size_t                       index,
+        size_t                       count,
+        void                         *results,
+        size_t                       result_stride,
+        Shading_state_material const *states,
+        void                         *tex_data,
+        void const                   *cap_args) = 0;
+
+    /// Run a compiled environment function on the CPU for several states, one after the other.
+    ///
+    /// \param[in]  index     the index of the function to execute
+    /// \param[in]  count     the number of states
+    /// \param[out] results   an array of \p count colors the results will be written to
+    /// \param[in]  states    an array of \p count environment states
+    /// \param[in]  tex_data  extra thread data for the texture handler
+    ///
+    /// \returns false if execution was aborted by runtime error, true otherwise
+    ///
+    /// \note This is equivalent to calling run_environment() \p count times, but sets up the
+    ///       exception and resource handling state only once for all states. The generated code
+    ///       itself is not vectorized, only the per-call overhead is amortized.
+    virtual bool run_environment_multi(
+        size_t                          index,
+        size_t                          count,
+        RGB_color                       *results,
+        Shading_state_environment const *states,
+        void                            *tex_data) = 0;
 };
 
 } // mdl
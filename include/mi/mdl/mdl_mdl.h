@@ -103,6 +103,26 @@ public:
     virtual char const *get_search_path(Path_set set, size_t i) const = 0;
 };
 
+/// The modules a module imports directly, see IMDL::get_module_imports().
+class IModule_imports : public
+    mi::base::Interface_declare<0xeba04911,0x9538,0x4483,0xb8,0x69,0x43,0xc3,0x56,0xaf,0xb4,0xb6,
+    mi::base::IInterface>
+{
+public:
+    /// Get the absolute name of the importing module.
+    virtual char const *get_module_name() const = 0;
+
+    /// Get the number of directly imported modules.
+    virtual size_t get_import_count() const = 0;
+
+    /// Get the absolute name of the i'th directly imported module.
+    ///
+    /// \param i  the index
+    ///
+    /// \returns the absolute module name or NULL if the index is out of range.
+    virtual char const *get_import_name(size_t i) const = 0;
+};
+
 /// The primary interface to the MDL core compiler and the MDL Core API.
 ///
 /// For historical reasons, this interface is not only the MDL compiler, but also the
@@ -110,7 +130,7 @@ public:
 ///
 /// An IMDL interface can be obtained by calling the mi_mdl_factory() function.
 class IMDL : public
-    mi::base::Interface_declare<0x6af90e47,0xb232,0x4567,0xa7,0x54,0x5d,0xce,0x7b,0x3e,0x0a,0x76,
+    mi::base::Interface_declare<0x982a3674,0xad85,0x4381,0xa3,0x18,0x4e,0xce,0x85,0xd0,0x95,0x95,
     mi::base::IInterface>
 {
 public:
@@ -533,6 +553,35 @@ public:
     /// \return true on success, false if the given translator was not found
     virtual bool remove_foreign_module_translator(
         IMDL_foreign_module_translator *translator) = 0;
+
+    /// Drop all cached knowledge about the directories and archives on the search path.
+    ///
+    /// The compiler caches directory contents and archive manifests it sees during file
+    /// resolution and revalidates them by their modification time. Call this after the
+    /// search path changed or files were replaced in a way the modification time does not
+    /// reflect.
+    virtual void invalidate_search_path_index() = 0;
+
+    /// Discover the modules a module imports directly.
+    ///
+    /// The module is parsed, but neither analyzed nor are its imports loaded, which makes this
+    /// much cheaper than load_module(). It is meant to discover the import graph of a module
+    /// upfront, so that independent modules of it can be loaded concurrently.
+    ///
+    /// Discovery is best-effort: imports through namespace aliases and imports that cannot be
+    /// resolved are skipped, as is the standard library. load_module() still handles (and
+    /// reports) all of them.
+    ///
+    /// \param context      if non-NULL, the thread context for this operation
+    /// \param module_name  the absolute module name
+    /// \param cache        if non-NULL, a module cache
+    ///
+    /// \returns            the direct imports or NULL if the module could not be resolved or
+    ///                     opened, or is a builtin or foreign module
+    virtual IModule_imports const *get_module_imports(
+        IThread_context *context,
+        char const      *module_name,
+        IModule_cache   *cache) = 0;
 };
 
 
@@ -95,6 +95,14 @@ public:
     /// The following options are supported by the NATIVE backend only:
     /// - \c "use_builtin_resource_handler": Enables/disables the built-in texture runtime.
     ///   Possible values: \c "on", \c "off". Default: \c "on".
+    /// - \c "tex_lookup_call_mode": Selects how tex_lookup calls will be generated.
+    ///   Possible values:
+    ///   * \c "vtable": call the texture runtime for every lookup (default)
+    ///   * \c "native_inline": sample 2D textures of the built-in texture runtime directly in
+    ///     the generated code. The texture runtime lays out these textures as flat RGBA float
+    ///     mip pyramids. Uv-tile and animated textures are still looked up via the runtime.
+    ///     Note that the pyramids are an additional copy of the texture data with 16 bytes per
+    ///     texel, independent of the pixel type of the texture.
     ///
     /// The following options are supported by the PTX, LLVM-IR, native and HLSL backend:
     ///
@@ -172,6 +180,11 @@ public:
     ///   * \c "vtable": generate calls through a vtable call (default)
     ///   * \c "direct_call": generate direct function calls
     ///   * \c "optix_cp": generate calls through OptiX bindless callable programs
+    /// - \c "num_codegen_threads": The number of threads used to generate PTX code for link units.
+    ///   If greater than one, the functions of a link unit are partitioned into independent
+    ///   clusters which are translated in parallel on the thread pool of the SDK. The result is
+    ///   independent of the thread scheduling, but its textual layout depends on the number of
+    ///   threads. Possible values: \c "1" to \c "64". Default: \c "1".
     ///
     /// The following options are supported by the HLSL backend only:
     /// - \c "hlsl_use_resource_data": If enabled, an extra user define resource data struct is
@@ -778,7 +791,7 @@ public:
 
 /// Represents target code of an MDL backend.
 class ITarget_code : public
-    mi::base::Interface_declare<0xefca46ae,0xd530,0x4b97,0x9d,0xab,0x3a,0xdb,0x0c,0x58,0xc3,0xac>
+    mi::base::Interface_declare<0x930caa6f,0x7959,0x400b,0x84,0x7c,0xa1,0x58,0xf9,0x48,0xe8,0xb4>
 {
 public:
     /// The potential state usage properties.
@@ -863,6 +876,18 @@ public:
         GM_FORCE_32_BIT = 0xFFFFFFFFu //   Undocumented, for alignment only
     };
 
+    /// The compilation phases for which timings are recorded.
+    ///
+    /// \see #get_compile_phase_time()
+    enum Compile_phase {
+        CP_DAG_TO_LLVM,      ///< Translation into LLVM-IR, including finalization.
+        CP_OPTIMIZE,         ///< The LLVM optimization pass pipeline.
+        CP_CODEGEN,          ///< Target code generation.
+        CP_MATERIALIZE,      ///< Materialization of native code.
+        CP_CACHE_LOOKUP,     ///< Lookup in the code cache.
+        CP_FORCE_32_BIT = 0xFFFFFFFFu //   Undocumented, for alignment only
+    };
+
     /// Returns the kind of backend this information belongs to.
     virtual IMdl_backend_api::Mdl_backend_kind get_backend_kind() const = 0;
 
@@ -1570,6 +1595,15 @@ public:
         Texture_handler_base* tex_handler,
         const ITarget_argument_block *cap_args) const = 0;
 
+    /// Returns the time spent in a compilation phase while this target code was generated.
+    ///
+    /// Timings are not serialized, a deserialized target code reports 0.0 for all phases.
+    ///
+    /// \param phase  The compilation phase.
+    /// \return       The time in seconds, or 0.0 if the phase was not executed or \p phase is
+    ///               invalid.
+    virtual Float64 get_compile_phase_time( Compile_phase phase) const = 0;
+
     virtual Size MI_NEURAYLIB_DEPRECATED_METHOD_14_0(get_body_texture_count)() const = 0;
 
     virtual Size MI_NEURAYLIB_DEPRECATED_METHOD_14_0(get_body_light_profile_count)() const = 0;
@@ -1843,6 +1877,7 @@ mi_static_assert( sizeof( ITarget_code::Prototype_language) == sizeof( mi::Uint3
 mi_static_assert( sizeof( ITarget_code::Distribution_kind) == sizeof( mi::Uint32));
 mi_static_assert( sizeof( ITarget_code::Function_kind) == sizeof( mi::Uint32));
 mi_static_assert( sizeof( ITarget_code::Gamma_mode) == sizeof( mi::Uint32));
+mi_static_assert( sizeof( ITarget_code::Compile_phase) == sizeof( mi::Uint32));
 mi_static_assert( sizeof( ILink_unit::Function_execution_context) == sizeof( mi::Uint32));
 
 } // namespace neuraylib
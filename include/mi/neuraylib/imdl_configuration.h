@@ -50,7 +50,7 @@ class IMdl_entity_resolver;
 
 /// This interface can be used to query and change the MDL configuration.
 class IMdl_configuration : public
-    mi::base::Interface_declare<0x2657ec0b,0x8a40,0x46c5,0xa8,0x3f,0x2b,0xb5,0x72,0xa0,0x8b,0x9c>
+    mi::base::Interface_declare<0x2657ec0b,0x8a40,0x46c5,0xa8,0x3f,0x2b,0xb5,0x72,0xa0,0x8b,0x9d>
 {
 public:
 
@@ -289,6 +289,58 @@ public:
     ///       #mi::neuraylib::IMdl_archive_api::create_archive()).
     virtual void set_entity_resolver( IMdl_entity_resolver* resolver) = 0;
 
+    //@}
+    /// \name Caches
+    //@{
+
+    /// Returns a statistic of the cache for generated target code.
+    ///
+    /// The cache is shared by all backends and avoids regenerating code for identical
+    /// inputs. Repeated calls allow to monitor its efficiency.
+    ///
+    /// \param name    The name of the statistic:
+    ///                - \c "hits": Number of lookups served from memory.
+    ///                - \c "disk_hits": Number of lookups served from the persistent tier.
+    ///                - \c "misses": Number of lookups that failed.
+    ///                - \c "evictions": Number of entries dropped from memory.
+    ///                - \c "disk_stores": Number of entries written to the persistent tier.
+    ///                - \c "entries": Number of entries currently held in memory.
+    ///                - \c "size": Number of bytes currently held in memory.
+    /// \return        The current value of the statistic, or 0 for unknown names or if
+    ///                \NeurayProductName has not been started yet.
+    virtual Size get_code_cache_statistic( const char* name) const = 0;
+
+    /// Returns a statistic of the cache for compiled materials.
+    ///
+    /// The cache is only used for material instances compiled with the execution context option
+    /// \c "use_compiled_material_cache" set to \c true (see
+    /// #mi::neuraylib::IMdl_execution_context).
+    ///
+    /// \param name    The name of the statistic:
+    ///                - \c "hits": Number of compilations served from the cache.
+    ///                - \c "misses": Number of lookups that failed.
+    ///                - \c "evictions": Number of entries dropped from the cache.
+    ///                - \c "entries": Number of entries currently held.
+    ///                - \c "size": Approximate number of bytes currently held.
+    /// \return        The current value of the statistic, or 0 for unknown names or if
+    ///                \NeurayProductName has not been started yet.
+    virtual Size get_compiled_material_cache_statistic( const char* name) const = 0;
+
+    /// Returns a statistic of the cache for runtime resources of native target codes.
+    ///
+    /// Textures, light profiles, and BSDF measurements used by target codes of the native backend
+    /// with the builtin texture handler are prepared once and shared by all target codes of the
+    /// process. An entry is released when the last target code using it is released.
+    ///
+    /// \param name    The name of the statistic:
+    ///                - \c "hits": Number of resources served from the cache.
+    ///                - \c "misses": Number of resources that had to be prepared.
+    ///                - \c "entries": Number of resources currently held.
+    ///                - \c "size": Approximate number of bytes of resource data currently held.
+    /// \return        The current value of the statistic, or 0 for unknown names or if
+    ///                \NeurayProductName has not been started yet.
+    virtual Size get_runtime_resource_cache_statistic( const char* name) const = 0;
+
     //@}
 
     virtual void MI_NEURAYLIB_DEPRECATED_METHOD_14_1(set_logger)( base::ILogger* logger) = 0;
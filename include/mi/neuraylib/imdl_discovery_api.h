@@ -244,7 +244,7 @@ public:
 /// data structure provides information about the discovered search paths as well as access to the
 /// result graph structure.
 class IMdl_discovery_api : public
-    base::Interface_declare<0x208aa1f2,0x08bc,0x4c81,0x8b,0x0f,0x54,0xba,0x4a,0x61,0xe9,0xd8>
+    base::Interface_declare<0xe00346c6,0x332f,0x45ca,0x90,0x6c,0x6b,0x8f,0x4e,0xa6,0xd5,0x20>
 {
 public:
 
@@ -254,6 +254,23 @@ public:
     ///                 By default, all kinds are included.
     virtual const IMdl_discovery_result*  discover(
         Uint32 filter = static_cast<Uint32>(IMdl_info::DK_ALL)) const = 0;
+
+    /// Returns the file system and archive discovery result, reusing an earlier result.
+    ///
+    /// Directories and archives whose modification time did not change since \p previous was
+    /// created are not listed or opened again. This is useful for repeated discovery on slow
+    /// file systems, e.g., network storage. The result is identical to the result of #discover()
+    /// with the same filter.
+    ///
+    /// \param previous A result of an earlier call of #discover() or #discover_incremental(),
+    ///                 possibly with a different filter. If \c NULL or not created by this API,
+    ///                 this method is equivalent to #discover().
+    /// \param filter   Bitmask, that can be used to specify which discovery kinds to include in
+    ///                 the result (see #mi::neuraylib::IMdl_info::Kind).
+    ///                 By default, all kinds are included.
+    virtual const IMdl_discovery_result*  discover_incremental(
+        const IMdl_discovery_result* previous,
+        Uint32 filter = static_cast<Uint32>(IMdl_info::DK_ALL)) const = 0;
 };
 
 } // namespace neuraylib
@@ -256,7 +256,7 @@ public:
 /// Allows to bake a varying or uniform expression of a compiled material into a texture or
 /// constant.
 class IBaker : public
-    mi::base::Interface_declare<0x4dba1b1d,0x8fce,0x43d9,0x80,0xa7,0xa2,0x24,0xf3,0x1e,0xdc,0xe7>
+    mi::base::Interface_declare<0x42d295af,0x75b6,0x4187,0x96,0x35,0x17,0xac,0xcc,0x39,0x21,0xd1>
 {
 public:
     /// Returns the pixel type that matches the expression to be baked best.
@@ -282,6 +282,35 @@ public:
     ///                  - -3: The execution of the MDL code failed.
     virtual Sint32 bake_texture( ICanvas* texture, Uint32 samples = 1) const = 0;
 
+    /// Bakes the expression as texture using adaptive sampling.
+    ///
+    /// All pixels are first sampled with \p min_samples samples. Pixels whose estimated standard
+    /// error (the maximum over all color channels) is above \p tolerance are then refined, doubling
+    /// their number of samples each time, until they converge or reach \p max_samples samples.
+    /// This is considerably faster than #bake_texture() with \p max_samples samples if large
+    /// parts of the texture are (nearly) constant.
+    ///
+    /// \param texture       The baked texture will be stored in this canvas. See #bake_texture().
+    /// \param min_samples   The initial number of samples per pixel. Values less than 2 are
+    ///                      raised to 2 (or \p max_samples if smaller) since the error estimate
+    ///                      requires at least two samples.
+    /// \param max_samples   The maximum number of samples per pixel.
+    /// \param tolerance     The maximum acceptable standard error of a pixel value.
+    /// \param num_samples   If not \c NULL, the total number of samples taken for all pixels is
+    ///                      stored here.
+    /// \return
+    ///                      -  0: Success.
+    ///                      - -1: Invalid parameters (\c NULL pointer, \p min_samples is zero or
+    ///                            larger than \p max_samples, or \p tolerance is negative).
+    ///                      - -2: The transaction that is bound to this baker is no longer open.
+    ///                      - -3: The execution of the MDL code failed.
+    virtual Sint32 bake_texture_adaptive(
+        ICanvas* texture,
+        Uint32 min_samples,
+        Uint32 max_samples,
+        Float32 tolerance,
+        Uint64* num_samples = 0) const = 0;
+
     /// Bakes the expression as constant.
     ///
     /// \param constant  An instance of #mi::IData of suitable type such that the baked constant can
@@ -139,6 +139,14 @@ public:
 ///   compilation mode. Default: \c false.
 /// - \c bool "ignore_noinline": If \c true, anno::noinline() annotations are ignored during
 ///   material compilation. Default: \c false.
+/// - \c bool "use_compiled_material_cache": If \c true, compiled materials are memoized in a
+///   process-wide cache keyed by the material definition, the arguments of the material instance
+///   (including all referenced function calls and resources), the compilation mode, and the
+///   options for material compilation. Repeated compilation of an unchanged material instance then
+///   returns a copy of the cached result. Note that messages of the original compilation are not
+///   reported again. See
+///   #mi::neuraylib::IMdl_configuration::get_compiled_material_cache_statistic(). Default:
+///   \c false.
 ///
 /// Options for code generation
 /// - \c bool "fold_meters_per_scene_unit": If \c true, occurrences of the functions
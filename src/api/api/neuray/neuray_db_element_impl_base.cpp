@@ -200,6 +200,9 @@ mi::Sint32 Db_element_impl_base::store(
             if( fc->is_immutable())
                 return -9;
         }
+
+        // overwriting might change the call graph
+        MDL::bump_validity_generation();
     }
 
     tag = transaction->get_tag_for_store( tag);
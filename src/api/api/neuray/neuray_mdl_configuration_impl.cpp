@@ -51,6 +51,7 @@
 #include <base/util/string_utils/i_string_utils.h>
 #include <mdl/integration/mdlnr/i_mdlnr.h>
 #include <io/scene/mdl_elements/i_mdl_elements_utilities.h>
+#include <render/mdl/runtime/i_mdlrt_resource_cache.h>
 
 namespace MI {
 
@@ -86,17 +87,30 @@ Mdl_configuration_impl::~Mdl_configuration_impl()
 
 mi::Sint32 Mdl_configuration_impl::add_mdl_path( const char* path)
 {
-    return !path ? -1 : m_path_module->add_path( PATH::MDL, path);
+    if( !path)
+        return -1;
+
+    mi::Sint32 result = m_path_module->add_path( PATH::MDL, path);
+    if( result == 0)
+        invalidate_search_path_index();
+    return result;
 }
 
 mi::Sint32 Mdl_configuration_impl::remove_mdl_path( const char* path)
 {
-    return !path ? -1 : m_path_module->remove_path( PATH::MDL, path);
+    if( !path)
+        return -1;
+
+    mi::Sint32 result = m_path_module->remove_path( PATH::MDL, path);
+    if( result == 0)
+        invalidate_search_path_index();
+    return result;
 }
 
 void Mdl_configuration_impl::clear_mdl_paths()
 {
     m_path_module->clear_search_path( PATH::MDL);
+    invalidate_search_path_index();
 }
 
 mi::Size Mdl_configuration_impl::get_mdl_paths_length() const
@@ -134,17 +148,30 @@ const char* Mdl_configuration_impl::get_mdl_user_path( mi::Size index) const
 
 mi::Sint32 Mdl_configuration_impl::add_resource_path( const char* path)
 {
-    return !path ? -1 : m_path_module->add_path( PATH::RESOURCE, path);
+    if( !path)
+        return -1;
+
+    mi::Sint32 result = m_path_module->add_path( PATH::RESOURCE, path);
+    if( result == 0)
+        invalidate_search_path_index();
+    return result;
 }
 
 mi::Sint32 Mdl_configuration_impl::remove_resource_path( const char* path)
 {
-    return !path ? -1 : m_path_module->remove_path( PATH::RESOURCE, path);
+    if( !path)
+        return -1;
+
+    mi::Sint32 result = m_path_module->remove_path( PATH::RESOURCE, path);
+    if( result == 0)
+        invalidate_search_path_index();
+    return result;
 }
 
 void Mdl_configuration_impl::clear_resource_paths()
 {
     m_path_module->clear_search_path( PATH::RESOURCE);
+    invalidate_search_path_index();
 }
 
 mi::Size Mdl_configuration_impl::get_resource_paths_length() const
@@ -231,6 +258,44 @@ void Mdl_configuration_impl::set_entity_resolver( mi::neuraylib::IMdl_entity_res
     mdl->set_external_entity_resolver( mdl_resolver.get());
 }
 
+mi::Size Mdl_configuration_impl::get_code_cache_statistic( const char* name) const
+{
+    mi::neuraylib::INeuray::Status status = m_neuray->get_status();
+    if( status != mi::neuraylib::INeuray::STARTED)
+        return 0;
+
+    return m_mdlc_module->get_code_cache_statistic( name);
+}
+
+mi::Size Mdl_configuration_impl::get_compiled_material_cache_statistic( const char* name) const
+{
+    mi::neuraylib::INeuray::Status status = m_neuray->get_status();
+    if( status != mi::neuraylib::INeuray::STARTED)
+        return 0;
+
+    return m_mdlc_module->get_compiled_material_cache_statistic( name);
+}
+
+mi::Size Mdl_configuration_impl::get_runtime_resource_cache_statistic( const char* name) const
+{
+    mi::neuraylib::INeuray::Status status = m_neuray->get_status();
+    if( status != mi::neuraylib::INeuray::STARTED || !name)
+        return 0;
+
+    MDLRT::Resource_cache::Statistics stats;
+    MDLRT::Resource_cache::get_instance().get_statistics( stats);
+
+    if( strcmp( name, "hits") == 0)
+        return stats.m_hits;
+    if( strcmp( name, "misses") == 0)
+        return stats.m_misses;
+    if( strcmp( name, "entries") == 0)
+        return stats.m_entries;
+    if( strcmp( name, "size") == 0)
+        return stats.m_memory;
+    return 0;
+}
+
 void Mdl_configuration_impl::deprecated_set_logger( mi::base::ILogger* logger)
 {
     mi::base::Handle<mi::neuraylib::ILogging_configuration> logging_configuration(
@@ -245,6 +310,16 @@ mi::base::ILogger* Mdl_configuration_impl::deprecated_get_logger()
     return logging_configuration->get_forwarding_logger();
 }
 
+void Mdl_configuration_impl::invalidate_search_path_index()
+{
+    // before start-up the compiler has not seen any search path yet
+    if( m_neuray->get_status() != mi::neuraylib::INeuray::STARTED)
+        return;
+
+    mi::base::Handle<mi::mdl::IMDL> mdl( m_mdlc_module->get_mdl());
+    mdl->invalidate_search_path_index();
+}
+
 mi::Sint32 Mdl_configuration_impl::start()
 {
     m_mdlc_module.set();
@@ -115,6 +115,13 @@ public:
     void set_entity_resolver( mi::neuraylib::IMdl_entity_resolver* resolver) final;
 
 
+    mi::Size get_code_cache_statistic( const char* name) const final;
+
+    mi::Size get_compiled_material_cache_statistic( const char* name) const final;
+
+    mi::Size get_runtime_resource_cache_statistic( const char* name) const final;
+
+
     void deprecated_set_logger( mi::base::ILogger* logger) final;
 
     mi::base::ILogger* deprecated_get_logger() final;
@@ -149,6 +156,10 @@ public:
     std::string get_default_mdl_user_path() const;
 
 private:
+    /// Drops the compiler's cached directory contents and archive manifests of the search
+    /// paths after they have been changed.
+    void invalidate_search_path_index();
+
     mi::neuraylib::INeuray* m_neuray;                       // neuray interface
 
     SYSTEM::Access_module<PATH::Path_module> m_path_module; // path module
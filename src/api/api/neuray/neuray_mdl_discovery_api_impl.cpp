@@ -45,8 +45,11 @@
 #include <mi/mdl/mdl_modules.h>
 #include <mi/mdl/mdl_streams.h>
 
+#include <base/data/db/i_db_database.h>
+#include <base/data/db/i_db_fragmented_job.h>
 #include <base/hal/disk/disk.h>
 #include <base/hal/hal/i_hal_ospath.h>
+#include <base/hal/time/i_time.h>
 #include <base/lib/path/i_path.h>
 #include <base/system/main/i_module_id.h>
 #include <base/util/string_utils/i_string_utils.h>
@@ -54,7 +57,10 @@
 #include <io/scene/mdl_elements/i_mdl_elements_module.h>
 #include <io/scene/mdl_elements/i_mdl_elements_utilities.h>
 
+#include <condition_variable>
+#include <deque>
 #include <string>
+#include <thread>
 
 namespace MI {
 
@@ -563,8 +569,124 @@ void Mdl_package_info_impl::reset_package(Mdl_package_info_impl* child, int inde
         m_packages[index] = make_handle_dup(child);
 }
 
+Mdl_discovery_snapshot::Mdl_discovery_snapshot(
+    const std::shared_ptr<const Mdl_discovery_snapshot>& previous)
+    : m_previous(previous)
+    , m_time(TIME::get_wallclock_time().get_seconds())
+{
+}
+
+bool Mdl_discovery_snapshot::is_unchanged(double previous_time, double modification_time) const
+{
+    // Modification times have a granularity of seconds. Changes in the same second as the start
+    // of the previous run might not be reflected in its listing.
+    return (previous_time == modification_time) && (previous_time < m_previous->m_time);
+}
+
+const Mdl_discovery_snapshot::Directory_listing& Mdl_discovery_snapshot::get_directory(
+    const std::string& path)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_directories.find(path);
+        if (it != m_directories.end())
+            return it->second;
+    }
+
+    Directory_listing listing;
+    DISK::Stat stat;
+    if (DISK::stat(path.c_str(), &stat) && stat.m_is_dir) {
+        listing.m_modification_time = stat.m_modification_time.get_seconds();
+
+        const Directory_listing* previous = nullptr;
+        if (m_previous) {
+            auto it = m_previous->m_directories.find(path);
+            if (it != m_previous->m_directories.end())
+                previous = &it->second;
+        }
+
+        if (previous
+            && is_unchanged(previous->m_modification_time, listing.m_modification_time)) {
+            listing = *previous;
+        }
+        else {
+            DISK::Directory dir;
+            if (dir.open(path.c_str())) {
+                listing.m_valid = true;
+                std::string entry = dir.read();
+                while (!entry.empty()) {
+                    std::string resolved_path = HAL::Ospath::join(path, entry);
+                    Entry_kind kind = EK_OTHER;
+                    if (DISK::is_directory(resolved_path.c_str()))
+                        kind = EK_DIRECTORY;
+                    else if (DISK::is_file(resolved_path.c_str()))
+                        kind = EK_FILE;
+                    listing.m_entries.emplace_back(entry, kind);
+                    entry = dir.read();
+                }
+                dir.close();
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_directories.emplace(path, std::move(listing)).first->second;
+}
+
+const Mdl_discovery_snapshot::Archive_listing& Mdl_discovery_snapshot::get_archive(
+    const std::string& path, mi::base::IAllocator* alloc)
+{
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        auto it = m_archives.find(path);
+        if (it != m_archives.end())
+            return it->second;
+    }
+
+    Archive_listing listing;
+    DISK::Stat stat;
+    if (DISK::stat(path.c_str(), &stat) && stat.m_is_file) {
+        listing.m_modification_time = stat.m_modification_time.get_seconds();
+        listing.m_size = stat.m_size;
+
+        const Archive_listing* previous = nullptr;
+        if (m_previous) {
+            auto it = m_previous->m_archives.find(path);
+            if (it != m_previous->m_archives.end())
+                previous = &it->second;
+        }
+
+        if (previous
+            && previous->m_size == listing.m_size
+            && is_unchanged(previous->m_modification_time, listing.m_modification_time)) {
+            listing = *previous;
+        }
+        else {
+            mi::mdl::MDL_zip_container_error_code err
+                = mi::mdl::MDL_zip_container_error_code::EC_OK;
+            mi::mdl::MDL_zip_container_archive* zip_archive =
+                mi::mdl::MDL_zip_container_archive::open(alloc, path.c_str(), err);
+            if (zip_archive) {
+                listing.m_valid = true;
+                for (int i = 0; i < zip_archive->get_num_entries(); ++i)
+                    listing.m_entries.push_back(zip_archive->get_entry_name(i));
+                zip_archive->close();
+            }
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    return m_archives.emplace(path, std::move(listing)).first->second;
+}
+
+void Mdl_discovery_snapshot::finish()
+{
+    m_previous.reset();
+}
+
 Mdl_discovery_api_impl::Mdl_discovery_api_impl(mi::neuraylib::INeuray* neuray)
     : m_neuray(neuray)
+    , m_database(nullptr)
     , m_mdlc_module(true)
     , m_path_module(true)
 {
@@ -765,6 +887,7 @@ namespace {
 } // end namespace
 
 bool Mdl_discovery_api_impl::discover_filesystem_recursive(
+    Mdl_discovery_snapshot& snapshot,
     const mi::base::Handle<Mdl_package_info_impl>& parent,
     const char* search_path, 
     mi::Size s_idx, 
@@ -772,8 +895,8 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
     const std::vector<std::string>& invalid_dirs,
     mi::Uint32 filter) const
 {
-    DISK::Directory dir;
-    if (!dir.open(path))
+    const Mdl_discovery_snapshot::Directory_listing& dir = snapshot.get_directory(path);
+    if (!dir.m_valid)
         return false;
 
     std::string current_path(path);
@@ -783,14 +906,13 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
         package_path);
     package_path += "::";
 
-    std::string entry = dir.read();
-    while (!entry.empty()) {
+    for (const auto& dir_entry : dir.m_entries) {
+        std::string entry = dir_entry.first;
         std::string resolved_path = HAL::Ospath::join(current_path, entry);
-        if (DISK::is_directory(resolved_path.c_str())) {
+        if (dir_entry.second == Mdl_discovery_snapshot::EK_DIRECTORY) {
             if (!is_valid_path( 
                 invalid_dirs, 
                 resolved_path)) {
-                entry = dir.read();
                 continue;
             }
            
@@ -808,7 +930,6 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
                     child_package->set_kind(mi::neuraylib::IMdl_info::Kind::DK_DIRECTORY);
                 }
                 else {
-                    entry = dir.read();
                     continue;
                 }
             }
@@ -821,6 +942,7 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
 
                 // Continue recursion with a merged node
                 discover_filesystem_recursive(
+                    snapshot,
                     merge_package,
                     search_path, 
                     s_idx, 
@@ -832,6 +954,7 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
             else{
                 // Continue recursion with a new node
                 discover_filesystem_recursive(
+                    snapshot,
                     child_package,
                     search_path, 
                     s_idx, 
@@ -844,13 +967,11 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
         else {
             size_t pos_e = entry.find_last_of('.');
             if (pos_e == std::string::npos) {
-                entry = dir.read();
                 continue;
             }
             else {
                 entry = entry.substr(0, pos_e);
                 if (!is_valid_node_name(entry.c_str())) {
-                    entry = dir.read();
                     continue;
                 }
             }
@@ -860,7 +981,7 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
 
             size_t pos_rp = resolved_path.find_last_of('.');
             std::string short_path(resolved_path.substr(0, pos_rp));
-            if (DISK::is_file(resolved_path.c_str()) &&
+            if ((dir_entry.second == Mdl_discovery_snapshot::EK_FILE) &&
                 (is_valid_path(invalid_dirs, short_path)) &&
                 (pos_rp != std::string::npos)) {
                 std::string ext = resolved_path.substr(
@@ -937,20 +1058,168 @@ bool Mdl_discovery_api_impl::discover_filesystem_recursive(
                 }
             }
         }
-        entry = dir.read();
     }
-    dir.close();
     return true;
 }
 
+namespace {
+
+/// Lists the directory trees of the search paths and reads the archives at their roots.
+///
+/// The fragments share a queue of directories and archives; the subdirectories of a listed
+/// directory are added to the queue. Subdirectories that are not traversed by the graph
+/// construction for the given filter are skipped. The results end up in the snapshot.
+class Discovery_prefetch_job : public DB::Fragmented_job
+{
+public:
+    Discovery_prefetch_job(
+        Mdl_discovery_snapshot& snapshot, mi::base::IAllocator* alloc, mi::Uint32 filter)
+      : m_snapshot(snapshot)
+      , m_alloc(alloc)
+      , m_filter(filter)
+    {
+    }
+
+    /// Adds a search path.
+    void add_search_path(const std::string& path)
+    {
+        m_tasks.push_back(Task{path, TK_SEARCH_PATH, /*package*/ true});
+    }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                while (m_tasks.empty() && m_active > 0)
+                    m_condition.wait(lock);
+                if (m_tasks.empty())
+                    return;
+                task = m_tasks.front();
+                m_tasks.pop_front();
+                ++m_active;
+            }
+
+            process(task);
+
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                --m_active;
+            }
+            m_condition.notify_all();
+        }
+    }
+
+private:
+    enum Task_kind { TK_SEARCH_PATH, TK_DIRECTORY, TK_ARCHIVE };
+
+    struct Task
+    {
+        std::string path;
+        Task_kind kind;
+        bool package;  ///< Whether the directory and all its parents are valid package names.
+    };
+
+    void process(const Task& task)
+    {
+        if (task.kind == TK_ARCHIVE) {
+            m_snapshot.get_archive(task.path, m_alloc);
+            return;
+        }
+
+        const Mdl_discovery_snapshot::Directory_listing& dir =
+            m_snapshot.get_directory(task.path);
+
+        std::vector<Task> tasks;
+        for (const auto& dir_entry : dir.m_entries) {
+            const std::string& entry = dir_entry.first;
+            if (dir_entry.second == Mdl_discovery_snapshot::EK_DIRECTORY) {
+                bool package = task.package && MDL::is_valid_module_name("::" + entry);
+                if (package || (m_filter & mi::neuraylib::IMdl_info::Kind::DK_DIRECTORY))
+                    tasks.push_back(Task{
+                        HAL::Ospath::join(task.path, entry), TK_DIRECTORY, package});
+            }
+            else if (dir_entry.second == Mdl_discovery_snapshot::EK_FILE
+                && task.kind == TK_SEARCH_PATH) {
+                std::size_t found_mdr = entry.rfind(".mdr");
+                if (found_mdr != std::string::npos && found_mdr == entry.size() - 4)
+                    tasks.push_back(Task{
+                        HAL::Ospath::join(task.path, entry), TK_ARCHIVE, false});
+            }
+        }
+
+        if (tasks.empty())
+            return;
+
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_tasks.insert(m_tasks.end(), tasks.begin(), tasks.end());
+        }
+        m_condition.notify_all();
+    }
+
+    Mdl_discovery_snapshot& m_snapshot;
+    mi::base::IAllocator* m_alloc;
+    mi::Uint32 m_filter;
+
+    std::deque<Task> m_tasks;
+    size_t m_active = 0;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+};
+
+} // namespace
+
+void Mdl_discovery_api_impl::prefetch(
+    Mdl_discovery_snapshot& snapshot,
+    const std::vector<std::string>& search_paths,
+    mi::Uint32 filter) const
+{
+    // Without parallelism, the graph construction lists the directories on demand.
+    size_t count = std::thread::hardware_concurrency();
+    if (!m_database || count <= 1)
+        return;
+
+    mi::base::Handle<mi::mdl::IMDL> mdl(m_mdlc_module->get_mdl());
+    Discovery_prefetch_job job(snapshot, mdl->get_mdl_allocator(), filter);
+    for (const std::string& path : search_paths)
+        if (!path.empty())
+            job.add_search_path(path);
+
+    m_database->execute_fragmented(&job, count);
+}
+
 const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover(
     mi::Uint32 filter) const
+{
+    return discover_incremental(nullptr, filter);
+}
+
+const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover_incremental(
+    const mi::neuraylib::IMdl_discovery_result* previous,
+    mi::Uint32 filter) const
 {
     const std::vector<std::string>& search_paths = m_path_module->get_search_path(PATH::MDL);
 
-    mi::base::Handle<Mdl_package_info_impl> root_package(
-        new Mdl_package_info_impl("", "", "", -1, ""));
+    // Results not created by this implementation carry no snapshot, which results in a full
+    // discovery.
+    std::shared_ptr<const Mdl_discovery_snapshot> previous_snapshot;
+    if (previous) {
+        mi::base::Handle<const IMdl_discovery_snapshot_wrapper> wrapper(
+            previous->get_interface<IMdl_discovery_snapshot_wrapper>());
+        if (wrapper)
+            previous_snapshot = wrapper->get_snapshot();
+    }
+    std::shared_ptr<Mdl_discovery_snapshot> snapshot(
+        std::make_shared<Mdl_discovery_snapshot>(previous_snapshot));
+    previous_snapshot.reset();
 
+    std::vector<std::string> paths(search_paths.size());
     for (mi::Size i = 0; i < search_paths.size(); ++i) {
         std::string path = search_paths[i]; 
         if (!DISK::access(path.c_str(), false))
@@ -958,23 +1227,35 @@ const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover(
 
         if (!DISK::is_path_absolute(path))
             path = HAL::Ospath::join(DISK::get_cwd(), path);
-        path = HAL::Ospath::normpath_v2(path);
+        paths[i] = HAL::Ospath::normpath_v2(path);
+    }
 
-        DISK::Directory dir;
-        if (!dir.open(path.c_str()))
+    // List all directories and read all archives up front, the graph construction below is
+    // sequential since its result depends on the order of the search paths.
+    prefetch(*snapshot, paths, filter);
+
+    mi::base::Handle<Mdl_package_info_impl> root_package(
+        new Mdl_package_info_impl("", "", "", -1, ""));
+
+    for (mi::Size i = 0; i < paths.size(); ++i) {
+        const std::string& path = paths[i];
+        if (path.empty())
+            continue;
+
+        const Mdl_discovery_snapshot::Directory_listing& dir = snapshot->get_directory(path);
+        if (!dir.m_valid)
             continue;
 
-        std::string entry = dir.read();
         std::map<std::string, bool> archives;
-        while (!entry.empty()) {
-            if (DISK::is_file(HAL::Ospath::join(path, entry).c_str())) {
+        for (const auto& dir_entry : dir.m_entries) {
+            const std::string& entry = dir_entry.first;
+            if (dir_entry.second == Mdl_discovery_snapshot::EK_FILE) {
                 std::size_t found_mdr = entry.rfind(".mdr");
                 if (found_mdr != std::string::npos && found_mdr == entry.size() - 4)
                     archives.insert(
                         std::make_pair(entry.substr(0, found_mdr), 
                         true));  
             }
-            entry = dir.read();
         }
 
         // Discover archives
@@ -988,6 +1269,7 @@ const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover(
                     std::string resolved_path = HAL::Ospath::join(path, archive.first);
                     resolved_path += ".mdr";
                     discover_archive(
+                        *snapshot,
                         root_package, 
                         path.c_str(), 
                         i, 
@@ -998,6 +1280,7 @@ const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover(
 
         // Discover file system
         discover_filesystem_recursive(
+            *snapshot,
             root_package, 
             path.c_str(), 
             i, 
@@ -1006,11 +1289,13 @@ const mi::neuraylib::IMdl_discovery_result* Mdl_discovery_api_impl::discover(
             filter);
     }
     root_package->sort_children();
+    snapshot->finish();
     
     mi::base::Handle<Mdl_discovery_result_impl>
         disc_res(new Mdl_discovery_result_impl(
             root_package.get(), 
-            search_paths));
+            search_paths,
+            snapshot));
     disc_res->retain();
     return disc_res.get();
 }
@@ -1245,6 +1530,7 @@ bool Mdl_discovery_api_impl::discover_archive_recursive(
 }
 
 bool Mdl_discovery_api_impl::read_archive(
+    Mdl_discovery_snapshot& snapshot,
     const char* res_path, 
     std::vector<std::string>& e_list,
     mi::Uint32 filter) const
@@ -1260,19 +1546,14 @@ bool Mdl_discovery_api_impl::read_archive(
         return false;
 
     mi::base::Handle<mi::mdl::IMDL> mdl(m_mdlc_module->get_mdl());
-    mi::mdl::MDL_zip_container_error_code err = mi::mdl::MDL_zip_container_error_code::EC_OK;
-    mi::mdl::MDL_zip_container_archive* zip_archive =
-        mi::mdl::MDL_zip_container_archive::open(
-            mdl->get_mdl_allocator(),
-            full_path.c_str(), 
-            err);
-    if (!zip_archive)
+    const Mdl_discovery_snapshot::Archive_listing& archive =
+        snapshot.get_archive(full_path, mdl->get_mdl_allocator());
+    if (!archive.m_valid)
         return false;
 
     std::vector<std::string>unhandled_packages;
     std::string ext;
-    for (int i = 0; i < zip_archive->get_num_entries(); ++i) {
-        std::string e = zip_archive->get_entry_name(i);
+    for (const std::string& e : archive.m_entries) {
 
         size_t e_pos = e.find_last_of('.');
         bool valid_entry = false;
@@ -1326,7 +1607,7 @@ bool Mdl_discovery_api_impl::read_archive(
                 }
             }
             if ((valid_entry) && (!is_filtered)) {
-                e_list.push_back(std::string(zip_archive->get_entry_name(i)));
+                e_list.push_back(e);
                 std::string res;
                 replace_expression(
                     e_list[e_list.size() - 1],
@@ -1351,11 +1632,11 @@ bool Mdl_discovery_api_impl::read_archive(
         e_list[e_list.size() - 1] = res;
     }
 
-    zip_archive->close();
     return true;
 }
 
 bool Mdl_discovery_api_impl::discover_archive(
+    Mdl_discovery_snapshot& snapshot,
     const mi::base::Handle<Mdl_package_info_impl>& parent,
     const char* search_path, 
     mi::Size s_idx, 
@@ -1363,7 +1644,7 @@ bool Mdl_discovery_api_impl::discover_archive(
     mi::Uint32 filter) const
 {
     std::vector<std::string> entry_list;
-    if (!read_archive(res_path, entry_list, filter))
+    if (!read_archive(snapshot, res_path, entry_list, filter))
         return false;
     
     for (mi::Size x = 0; x < entry_list.size(); ++x) {
@@ -1392,8 +1673,9 @@ bool Mdl_discovery_api_impl::discover_archive(
     return true;
 }
 
-mi::Sint32 Mdl_discovery_api_impl::start()
+mi::Sint32 Mdl_discovery_api_impl::start(DB::Database* database)
 {
+    m_database = database;
     m_path_module.set();
     m_mdlc_module.set();
     return 0;
@@ -1401,6 +1683,7 @@ mi::Sint32 Mdl_discovery_api_impl::start()
 
 mi::Sint32 Mdl_discovery_api_impl::shutdown()
 {
+    m_database = nullptr;
     m_path_module.reset();
     m_mdlc_module.reset();
     return 0;
@@ -1408,13 +1691,21 @@ mi::Sint32 Mdl_discovery_api_impl::shutdown()
 
 Mdl_discovery_result_impl::Mdl_discovery_result_impl(
     const Mdl_package_info_impl* graph,
-    const std::vector<std::string>& paths)
+    const std::vector<std::string>& paths,
+    const std::shared_ptr<const Mdl_discovery_snapshot>& snapshot)
     : m_graph(make_handle_dup(graph))
+    , m_snapshot(snapshot)
 {
     for (mi::Size i=0; i < paths.size(); ++i)
         m_search_paths.push_back(paths[i]);
 }
 
+const std::shared_ptr<const Mdl_discovery_snapshot>&
+Mdl_discovery_result_impl::get_snapshot() const
+{
+    return m_snapshot;
+}
+
 const mi::neuraylib::IMdl_package_info* Mdl_discovery_result_impl::get_graph() const
 {
     m_graph->retain();
@@ -38,9 +38,13 @@
 #include <mi/neuraylib/ineuray.h>
 #include <mi/neuraylib/istring.h>
 #include <mi/base/handle.h>
+#include <mi/base/iallocator.h>
 #include <mi/base/interface_implement.h>
 #include <base/system/main/access_module.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -51,6 +55,7 @@ namespace mi { namespace neuraylib { class INeuray; } }
 
 namespace MI {
 
+    namespace DB { class Database; }
     namespace PATH { class Path_module; }
     namespace MDLC { class Mdlc_module; }
     namespace MDL { class Mdl_module; }
@@ -499,6 +504,67 @@ class Mdl_package_info_impl
 };
 
 
+/// Directory listings and archive entries seen by a discovery run.
+///
+/// The graph construction reads the file system only through a snapshot. Snapshots are kept by
+/// the discovery result, such that incremental discovery can reuse listings of directories and
+/// archives whose modification time did not change. All methods are thread-safe.
+class Mdl_discovery_snapshot : public boost::noncopyable
+{
+    public:
+        /// Kinds of directory entries.
+        enum Entry_kind { EK_OTHER, EK_DIRECTORY, EK_FILE };
+
+        /// The entries of a directory in the order returned by the file system.
+        struct Directory_listing
+        {
+            double m_modification_time = 0.0;
+            bool m_valid = false;
+            std::vector<std::pair<std::string, Entry_kind>> m_entries;
+        };
+
+        /// The entry names of an archive.
+        struct Archive_listing
+        {
+            double m_modification_time = 0.0;
+            mi::Sint64 m_size = 0;
+            bool m_valid = false;
+            std::vector<std::string> m_entries;
+        };
+
+        /// Constructor.
+        ///
+        /// \param previous   Snapshot of an earlier discovery run, or \c NULL.
+        explicit Mdl_discovery_snapshot(
+            const std::shared_ptr<const Mdl_discovery_snapshot>& previous);
+
+        /// Returns the listing of a directory.
+        ///
+        /// The directory is only listed on the first call for \p path. The listing of the
+        /// previous snapshot is reused if the modification time of the directory did not change.
+        const Directory_listing& get_directory(const std::string& path);
+
+        /// Returns the entry names of an archive.
+        ///
+        /// The archive is only read on the first call for \p path. The entries of the previous
+        /// snapshot are reused if the modification time and size of the archive did not change.
+        const Archive_listing& get_archive(const std::string& path, mi::base::IAllocator* alloc);
+
+        /// Drops the reference to the previous snapshot after the discovery run.
+        void finish();
+
+    private:
+        /// Returns \c true if an entry of the previous snapshot with the given modification time
+        /// can be reused for a file system object with modification time \p modification_time.
+        bool is_unchanged(double previous_time, double modification_time) const;
+
+        std::shared_ptr<const Mdl_discovery_snapshot> m_previous;
+        double m_time;
+        std::map<std::string, Directory_listing> m_directories;
+        std::map<std::string, Archive_listing> m_archives;
+        mutable std::mutex m_mutex;
+};
+
 /// This class implements features to discover MDL content.
 class Mdl_discovery_api_impl
     : public mi::base::Interface_implement< mi::neuraylib::IMdl_discovery_api>,
@@ -511,7 +577,11 @@ class Mdl_discovery_api_impl
 
         const mi::neuraylib::IMdl_discovery_result* discover(mi::Uint32 filter) const final;
 
-        mi::Sint32 start();
+        const mi::neuraylib::IMdl_discovery_result* discover_incremental(
+            const mi::neuraylib::IMdl_discovery_result* previous,
+            mi::Uint32 filter) const final;
+
+        mi::Sint32 start(DB::Database* database);
 
         mi::Sint32 shutdown();
 
@@ -539,12 +609,14 @@ class Mdl_discovery_api_impl
 
         // Reads an archive and adds all modules and resource entries to e_list.
         bool read_archive(
+            Mdl_discovery_snapshot& snapshot,
             const char* res_path, 
             std::vector<std::string>& e_list,
             mi::Uint32 filter) const;
 
         // Creates a graph structure out of an mdl archive file.
         bool discover_archive(
+            Mdl_discovery_snapshot& snapshot,
             const mi::base::Handle<Mdl_package_info_impl>& parent,
             const char* search_path,
             mi::Size search_idx,
@@ -564,6 +636,7 @@ class Mdl_discovery_api_impl
 
         // Direct recursion to create a graph out of a folder from a file system.
         bool discover_filesystem_recursive(
+            Mdl_discovery_snapshot& snapshot,
             const mi::base::Handle<Mdl_package_info_impl>& parent,
             const char* search_path,
             mi::Size search_idx,
@@ -571,21 +644,43 @@ class Mdl_discovery_api_impl
             const std::vector<std::string>& invalid_dirs,
             mi::Uint32 filter) const;
 
+        // Lists the directory trees of the search paths and reads their archives in parallel.
+        void prefetch(
+            Mdl_discovery_snapshot& snapshot,
+            const std::vector<std::string>& search_paths,
+            mi::Uint32 filter) const;
+
         mi::neuraylib::INeuray*                          m_neuray;
+        DB::Database*                                    m_database;
         SYSTEM::Access_module<MDLC::Mdlc_module> m_mdlc_module;
         SYSTEM::Access_module<PATH::Path_module> m_path_module;
 };
 
+/// All discovery results created by Mdl_discovery_api_impl also implement this interface which
+/// allows access to the file system snapshot used to create them.
+class IMdl_discovery_snapshot_wrapper : public
+    mi::base::Interface_declare<0x92856c1d,0x610d,0x4eab,0xad,0x9e,0x31,0xb0,0x6b,0x2c,0xcb,0x2e>
+{
+public:
+    /// Returns the snapshot of the file system used to create this result.
+    virtual const std::shared_ptr<const Mdl_discovery_snapshot>& get_snapshot() const = 0;
+};
+
 /// This class implements the discover result.
 class Mdl_discovery_result_impl
-    : public mi::base::Interface_implement< mi::neuraylib::IMdl_discovery_result>
+    : public mi::base::Interface_implement_2<
+        mi::neuraylib::IMdl_discovery_result, IMdl_discovery_snapshot_wrapper>
 {
     public:
         Mdl_discovery_result_impl(
             const Mdl_package_info_impl* graph,
-            const std::vector<std::string>& paths);
+            const std::vector<std::string>& paths,
+            const std::shared_ptr<const Mdl_discovery_snapshot>& snapshot);
         ~Mdl_discovery_result_impl() {};
 
+        /// Returns the snapshot of the file system used to create this result.
+        const std::shared_ptr<const Mdl_discovery_snapshot>& get_snapshot() const final;
+
         /// Returns a pointer to the root of mdl graph.
         const mi::neuraylib::IMdl_package_info* get_graph() const final;
 
@@ -598,6 +693,7 @@ class Mdl_discovery_result_impl
     private:
         mi::base::Handle<const mi::neuraylib::IMdl_package_info> m_graph;
         std::vector<std::string> m_search_paths;
+        std::shared_ptr<const Mdl_discovery_snapshot> m_snapshot;
 };
 
 } // namespace NEURAY
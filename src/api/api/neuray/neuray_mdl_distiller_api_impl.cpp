@@ -34,6 +34,7 @@
 
 #include "neuray_mdl_distiller_api_impl.h"
 
+#include <algorithm>
 #include <string>
 #include <mi/neuraylib/icolor.h>
 #include <mi/neuraylib/imap.h>
@@ -466,6 +467,28 @@ mi::Sint32 Baker_impl::bake_texture( mi::neuraylib::ICanvas* texture, mi::Uint32
     return 0;
 }
 
+mi::Sint32 Baker_impl::bake_texture_adaptive(
+    mi::neuraylib::ICanvas* texture,
+    mi::Uint32 min_samples,
+    mi::Uint32 max_samples,
+    mi::Float32 tolerance,
+    mi::Uint64* num_samples) const
+{
+    if( !texture || min_samples == 0 || min_samples > max_samples || !(tolerance >= 0.0f))
+        return -1;
+    if( !m_transaction->is_open())
+        return -2;
+
+    // the error estimate needs at least two samples per pixel
+    min_samples = std::min( std::max( min_samples, 2u), max_samples);
+
+    if( m_baker_module->bake_texture_adaptive(
+        m_transaction, m_baker_code.get(), texture, min_samples, max_samples, tolerance,
+        /*state_flags*/ 0, num_samples) != 0)
+        return -3;
+    return 0;
+}
+
 mi::Sint32 Baker_impl::bake_constant( mi::IData* constant, mi::Uint32 samples) const
 {
     if( !constant)
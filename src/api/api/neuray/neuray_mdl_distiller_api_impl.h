@@ -134,6 +134,13 @@ public:
 
     mi::Sint32 bake_texture( mi::neuraylib::ICanvas* texture, mi::Uint32 samples) const;
 
+    mi::Sint32 bake_texture_adaptive(
+        mi::neuraylib::ICanvas* texture,
+        mi::Uint32 min_samples,
+        mi::Uint32 max_samples,
+        mi::Float32 tolerance,
+        mi::Uint64* num_samples) const;
+
     mi::Sint32 bake_constant( mi::IData* constant, mi::Uint32 samples) const;
 
     // internal methods
@@ -301,6 +301,9 @@ mi::Sint32 Transaction_impl::copy( const char* source, const char* target, mi::U
                 if( fc->is_immutable())
                     return -9;
             }
+
+            // overwriting might change the call graph
+            MDL::bump_validity_generation();
         }
 
         DB::Access<DB::Element_base> access(source_tag, m_db_transaction);
@@ -191,6 +191,46 @@ public:
     /// \see #mi::neuraylib::IDatabase_configuration::get_memory_limits().
     virtual void get_memory_limits( size_t& low_water, size_t& high_water) const = 0;
 
+    //@}
+    /// \name Snapshots
+    //@{
+
+    /// Writes all DB elements visible to a transaction to a snapshot file.
+    ///
+    /// For each DB element the file contains its tag, its name (if any), whether the tag has been
+    /// marked for removal, and the compressed serialized element itself. Referenced DB elements
+    /// precede the DB elements referencing them.
+    ///
+    /// \param transaction              The transaction whose view is written. RCS:NEU
+    /// \param filename                 The file to write.
+    /// \return
+    ///                                 -  0: Success.
+    ///                                 - -1: Invalid parameters (\p transaction is \c NULL or not
+    ///                                       open).
+    ///                                 - -2: Failed to open or write the file.
+    ///                                 - -3: A DB element references a tag that is not visible, or
+    ///                                       the references are cyclic.
+    virtual mi::Sint32 snapshot( Transaction* transaction, const std::string& filename) = 0;
+
+    /// Stores the DB elements of a snapshot file in a transaction.
+    ///
+    /// The DB elements keep their tags, names, and removal markers. This is meant for warm starts
+    /// of a database that does not yet contain DB elements with these tags or names. The classes of
+    /// all DB elements need to be registered with the deserialization manager.
+    ///
+    /// \param transaction              The transaction to store the DB elements in. In case of
+    ///                                 failure some DB elements might have been stored already, and
+    ///                                 the transaction should be aborted. RCS:NEU
+    /// \param filename                 The file to read.
+    /// \return
+    ///                                 -  0: Success.
+    ///                                 - -1: Invalid parameters (\p transaction is \c NULL or not
+    ///                                       open).
+    ///                                 - -2: Failed to open or read the file.
+    ///                                 - -3: Invalid file format, or unregistered class ID.
+    ///                                 - -4: A tag or name is already in use.
+    virtual mi::Sint32 restore( Transaction* transaction, const std::string& filename) = 0;
+
     //@}
     /// \name Listeners
     //@{
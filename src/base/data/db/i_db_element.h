@@ -92,6 +92,17 @@ public:
     /// Used to make decisions about garbage collection, offloading, etc.
     virtual size_t get_size() const { return sizeof( *this); }
 
+    /// Releases memory that can be restored transparently when needed again.
+    ///
+    /// Used by the database to obey the memory limits (see DB::Database::set_memory_limits()).
+    /// Typical candidates are data loaded lazily from files, or caches of derived data. The
+    /// database calls this method only for elements that are currently not accessed via the
+    /// database, but implementations need to be thread-safe w.r.t. users that obtained parts of the
+    /// element earlier.
+    ///
+    /// \return   \c true if some memory was released, \c false otherwise.
+    virtual bool evict_reloadable_data() { return false; }
+
     /// Indicates how the database element should be distributed in the cluster.
     ///
     /// If the method returns \c true the stored or edited database element is distributed to all
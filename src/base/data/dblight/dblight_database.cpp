@@ -33,6 +33,7 @@
 
 #include "dblight_info.h"
 #include "dblight_fragmented_job.h"
+#include "dblight_gc_job.h"
 #include "dblight_scope.h"
 #include "dblight_transaction.h"
 #include "dblight_util.h"
@@ -42,6 +43,8 @@
 #include <iostream>
 #endif // DBLIGHT_ENABLE_STATISTICS
 
+#include <thread>
+
 #include <base/data/db/i_db_element.h>
 #include <base/data/serial/serial.h>
 #include <base/data/thread_pool/i_thread_pool_thread_pool.h>
@@ -81,10 +84,27 @@ Database_impl::Database_impl()
     if( m_check_serialization_edit)
         LOG::mod_log->info( M_DB, LOG::Mod_log::C_DATABASE,
             "Testing of serialization for database elements after edits enabled.");
+
+    CONFIG::update_value( registry, "dblight_gc_incremental", m_gc_incremental);
+    CONFIG::update_value( registry, "dblight_gc_step_max_tags", m_gc_step_max_tags);
+    CONFIG::update_value( registry, "dblight_gc_step_max_time", m_gc_step_max_time);
+    if( m_gc_incremental)
+        LOG::mod_log->info( M_DB, LOG::Mod_log::C_DATABASE,
+            "Incremental garbage collection enabled (at most %u tags and %.1f ms per step).",
+            m_gc_step_max_tags, m_gc_step_max_time * 1000.0);
 }
 
 Database_impl::~Database_impl()
 {
+    // Wait for pending jobs, in particular GC jobs, before tearing down the managers.
+    m_thread_pool.reset();
+
+    // Complete the GC in case a GC job was still scheduled after the last transaction ended.
+    if( m_gc_incremental) {
+        THREAD::Block block( &m_lock);
+        m_info_manager->garbage_collection( m_transaction_manager->get_lowest_open_transaction_id());
+    }
+
     m_global_scope->unpin();
 
     // Clearing the transaction manager first will trigger assertions if there are infos left which
@@ -130,15 +150,14 @@ void Database_impl::check_is_locked( mi::Uint32 lock_id) NOT_IMPLEMENTED
 
 mi::Sint32 Database_impl::set_memory_limits( size_t low_water, size_t high_water)
 {
-    MI_ASSERT( !"Not implemented");
-    return -1;
+    THREAD::Block block( &m_lock);
+    return m_info_manager->set_memory_limits( low_water, high_water);
 }
 
 void Database_impl::get_memory_limits( size_t& low_water, size_t& high_water) const
 {
-    MI_ASSERT( !"Not implemented");
-    low_water = 0;
-    high_water = 0;
+    THREAD::Block_shared block( &m_lock);
+    m_info_manager->get_memory_limits( low_water, high_water);
 }
 
 void Database_impl::register_status_listener( DB::Status_listener* listener) NOT_IMPLEMENTED
@@ -217,9 +236,47 @@ SERIAL::Deserialization_manager* Database_impl::get_deserialization_manager()
     return m_deserialization_manager;
 }
 
+void Database_impl::schedule_incremental_garbage_collection()
+{
+    m_gc_pending = true;
+    if( m_gc_job_scheduled.exchange( true))
+        return;
+
+    mi::base::Handle<Gc_job> job( new Gc_job( this));
+    m_thread_pool->submit_job( job.get());
+}
+
+void Database_impl::execute_incremental_garbage_collection()
+{
+    while( true) {
+
+        m_gc_pending = false;
+
+        bool done = false;
+        while( !done) {
+            {
+                THREAD::Block block( &m_lock);
+                done = m_info_manager->garbage_collection_step(
+                    m_transaction_manager->get_lowest_open_transaction_id(),
+                    m_gc_step_max_tags,
+                    m_gc_step_max_time);
+            }
+            // Give threads waiting for the lock a chance before the next step.
+            if( !done)
+                std::this_thread::yield();
+        }
+
+        // Process requests that arrived after the last step started, unless a new job has already
+        // been scheduled for them.
+        m_gc_job_scheduled = false;
+        if( !m_gc_pending || m_gc_job_scheduled.exchange( true))
+            return;
+    }
+}
+
 void Database_impl::dump( std::ostream& s, bool mask_pointer_values)
 {
-    THREAD::Block_shared block( &m_lock);
+    THREAD::Block block( &m_lock);
 
     m_transaction_manager->dump( s, mask_pointer_values);
     m_info_manager->dump( s, mask_pointer_values);
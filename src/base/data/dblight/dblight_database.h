@@ -86,8 +86,11 @@ public:
     /*NI*/ bool unlock( mi::Uint32 lock_id) override;
     /*NI*/ void check_is_locked( mi::Uint32 lock_id) override;
 
-    /*NI*/ mi::Sint32 set_memory_limits( size_t low_water, size_t high_water) override;
-    /*NI*/ void get_memory_limits( size_t& low_water, size_t& high_water) const override;
+    mi::Sint32 set_memory_limits( size_t low_water, size_t high_water) override;
+    void get_memory_limits( size_t& low_water, size_t& high_water) const override;
+
+    mi::Sint32 snapshot( DB::Transaction* transaction, const std::string& filename) override;
+    mi::Sint32 restore( DB::Transaction* transaction, const std::string& filename) override;
 
     /*NI*/ void register_status_listener( DB::Status_listener* listener) override;
     /*NI*/ void unregister_status_listener( DB::Status_listener* listener) override;
@@ -153,9 +156,26 @@ public:
     /// Dumps the state of the database to the stream.
     void dump( std::ostream& s, bool mask_pointer_values = false);
 
+    /// Indicates whether the garbage collection after transaction ends is done incrementally on
+    /// the thread pool (instead of synchronously).
+    bool get_gc_incremental() const { return m_gc_incremental; }
+
+    /// Requests a run of the incremental garbage collection.
+    ///
+    /// Submits a GC job to the thread pool unless such a job is already scheduled or running. That
+    /// job picks up the request.
+    void schedule_incremental_garbage_collection();
+
+    /// Executes steps of the incremental garbage collection until all requests are processed.
+    ///
+    /// Each step holds the database lock in exclusive mode, and is limited by the budget given by
+    /// the debug options "dblight_gc_step_max_tags" and "dblight_gc_step_max_time". The lock is
+    /// released between the steps. Called by Gc_job.
+    void execute_incremental_garbage_collection();
+
 private:
     /// The central database lock.
-    THREAD::Shared_lock m_lock;
+    mutable THREAD::Shared_lock m_lock;
 
     /// The info manager.
     std::unique_ptr<Info_manager> m_info_manager;
@@ -180,6 +200,26 @@ private:
 
     /// Indicates whether serialization should be tested in Transaction::finish_edit().
     bool m_check_serialization_edit = false;
+
+    /// \name Incremental garbage collection
+    //@{
+
+    /// Indicates whether the incremental garbage collection is enabled.
+    bool m_gc_incremental = false;
+
+    /// The maximum number of tags processed per step.
+    mi::Uint32 m_gc_step_max_tags = 1000;
+
+    /// The maximum time per step (in seconds).
+    mi::Float64 m_gc_step_max_time = 0.002;
+
+    /// Indicates whether a run was requested since the current run started.
+    std::atomic_bool m_gc_pending = false;
+
+    /// Indicates whether a GC job is scheduled or running.
+    std::atomic_bool m_gc_job_scheduled = false;
+
+    //@}
 };
 
 } // namespace DBLIGHT
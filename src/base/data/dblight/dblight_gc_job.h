@@ -0,0 +1,77 @@
+/***************************************************************************************************
+ * Copyright (c) 2017-2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************************************/
+
+#ifndef BASE_DATA_DBLIGHT_DBLIGHT_GC_JOB_H
+#define BASE_DATA_DBLIGHT_DBLIGHT_GC_JOB_H
+
+#include <mi/base/interface_implement.h>
+
+#include <base/data/thread_pool/i_thread_pool_ijob.h>
+
+#include "dblight_database.h"
+
+namespace MI {
+
+namespace DBLIGHT {
+
+/// Runs the incremental garbage collection on the thread pool.
+///
+/// \see Database_impl::execute_incremental_garbage_collection()
+class Gc_job : public mi::base::Interface_implement<THREAD_POOL::IJob>
+{
+public:
+    /// Constructor.
+    Gc_job( Database_impl* database) : m_database( database) { }
+
+    // methods of THREAD_POOL::IJob
+
+    mi::Float32 get_cpu_load() const override { return 1.0f; }
+
+    mi::Float32 get_gpu_load() const override { return 0.0f; }
+
+    /// Lowest priority, the GC should not delay regular work.
+    mi::Sint8 get_priority() const override { return 127; }
+
+    void pre_execute( const mi::neuraylib::IJob_execution_context* context) override { }
+
+    void execute( const mi::neuraylib::IJob_execution_context* context) override
+    {
+        m_database->execute_incremental_garbage_collection();
+    }
+
+    bool is_remaining_work_splittable() override { return false; }
+
+private:
+    Database_impl* m_database;
+};
+
+} // namespace DBLIGHT
+
+} // namespace MI
+
+#endif // BASE_DATA_DBLIGHT_DBLIGHT_GC_JOB_H
@@ -30,6 +30,9 @@
 
 #include "dblight_info.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
 #include <numeric>
 #include <sstream>
 
@@ -38,6 +41,7 @@
 #include <base/data/db/i_db_element.h>
 #include <base/hal/thread/i_thread_block.h>
 #include <base/hal/thread/i_thread_rw_lock.h>
+#include <base/hal/time/i_time.h>
 #include <base/lib/config/config.h>
 #include <base/lib/log/i_log_logger.h>
 #include <base/util/registry/i_config_registry.h>
@@ -160,6 +164,13 @@ void Info_impl::set_element( DB::Element_base* element)
     m_element = element;
 }
 
+std::ptrdiff_t Info_impl::update_size()
+{
+    size_t old_size = m_size;
+    m_size = m_element ? m_element->get_size() : 0;
+    return static_cast<std::ptrdiff_t>( m_size) - static_cast<std::ptrdiff_t>( old_size);
+}
+
 bool operator==( const Info_impl& lhs, const Info_impl& rhs)
 {
     if( lhs.get_scope_id() != rhs.get_scope_id())
@@ -359,7 +370,7 @@ Minor_page::Minor_page()
 Infos_per_tag* Minor_page::find( size_t index) const
 {
     MI_ASSERT( index < L);
-    return m_infos_per_tags[index];
+    return m_infos_per_tags[index].load( std::memory_order_acquire);
 }
 
 void Minor_page::insert( size_t index, Infos_per_tag* element)
@@ -367,7 +378,7 @@ void Minor_page::insert( size_t index, Infos_per_tag* element)
     MI_ASSERT( index < L);
     auto& ptr = m_infos_per_tags[index];
     MI_ASSERT( !ptr);
-    ptr = element;
+    ptr.store( element, std::memory_order_release);
     ++m_local_size;
 }
 
@@ -382,16 +393,20 @@ void Minor_page::erase( size_t index)
 
 void Minor_page::apply( std::function<void( Infos_per_tag*)> f) const
 {
-    for( size_t i = 0; i < N; ++i)
-        if( m_infos_per_tags[i])
-            f( m_infos_per_tags[i]);
+    for( size_t i = 0; i < N; ++i) {
+        Infos_per_tag* ptr = m_infos_per_tags[i];
+        if( ptr)
+            f( ptr);
+    }
 }
 
 void Minor_page::get_tags( std::vector<DB::Tag>& tags) const
 {
-    for( size_t i = 0; i < N; ++i)
-        if( m_infos_per_tags[i])
-            tags.push_back( m_infos_per_tags[i]->get_tag());
+    for( size_t i = 0; i < N; ++i) {
+        Infos_per_tag* ptr = m_infos_per_tags[i];
+        if( ptr)
+            tags.push_back( ptr->get_tag());
+    }
 }
 
 Major_page::Major_page()
@@ -403,13 +418,13 @@ Major_page::Major_page()
 Major_page::~Major_page()
 {
     for( size_t i = 0; i < N; ++i)
-        delete m_minor_pages[i];
+        delete m_minor_pages[i].load();
 }
 
 Infos_per_tag* Major_page::find( size_t index) const
 {
     MI_ASSERT( index < L);
-    auto ptr = m_minor_pages[index >> S];
+    Minor_page* ptr = m_minor_pages[index >> S].load( std::memory_order_acquire);
     if( !ptr)
         return nullptr;
 
@@ -420,22 +435,25 @@ void Major_page::insert( size_t index, Infos_per_tag* element)
 {
     MI_ASSERT( index < L);
     auto& ptr = m_minor_pages[index >> S];
-    if( !ptr) {
-        ptr = new Minor_page;
+    Minor_page* page = ptr.load( std::memory_order_relaxed);
+    if( !page) {
+        page = new Minor_page;
+        ptr.store( page, std::memory_order_release);
         ++m_local_size;
     }
 
-    ptr->insert( index & M, element);
+    page->insert( index & M, element);
 }
 
 void Major_page::erase( size_t index)
 {
     MI_ASSERT( index < L);
     auto& ptr = m_minor_pages[index >> S];
-    MI_ASSERT( ptr);
-    ptr->erase( index & M);
-    if( ptr->get_local_size() == 0) {
-        delete ptr;
+    Minor_page* page = ptr.load( std::memory_order_relaxed);
+    MI_ASSERT( page);
+    page->erase( index & M);
+    if( page->get_local_size() == 0) {
+        delete page;
         ptr = nullptr;
         --m_local_size;
     }
@@ -444,7 +462,7 @@ void Major_page::erase( size_t index)
 void Major_page::apply( std::function<void( Infos_per_tag*)> f) const
 {
     for( size_t i = 0; i < N; ++i) {
-    auto ptr = m_minor_pages[i];
+        Minor_page* ptr = m_minor_pages[i];
         if( ptr)
             ptr->apply( f);
     }
@@ -453,7 +471,7 @@ void Major_page::apply( std::function<void( Infos_per_tag*)> f) const
 void Major_page::get_tags( std::vector<DB::Tag>& tags) const
 {
    for( size_t i = 0; i < N; ++i) {
-        auto ptr = m_minor_pages[i];
+        Minor_page* ptr = m_minor_pages[i];
         if( ptr)
             ptr->get_tags( tags);
     }
@@ -468,7 +486,7 @@ Tag_tree::Tag_tree()
 Tag_tree::~Tag_tree()
 {
     for( size_t i = 0; i < N; ++i)
-        delete m_major_pages[i];
+        delete m_major_pages[i].load();
 }
 
 Infos_per_tag* Tag_tree::find( DB::Tag tag) const
@@ -476,7 +494,7 @@ Infos_per_tag* Tag_tree::find( DB::Tag tag) const
     size_t index = tag();
 
     MI_ASSERT( index < L);
-    auto ptr = m_major_pages[index >> S];
+    Major_page* ptr = m_major_pages[index >> S].load( std::memory_order_acquire);
     if( !ptr)
         return nullptr;
 
@@ -488,13 +506,18 @@ void Tag_tree::insert( DB::Tag tag, Infos_per_tag* element)
     size_t index = tag();
 
     MI_ASSERT( index < L);
+
+    THREAD::Lock::Block block( &m_insert_lock);
+
     auto& ptr = m_major_pages[index >> S];
-    if( !ptr) {
-        ptr = new Major_page;
+    Major_page* page = ptr.load( std::memory_order_relaxed);
+    if( !page) {
+        page = new Major_page;
+        ptr.store( page, std::memory_order_release);
         ++m_local_size;
     }
 
-    ptr->insert( index & M, element);
+    page->insert( index & M, element);
     ++m_total_size;
 }
 
@@ -504,10 +527,11 @@ void Tag_tree::erase( DB::Tag tag)
 
     MI_ASSERT( index < L);
     auto& ptr = m_major_pages[index >> S];
-    MI_ASSERT( ptr);
-    ptr->erase( index & M);
-    if( ptr->get_local_size() == 0) {
-        delete ptr;
+    Major_page* page = ptr.load( std::memory_order_relaxed);
+    MI_ASSERT( page);
+    page->erase( index & M);
+    if( page->get_local_size() == 0) {
+        delete page;
         ptr = nullptr;
         --m_local_size;
     }
@@ -518,7 +542,7 @@ void Tag_tree::erase( DB::Tag tag)
 void Tag_tree::apply( std::function<void( Infos_per_tag*)> f) const
 {
    for( size_t i = 0; i < N; ++i) {
-        auto ptr = m_major_pages[i];
+        Major_page* ptr = m_major_pages[i];
         if( ptr)
             ptr->apply( f);
     }
@@ -527,7 +551,7 @@ void Tag_tree::apply( std::function<void( Infos_per_tag*)> f) const
 void Tag_tree::get_tags( std::vector<DB::Tag>& tags) const
 {
    for( size_t i = 0; i < N; ++i) {
-        auto ptr = m_major_pages[i];
+        Major_page* ptr = m_major_pages[i];
         if( ptr)
             ptr->get_tags( tags);
     }
@@ -558,6 +582,10 @@ Info_manager::~Info_manager()
     MI_ASSERT( m_gc_candidates_general.empty());
     MI_ASSERT( m_gc_candidates_pin_count_zero.empty());
 
+    // Unlink all infos before they are destroyed below.
+    m_accessed_infos = nullptr;
+    m_lru_infos.clear();
+
     // Each info has a tag, but not necessarily a name. Hence, clearing by name first does not
     // require a deleter for the infos, only when clearing by tag second.
 
@@ -566,8 +594,9 @@ Info_manager::~Info_manager()
     // longer exist and (b) all infos and Infos_per_tag containers are to be destroyed anyway.
 
     // This invalidates the Info::m_name pointers.
-    for( auto& it: m_infos_by_name)
-        delete it.second;
+    for( auto& shard: m_infos_by_name)
+        for( auto& it: shard.m_infos)
+            delete it.second;
 
     auto Destroy_infos_per_tag = []( Infos_per_tag* ipt){
         // Check that there is exactly one version per tag. Otherwise the GC might have missed
@@ -588,46 +617,65 @@ void Info_manager::store(
     DB::Tag tag,
     const char* name)
 {
-    THREAD::Block block( &m_database->get_lock());
+    {
+        THREAD::Block_shared block( &m_database->get_lock());
+        THREAD::Block block_tag( &get_tag_lock( tag));
 
-    // Retrieve (or create) set of infos for \p tag.
-    Infos_per_tag* infos_per_tag = m_infos_by_tag.find( tag);
-    if( !infos_per_tag) {
-        infos_per_tag = new Infos_per_tag( tag);
-        m_infos_by_tag.insert( tag, infos_per_tag);
-    }
-
-    // Retrieve (or create) set of infos for \p name (if not \c NULL).
-    Infos_per_name* infos_per_name = nullptr;
-    if( name) {
-        auto it_by_name = m_infos_by_name.find( name);
-        if( it_by_name == m_infos_by_name.end()) {
-            infos_per_name = new Infos_per_name( name);
-            m_infos_by_name[name] = infos_per_name;
-        } else {
-            infos_per_name = it_by_name->second;
+        // Retrieve (or create) set of infos for \p tag.
+        Infos_per_tag* infos_per_tag = m_infos_by_tag.find( tag);
+        if( !infos_per_tag) {
+            infos_per_tag = new Infos_per_tag( tag);
+            m_infos_by_tag.insert( tag, infos_per_tag);
         }
-        // Re-map name to a pointer that is guaranteed to exist as long as we need it.
-        name = infos_per_name->get_name().c_str();
-    }
 
-    // Create info.
-    Info_impl* info = new Info_impl( element, scope_id, transaction, version, tag, name);
+        // Retrieve (or create) set of infos for \p name (if not \c NULL).
+        THREAD::Shared_lock::Block_exclusive block_name;
+        Infos_per_name* infos_per_name = nullptr;
+        if( name) {
+            Name_shard& shard = get_name_shard( name);
+            block_name.set( &shard.m_lock);
+            auto it_by_name = shard.m_infos.find( name);
+            if( it_by_name == shard.m_infos.end()) {
+                infos_per_name = new Infos_per_name( name);
+                shard.m_infos[name] = infos_per_name;
+            } else {
+                infos_per_name = it_by_name->second;
+            }
+            // Re-map name to a pointer that is guaranteed to exist as long as we need it.
+            name = infos_per_name->get_name().c_str();
+        }
 
-    // Insert info into the sets of infos for that tag/name.
-    infos_per_tag->insert_info( info);
-    if( infos_per_name)
-        infos_per_name->insert_info( info);
+        // Create info.
+        Info_impl* info = new Info_impl( element, scope_id, transaction, version, tag, name);
+        info->set_last_access( ++m_access_counter);
+        m_total_size += info->update_size();
+        insert_lru_info( info);
+
+        // Insert info into the sets of infos for that tag/name.
+        infos_per_tag->insert_info( info);
+        if( infos_per_name)
+            infos_per_name->insert_info( info);
+
+        // Record DB element references of this info.
+        const DB::Tag_set& references = info->get_references();
+        increment_pin_counts( references);
+
+        // Consider tag as a candidate for garbage collection.
+        if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO) {
+            THREAD::Lock::Block block_gc( &m_gc_candidates_lock);
+            m_gc_candidates_general.insert( tag);
+        }
 
-    // Record DB element references of this info.
-    const DB::Tag_set& references = info->get_references();
-    increment_pin_counts( references);
+        info->unpin();
+    }
 
-    // Consider tag as a candidate for garbage collection.
-    if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO)
-        m_gc_candidates_general.insert( tag);
+    check_memory_limits_after_modification();
+}
 
-    info->unpin();
+Info_manager::Name_shard& Info_manager::get_name_shard( const char* name)
+{
+    size_t hash = robin_hood::hash_bytes( name, strlen( name));
+    return m_infos_by_name[hash % N_STRIPES];
 }
 
 Info_impl* Info_manager::lookup_info(
@@ -636,12 +684,16 @@ Info_impl* Info_manager::lookup_info(
     Statistics_helper helper( g_lookup_info_by_tag);
 
     THREAD::Block_shared block( &m_database->get_lock());
+    THREAD::Block_shared block_tag( &get_tag_lock( tag));
 
     Infos_per_tag* infos_per_tag = m_infos_by_tag.find( tag);
     if( !infos_per_tag)
         return nullptr;
 
-    return infos_per_tag->lookup_info( scope, transaction_id);
+    Info_impl* info = infos_per_tag->lookup_info( scope, transaction_id);
+    if( info)
+        record_access( info);
+    return info;
 }
 
 Info_impl* Info_manager::lookup_info(
@@ -652,12 +704,17 @@ Info_impl* Info_manager::lookup_info(
     MI_ASSERT( name);
 
     THREAD::Block_shared block( &m_database->get_lock());
+    Name_shard& shard = get_name_shard( name);
+    THREAD::Block_shared block_name( &shard.m_lock);
 
-    auto it = m_infos_by_name.find( name);
-    if( it == m_infos_by_name.end())
+    auto it = shard.m_infos.find( name);
+    if( it == shard.m_infos.end())
         return nullptr;
 
-    return it->second->lookup_info( scope, transaction_id);
+    Info_impl* info = it->second->lookup_info( scope, transaction_id);
+    if( info)
+        record_access( info);
+    return info;
 }
 
 Info_impl* Info_manager::start_edit(
@@ -669,15 +726,19 @@ Info_impl* Info_manager::start_edit(
     const char* name,
     const DB::Tag_set& references)
 {
-    THREAD::Block block( &m_database->get_lock());
+    THREAD::Block_shared block( &m_database->get_lock());
+    THREAD::Block block_tag( &get_tag_lock( tag));
 
     // Retrieve set of infos for \p tag.
     Infos_per_tag* infos_per_tag = m_infos_by_tag.find( tag);
 
     // Retrieve set of infos for \p name (if not \c NULL).
+    THREAD::Shared_lock::Block_exclusive block_name;
     Infos_per_name* infos_per_name = nullptr;
     if( name) {
-        infos_per_name = m_infos_by_name.find( name)->second;
+        Name_shard& shard = get_name_shard( name);
+        block_name.set( &shard.m_lock);
+        infos_per_name = shard.m_infos.find( name)->second;
         // No need to re-map name (it points already to the re-mapped destination).
         MI_ASSERT( name == infos_per_name->get_name().c_str());
     }
@@ -685,6 +746,9 @@ Info_impl* Info_manager::start_edit(
     // Create info.
     Info_impl* info = new Info_impl(
         element, scope_id, transaction, version, tag, name, references);
+    info->set_last_access( ++m_access_counter);
+    m_total_size += info->update_size();
+    insert_lru_info( info);
 
     // Insert info into the sets of infos for that tag/name.
     infos_per_tag->insert_info( info);
@@ -695,25 +759,36 @@ Info_impl* Info_manager::start_edit(
     increment_pin_counts( references);
 
     // Consider tag as a candidate for garbage collection.
-    if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO)
+    if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO) {
+        THREAD::Lock::Block block_gc( &m_gc_candidates_lock);
         m_gc_candidates_general.insert( tag);
+    }
 
     return info;
 }
 
 void Info_manager::finish_edit( Info_impl* info)
 {
-    THREAD::Block block( &m_database->get_lock());
+    {
+        // The info is still pinned by the editing transaction and its references are only used
+        // with the database lock held in exclusive mode. Hence, the tag stripe is not needed.
+        THREAD::Block_shared block( &m_database->get_lock());
 
-    const DB::Tag_set& old_references = info->get_references();
-    decrement_pin_counts( old_references, /*from_gc*/ false);
+        const DB::Tag_set& old_references = info->get_references();
+        decrement_pin_counts( old_references, /*from_gc*/ false);
 
-    info->update_references();
+        info->update_references();
 
-    const DB::Tag_set& new_references = info->get_references();
-    increment_pin_counts( new_references);
+        const DB::Tag_set& new_references = info->get_references();
+        increment_pin_counts( new_references);
 
-    info->unpin();
+        // The element has been modified since start_edit().
+        m_total_size += info->update_size();
+
+        info->unpin();
+    }
+
+    check_memory_limits_after_modification();
 }
 
 bool Info_manager::remove(
@@ -724,7 +799,8 @@ bool Info_manager::remove(
 {
     MI_ASSERT( scope_id == 0);
 
-    THREAD::Block block( &m_database->get_lock());
+    THREAD::Block_shared block( &m_database->get_lock());
+    THREAD::Block block_tag( &get_tag_lock( tag));
 
     // Retrieve set of infos for \p tag.
     Infos_per_tag* ipt = m_infos_by_tag.find( tag);
@@ -741,8 +817,10 @@ bool Info_manager::remove(
     ipt->insert_info( info);
 
     // Consider tag as a candidate for garbage collection.
-    if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO)
+    if( m_gc_method == GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO) {
+        THREAD::Lock::Block block_gc( &m_gc_candidates_lock);
         m_gc_candidates_general.insert( tag);
+    }
 
     // Prevent double removals.
     ipt->set_removed();
@@ -755,6 +833,13 @@ void Info_manager::garbage_collection( DB::Transaction_id lowest_open)
 {
     m_database->get_lock().check_is_owned();
 
+    ++m_gc_statistics.m_runs;
+
+    // Discard the state of an interrupted sequence of incremental steps, this call does all the
+    // work.
+    m_gc_step_pin_count_zero = false;
+    m_gc_step_cursor = DB::Tag();
+
     if( m_gc_method == GC_FULL_SWEEPS_ONLY) {
 
         while( true) {
@@ -830,11 +915,228 @@ void Info_manager::garbage_collection( DB::Transaction_id lowest_open)
     } else {
         MI_ASSERT( !"Unexpected GC method");
     }
+
+    // Elements might have grown since they were stored, e.g., by lazy loading.
+    check_memory_limits( /*update_all_sizes*/ false);
+}
+
+bool Info_manager::garbage_collection_step(
+    DB::Transaction_id lowest_open, size_t max_tags, mi::Float64 max_time)
+{
+    m_database->get_lock().check_is_owned();
+
+    ++m_gc_statistics.m_steps;
+
+    if( m_gc_method != GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO) {
+        garbage_collection( lowest_open);
+        return true;
+    }
+
+    TIME::Time start = TIME::get_time();
+    size_t processed_tags = 0;
+    auto budget_exhausted = [&]() {
+        return (processed_tags >= max_tags)
+            || ((TIME::get_time() - start).get_seconds() >= max_time);
+    };
+
+    // Same work as in garbage_collection(), but resumable. Tags added to the general candidates
+    // before the cursor are picked up by the next sequence of steps.
+    if( !m_gc_step_pin_count_zero) {
+
+        auto it = m_gc_candidates_general.upper_bound( m_gc_step_cursor);
+        while( it != m_gc_candidates_general.end()) {
+            if( budget_exhausted())
+                return false;
+            DB::Tag tag = *it;
+            bool progress_tag = false;
+            cleanup_tag_general( tag, lowest_open, progress_tag);
+            ++processed_tags;
+            m_gc_step_cursor = tag;
+            it = m_gc_candidates_general.upper_bound( tag);
+        }
+
+        m_gc_step_pin_count_zero = true;
+        m_gc_step_cursor = DB::Tag();
+    }
+
+    while( !m_gc_candidates_pin_count_zero.empty()) {
+        if( budget_exhausted())
+            return false;
+        DB::Tag tag = *m_gc_candidates_pin_count_zero.begin();
+        m_gc_candidates_pin_count_zero.erase( m_gc_candidates_pin_count_zero.begin());
+        bool progress_tag = false;
+        cleanup_tag_with_pin_count_zero( tag, progress_tag);
+        ++processed_tags;
+    }
+
+    m_gc_step_pin_count_zero = false;
+
+    // Elements might have grown since they were stored, e.g., by lazy loading.
+    check_memory_limits( /*update_all_sizes*/ false);
+    return true;
+}
+
+Info_manager::Gc_statistics Info_manager::get_gc_statistics() const
+{
+    THREAD::Block_shared block( &m_database->get_lock());
+    return m_gc_statistics;
+}
+
+mi::Sint32 Info_manager::set_memory_limits( size_t low_water, size_t high_water)
+{
+    m_database->get_lock().check_is_owned();
+
+    if( high_water > 0 && low_water >= high_water)
+        return -1;
+
+    m_low_water          = high_water > 0 ? low_water : 0;
+    m_high_water         = high_water;
+    m_eviction_threshold = high_water > 0 ? high_water : SIZE_MAX;
+
+    check_memory_limits( /*update_all_sizes*/ true);
+    return 0;
+}
+
+void Info_manager::get_memory_limits( size_t& low_water, size_t& high_water) const
+{
+    low_water  = m_low_water;
+    high_water = m_high_water;
+}
+
+Info_manager::Memory_statistics Info_manager::get_memory_statistics() const
+{
+    THREAD::Block_shared block( &m_database->get_lock());
+    Memory_statistics result = m_memory_statistics;
+    result.m_total_size = m_total_size;
+    return result;
+}
+
+void Info_manager::check_memory_limits_after_modification()
+{
+    if( m_total_size <= m_eviction_threshold)
+        return;
+
+    THREAD::Block block( &m_database->get_lock());
+    check_memory_limits( /*update_all_sizes*/ false);
+}
+
+void Info_manager::check_memory_limits( bool update_all_sizes)
+{
+    m_database->get_lock().check_is_owned();
+
+    if( m_high_water == 0)
+        return;
+
+    process_accessed_infos();
+
+    if( update_all_sizes) {
+        size_t total_size = m_total_size;
+        for( Info_impl& info: m_lru_infos)
+            total_size += info.update_size();
+        m_total_size = total_size;
+        m_lru_infos.sort( []( const Info_impl& lhs, const Info_impl& rhs) {
+            return lhs.get_last_access() < rhs.get_last_access(); });
+    }
+
+    size_t total_size = m_total_size;
+    if( total_size <= m_eviction_threshold)
+        return;
+
+    // Evict in LRU order until the low water mark is reached. Visited infos that are not pinned
+    // are moved to the end, their data is either evicted now or there is nothing to evict.
+    size_t old_total_size = total_size;
+    size_t evicted_elements = 0;
+    auto it = m_lru_infos.begin();
+    for( size_t n = m_lru_infos.size(); n > 0 && total_size > m_low_water; --n) {
+        Info_impl& info = *it;
+        if( info.get_pin_count() > 0) {
+            ++it;
+            continue;
+        }
+        it = m_lru_infos.erase( it);
+        m_lru_infos.push_back( info);
+        if( !info.get_element()->evict_reloadable_data())
+            continue;
+        total_size += info.update_size();
+        ++evicted_elements;
+    }
+    m_total_size = total_size;
+
+    ++m_memory_statistics.m_eviction_runs;
+    m_memory_statistics.m_evicted_elements += evicted_elements;
+    m_memory_statistics.m_evicted_bytes
+        += old_total_size > total_size ? old_total_size - total_size : 0;
+
+    // If the low water mark could not be reached, do not try again from store() or finish_edit()
+    // before the total size has grown by the gap between the two water marks.
+    m_eviction_threshold = std::max( m_high_water, total_size + (m_high_water - m_low_water));
+
+    LOG::mod_log->debug( M_DB, LOG::Mod_log::C_DATABASE,
+        "Evicted data of %zu elements, total size reduced from %zu to %zu bytes "
+        "(low water mark %zu, high water mark %zu).",
+        evicted_elements, old_total_size, total_size, m_low_water, m_high_water);
+}
+
+void Info_manager::record_access( Info_impl* info)
+{
+    info->set_last_access( m_access_counter.fetch_add( 1, std::memory_order_relaxed) + 1);
+
+    if( m_high_water == 0 || !info->mark_accessed())
+        return;
+
+    Info_impl* head = m_accessed_infos.load( std::memory_order_relaxed);
+    do
+        info->m_next_accessed = head;
+    while( !m_accessed_infos.compare_exchange_weak(
+        head, info, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void Info_manager::process_accessed_infos()
+{
+    m_database->get_lock().check_is_owned();
+
+    Info_impl* head = m_accessed_infos.exchange( nullptr, std::memory_order_acquire);
+    if( !head)
+        return;
+
+    std::vector<Info_impl*> infos;
+    Info_impl* pinned = nullptr;
+    while( head) {
+        Info_impl* info = head;
+        head = head->m_next_accessed;
+        infos.push_back( info);
+        if( info->get_pin_count() > 0) {
+            info->m_next_accessed = pinned;
+            pinned = info;
+        } else {
+            info->m_next_accessed = nullptr;
+            info->clear_accessed();
+        }
+    }
+    m_accessed_infos = pinned;
+
+    std::sort( infos.begin(), infos.end(), []( const Info_impl* lhs, const Info_impl* rhs) {
+        return lhs->get_last_access() < rhs->get_last_access(); });
+
+    size_t total_size = m_total_size;
+    for( Info_impl* info: infos) {
+        total_size += info->update_size();
+        m_lru_infos.erase( m_lru_infos.iterator_to( *info));
+        m_lru_infos.push_back( *info);
+    }
+    m_total_size = total_size;
+}
+
+void Info_manager::insert_lru_info( Info_impl* info)
+{
+    THREAD::Lock::Block block( &m_lru_lock);
+    m_lru_infos.push_back( *info);
 }
 
 mi::Uint32 Info_manager::get_tag_reference_count( DB::Tag tag)
 {
     THREAD::Block_shared block( &m_database->get_lock());
+    THREAD::Block_shared block_tag( &get_tag_lock( tag));
 
     // Retrieve set of infos for \p tag.
     Infos_per_tag* ipt = m_infos_by_tag.find( tag);
@@ -847,6 +1149,7 @@ mi::Uint32 Info_manager::get_tag_reference_count( DB::Tag tag)
 bool Info_manager::get_tag_is_removed( DB::Tag tag)
 {
     THREAD::Block_shared block( &m_database->get_lock());
+    THREAD::Block_shared block_tag( &get_tag_lock( tag));
 
    // Retrieve set of infos for \p tag.
     Infos_per_tag* ipt = m_infos_by_tag.find( tag);
@@ -856,6 +1159,17 @@ bool Info_manager::get_tag_is_removed( DB::Tag tag)
     return ipt->get_is_removed();
 }
 
+void Info_manager::get_tags( std::vector<DB::Tag>& tags)
+{
+    // Tags are only erased under the exclusive lock. Concurrent stores insert tags under the
+    // shared lock, but their tags are not visible to the caller's transaction anyway.
+    THREAD::Block_shared block( &m_database->get_lock());
+
+    tags.clear();
+    tags.reserve( m_infos_by_tag.size());
+    m_infos_by_tag.get_tags( tags);
+}
+
 namespace {
 
 std::ostream& operator<<( std::ostream& s, const DB::Tag_set& tag_set)
@@ -950,16 +1264,20 @@ void dump( std::ostream& s, bool mask_pointer_values, const Infos_per_tag* ipt,
 
 void Info_manager::dump( std::ostream& s, bool mask_pointer_values)
 {
-    s << "Count of infos by distinct names: " << m_infos_by_name.size() << std::endl;
+    m_database->get_lock().check_is_owned();
+
+    // Dump by order of names, not by order of hashes or shards.
+    std::map<std::string, const Infos_per_name*> names;
+    for( const auto& shard: m_infos_by_name)
+        for( const auto& ipn: shard.m_infos)
+            names[ipn.first] = ipn.second;
+
+    s << "Count of infos by distinct names: " << names.size() << std::endl;
 
     size_t j1 = 0;
-    // Dump by order of names, not by order of hashes.
-    std::set<std::string> names;
-    for( const auto& ipn: m_infos_by_name)
-        names.insert( ipn.first);
     for( const auto& name: names)
-        DBLIGHT::dump( s, mask_pointer_values, m_infos_by_name[name], j1++);
-    if( !m_infos_by_name.empty())
+        DBLIGHT::dump( s, mask_pointer_values, name.second, j1++);
+    if( !names.empty())
         s << std::endl;
 
     s << "Count of infos by distinct tags: " << m_infos_by_tag.size() << std::endl;
@@ -1182,12 +1500,18 @@ Infos_per_tag::Infos_per_tag_set::iterator Info_manager::cleanup_info(
     Info_impl* info = & *it;
     MI_ASSERT( info->get_pin_count() == 0);
 
+    // Unlink the info from the memory limit data structures.
+    if( info->get_accessed())
+        process_accessed_infos();
+    if( info->m_lru_hook.is_linked())
+        m_lru_infos.erase( m_lru_infos.iterator_to( *info));
+
     const char* name = info->get_name();
     if( name) {
         Infos_per_name* infos_per_name = info->get_infos_per_name();
         infos_per_name->erase_info( info);
         if( infos_per_name->get_infos().empty()) {
-            m_infos_by_name.erase( name);
+            get_name_shard( name).m_infos.erase( name);
             delete infos_per_name;
         }
     }
@@ -1196,6 +1520,9 @@ Infos_per_tag::Infos_per_tag_set::iterator Info_manager::cleanup_info(
 
     const DB::Tag_set& old_references = info->get_references();
     decrement_pin_counts( old_references, /*from_gc*/ true);
+    m_total_size -= info->get_size();
+    ++m_gc_statistics.m_reclaimed_infos;
+    m_gc_statistics.m_reclaimed_bytes += info->get_size();
     delete info;
 
     return next;
@@ -1203,7 +1530,12 @@ Infos_per_tag::Infos_per_tag_set::iterator Info_manager::cleanup_info(
 
 void Info_manager::increment_pin_counts( const DB::Tag_set& tag_set)
 {
-    m_database->get_lock().check_is_owned();
+    m_database->get_lock().check_is_owned_shared_or_exclusive();
+
+    if( tag_set.empty())
+        return;
+
+    THREAD::Lock::Block block( &m_gc_candidates_lock);
 
     for( const DB::Tag& tag: tag_set) {
         Infos_per_tag* ipt = m_infos_by_tag.find( tag);
@@ -1216,7 +1548,12 @@ void Info_manager::increment_pin_counts( const DB::Tag_set& tag_set)
 
 void Info_manager::decrement_pin_counts( const DB::Tag_set& tag_set, bool from_gc)
 {
-    m_database->get_lock().check_is_owned();
+    m_database->get_lock().check_is_owned_shared_or_exclusive();
+
+    if( tag_set.empty())
+        return;
+
+    THREAD::Lock::Block block( &m_gc_candidates_lock);
 
     for( const DB::Tag& tag: tag_set) {
         Infos_per_tag* ipt = m_infos_by_tag.find( tag);
@@ -32,13 +32,18 @@
 #include <base/data/db/i_db_info.h>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <vector>
 
 #include <boost/core/noncopyable.hpp>
+#include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 
 #include <base/data/db/i_db_scope.h>
+#include <base/hal/thread/i_thread_lock.h>
+#include <base/hal/thread/i_thread_rw_lock.h>
 #include <base/lib/robin_hood/robin_hood.h>
 
 #include "dblight_transaction.h"
@@ -158,6 +163,31 @@ public:
     /// Only to be used for serialization checks.
     void set_element( DB::Element_base* element);
 
+    /// Returns the size of the DB element as measured by the last call to #update_size().
+    size_t get_size() const { return m_size; }
+
+    /// Measures the size of the DB element (0 for removals) and returns the difference to the
+    /// previous measurement.
+    std::ptrdiff_t update_size();
+
+    /// Marks the info as accessed since its size was measured.
+    ///
+    /// \return   \c true if the info was not marked before, i.e., the caller needs to record it
+    ///           in Info_manager::m_accessed_infos.
+    bool mark_accessed() { return !m_accessed.exchange( true); }
+
+    /// Indicates whether the info is marked as accessed (see #mark_accessed()).
+    bool get_accessed() const { return m_accessed; }
+
+    /// Clears the mark set by #mark_accessed().
+    void clear_accessed() { m_accessed = false; }
+
+    /// Returns the stamp of the last access (see Info_manager::lookup_info()).
+    mi::Uint64 get_last_access() const { return m_last_access; }
+
+    /// Sets the stamp of the last access.
+    void set_last_access( mi::Uint64 stamp) { m_last_access = stamp; }
+
 private:
     // The only members that can change after construction are the element pointer (if serialization
     /// checks for edits are enabled), the pin count, the transaction pointer (reset only), the set
@@ -206,11 +236,24 @@ private:
     /// Can be invalid if the info is visible for all open (and future) transactions.
     Transaction_impl_ptr m_transaction;
 
+    /// The size of m_element as of the last call to #update_size().
+    size_t m_size = 0;
+
+    /// The stamp of the last access. Updated with the database lock held in shared mode.
+    std::atomic_uint64_t m_last_access = 0;
+
+    /// Indicates whether the info is recorded in Info_manager::m_accessed_infos.
+    std::atomic_bool m_accessed = false;
+
 public:
     /// Hook for Infos_per_name::m_infos.
     bi::set_member_hook<> m_infos_per_name_hook;
     /// Hook for Infos_per_tag::m_infos.
     bi::set_member_hook<> m_infos_per_tag_hook;
+    /// Hook for Info_manager::m_lru_infos.
+    bi::list_member_hook<> m_lru_hook;
+    /// Next info in Info_manager::m_accessed_infos.
+    Info_impl* m_next_accessed = nullptr;
 };
 
 /// Comparison operators for Info_impl.
@@ -415,8 +458,8 @@ private:
     /// Returns the number of non-\c NULL array elements.
     size_t get_local_size() const { return m_local_size; }
 
-    /// The array of minor pages.
-    Infos_per_tag* m_infos_per_tags[N];
+    /// The array of Infos_per_tag pointers.
+    std::atomic<Infos_per_tag*> m_infos_per_tags[N];
     /// The number of non-\c NULL array elements.
     size_t m_local_size = 0;
 };
@@ -469,7 +512,7 @@ private:
     size_t get_local_size() const { return m_local_size; }
 
     /// The array of minor pages.
-    Minor_page* m_minor_pages[N];
+    std::atomic<Minor_page*> m_minor_pages[N];
     /// The number of allocated minor pages.
     size_t m_local_size = 0;
 };
@@ -483,6 +526,10 @@ private:
 /// the major and minor pages, which are allocated and deallocated on demand.
 ///
 /// Owns the major and minor pages, but does \em not own the Infos_per_tag instances.
+///
+/// #find() can be called concurrently with #insert() (page pointers are published atomically), and
+/// concurrent calls of #insert() are serialized internally. The caller needs to ensure that
+/// concurrent calls for the same tag do not happen. All other methods require exclusive access.
 class Tag_tree
 {
 public:
@@ -529,17 +576,28 @@ public:
 
 private:
     /// The array of major pages.
-    Major_page* m_major_pages[N];
+    std::atomic<Major_page*> m_major_pages[N];
     /// The number of allocated major pages.
     size_t m_local_size = 0;
     /// The total number of non-\c NULL array elements.
-    size_t m_total_size = 0;
+    std::atomic_size_t m_total_size = 0;
+    /// Serializes concurrent calls of #insert().
+    THREAD::Lock m_insert_lock;
 };
 
 /// The three-level hierarchy needs to cover the entire value range of tags.
 static_assert( Minor_page::N + Major_page::N + Tag_tree::N >= 32);
 
 /// The info manager owns all infos, and indirectly, all elements.
+///
+/// Locking scheme: Operations that only add infos or change pin counts (store, edits, removals,
+/// lookups) hold the database lock in shared mode, plus the lock stripe for the affected tag and
+/// the shard for the affected name (exclusive mode for modifications, shared mode for lookups).
+/// Hence, lookups of unrelated tags or names do not block on such modifications. Operations that
+/// destroy infos or iterate over all of them (garbage collection, eviction, dumps) hold the
+/// database lock in exclusive mode and do not need any of the finer-grained locks.
+///
+/// Lock order: database lock, tag stripe, name shard, #m_gc_candidates_lock, #m_lru_lock.
 class Info_manager
 {
 public:
@@ -633,12 +691,81 @@ public:
     ///                      next transaction if there are no open transactions).
     void garbage_collection( DB::Transaction_id lowest_open);
 
+    /// Runs one step of the incremental garbage collection.
+    ///
+    /// A sequence of steps that ends with a step returning \c true is equivalent to one call of
+    /// #garbage_collection(). Each step processes tags until the budget is exhausted, the next
+    /// step resumes from there. Only the GC method #GC_GENERAL_CANDIDATES_THEN_PIN_COUNT_ZERO can
+    /// be interrupted, for the other methods each step is a full call of #garbage_collection().
+    ///
+    /// \param lowest_open   The currently lowest ID of all open transactions (or the ID of the
+    ///                      next transaction if there are no open transactions).
+    /// \param max_tags      The maximum number of tags to process in this step.
+    /// \param max_time      The maximum time to spend in this step (in seconds).
+    /// \return              \c true if the sequence of steps is complete, \c false if there is
+    ///                      work left.
+    bool garbage_collection_step(
+        DB::Transaction_id lowest_open, size_t max_tags, mi::Float64 max_time);
+
+    /// Statistics about the garbage collection.
+    struct Gc_statistics
+    {
+        /// The number of calls of #garbage_collection() (including those from
+        /// #garbage_collection_step() for GC methods that cannot be interrupted).
+        size_t m_runs = 0;
+        /// The number of calls of #garbage_collection_step().
+        size_t m_steps = 0;
+        /// The number of destroyed infos.
+        size_t m_reclaimed_infos = 0;
+        /// The sizes of the destroyed infos (see Info_impl::get_size()).
+        size_t m_reclaimed_bytes = 0;
+    };
+
+    /// Returns the statistics about the garbage collection.
+    Gc_statistics get_gc_statistics() const;
+
+    /// Sets the memory limits.
+    ///
+    /// If the total size of all DB elements exceeds the high water mark, reloadable data of DB
+    /// elements that are currently not accessed is evicted in LRU order until the total size drops
+    /// below the low water mark (see DB::Element_base::evict_reloadable_data()).
+    ///
+    /// \param low_water    The low water mark.
+    /// \param high_water   The high water mark. The value 0 disables the memory limits.
+    /// \return             0 in case of success, -1 if \p low_water is not less than
+    ///                     \p high_water (unless \p high_water is 0).
+    mi::Sint32 set_memory_limits( size_t low_water, size_t high_water);
+
+    /// Returns the memory limits.
+    void get_memory_limits( size_t& low_water, size_t& high_water) const;
+
+    /// Statistics about the memory limits.
+    struct Memory_statistics
+    {
+        /// The total size of all DB elements (as of the last measurement).
+        size_t m_total_size = 0;
+        /// The number of eviction runs.
+        size_t m_eviction_runs = 0;
+        /// The number of DB elements for which data was evicted.
+        size_t m_evicted_elements = 0;
+        /// The number of bytes released by eviction.
+        size_t m_evicted_bytes = 0;
+    };
+
+    /// Returns the statistics about the memory limits.
+    Memory_statistics get_memory_statistics() const;
+
     /// Returns the pin count of the corresponding Infos_per_tag set.
     mi::Uint32 get_tag_reference_count( DB::Tag tag);
 
     /// Indicates whether the tag has been marked for removal.
     bool get_tag_is_removed( DB::Tag tag);
 
+    /// Returns all tags with at least one info (in ascending order).
+    ///
+    /// Note that the infos of these tags are not necessarily visible to any transaction.
+    void get_tags( std::vector<DB::Tag>& tags);
+
     /// Dumps the state of the info manager to the stream.
     void dump( std::ostream& s, bool mask_pointer_values);
 
@@ -684,6 +811,47 @@ private:
     /// Decrements the pin counts of the given tags.
     void decrement_pin_counts( const DB::Tag_set& tag_set, bool from_gc);
 
+    /// Acquires the database lock in exclusive mode and evicts data if the total size exceeds the
+    /// eviction threshold.
+    ///
+    /// Used after modifications that hold the database lock only in shared mode. The caller must
+    /// not hold the database lock.
+    void check_memory_limits_after_modification();
+
+    /// Evicts data if the total size exceeds the eviction threshold.
+    ///
+    /// Updates the sizes of the infos accessed since their last measurement first. Eviction
+    /// visits the infos in LRU order and stops as soon as the low water mark is reached.
+    ///
+    /// The caller needs to hold the database lock in exclusive mode.
+    ///
+    /// \param update_all_sizes   Indicates whether the sizes of all infos should be measured
+    ///                           again, and #m_lru_infos be sorted by the access stamps. Needed
+    ///                           when enabling the memory limits since accesses are not recorded
+    ///                           while they are disabled.
+    void check_memory_limits( bool update_all_sizes);
+
+    /// Records an access of \p info for the memory limits.
+    ///
+    /// Sets a new access stamp and pushes the info onto #m_accessed_infos if memory limits are
+    /// enabled and the info is not yet recorded there. Requires only the database lock in shared
+    /// mode.
+    void record_access( Info_impl* info);
+
+    /// Processes #m_accessed_infos.
+    ///
+    /// Updates the sizes of the recorded infos and moves them to the end of #m_lru_infos in the
+    /// order of their access stamps. Pinned infos stay recorded since their elements might still
+    /// change while being accessed.
+    ///
+    /// The caller needs to hold the database lock in exclusive mode.
+    void process_accessed_infos();
+
+    /// Inserts \p info at the end of #m_lru_infos.
+    ///
+    /// The caller needs to hold the database lock (in shared or exclusive mode).
+    void insert_lru_info( Info_impl* info);
+
     /// Instance of the database this manager belongs to.
     Database_impl* const m_database;
 
@@ -694,12 +862,41 @@ private:
 
     using Infos_by_tag = Tag_tree;
 
-    /// All infos that have a name ordered by name.
-    Infos_by_name m_infos_by_name;
+    /// Number of tag stripes and name shards.
+    static const size_t N_STRIPES = 64;
+
+    /// A lock stripe for tags.
+    struct alignas( 64) Tag_stripe
+    {
+        /// Protects the Infos_per_tag sets of all tags mapped to this stripe.
+        THREAD::Shared_lock m_lock;
+    };
+
+    /// A shard of the infos that have a name.
+    struct alignas( 64) Name_shard
+    {
+        /// Protects m_infos and the Infos_per_name sets referenced by it.
+        THREAD::Shared_lock m_lock;
+        /// All infos that have a name mapped to this shard by name.
+        Infos_by_name m_infos;
+    };
+
+    /// Returns the lock stripe for \p tag.
+    THREAD::Shared_lock& get_tag_lock( DB::Tag tag)
+    { return m_tag_stripes[tag() % N_STRIPES].m_lock; }
+
+    /// Returns the shard for \p name.
+    Name_shard& get_name_shard( const char* name);
+
+    /// All infos that have a name, sharded by the hash value of the name.
+    Name_shard m_infos_by_name[N_STRIPES];
 
     /// All infos ordered by tag.
     Infos_by_tag m_infos_by_tag;
 
+    /// The lock stripes for #m_infos_by_tag.
+    Tag_stripe m_tag_stripes[N_STRIPES];
+
     //@}
     /// \name Garbage collection
     //@{
@@ -734,6 +931,74 @@ private:
     /// Only used when #m_gc_method is not #GC_FULL_SWEEPS_ONLY.
     DB::Tag_set m_gc_candidates_pin_count_zero;
 
+    /// Indicates whether the current sequence of incremental GC steps has finished processing
+    /// #m_gc_candidates_general and is processing #m_gc_candidates_pin_count_zero.
+    bool m_gc_step_pin_count_zero = false;
+
+    /// The last tag of #m_gc_candidates_general processed by the current sequence of incremental
+    /// GC steps (or the invalid tag at the start of the sequence).
+    DB::Tag m_gc_step_cursor;
+
+    /// The statistics about the garbage collection.
+    Gc_statistics m_gc_statistics;
+
+    /// Protects both sets of GC candidates and the pin counts of Infos_per_tag (such that changes
+    /// of the pin count and of the set of candidates are atomic) while the database lock is held
+    /// in shared mode.
+    THREAD::Lock m_gc_candidates_lock;
+
+    //@}
+    /// \name Memory limits
+    //@{
+
+    /// The low water mark.
+    size_t m_low_water = 0;
+
+    /// The high water mark, or 0 if memory limits are disabled.
+    size_t m_high_water = 0;
+
+    /// The total size of all infos that triggers the next eviction run from store() or
+    /// finish_edit(). At least #m_high_water, but higher if the last run could not reach the low
+    /// water mark (to avoid repeated unsuccessful runs). The maximum value if memory limits are
+    /// disabled.
+    std::atomic_size_t m_eviction_threshold = SIZE_MAX;
+
+    /// Counter for the access stamps of infos.
+    ///
+    /// Incremented by modifications and lookups such that each access gets a distinct stamp and
+    /// an element read after another one is considered more recently used (even if no
+    /// modifications happened in between).
+    std::atomic_uint64_t m_access_counter = 0;
+
+    /// The sum of Info_impl::get_size() of all infos.
+    std::atomic_size_t m_total_size = 0;
+
+    using Lru_hook = bi::member_hook<Info_impl, bi::list_member_hook<>, &Info_impl::m_lru_hook>;
+
+    using Lru_list = bi::list<Info_impl, Lru_hook>;
+
+    /// All infos except removals, approximately in LRU order.
+    ///
+    /// New infos are appended by store() and start_edit(). Accessed infos are only moved to the
+    /// end when #m_accessed_infos is processed. Infos visited by eviction are moved to the end
+    /// such that subsequent eviction runs do not visit them first again. Modified with the
+    /// database lock held in shared mode and #m_lru_lock, or with the database lock held in
+    /// exclusive mode.
+    Lru_list m_lru_infos;
+
+    /// Protects #m_lru_infos while the database lock is held in shared mode.
+    THREAD::Lock m_lru_lock;
+
+    /// Lock-free stack of infos accessed since their sizes were measured, linked via
+    /// Info_impl::m_next_accessed.
+    ///
+    /// Pushed by lookups, popped with the database lock held in exclusive mode. Avoids that
+    /// eviction runs need to visit all infos to find those whose size might have changed.
+    std::atomic<Info_impl*> m_accessed_infos = nullptr;
+
+    /// The statistics (except for the total size, see #m_total_size).
+    Memory_statistics m_memory_statistics;
+
     //@}
 };
 
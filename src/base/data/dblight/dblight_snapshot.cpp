@@ -0,0 +1,486 @@
+/***************************************************************************************************
+ * Copyright (c) 2012-2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************************************/
+
+#include "pch.h"
+
+#include "dblight_database.h"
+
+#include "dblight_info.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <base/data/db/i_db_element.h>
+#include <base/data/db/i_db_fragmented_job.h>
+#include <base/data/db/i_db_transaction.h>
+#include <base/data/serial/i_compressed_serialization.h>
+#include <base/data/serial/i_serial_buffer_serializer.h>
+#include <base/data/serial/i_serial_file_serializer.h>
+#include <base/data/serial/serial.h>
+#include <base/hal/disk/disk.h>
+#include <base/hal/disk/i_disk_file.h>
+#include <base/lib/log/i_log_logger.h>
+
+namespace MI {
+
+namespace DBLIGHT {
+
+namespace {
+
+/// Magic number at the start of snapshot files ("DBLS").
+const mi::Uint32 g_snapshot_magic = 0x534c4244;
+
+/// Version of the snapshot file format.
+const mi::Uint32 g_snapshot_version = 1;
+
+/// Maximum number of DB elements per batch.
+///
+/// Bounds the memory needed for serialized DB elements while the file is streamed.
+const size_t g_snapshot_batch_size = 256;
+
+/// Serializes and compresses a batch of DB elements, one DB element per fragment.
+class Serialize_job : public DB::Fragmented_job
+{
+public:
+    /// Constructor.
+    ///
+    /// \param infos   The infos of the DB elements to serialize (as many as fragments).
+    Serialize_job( const std::vector<Info_impl*>& infos)
+      : m_infos( infos), m_blobs( infos.size()), m_success( infos.size(), false) { }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        SERIAL::Buffer_serializer serializer;
+        serializer.serialize( m_infos[index]->get_element());
+        size_t size = serializer.get_buffer_size();
+        std::vector<mi::Uint8> data = serializer.takeover_buffer();
+        data.resize( size);
+
+        SERIAL::Buffer_serializer compressed;
+        std::vector<unsigned char> temp;
+        m_success[index] = SERIAL::compress_and_serialize( &compressed, data, temp);
+        size = compressed.get_buffer_size();
+        m_blobs[index] = compressed.takeover_buffer();
+        m_blobs[index].resize( size);
+    }
+
+    /// Returns the compressed serialized DB element for fragment \p index.
+    const std::vector<mi::Uint8>& get_blob( size_t index) const { return m_blobs[index]; }
+
+    /// Indicates whether all DB elements were compressed successfully.
+    bool get_success() const
+    {
+        for( bool success: m_success)
+            if( !success)
+                return false;
+        return true;
+    }
+
+private:
+    const std::vector<Info_impl*>& m_infos;
+    std::vector<std::vector<mi::Uint8>> m_blobs;
+    std::vector<bool> m_success;
+};
+
+/// Decompresses and deserializes a batch of DB elements, one DB element per fragment.
+class Deserialize_job : public DB::Fragmented_job
+{
+public:
+    /// Constructor.
+    ///
+    /// \param manager   The deserialization manager used to construct the DB elements.
+    /// \param blobs     The compressed serialized DB elements (as many as fragments).
+    Deserialize_job(
+        SERIAL::Deserialization_manager* manager, const std::vector<std::vector<mi::Uint8>>& blobs)
+      : m_manager( manager), m_blobs( blobs), m_elements( blobs.size(), nullptr) { }
+
+    /// Destroys DB elements that have not been released.
+    ~Deserialize_job()
+    {
+        for( DB::Element_base* element: m_elements)
+            delete element;
+    }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        const std::vector<mi::Uint8>& blob = m_blobs[index];
+        SERIAL::Buffer_deserializer compressed;
+        compressed.reset( blob.data(), blob.size());
+        std::vector<mi::Uint8> data;
+        std::vector<unsigned char> temp;
+        if( !SERIAL::deserialize_and_decompress( &compressed, data, temp) || !compressed.is_valid())
+            return;
+
+        SERIAL::Buffer_deserializer deserializer( m_manager);
+        m_elements[index] = static_cast<DB::Element_base*>(
+            deserializer.deserialize( data.data(), data.size()));
+    }
+
+    /// Indicates whether all DB elements were deserialized successfully.
+    bool get_success() const
+    {
+        for( const DB::Element_base* element: m_elements)
+            if( !element)
+                return false;
+        return true;
+    }
+
+    /// Returns the DB element for fragment \p index and releases ownership. RCS:TRO
+    DB::Element_base* release_element( size_t index)
+    {
+        DB::Element_base* element = m_elements[index];
+        m_elements[index] = nullptr;
+        return element;
+    }
+
+private:
+    SERIAL::Deserialization_manager* m_manager;
+    const std::vector<std::vector<mi::Uint8>>& m_blobs;
+    std::vector<DB::Element_base*> m_elements;
+};
+
+/// Orders infos such that referenced DB elements precede the DB elements referencing them.
+///
+/// If several infos share a name, the info that the name resolves to is placed after the others,
+/// such that it again wins the lookup by name after all infos have been stored in that order.
+///
+/// \param infos     The infos to sort.
+/// \param owners    For each info the index of the info its name resolves to, or the info itself.
+/// \return          \c false if some reference is not among \p infos or if the references are
+///                  cyclic, \c true otherwise.
+bool sort_by_references( std::vector<Info_impl*>& infos, const std::vector<size_t>& owners)
+{
+    const size_t n = infos.size();
+
+    std::unordered_map<mi::Uint32, size_t> index_by_tag;
+    for( size_t i = 0; i < n; ++i)
+        index_by_tag[infos[i]->get_tag().get_uint()] = i;
+
+    std::vector<std::vector<size_t>> dependencies( n);
+    for( size_t i = 0; i < n; ++i) {
+        for( const DB::Tag& tag: infos[i]->get_references()) {
+            auto it = index_by_tag.find( tag.get_uint());
+            if( it == index_by_tag.end())
+                return false;
+            dependencies[i].push_back( it->second);
+        }
+        if( owners[i] != i)
+            dependencies[owners[i]].push_back( i);
+    }
+
+    // Iterative depth-first search emitting each info after its dependencies.
+    enum State { NEW, ACTIVE, DONE };
+    std::vector<State> states( n, NEW);
+    std::vector<std::pair<size_t, size_t>> stack; // info index, next dependency
+    std::vector<Info_impl*> result;
+    result.reserve( n);
+
+    for( size_t root = 0; root < n; ++root) {
+        if( states[root] != NEW)
+            continue;
+        states[root] = ACTIVE;
+        stack.emplace_back( root, 0);
+        while( !stack.empty()) {
+            size_t i = stack.back().first;
+            size_t d = stack.back().second;
+            if( d == dependencies[i].size()) {
+                states[i] = DONE;
+                result.push_back( infos[i]);
+                stack.pop_back();
+                continue;
+            }
+            ++stack.back().second;
+            size_t j = dependencies[i][d];
+            if( states[j] == ACTIVE)
+                return false;
+            if( states[j] == NEW) {
+                states[j] = ACTIVE;
+                stack.emplace_back( j, 0);
+            }
+        }
+    }
+
+    infos.swap( result);
+    return true;
+}
+
+/// Writes the DB elements of the given infos to \p serializer.
+///
+/// \return   See #DB::Database::snapshot().
+mi::Sint32 write_snapshot(
+    Database_impl* database,
+    DB::Transaction* transaction,
+    std::vector<Info_impl*>& infos,
+    SERIAL::File_serializer& serializer)
+{
+    Info_manager* info_manager = database->get_info_manager();
+    DB::Scope* scope = transaction->get_scope();
+    DB::Transaction_id id = transaction->get_id();
+
+    std::unordered_map<mi::Uint32, size_t> index_by_tag;
+    for( size_t i = 0; i < infos.size(); ++i)
+        index_by_tag[infos[i]->get_tag().get_uint()] = i;
+
+    std::vector<size_t> owners( infos.size());
+    for( size_t i = 0; i < infos.size(); ++i) {
+        owners[i] = i;
+        const char* name = infos[i]->get_name();
+        if( !name)
+            continue;
+        Info_impl* owner = info_manager->lookup_info( name, scope, id);
+        if( !owner)
+            continue;
+        auto it = index_by_tag.find( owner->get_tag().get_uint());
+        if( it != index_by_tag.end())
+            owners[i] = it->second;
+        owner->unpin();
+    }
+
+    if( !sort_by_references( infos, owners))
+        return -3;
+
+    mi::Uint32 max_tag = 0;
+    for( const Info_impl* info: infos)
+        max_tag = std::max( max_tag, info->get_tag().get_uint());
+
+    serializer.write( g_snapshot_magic);
+    serializer.write( g_snapshot_version);
+    serializer.write( static_cast<mi::Uint64>( infos.size()));
+    serializer.write( max_tag);
+
+    for( size_t begin = 0; begin < infos.size(); begin += g_snapshot_batch_size) {
+
+        size_t end = std::min( begin + g_snapshot_batch_size, infos.size());
+        std::vector<Info_impl*> batch( infos.begin() + begin, infos.begin() + end);
+
+        Serialize_job job( batch);
+        database->execute_fragmented( transaction, &job, batch.size());
+        if( !job.get_success())
+            return -2;
+
+        serializer.write( static_cast<mi::Uint32>( batch.size()));
+        for( size_t i = 0; i < batch.size(); ++i) {
+            const Info_impl* info = batch[i];
+            const char* name = info->get_name();
+            serializer.write( info->get_tag());
+            serializer.write( info->get_element()->get_class_id());
+            serializer.write( transaction->get_tag_is_removed( info->get_tag()));
+            SERIAL::write( &serializer, std::string( name ? name : ""));
+            SERIAL::write( &serializer, job.get_blob( i));
+        }
+
+        if( !serializer.is_valid())
+            return -2;
+    }
+
+    serializer.write( static_cast<mi::Uint32>( 0));
+    return serializer.is_valid() ? 0 : -2;
+}
+
+/// A DB element of a snapshot file before deserialization.
+struct Snapshot_record
+{
+    DB::Tag m_tag;
+    SERIAL::Class_id m_class_id = 0;
+    bool m_is_removed = false;
+    std::string m_name;
+};
+
+} // namespace
+
+mi::Sint32 Database_impl::snapshot( DB::Transaction* transaction, const std::string& filename)
+{
+    if( !transaction || !transaction->is_open( /*closing_is_open*/ false))
+        return -1;
+
+    DISK::File file;
+    if( !file.open( filename, DISK::IFile::M_WRITE)) {
+        LOG::mod_log->error( M_DB, LOG::Mod_log::C_DATABASE,
+            "Failed to open snapshot file \"%s\" for writing.", filename.c_str());
+        return -2;
+    }
+
+    // Collect the infos visible to the transaction. They stay pinned until the file is written.
+    std::vector<DB::Tag> tags;
+    m_info_manager->get_tags( tags);
+    std::vector<Info_impl*> infos;
+    infos.reserve( tags.size());
+    DB::Scope* scope = transaction->get_scope();
+    DB::Transaction_id id = transaction->get_id();
+    for( const DB::Tag& tag: tags) {
+        Info_impl* info = m_info_manager->lookup_info( tag, scope, id);
+        if( info)
+            infos.push_back( info);
+    }
+
+    SERIAL::File_serializer serializer;
+    serializer.set_output_file( &file);
+    mi::Sint32 result = write_snapshot( this, transaction, infos, serializer);
+
+    for( Info_impl* info: infos)
+        info->unpin();
+
+    if( !file.close() && result == 0)
+        result = -2;
+
+    if( result == 0)
+        LOG::mod_log->info( M_DB, LOG::Mod_log::C_DATABASE,
+            "Wrote %zu DB elements to snapshot file \"%s\".", infos.size(), filename.c_str());
+    else {
+        LOG::mod_log->error( M_DB, LOG::Mod_log::C_DATABASE,
+            "Failed to write snapshot file \"%s\".", filename.c_str());
+        DISK::file_remove( filename.c_str());
+    }
+    return result;
+}
+
+mi::Sint32 Database_impl::restore( DB::Transaction* transaction, const std::string& filename)
+{
+    if( !transaction || !transaction->is_open( /*closing_is_open*/ false))
+        return -1;
+
+    DISK::File file;
+    if( !file.open( filename, DISK::IFile::M_READ)) {
+        LOG::mod_log->error( M_DB, LOG::Mod_log::C_DATABASE,
+            "Failed to open snapshot file \"%s\" for reading.", filename.c_str());
+        return -2;
+    }
+
+    SERIAL::File_deserializer deserializer;
+    deserializer.set_input_file( &file);
+
+    mi::Uint32 magic = 0;
+    mi::Uint32 version = 0;
+    mi::Uint64 count = 0;
+    mi::Uint32 max_tag = 0;
+    deserializer.read( &magic);
+    deserializer.read( &version);
+    if( !deserializer.is_valid())
+        return -2;
+    if( magic != g_snapshot_magic || version != g_snapshot_version) {
+        LOG::mod_log->error( M_DB, LOG::Mod_log::C_DATABASE,
+            "Invalid snapshot file \"%s\".", filename.c_str());
+        return -3;
+    }
+    deserializer.read( &count);
+    deserializer.read( &max_tag);
+    if( !deserializer.is_valid())
+        return -2;
+
+    // Reserve the tags of the snapshot such that they are not allocated concurrently.
+    mi::Uint32 next_tag = m_next_tag.load();
+    while( next_tag <= max_tag && !m_next_tag.compare_exchange_weak( next_tag, max_tag + 1))
+        ;
+
+    std::vector<DB::Tag> used_tags;
+    m_info_manager->get_tags( used_tags);
+    std::set<std::string> restored_names;
+
+    mi::Uint64 restored = 0;
+    while( true) {
+
+        mi::Uint32 n = 0;
+        deserializer.read( &n);
+        if( !deserializer.is_valid())
+            return -2;
+        if( n == 0)
+            break;
+        if( n > g_snapshot_batch_size)
+            return -3;
+
+        std::vector<Snapshot_record> records( n);
+        std::vector<std::vector<mi::Uint8>> blobs( n);
+        for( mi::Uint32 i = 0; i < n; ++i) {
+            Snapshot_record& record = records[i];
+            deserializer.read( &record.m_tag);
+            deserializer.read( &record.m_class_id);
+            deserializer.read( &record.m_is_removed);
+            SERIAL::read( &deserializer, &record.m_name);
+            SERIAL::read( &deserializer, &blobs[i]);
+            if( !deserializer.is_valid())
+                return -2;
+            if( !record.m_tag || record.m_tag.get_uint() > max_tag)
+                return -3;
+            if( !m_deserialization_manager->is_registered( record.m_class_id)) {
+                LOG::mod_log->error( M_DB, LOG::Mod_log::C_DATABASE,
+                    "Snapshot file \"%s\" contains unregistered class ID 0x%x.",
+                    filename.c_str(), record.m_class_id);
+                return -3;
+            }
+            if( std::binary_search( used_tags.begin(), used_tags.end(), record.m_tag))
+                return -4;
+            if( !record.m_name.empty()
+                && restored_names.count( record.m_name) == 0
+                && transaction->name_to_tag( record.m_name.c_str()))
+                return -4;
+        }
+
+        Deserialize_job job( m_deserialization_manager, blobs);
+        execute_fragmented( transaction, &job, n);
+        if( !job.get_success())
+            return -3;
+
+        // Store sequentially, in file order, to keep referenced DB elements ahead of their users.
+        for( mi::Uint32 i = 0; i < n; ++i) {
+            const Snapshot_record& record = records[i];
+            const char* name = record.m_name.empty() ? nullptr : record.m_name.c_str();
+            DB::Element_base* element = job.release_element( i);
+            if( record.m_is_removed)
+                transaction->store_for_reference_counting( record.m_tag, element, name);
+            else
+                transaction->store( record.m_tag, element, name);
+            if( name)
+                restored_names.insert( record.m_name);
+        }
+
+        restored += n;
+    }
+
+    if( restored != count)
+        return -3;
+
+    LOG::mod_log->info( M_DB, LOG::Mod_log::C_DATABASE,
+        "Restored %llu DB elements from snapshot file \"%s\".",
+        static_cast<unsigned long long>( restored), filename.c_str());
+    return 0;
+}
+
+} // namespace DBLIGHT
+
+} // namespace MI
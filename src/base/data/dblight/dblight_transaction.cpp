@@ -557,7 +557,10 @@ void Transaction_manager::end_transaction( Transaction_impl* transaction, bool c
     transaction->set_state( commit ? Transaction_impl::COMMITTED : Transaction_impl::ABORTED);
     transaction->unpin();
 
-    m_database->get_info_manager()->garbage_collection( get_lowest_open_transaction_id());
+    if( m_database->get_gc_incremental())
+        m_database->schedule_incremental_garbage_collection();
+    else
+        m_database->get_info_manager()->garbage_collection( get_lowest_open_transaction_id());
 }
 
 void Transaction_manager::remove_from_all_transactions( Transaction_impl* transaction)
@@ -34,9 +34,11 @@
 #include <base/system/test/i_test_auto_driver.h>
 #include <base/system/test/i_test_auto_case.h>
 
+#include <atomic>
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
+#include <thread>
 
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -56,6 +58,7 @@
 
 #include <base/data/serial/i_serializer.h>
 #include <base/data/serial/serial.h>
+#include <base/hal/time/i_time.h>
 #include <base/lib/config/config.h>
 #include <base/lib/log/i_log_module.h>
 #include <base/system/main/access_module.h>
@@ -90,6 +93,30 @@ private:
     DB::Tag_set m_tag_set;
 };
 
+/// Element with a payload that can be evicted and is reloaded on demand.
+class My_evictable_element : public DB::Element<My_evictable_element, 0x12345679>
+{
+public:
+    const SERIAL::Serializable* serialize( SERIAL::Serializer* serializer) const
+    { serializer->write( m_payload_size); return this + 1; }
+    SERIAL::Serializable* deserialize( SERIAL::Deserializer* deserializer)
+    { deserializer->read( &m_payload_size); return this + 1; }
+    DB::Element_base* copy() const { return new My_evictable_element( *this); }
+    std::string get_class_name() const { return "My_evictable_element"; }
+    size_t get_size() const
+    { return sizeof( *this) + (m_payload_loaded ? m_payload_size : 0); }
+    bool evict_reloadable_data()
+    { bool result = m_payload_loaded; m_payload_loaded = false; return result; }
+
+    My_evictable_element() : m_payload_size( 0) { }
+    explicit My_evictable_element( mi::Uint64 payload_size) : m_payload_size( payload_size) { }
+    bool get_payload_loaded() const { return m_payload_loaded; }
+
+private:
+    mi::Uint64 m_payload_size;
+    bool m_payload_loaded = true;
+};
+
 /// Compares two streams in a very simple way.
 bool compare_files( std::ifstream& s1, std::stringstream& s2)
 {
@@ -145,6 +172,7 @@ public:
 
         SERIAL::Deserialization_manager* manager = m_db_impl->get_deserialization_manager();
         manager->register_class<My_element>();
+        manager->register_class<My_evictable_element>();
     }
 
     ~Test_db()
@@ -1356,6 +1384,49 @@ void test_gc_pin_count_zero()
     db.dump();
 }
 
+void test_gc_incremental()
+{
+    SYSTEM::Access_module<CONFIG::Config_module> config_module( false);
+    config_module->override( "dblight_gc_incremental=1");
+    config_module->override( "dblight_gc_step_max_tags=2");
+
+    {
+        Test_db db( __func__, /*compare*/ false); // GC runs asynchronously
+        DBLIGHT::Info_manager* info_manager = db.m_db_impl->get_info_manager();
+
+        const size_t n = 20;
+        std::vector<DB::Tag> tags;
+        DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+        for( size_t i = 0; i < n; ++i) {
+            std::string name = "foo_" + std::to_string( i);
+            tags.push_back( transaction->store( new My_element( i), name.c_str()));
+        }
+        transaction->commit();
+
+        transaction = db.m_scope->start_transaction();
+        for( const auto& tag: tags)
+            transaction->remove( tag);
+        transaction->commit();
+
+        // Wait for the GC job to destroy all infos (one regular and one removal info per tag).
+        for( size_t i = 0; i < 1000; ++i) {
+            if( info_manager->get_gc_statistics().m_reclaimed_infos == 2*n)
+                break;
+            TIME::sleep( 0.01);
+        }
+
+        DBLIGHT::Info_manager::Gc_statistics stats = info_manager->get_gc_statistics();
+        MI_CHECK_EQUAL( stats.m_reclaimed_infos, 2*n);
+        MI_CHECK_EQUAL( stats.m_reclaimed_bytes, n * My_element().get_size());
+        if( stats.m_runs == 0)
+            MI_CHECK_GREATER_OR_EQUAL( stats.m_steps, n/2); // budget of 2 tags per step
+        else
+            MI_CHECK_EQUAL( stats.m_runs, stats.m_steps);   // GC method cannot be interrupted
+    }
+
+    config_module->override( "dblight_gc_incremental=0");
+}
+
 void test_use_of_closed_transaction()
 {
     Test_db db( __func__, /*compare*/ false); // Empty dump
@@ -1421,6 +1492,361 @@ void test_dump_with_pointers()
     db.dump( /*mask_pointer_values*/ false);
 }
 
+void test_memory_limits()
+{
+    Test_db db( __func__, /*compare*/ false); // Not relevant
+    DBLIGHT::Info_manager* info_manager = db.m_db_impl->get_info_manager();
+
+    size_t low_water = 1;
+    size_t high_water = 1;
+    db.m_db->get_memory_limits( low_water, high_water);
+    MI_CHECK_EQUAL( low_water, 0);
+    MI_CHECK_EQUAL( high_water, 0);
+
+    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 2000, 1000), -1);
+    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 1000, 1000), -1);
+    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 100000, 200000), 0);
+    db.m_db->get_memory_limits( low_water, high_water);
+    MI_CHECK_EQUAL( low_water, 100000);
+    MI_CHECK_EQUAL( high_water, 200000);
+
+    DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+
+    // Stay below the high water mark.
+    std::vector<DB::Tag> tags;
+    for( size_t i = 0; i < 5; ++i)
+        tags.push_back( transaction->store( new My_evictable_element( 35000)));
+    DBLIGHT::Info_manager::Memory_statistics stats = info_manager->get_memory_statistics();
+    MI_CHECK_GREATER( stats.m_total_size, 175000);
+    MI_CHECK_LESS( stats.m_total_size, 200000);
+    MI_CHECK_EQUAL( stats.m_eviction_runs, 0);
+
+    // Keep the most recently stored element pinned, it must not be evicted.
+    DB::Access<My_evictable_element> pinned( tags.back(), transaction.get());
+
+    // Exceed the high water mark. Eviction starts with the least recently used elements.
+    tags.push_back( transaction->store( new My_evictable_element( 35000)));
+    stats = info_manager->get_memory_statistics();
+    MI_CHECK_EQUAL( stats.m_eviction_runs, 1);
+    MI_CHECK_EQUAL( stats.m_evicted_elements, 4);
+    MI_CHECK_GREATER_OR_EQUAL( stats.m_evicted_bytes, 140000);
+    MI_CHECK_LESS_OR_EQUAL( stats.m_total_size, 100000);
+    MI_CHECK( pinned->get_payload_loaded());
+    {
+        DB::Access<My_evictable_element> access( tags.front(), transaction.get());
+        MI_CHECK( !access->get_payload_loaded());
+        DB::Access<My_evictable_element> access2( tags.back(), transaction.get());
+        MI_CHECK( access2->get_payload_loaded());
+    }
+    pinned.reset();
+
+    // Disable the memory limits.
+    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 1000, 0), 0);
+    db.m_db->get_memory_limits( low_water, high_water);
+    MI_CHECK_EQUAL( low_water, 0);
+    MI_CHECK_EQUAL( high_water, 0);
+    for( size_t i = 0; i < 10; ++i)
+        transaction->store( new My_evictable_element( 35000));
+    stats = info_manager->get_memory_statistics();
+    MI_CHECK_EQUAL( stats.m_eviction_runs, 1);
+
+    transaction->commit();
+}
+
+void test_memory_limits_read_element_survives()
+{
+    Test_db db( __func__, /*compare*/ false); // Not relevant
+    DBLIGHT::Info_manager* info_manager = db.m_db_impl->get_info_manager();
+
+    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 100000, 200000), 0);
+
+    DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+
+    std::vector<DB::Tag> tags;
+    for( size_t i = 0; i < 5; ++i)
+        tags.push_back( transaction->store( new My_evictable_element( 35000)));
+
+    // Read the least recently stored element. Without any modification in between, this turns it
+    // into the most recently used element.
+    {
+        DB::Access<My_evictable_element> access( tags.front(), transaction.get());
+        MI_CHECK( access->get_payload_loaded());
+    }
+
+    // Exceed the high water mark. The element read above must survive the eviction.
+    tags.push_back( transaction->store( new My_evictable_element( 35000)));
+    DBLIGHT::Info_manager::Memory_statistics stats = info_manager->get_memory_statistics();
+    MI_CHECK_EQUAL( stats.m_eviction_runs, 1);
+    MI_CHECK_EQUAL( stats.m_evicted_elements, 4);
+    MI_CHECK_LESS_OR_EQUAL( stats.m_total_size, 100000);
+    {
+        DB::Access<My_evictable_element> access( tags.front(), transaction.get());
+        MI_CHECK( access->get_payload_loaded());
+        for( size_t i = 1; i < 5; ++i) {
+            DB::Access<My_evictable_element> access2( tags[i], transaction.get());
+            MI_CHECK( !access2->get_payload_loaded());
+        }
+        DB::Access<My_evictable_element> access3( tags.back(), transaction.get());
+        MI_CHECK( access3->get_payload_loaded());
+    }
+
+    transaction->commit();
+}
+
+void test_snapshot_and_restore()
+{
+    fs::create_directory( "data");
+    std::string filename = (fs::path( "data") / "test_snapshot_and_restore.snapshot").string();
+    std::string filename_cyclic = (fs::path( "data") / "test_snapshot_cyclic.snapshot").string();
+
+    DB::Tag tag1, tag2, tag3, tag4, tag5;
+
+    {
+        Test_db db( __func__, /*compare*/ false); // Not relevant
+        DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+
+        tag1 = transaction->store( new My_element( 1), "foo");
+        tag2 = transaction->store( new My_element( 2, { tag1 }), "bar");
+        tag3 = transaction->store_for_reference_counting( new My_element( 3));
+        tag4 = transaction->store( new My_element( 4, { tag3 }));
+        {
+            // Reference a tag with a higher value.
+            DB::Edit<My_element> edit( tag1, transaction.get());
+            edit->set_tag_set( { tag4 });
+        }
+        tag5 = transaction->store( new My_element( 5), "foo");
+        transaction->commit();
+
+        transaction = db.m_scope->start_transaction();
+        MI_CHECK_EQUAL( db.m_db->snapshot( nullptr, filename), -1);
+        MI_CHECK_EQUAL( db.m_db->snapshot( transaction.get(), filename), 0);
+
+        {
+            // Cyclic references cannot be ordered.
+            DB::Edit<My_element> edit( tag4, transaction.get());
+            edit->set_tag_set( { tag2 });
+        }
+        MI_CHECK_EQUAL( db.m_db->snapshot( transaction.get(), filename_cyclic), -3);
+        transaction->abort();
+    }
+
+    {
+        Test_db db( "test_snapshot_and_restore_target", /*compare*/ false); // Not relevant
+        DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+
+        MI_CHECK_EQUAL( db.m_db->restore( nullptr, filename), -1);
+        MI_CHECK_EQUAL( db.m_db->restore( transaction.get(), filename + ".missing"), -2);
+        MI_CHECK_EQUAL( db.m_db->restore( transaction.get(), filename), 0);
+
+        MI_CHECK_EQUAL( transaction->name_to_tag( "foo"), tag5);
+        MI_CHECK_EQUAL( transaction->name_to_tag( "bar"), tag2);
+        MI_CHECK_EQUAL_CSTR( transaction->tag_to_name( tag1), "foo");
+        MI_CHECK( !transaction->tag_to_name( tag3));
+        {
+            DB::Access<My_element> access( tag1, transaction.get());
+            MI_CHECK_EQUAL( access->get_value(), 1);
+            MI_CHECK( access->get_tag_set() == DB::Tag_set( { tag4 }));
+        }
+        MI_CHECK( transaction->get_tag_is_removed( tag3));
+        MI_CHECK( !transaction->get_tag_is_removed( tag4));
+
+        // The tags and names are in use now.
+        MI_CHECK_EQUAL( db.m_db->restore( transaction.get(), filename), -4);
+
+        // New tags do not collide with restored tags.
+        DB::Tag tag6 = transaction->store( new My_element( 6));
+        MI_CHECK_GREATER( tag6.get_uint(), tag5.get_uint());
+
+        transaction->commit();
+        db.m_db->garbage_collection( 0);
+
+        // The element marked for removal is still referenced.
+        transaction = db.m_scope->start_transaction();
+        {
+            DB::Access<My_element> access( tag3, transaction.get());
+            MI_CHECK_EQUAL( access->get_value(), 3);
+        }
+        transaction->commit();
+    }
+}
+
+/// Stores, edits and looks up elements from concurrent transactions and checks the values seen
+/// by each transaction, and the final state after all of them committed.
+///
+/// Readers start before the writers and must see the initial state only. Each writer edits its
+/// own subset of the initial elements and stores new named elements.
+void test_concurrent_store_edit_lookup()
+{
+    Test_db db( __func__, /*compare*/ false); // Not relevant
+
+    const size_t n_elements = 1024;
+    const size_t n_readers  = 4;
+    const size_t n_writers  = 2;
+    const size_t n_rounds   = 2000;
+
+    std::vector<DB::Tag> tags;
+    std::vector<std::string> names;
+    {
+        DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+        for( size_t i = 0; i < n_elements; ++i) {
+            names.push_back( "element_" + std::to_string( i));
+            tags.push_back( transaction->store( new My_element( int( i)), names.back().c_str()));
+        }
+        transaction->commit();
+    }
+
+    auto get_writer_name = []( size_t w, size_t i) {
+        return "writer_" + std::to_string( w) + "_" + std::to_string( i);
+    };
+
+    std::vector<DB::Transaction_ptr> reader_transactions;
+    for( size_t r = 0; r < n_readers; ++r)
+        reader_transactions.push_back( db.m_scope->start_transaction());
+
+    std::vector<std::thread> threads;
+    for( size_t r = 0; r < n_readers; ++r)
+        threads.emplace_back( [&, r]() {
+            DB::Transaction* transaction = reader_transactions[r].get();
+            mi::Uint32 seed = static_cast<mi::Uint32>( r) * 7919 + 1;
+            for( size_t i = 0; i < n_rounds * 4; ++i) {
+                seed = seed * 1664525 + 1013904223;
+                size_t index = (seed >> 8) % n_elements;
+                DB::Tag tag = transaction->name_to_tag( names[index].c_str());
+                MI_CHECK_EQUAL( tag, tags[index]);
+                DB::Access<My_element> access( tag, transaction);
+                MI_CHECK_EQUAL( access->get_value(), int( index));
+                // elements stored by the writers are not visible
+                DB::Tag new_tag = transaction->name_to_tag(
+                    get_writer_name( index % n_writers, i % n_rounds).c_str());
+                MI_CHECK( !new_tag);
+            }
+        });
+
+    std::vector<std::vector<DB::Tag>> writer_tags( n_writers);
+    for( size_t w = 0; w < n_writers; ++w)
+        threads.emplace_back( [&, w]() {
+            DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+            for( size_t i = 0; i < n_rounds; ++i) {
+                std::string name = get_writer_name( w, i);
+                DB::Tag new_tag = transaction->store(
+                    new My_element( int( 1000000 * (w+1) + i)), name.c_str());
+                writer_tags[w].push_back( new_tag);
+                MI_CHECK_EQUAL( transaction->name_to_tag( name.c_str()), new_tag);
+
+                size_t index = (i * n_writers + w) % n_elements;
+                {
+                    DB::Edit<My_element> edit( tags[index], transaction.get());
+                    MI_CHECK_EQUAL( edit->get_value() % 1000000, int( index));
+                    edit->set_value( int( 1000000 * (i+1) + index));
+                }
+                DB::Access<My_element> access( tags[index], transaction.get());
+                MI_CHECK_EQUAL( access->get_value(), int( 1000000 * (i+1) + index));
+            }
+            transaction->commit();
+        });
+
+    for( auto& t: threads)
+        t.join();
+    for( auto& transaction: reader_transactions)
+        transaction->commit();
+
+    // check the final state: the last edit wins, all stored elements are visible
+    DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+    std::vector<int> expected( n_elements);
+    for( size_t i = 0; i < n_elements; ++i)
+        expected[i] = int( i);
+    for( size_t w = 0; w < n_writers; ++w)
+        for( size_t i = 0; i < n_rounds; ++i) {
+            size_t index = (i * n_writers + w) % n_elements;
+            expected[index] = int( 1000000 * (i+1) + index);
+        }
+    for( size_t i = 0; i < n_elements; ++i) {
+        MI_CHECK_EQUAL( transaction->name_to_tag( names[i].c_str()), tags[i]);
+        DB::Access<My_element> access( tags[i], transaction.get());
+        MI_CHECK_EQUAL( access->get_value(), expected[i]);
+    }
+    for( size_t w = 0; w < n_writers; ++w)
+        for( size_t i = 0; i < n_rounds; ++i) {
+            std::string name = get_writer_name( w, i);
+            MI_CHECK_EQUAL( transaction->name_to_tag( name.c_str()), writer_tags[w][i]);
+            DB::Access<My_element> access( writer_tags[w][i], transaction.get());
+            MI_CHECK_EQUAL( access->get_value(), int( 1000000 * (w+1) + i));
+        }
+    transaction->commit();
+}
+
+/// Measures the lookup throughput of concurrent transactions, with and without a concurrent
+/// writer that keeps storing and editing DB elements.
+///
+/// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_lookup_contention()
+{
+    Test_db db( __func__, /*compare*/ false); // Not relevant
+
+    const size_t n_elements = 4096;
+    const size_t n_lookups  = 20000;
+
+    std::vector<DB::Tag> tags;
+    std::vector<std::string> names;
+    {
+        DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+        for( size_t i = 0; i < n_elements; ++i) {
+            names.push_back( "element_" + std::to_string( i));
+            tags.push_back( transaction->store( new My_element( i), names.back().c_str()));
+        }
+        transaction->commit();
+    }
+
+    for( size_t readers = 1; readers <= 8; readers *= 2) {
+        for( int with_writer = 0; with_writer < 2; ++with_writer) {
+
+            std::atomic_bool stop = false;
+            std::thread writer;
+            if( with_writer)
+                writer = std::thread( [&db, &tags, &stop]() {
+                    DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+                    for( size_t i = 0; !stop; ++i) {
+                        transaction->store( new My_element( i));
+                        DB::Edit<My_element> edit( tags[i % tags.size()], transaction.get());
+                        edit->set_value( i);
+                    }
+                    transaction->commit();
+                });
+
+            TIME::Time start = TIME::get_time();
+
+            std::vector<std::thread> threads;
+            for( size_t r = 0; r < readers; ++r)
+                threads.emplace_back( [&db, &tags, &names, r]() {
+                    DB::Transaction_ptr transaction = db.m_scope->start_transaction();
+                    mi::Uint32 seed = static_cast<mi::Uint32>( r) * 7919 + 1;
+                    for( size_t i = 0; i < n_lookups; ++i) {
+                        seed = seed * 1664525 + 1013904223;
+                        size_t index = (seed >> 8) % n_elements;
+                        DB::Tag tag = (i % 4 == 0)
+                            ? transaction->name_to_tag( names[index].c_str()) : tags[index];
+                        DB::Access<My_element> access( tag, transaction.get());
+                        MI_CHECK( access);
+                    }
+                    transaction->commit();
+                });
+            for( auto& t: threads)
+                t.join();
+
+            double time = (TIME::get_time() - start).get_seconds();
+
+            stop = true;
+            if( writer.joinable())
+                writer.join();
+
+            LOG::mod_log->info( M_DB, LOG::Mod_log::C_DATABASE,
+                "Benchmark %zu reader transactions, %-14s: %10.0f lookups/s",
+                readers, with_writer ? "with writer" : "without writer",
+                readers * n_lookups / std::max( time, 1e-6));
+        }
+    }
+}
+
 void test_not_implemented_with_assertions()
 {
     Test_db db( __func__, /*compare*/ false); // Empty dump
@@ -1430,13 +1856,6 @@ void test_not_implemented_with_assertions()
     MI_CHECK( !result);
     db.m_db->check_is_locked( 42);
 
-    MI_CHECK_EQUAL( db.m_db->set_memory_limits( 1000, 2000), -1);
-    size_t low_water = 1;
-    size_t high_water = 1;
-    db.m_db->get_memory_limits( low_water, high_water);
-    MI_CHECK_EQUAL( low_water, 0);
-    MI_CHECK_EQUAL( high_water, 0);
-
     // artificial test arguments
     db.m_db->register_status_listener( nullptr);
     db.m_db->unregister_status_listener( nullptr);
@@ -1535,9 +1954,13 @@ void test( const char* explicit_gc_method)
     test_gc_multiple_references();
     test_gc_explicit_call();
     test_gc_pin_count_zero();
+    test_gc_incremental();
 
     test_use_of_closed_transaction();
     test_dump_with_pointers();
+    test_memory_limits();
+    test_memory_limits_read_element_survives();
+    test_snapshot_and_restore();
 #ifdef NDEBUG
     test_not_implemented_with_assertions();
 #endif // NDEBUG
@@ -1560,6 +1983,12 @@ MI_TEST_AUTO_FUNCTION( test_dblight )
     test( "full_sweep_then_pin_count_zero");
     test( "general_candidates_then_pin_count_zero");
     test( "invalid_method");
+
+    config_module->override( "check_serializer_store=0");
+    config_module->override( "check_serializer_edit=0");
+    test_concurrent_store_edit_lookup();
+    if( getenv( "MI_TEST_RUN_BENCHMARKS"))
+        benchmark_lookup_contention();
 }
 
 MI_TEST_MAIN_CALLING_TEST_MAIN();
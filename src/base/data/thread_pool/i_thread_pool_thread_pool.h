@@ -80,9 +80,26 @@ class IJob;
 ///
 /// Last but not least the thread pool supports job priorities which can be used to influence the
 /// position of the job in the queue.
+///
+/// The scheduling mode selected at construction time determines where pending jobs are kept. In
+/// the default mode all jobs are kept in a single job queue protected by one lock. In the
+/// work-stealing mode each worker thread additionally owns a local job queue: jobs submitted from
+/// a worker thread are put at the front of its local queue, and idle worker threads steal jobs from
+/// the back of the local queues of other worker threads. Jobs submitted from other threads still
+/// go to the global job queue. Priorities and load limits are obeyed in both modes, but in the
+/// work-stealing mode priorities are only considered per queue, not globally.
 class Thread_pool : public boost::noncopyable
 {
 public:
+    /// The scheduling modes of the thread pool.
+    enum Scheduling_mode {
+        /// All jobs are kept in a single job queue.
+        SCHEDULING_GLOBAL_QUEUE,
+        /// Jobs submitted from worker threads are kept in per-worker job queues, idle worker
+        /// threads steal jobs from other worker threads.
+        SCHEDULING_WORK_STEALING
+    };
+
     /// Constructor
     ///
     /// Creates the given number of worker threads and starts them.
@@ -91,10 +108,12 @@ public:
     /// \param gpu_load_limit         The initial limit for the GPU load.
     /// \param nr_of_worker_threads   The number of worker threads to create upfront. Note that the
     ///                               thread pool might start additional worker threads as needed.
+    /// \param scheduling_mode        The scheduling mode, see #Scheduling_mode.
     Thread_pool(
         mi::Float32 cpu_load_limit = 1.0,
         mi::Float32 gpu_load_limit = 1.0,
-        mi::Size nr_of_worker_threads = 1);
+        mi::Size nr_of_worker_threads = 1,
+        Scheduling_mode scheduling_mode = SCHEDULING_GLOBAL_QUEUE);
 
     /// Destructor
     ///
@@ -104,6 +123,9 @@ public:
     /// Install the admin HTTP server page on \p server.
     void install_admin_http_server_page( HTTP::Server* server, const char* uri);
 
+    /// Returns the scheduling mode selected at construction time.
+    Scheduling_mode get_scheduling_mode() const { return m_scheduling_mode; }
+
     /// \name Load limits and thread affinity
     //@{
 
@@ -262,6 +284,9 @@ public:
 
     /// Returns the next job to be executed by \p thread.
     ///
+    /// In the work-stealing mode the local queue of \p thread is considered first, then the
+    /// global job queue, and finally the local queues of the other worker threads.
+    ///
     /// Returns \c NULL if there is no job to be executed, or no job whose load requirements fit the
     /// gap between load limits and current load values.
     ///
@@ -309,15 +334,17 @@ public:
     /// Returns the current CPU load.
     mi::Float32 get_current_cpu_load() const
     {
-        mi::base::Lock::Block block( &m_lock);
-        return m_current_cpu_load;
+        mi::Float32 cpu_load, gpu_load;
+        unpack_load( m_current_load, cpu_load, gpu_load);
+        return cpu_load;
     }
 
     /// Returns the current GPU load.
     mi::Float32 get_current_gpu_load() const
     {
-        mi::base::Lock::Block block( &m_lock);
-        return m_current_gpu_load;
+        mi::Float32 cpu_load, gpu_load;
+        unpack_load( m_current_load, cpu_load, gpu_load);
+        return gpu_load;
     }
 
     /// Dumps the current CPU/GPU load/limits to the log (category MISC, severity INFO).
@@ -329,6 +356,41 @@ public:
     //@}
 
 private:
+    /// The type of the job list. One job list is used for each priority.
+    typedef std::list<mi::base::Handle<IJob> > Job_list;
+    /// The type of the job queue. Maps priorities to job lists.
+    typedef std::map<mi::Sint32, Job_list> Job_queue;
+
+    /// The local job queue of a worker thread (only used in the work-stealing mode).
+    ///
+    /// Local queues are created on demand when a worker thread asks for its first job. They are
+    /// linked into a list that only grows, such that other worker threads can traverse it for
+    /// stealing without holding m_lock. They are destroyed by the destructor of the thread pool.
+    struct Local_queue
+    {
+        Local_queue( Thread_pool* thread_pool, Worker_thread* thread)
+          : m_thread_pool( thread_pool), m_thread( thread), m_next( nullptr),
+            m_top_priority( s_no_priority), m_current_job( nullptr), m_suspended( false) { }
+
+        /// The thread pool owning this queue.
+        Thread_pool* m_thread_pool;
+        /// The worker thread owning this queue.
+        Worker_thread* m_thread;
+        /// The next queue in the list of all local queues. Never changes after publication.
+        Local_queue* m_next;
+        /// The lock that protects m_jobs.
+        mi::base::Lock m_lock;
+        /// The jobs of this queue, with the same structure and invariant as m_job_queue. The owner
+        /// takes jobs from the front, other worker threads steal jobs from the back.
+        Job_queue m_jobs;
+        /// The highest priority in m_jobs, or #s_no_priority. Modified under m_lock, read without.
+        std::atomic<mi::Sint32> m_top_priority;
+        /// The job currently executed by the owner, or \c NULL. Only accessed by the owner.
+        IJob* m_current_job;
+        /// Indicates whether m_current_job is suspended. Only accessed by the owner.
+        bool m_suspended;
+    };
+
     /// Submits a job, i.e., puts it into the job queue.
     ///
     /// The job is executed asynchronously and the method returns immediately. Used by #submit_job()
@@ -375,12 +437,85 @@ private:
     /// Indicates whether a job with given CPU/GPU loads can be executed given the current CPU/GPU
     /// load and the CPU/GPU load limits.
     ///
-    /// The callers needs to hold m_lock.
+    /// Does not require m_lock, but the result might be outdated without holding it.
     bool job_fits_load_limits( mi::Float32 cpu_load, mi::Float32 gpu_load) const;
 
+    /// Increases the current loads by the given values if the job fits the load limits.
+    ///
+    /// Check and update are done atomically, m_lock is not required.
+    ///
+    /// \return   \c true if the current loads have been increased, \c false otherwise.
+    bool try_acquire_load( mi::Float32 cpu_load, mi::Float32 gpu_load);
+
+    /// Decreases the current loads by the given values and increments #m_work_generation.
+    ///
+    /// The update is done atomically, m_lock is not required.
+    void release_load( mi::Float32 cpu_load, mi::Float32 gpu_load);
+
+    /// Packs CPU and GPU load into a single value for m_current_load.
+    static mi::Uint64 pack_load( mi::Float32 cpu_load, mi::Float32 gpu_load);
+
+    /// Unpacks CPU and GPU load from a value of m_current_load.
+    static void unpack_load( mi::Uint64 load, mi::Float32& cpu_load, mi::Float32& gpu_load);
+
+    /// Finds the first job in \p queue whose load fits the load limits, acquires its load, and
+    /// calls #IJob::pre_execute(). The job is removed from the queue unless its remaining work is
+    /// splittable.
+    ///
+    /// The caller needs to hold the lock protecting \p queue.
+    ///
+    /// \param queue             The queue to search.
+    /// \param thread            The worker thread that is going to execute the job.
+    /// \param from_back         Indicates whether the job lists are searched from the back
+    ///                          (used for stealing) or from the front.
+    /// \param[out] splittable   Indicates whether the job remained in the queue.
+    /// \return                  The retained job, or \c NULL if there is no suitable job.
+    IJob* dequeue_job( Job_queue& queue, Worker_thread* thread, bool from_back, bool& splittable);
+
+    /// Implements #get_next_job() for the work-stealing mode.
+    IJob* get_next_job_work_stealing( Worker_thread* thread);
+
+    /// Takes a job from \p queue, or from the global job queue if \p queue is \c NULL, and
+    /// updates the corresponding priority hint (work-stealing mode only).
+    ///
+    /// Acquires the lock protecting the queue. See #dequeue_job() for the other parameters.
+    IJob* take_job( Local_queue* queue, Worker_thread* thread, bool from_back, bool& splittable);
+
+    /// Returns the highest priority of all queued jobs, or #s_no_priority if there are none
+    /// (work-stealing mode only).
+    ///
+    /// Based on the priority hints without acquiring any lock, i.e., the result might be outdated.
+    mi::Sint32 get_top_priority() const;
+
+    /// Returns the highest priority in \p queue, or #s_no_priority if it is empty.
+    static mi::Sint32 get_top_priority( const Job_queue& queue)
+    { return queue.empty() ? s_no_priority : queue.begin()->first; }
+
+    /// Returns the local queue of \p thread (work-stealing mode only).
+    ///
+    /// Creates the queue if necessary and caches it as #s_current_local_queue.
+    Local_queue* get_local_queue( Worker_thread* thread);
+
+    /// Returns the local queue of the calling thread if it is a worker thread of this thread pool
+    /// (work-stealing mode only), or \c NULL otherwise.
+    Local_queue* get_current_local_queue() const;
+
+    /// Puts a job into the local queue \p queue and wakes up another worker thread if the job
+    /// could be executed immediately (work-stealing mode only).
+    ///
+    /// Child jobs are put at the front (taken first by the owner), resume jobs of the suspended
+    /// owner at the back (taken first by thieves).
+    void submit_job_local( Local_queue* queue, IJob* job);
+
+    /// Wakes up a sleeping worker thread if the given loads fit the load limits.
+    ///
+    /// Acquires m_lock only if needed (work-stealing mode only).
+    void wake_up_worker_thread_if_fits( mi::Float32 cpu_load, mi::Float32 gpu_load);
+
     /// Returns some job data for the job assigned to a running or suspended worker thread.
     ///
-    /// Acquires m_lock and calls #get_current_job_data_locked().
+    /// In the work-stealing mode the data is taken from the local queue of the calling thread
+    /// without m_lock, otherwise acquires m_lock and calls #get_current_job_data_locked().
     bool get_current_job_data(
         mi::Float32& cpu_load,
         mi::Float32& gpu_load,
@@ -417,18 +552,22 @@ private:
     /// which would cause a huge number of threads to be spawned.
     static void adjust_load( mi::Float32& cpu_load, mi::Float32& gpu_load);
 
-    /// The configured CPU load limit.
-    mi::Float32 m_cpu_load_limit;
-    /// The configured GPU load limit.
-    mi::Float32 m_gpu_load_limit;
+    /// The scheduling mode.
+    const Scheduling_mode m_scheduling_mode;
+
+    /// The configured CPU load limit. Modified under m_lock, atomic for lock-free readers.
+    std::atomic<mi::Float32> m_cpu_load_limit;
+    /// The configured GPU load limit. Modified under m_lock, atomic for lock-free readers.
+    std::atomic<mi::Float32> m_gpu_load_limit;
     /// The configured CPU load license limit.
     mi::Float32 m_cpu_load_license_limit;
     /// The configured GPU load license_limit.
     mi::Float32 m_gpu_load_license_limit;
-    /// The current CPU load. Protected by m_lock.
-    mi::Float32 m_current_cpu_load;
-    /// The current GPU load. Protected by m_lock.
-    mi::Float32 m_current_gpu_load;
+    /// The current CPU and GPU load, packed into one value (see #pack_load()) such that both can
+    /// be checked and updated atomically without holding m_lock.
+    std::atomic<mi::Uint64> m_current_load;
+    /// The value of priority hints for empty queues (lower than any job priority).
+    static const mi::Sint32 s_no_priority = 0x7fffffff;
     /// The smallest CPU load a job can cause.
     static mi::Float32 s_min_cpu_load;
     /// The smallest GPU load a job can cause.
@@ -446,10 +585,6 @@ private:
     /// The set of sleeping worker threads. Protected by m_lock.
     Sleeping_threads m_sleeping_threads;
 
-    /// The type of the job list. One job list is used for each priority.
-    typedef std::list<mi::base::Handle<IJob> > Job_list;
-    /// The type of the job queue. Maps priorities to job lists.
-    typedef std::map<mi::Sint32, Job_list> Job_queue;
     /// The job queue. Protected by m_lock.
     ///
     /// Actually, this is a map of lists instead of a queue such that we can efficiently insert and
@@ -462,17 +597,36 @@ private:
 
     /// The type of the maps below.
     typedef std::map<mi::Uint64, IJob*> Job_map;
-    /// The map that holds for each running worker thread the job that it is executing.
-    /// Protected by m_lock.
+    /// The map that holds for each running worker thread the job that it is executing (global
+    /// queue mode only, see Local_queue::m_current_job otherwise). Protected by m_lock.
     Job_map m_running_jobs;
-    /// The map that holds for each suspended worker thread the job that it is executing.
-    /// Protected by m_lock.
+    /// The map that holds for each suspended worker thread the job that it is executing (global
+    /// queue mode only, see Local_queue::m_suspended otherwise). Protected by m_lock.
     Job_map m_suspended_jobs;
 
-    /// The lock that protects the current loads, the vector of all worker threads, the set of
-    /// sleeping worker threads, the job queue, and the maps for running and suspended jobs.
+    /// The lock that protects the vector of all worker threads, the set of sleeping worker
+    /// threads, the job queue, and the maps for running and suspended jobs.
     mutable mi::base::Lock m_lock;
 
+    /// The head of the list of local queues (work-stealing mode only). New queues are added at
+    /// the front under m_lock.
+    std::atomic<Local_queue*> m_local_queues;
+
+    /// The highest priority in m_job_queue, or #s_no_priority (work-stealing mode only). Modified
+    /// under m_lock, read without.
+    std::atomic<mi::Sint32> m_global_top_priority;
+
+    /// The number of jobs in all local queues (work-stealing mode only).
+    std::atomic_uint32_t m_nr_of_local_jobs;
+
+    /// Incremented whenever a job is queued or load is released (see #release_load()). Used in
+    /// the work-stealing mode to detect new work between an unsuccessful search and putting a
+    /// worker thread to sleep.
+    std::atomic_uint32_t m_work_generation;
+
+    /// The local queue of the calling worker thread (work-stealing mode only).
+    static thread_local Local_queue* s_current_local_queue;
+
     /// The thread state counters.
     ///
     /// These values are updated by the worker threads themselves, not by the thread pool.
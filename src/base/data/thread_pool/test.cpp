@@ -31,7 +31,9 @@
 #define MI_TEST_AUTO_SUITE_NAME "Regression Test Suite for base/data/thread_pool"
 #define MI_TEST_IMPLEMENT_TEST_MAIN_INSTEAD_OF_MAIN
 
+#include <algorithm>
 #include <atomic>
+#include <cstdlib>
 
 #include <base/system/test/i_test_auto_driver.h>
 #include <base/system/test/i_test_auto_case.h>
@@ -582,12 +584,110 @@ private:
 
 bool Yield_job::s_completed_yield_child_job = false;
 
+/// Burns some CPU cycles. Used by the benchmark jobs below.
+mi::Uint32 spin( mi::Uint32 iterations)
+{
+    volatile mi::Uint32 x = 1;
+    for( mi::Uint32 i = 0; i < iterations; ++i)
+        x = x * 1664525u + 1013904223u;
+    return x;
+}
+
+/// A small job for the benchmark. Signals the condition when the last job of a batch finishes.
+class Spin_job : public mi::base::Interface_implement<IJob>
+{
+public:
+    Spin_job(
+        mi::Uint32 iterations, std::atomic_uint32_t* pending, mi::base::Condition* condition)
+      : m_iterations( iterations), m_pending( pending), m_condition( condition) { }
+
+    mi::Float32 get_cpu_load() const { return 1.0f; }
+    mi::Float32 get_gpu_load() const { return 0.0f; }
+    mi::Sint8 get_priority() const { return 0; }
+    bool is_remaining_work_splittable() { return false; }
+    void pre_execute( const mi::neuraylib::IJob_execution_context* context) { }
+
+    void execute( const mi::neuraylib::IJob_execution_context* context)
+    {
+        spin( m_iterations);
+        if( --(*m_pending) == 0)
+            m_condition->signal();
+    }
+
+private:
+    mi::Uint32 m_iterations;
+    std::atomic_uint32_t* m_pending;
+    mi::base::Condition* m_condition;
+};
+
+/// A parent job for the benchmark that submits many small child jobs and waits for them.
+class Spawn_job : public mi::base::Interface_implement<IJob>
+{
+public:
+    Spawn_job( Thread_pool* thread_pool, mi::Uint32 count, mi::Uint32 iterations)
+      : m_thread_pool( thread_pool), m_count( count), m_iterations( iterations) { }
+
+    mi::Float32 get_cpu_load() const { return 1.0f; }
+    mi::Float32 get_gpu_load() const { return 0.0f; }
+    mi::Sint8 get_priority() const { return 0; }
+    bool is_remaining_work_splittable() { return false; }
+    void pre_execute( const mi::neuraylib::IJob_execution_context* context) { }
+
+    void execute( const mi::neuraylib::IJob_execution_context* context)
+    {
+        std::atomic_uint32_t pending( m_count);
+        mi::base::Condition condition;
+        for( mi::Uint32 i = 0; i < m_count; ++i) {
+            mi::base::Handle<Spin_job> job( new Spin_job( m_iterations, &pending, &condition));
+            m_thread_pool->submit_job( job.get());
+        }
+        m_thread_pool->suspend_current_job();
+        condition.wait();
+        m_thread_pool->resume_current_job();
+    }
+
+private:
+    Thread_pool* m_thread_pool;
+    mi::Uint32 m_count;
+    mi::Uint32 m_iterations;
+};
+
+/// A fragmented job for the benchmark with many small fragments.
+class Spin_fragmented_job : public Fragmented_job
+{
+public:
+    Spin_fragmented_job( mi::Uint32 count, mi::Uint32 iterations)
+      : Fragmented_job( 0, count), m_iterations( iterations) { }
+
+    mi::Float32 get_cpu_load() const { return 1.0f; }
+    mi::Float32 get_gpu_load() const { return 0.0f; }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context)
+    {
+        spin( m_iterations);
+    }
+
+private:
+    mi::Uint32 m_iterations;
+};
+
+/// Returns a name for the scheduling mode for log output.
+const char* get_mode_name( Thread_pool::Scheduling_mode mode)
+{
+    return mode == Thread_pool::SCHEDULING_WORK_STEALING ? "work-stealing" : "global queue";
+}
+
 /// Submits a high number of simple jobs with different loads and delays.
-void test_many_jobs()
+void test_many_jobs( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing many jobs ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing many jobs (%s) ...\n ", get_mode_name( mode));
 
-    Thread_pool thread_pool( 5.0, 5.0, 1);
+    Thread_pool thread_pool( 5.0, 5.0, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -617,16 +717,17 @@ void test_many_jobs()
 }
 
 /// Submits a job that recursively submits child jobs.
-void test_child_jobs()
+void test_child_jobs( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing child jobs ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing child jobs (%s) ...\n ", get_mode_name( mode));
 
     mi::Float32 cpu_load = 1.0f;
     mi::Float32 gpu_load = 1.0f;
     mi::Float32 delay    = 0.1f;
     mi::Uint32  levels   = 8;
 
-    Thread_pool thread_pool( cpu_load, gpu_load, 1);
+    Thread_pool thread_pool( cpu_load, gpu_load, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -653,16 +754,17 @@ void test_child_jobs()
 }
 
 /// Submits a job that can be split into several fragments.
-void test_fragmented_jobs()
+void test_fragmented_jobs( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing fragmented jobs ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing fragmented jobs (%s) ...\n ", get_mode_name( mode));
 
     mi::Float32 cpu_load = 1.0f;
     mi::Float32 gpu_load = 1.0f;
     mi::Float32 delay    = 0.1f;
     mi::Uint32  count    = 16;
 
-    Thread_pool thread_pool( 5.0, 5.0, 1);
+    Thread_pool thread_pool( 5.0, 5.0, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -702,15 +804,16 @@ void test_fragmented_jobs()
 
 /// Submits a second job that never fits the limits. It will be executed eventually when the load
 /// drops to 0 after the first job has been finished.
-void test_expensive_jobs()
+void test_expensive_jobs( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing expensive jobs ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing expensive jobs (%s) ...\n ", get_mode_name( mode));
 
     mi::Float32 cpu_load = 1.0f;
     mi::Float32 gpu_load = 1.0f;
     mi::Float32 delay    = 0.1f;
 
-    Thread_pool thread_pool( cpu_load, gpu_load, 1);
+    Thread_pool thread_pool( cpu_load, gpu_load, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -734,15 +837,16 @@ void test_expensive_jobs()
 }
 
 /// Submits jobs with various priorities. Checks that they are executed in reverse order.
-void test_priorities()
+void test_priorities( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing priorities ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing priorities (%s) ...\n ", get_mode_name( mode));
 
     mi::Float32 cpu_load = 1.0f;
     mi::Float32 gpu_load = 1.0f;
     mi::Float32 delay    = 0.1f;
 
-    Thread_pool thread_pool( cpu_load, gpu_load, 1);
+    Thread_pool thread_pool( cpu_load, gpu_load, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -781,15 +885,16 @@ void test_priorities()
 }
 
 /// Tests the yield() functionality using child jobs of higher/same/lower priority.
-void test_yield()
+void test_yield( Thread_pool::Scheduling_mode mode)
 {
-    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, "Testing yield() ...\n ");
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+        "Testing yield() (%s) ...\n ", get_mode_name( mode));
 
     mi::Float32 cpu_load = 1.0f;
     mi::Float32 gpu_load = 1.0f;
     mi::Float32 delay    = 0.1f;
 
-    Thread_pool thread_pool( cpu_load, gpu_load, 1);
+    Thread_pool thread_pool( cpu_load, gpu_load, 1, mode);
     thread_pool.dump_thread_state_counters();
     thread_pool.dump_load();
 
@@ -811,6 +916,46 @@ void test_yield()
     LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, " ");
 }
 
+/// Compares the throughput of both scheduling modes for many small child jobs and for a fragmented
+/// job with many small fragments, for 1 up to 64 worker threads.
+///
+/// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_scheduling_modes()
+{
+    const mi::Uint32 jobs       = 4096;
+    const mi::Uint32 iterations = 2000;
+
+    for( mi::Uint32 threads = 1; threads <= 64; threads *= 2) {
+        for( int m = 0; m < 2; ++m) {
+
+            Thread_pool::Scheduling_mode mode = m == 0
+                ? Thread_pool::SCHEDULING_GLOBAL_QUEUE : Thread_pool::SCHEDULING_WORK_STEALING;
+            // One extra unit of CPU load for the spawning parent job.
+            Thread_pool thread_pool(
+                static_cast<mi::Float32>( threads+1), 1.0f, threads+1, mode);
+
+            TIME::Time start = TIME::get_time();
+            mi::base::Handle<Spawn_job> spawn_job(
+                new Spawn_job( &thread_pool, jobs, iterations));
+            thread_pool.submit_job_and_wait( spawn_job.get());
+            double child_jobs_time = (TIME::get_time() - start).get_seconds();
+
+            start = TIME::get_time();
+            mi::base::Handle<Spin_fragmented_job> fragmented_job(
+                new Spin_fragmented_job( jobs, iterations));
+            thread_pool.submit_job_and_wait( fragmented_job.get());
+            double fragments_time = (TIME::get_time() - start).get_seconds();
+
+            LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
+                "Benchmark %2u worker threads, %-13s: %8.0f child jobs/s, %8.0f fragments/s",
+                threads, get_mode_name( mode),
+                jobs / std::max( child_jobs_time, 1e-6), jobs / std::max( fragments_time, 1e-6));
+        }
+    }
+
+    LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC, " ");
+}
+
 MI_TEST_AUTO_FUNCTION( test_thread_pool )
 {
     SYSTEM::Access_module<MEM::Mem_module> mem_module( false);
@@ -818,12 +963,20 @@ MI_TEST_AUTO_FUNCTION( test_thread_pool )
     // log_module->set_severity_limit( LOG::ILogger::S_ALL);
     // log_module->set_severity_by_category( LOG::ILogger::C_MISC, LOG::ILogger::S_ALL);
 
-    test_many_jobs();
-    test_child_jobs();
-    test_fragmented_jobs();
-    test_expensive_jobs();
-    test_priorities();
-    test_yield();
+    Thread_pool::Scheduling_mode modes[] = {
+        Thread_pool::SCHEDULING_GLOBAL_QUEUE, Thread_pool::SCHEDULING_WORK_STEALING };
+
+    for( Thread_pool::Scheduling_mode mode : modes) {
+        test_many_jobs( mode);
+        test_child_jobs( mode);
+        test_fragmented_jobs( mode);
+        test_expensive_jobs( mode);
+        test_priorities( mode);
+        test_yield( mode);
+    }
+
+    if( getenv( "MI_TEST_RUN_BENCHMARKS"))
+        benchmark_scheduling_modes();
 }
 
 MI_TEST_MAIN_CALLING_TEST_MAIN();
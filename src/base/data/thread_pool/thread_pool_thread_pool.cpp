@@ -36,6 +36,7 @@
 #include "thread_pool_jobs.h"
 
 #include <cfloat>
+#include <cstring>
 #include <utility>
 #include <boost/core/ignore_unused.hpp>
 #include <base/hal/time/i_time.h>
@@ -56,17 +57,24 @@ mi::Float32 Thread_pool::s_min_cpu_load = 0.0f;
 /// A positive number might create problems if the system has no GPUs.
 mi::Float32 Thread_pool::s_min_gpu_load = 0.0f;
 
+thread_local Thread_pool::Local_queue* Thread_pool::s_current_local_queue = nullptr;
+
 Thread_pool::Thread_pool(
     mi::Float32 cpu_load_limit,
     mi::Float32 gpu_load_limit,
-    mi::Size nr_of_worker_threads)
-  : m_cpu_load_limit( cpu_load_limit),
+    mi::Size nr_of_worker_threads,
+    Scheduling_mode scheduling_mode)
+  : m_scheduling_mode( scheduling_mode),
+    m_cpu_load_limit( cpu_load_limit),
     m_gpu_load_limit( gpu_load_limit),
     m_cpu_load_license_limit( FLT_MAX),
     m_gpu_load_license_limit( FLT_MAX),
-    m_current_cpu_load( 0.0f),
-    m_current_gpu_load( 0.0f),
+    m_current_load( pack_load( 0.0f, 0.0f)),
     m_thread_affinity( false),
+    m_local_queues( nullptr),
+    m_global_top_priority( s_no_priority),
+    m_nr_of_local_jobs( 0),
+    m_work_generation( 0),
     m_next_cpu_id( 0),
     m_shutdown( false)
 {
@@ -85,8 +93,8 @@ Thread_pool::~Thread_pool()
     mi::base::Lock::Block block( &m_lock);
     m_shutdown = true;
 
-    // Wait until job queue is empty.
-    while( !m_job_queue.empty()) {
+    // Wait until job queue (and all local queues) are empty.
+    while( !m_job_queue.empty() || m_nr_of_local_jobs > 0) {
         block.release();
         TIME::sleep( 0.01);
         block.set( &m_lock);
@@ -107,6 +115,7 @@ Thread_pool::~Thread_pool()
     block.set( &m_lock);
 
     ASSERT( M_THREAD_POOL, m_job_queue.empty());
+    ASSERT( M_THREAD_POOL, m_nr_of_local_jobs == 0);
     ASSERT( M_THREAD_POOL, m_running_jobs.empty());
     ASSERT( M_THREAD_POOL, m_suspended_jobs.empty());
 
@@ -122,6 +131,15 @@ Thread_pool::~Thread_pool()
     m_all_threads.clear();
     m_sleeping_threads.clear();
 
+    Local_queue* queue = m_local_queues;
+    while( queue) {
+        ASSERT( M_THREAD_POOL, queue->m_jobs.empty());
+        Local_queue* next = queue->m_next;
+        delete queue;
+        queue = next;
+    }
+    m_local_queues = nullptr;
+
     ASSERT( M_THREAD_POOL, m_thread_state_counter[THREAD_SHUTDOWN]  == 0);
 }
 
@@ -258,6 +276,7 @@ bool Thread_pool::remove_job( IJob* job)
                 it_map->second.erase( it_list);
                 if( it_map->second.empty())
                     m_job_queue.erase( it_map);
+                m_global_top_priority = get_top_priority( m_job_queue);
                 return true;
             }
 
@@ -266,6 +285,26 @@ bool Thread_pool::remove_job( IJob* job)
         ++it_map;
     }
 
+    block.release();
+
+    for( Local_queue* queue = m_local_queues; queue; queue = queue->m_next) {
+
+        mi::base::Lock::Block queue_block( &queue->m_lock);
+
+        for( it_map = queue->m_jobs.begin(); it_map != queue->m_jobs.end(); ++it_map) {
+            for( Job_list::iterator it = it_map->second.begin(); it != it_map->second.end(); ++it) {
+                if( it->get() == job) {
+                    it_map->second.erase( it);
+                    if( it_map->second.empty())
+                        queue->m_jobs.erase( it_map);
+                    queue->m_top_priority = get_top_priority( queue->m_jobs);
+                    --m_nr_of_local_jobs;
+                    return true;
+                }
+            }
+        }
+    }
+
     return false;
 }
 
@@ -288,14 +327,45 @@ void Thread_pool::yield()
 
 IJob* Thread_pool::get_next_job( Worker_thread* thread)
 {
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING)
+        return get_next_job_work_stealing( thread);
+
     mi::base::Lock::Block block( &m_lock);
 
     ASSERT( M_THREAD_POOL, thread->get_state() == THREAD_IDLE);
 
-    Job_queue::iterator it_map      = m_job_queue.begin();
-    Job_queue::iterator it_map_end  = m_job_queue.end();
+    bool splittable = false;
+    IJob* job = dequeue_job( m_job_queue, thread, /*from_back*/ false, splittable);
+
+    if( !job) {
+        thread->set_state( THREAD_SLEEPING);
+        std::pair<Sleeping_threads::iterator,bool> result = m_sleeping_threads.insert( thread);
+        ASSERT( M_THREAD_POOL, result.second);
+        boost::ignore_unused( result);
+        return 0;
+    }
+
+    // wake up another worker thread for jobs that want more parallel calls (after removing this
+    // thread from the set of sleeping threads)
+    if( splittable)
+       wake_up_worker_thread();
+
+    // map thread to the job
+    mi::Uint64 thread_id = thread->get_thread_id();
+    ASSERT( M_THREAD_POOL, m_running_jobs.find( thread_id) == m_running_jobs.end());
+    m_running_jobs[thread_id] = job;
+
+    return job;
+}
+
+IJob* Thread_pool::dequeue_job(
+    Job_queue& queue, Worker_thread* thread, bool from_back, bool& splittable)
+{
+    // The caller is supposed to hold the lock protecting queue.
+
+    Job_queue::iterator it_map      = queue.begin();
+    Job_queue::iterator it_map_end  = queue.end();
     Job_list::iterator  it_list;
-    Job_list::iterator  it_list_end;
 #ifdef MI_THREAD_POOL_VERBOSE
     mi::Size k = 0;
 #endif // MI_THREAD_POOL_VERBOSE
@@ -304,31 +374,32 @@ IJob* Thread_pool::get_next_job( Worker_thread* thread)
     mi::Float32 requested_cpu_load = 0.f;
     mi::Float32 requested_gpu_load = 0.f;
 
-    // find first job whose resource request fits the load limits
+    // find first job whose resource request fits the load limits (and acquire that load)
     while( it_map != it_map_end) {
 
-        it_list     = it_map->second.begin();
-        it_list_end = it_map->second.end();
-        while( it_list != it_list_end) {
+        Job_list& list = it_map->second;
+        it_list = from_back ? list.end() : list.begin();
+        while( from_back ? it_list != list.begin() : it_list != list.end()) {
 
+            if( from_back)
+                --it_list;
             job = it_list->get();
             requested_cpu_load = job->get_cpu_load();
             requested_gpu_load = job->get_gpu_load();
             adjust_load( requested_cpu_load, requested_gpu_load);
-            if( job_fits_load_limits( requested_cpu_load, requested_gpu_load))
+            if( try_acquire_load( requested_cpu_load, requested_gpu_load))
                 break;
 #ifdef MI_THREAD_POOL_VERBOSE
             LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
                 "Delaying job %p, queue index %" FMT_SIZE_T ", "
                 "CPU load %.1f/%.1f/%.1f, GPU load %.1f/%.1f/%.1f, priority %d\n", job, (size_t) k,
-                requested_cpu_load, m_current_cpu_load, m_cpu_load_limit,
-                requested_gpu_load, m_current_gpu_load, m_gpu_load_limit,
+                requested_cpu_load, get_current_cpu_load(), m_cpu_load_limit.load(),
+                requested_gpu_load, get_current_gpu_load(), m_gpu_load_limit.load(),
                 (int) job->get_priority());
-#endif // MI_THREAD_POOL_VERBOSE
-            ++it_list;
-#ifdef MI_THREAD_POOL_VERBOSE
             ++k;
 #endif // MI_THREAD_POOL_VERBOSE
+            if( !from_back)
+                ++it_list;
             job = 0;
         }
         if( job)
@@ -336,21 +407,15 @@ IJob* Thread_pool::get_next_job( Worker_thread* thread)
         ++it_map;
     }
 
-    if( it_map == it_map_end) {
-        ASSERT( M_THREAD_POOL, !job);
-        thread->set_state( THREAD_SLEEPING);
-        std::pair<Sleeping_threads::iterator,bool> result = m_sleeping_threads.insert( thread);
-        ASSERT( M_THREAD_POOL, result.second);
-        boost::ignore_unused( result);
+    if( !job)
         return 0;
-    }
 
 #ifdef MI_THREAD_POOL_VERBOSE
     LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
         "Executing job %p, queue index %" FMT_SIZE_T ", "
         "CPU load %.1f/%.1f/%.1f, GPU load %.1f/%.1f/%.1f, priority %d\n", job, (size_t) k,
-        requested_cpu_load, m_current_cpu_load, m_cpu_load_limit,
-        requested_gpu_load, m_current_gpu_load, m_gpu_load_limit,
+        requested_cpu_load, get_current_cpu_load(), m_cpu_load_limit.load(),
+        requested_gpu_load, get_current_gpu_load(), m_gpu_load_limit.load(),
         (int) job->get_priority());
 #endif // MI_THREAD_POOL_VERBOSE
 
@@ -362,34 +427,113 @@ IJob* Thread_pool::get_next_job( Worker_thread* thread)
     job->pre_execute( thread);
 
     // remove job from queue if the job does no want more parallel calls
-    bool dequeue_job = !job->is_remaining_work_splittable();
-    if( dequeue_job) {
+    splittable = job->is_remaining_work_splittable();
+    if( !splittable) {
         it_map->second.erase( it_list);
         if( it_map->second.empty())
-            m_job_queue.erase( it_map);
+            queue.erase( it_map);
     }
 
-    // adjust current load
-    m_current_cpu_load += requested_cpu_load;
-    m_current_gpu_load += requested_gpu_load;
+    return job;
+}
 
-    // wake up another worker thread for jobs that want more parallel calls (after removing this
-    // thread from the set of sleeping threads)
-    if( !dequeue_job)
-       wake_up_worker_thread();
+IJob* Thread_pool::get_next_job_work_stealing( Worker_thread* thread)
+{
+    ASSERT( M_THREAD_POOL, thread->get_state() == THREAD_IDLE);
 
-    // map thread to the job
-    mi::Uint64 thread_id = thread->get_thread_id();
-    ASSERT( M_THREAD_POOL, m_running_jobs.find( thread_id) == m_running_jobs.end());
-    m_running_jobs[thread_id] = job;
+    Local_queue* own_queue = get_local_queue( thread);
+    ASSERT( M_THREAD_POOL, !own_queue->m_current_job);
+
+    while( true) {
+
+        mi::Uint32 generation = m_work_generation;
+        mi::Sint32 top_priority = get_top_priority();
+        IJob* job = 0;
+        bool splittable = false;
+
+        // The first pass only considers queues whose highest priority matches the overall highest
+        // priority, such that priorities are obeyed across queues. The second pass considers all
+        // queues, e.g., if the jobs of highest priority do not fit the load limits. In each pass,
+        // consider the own queue (from the front), then the global queue, and finally the local
+        // queues of other worker threads (from the back, starting after the own queue to spread
+        // thieves across victims).
+        for( int pass = 0; !job && pass < 2 && top_priority != s_no_priority; ++pass) {
 
+            mi::Sint32 limit = pass == 0 ? top_priority : s_no_priority - 1;
+
+            if( own_queue->m_top_priority <= limit)
+                job = take_job( own_queue, thread, /*from_back*/ false, splittable);
+
+            if( !job && m_global_top_priority <= limit)
+                job = take_job( nullptr, thread, /*from_back*/ false, splittable);
+
+            Local_queue* victim = own_queue->m_next ? own_queue->m_next : m_local_queues.load();
+            while( !job && victim != own_queue) {
+                if( victim->m_top_priority <= limit)
+                    job = take_job( victim, thread, /*from_back*/ true, splittable);
+                victim = victim->m_next ? victim->m_next : m_local_queues.load();
+            }
+        }
+
+        if( job) {
+            // wake up another worker thread for jobs that want more parallel calls
+            if( splittable) {
+                mi::Float32 cpu_load = job->get_cpu_load();
+                mi::Float32 gpu_load = job->get_gpu_load();
+                adjust_load( cpu_load, gpu_load);
+                wake_up_worker_thread_if_fits( cpu_load, gpu_load);
+            }
+            own_queue->m_current_job = job;
+            return job;
+        }
+
+        // Go to sleep unless new work arrived since the search started. Submitters increment
+        // m_work_generation before acquiring m_lock to wake up sleeping threads.
+        mi::base::Lock::Block block( &m_lock);
+        if( generation != m_work_generation)
+            continue;
+
+        thread->set_state( THREAD_SLEEPING);
+        std::pair<Sleeping_threads::iterator,bool> result = m_sleeping_threads.insert( thread);
+        ASSERT( M_THREAD_POOL, result.second);
+        boost::ignore_unused( result);
+        return 0;
+    }
+}
+
+IJob* Thread_pool::take_job(
+    Local_queue* queue, Worker_thread* thread, bool from_back, bool& splittable)
+{
+    if( !queue) {
+        mi::base::Lock::Block block( &m_lock);
+        IJob* job = dequeue_job( m_job_queue, thread, from_back, splittable);
+        if( job && !splittable)
+            m_global_top_priority = get_top_priority( m_job_queue);
+        return job;
+    }
+
+    mi::base::Lock::Block block( &queue->m_lock);
+    IJob* job = dequeue_job( queue->m_jobs, thread, from_back, splittable);
+    if( job && !splittable) {
+        queue->m_top_priority = get_top_priority( queue->m_jobs);
+        --m_nr_of_local_jobs;
+    }
     return job;
 }
 
-void Thread_pool::job_execution_finished( Worker_thread* thread, IJob* job)
+mi::Sint32 Thread_pool::get_top_priority() const
 {
-    mi::base::Lock::Block block( &m_lock);
+    mi::Sint32 result = m_global_top_priority;
+    for( Local_queue* queue = m_local_queues; queue; queue = queue->m_next) {
+        mi::Sint32 priority = queue->m_top_priority;
+        if( priority < result)
+            result = priority;
+    }
+    return result;
+}
 
+void Thread_pool::job_execution_finished( Worker_thread* thread, IJob* job)
+{
     ASSERT( M_THREAD_POOL, thread->get_state() == THREAD_IDLE);
 
     mi::Float32 requested_cpu_load = job->get_cpu_load();
@@ -398,18 +542,29 @@ void Thread_pool::job_execution_finished( Worker_thread* thread, IJob* job)
     LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
         "Finished job %p, queue index n/a, CPU load %.1f/%.1f/%.1f, GPU load %.1f/%.1f/%.1f, "
         "priority %d\n", job,
-        requested_cpu_load, m_current_cpu_load, m_cpu_load_limit,
-        requested_gpu_load, m_current_gpu_load, m_gpu_load_limit,
+        requested_cpu_load, get_current_cpu_load(), m_cpu_load_limit.load(),
+        requested_gpu_load, get_current_gpu_load(), m_gpu_load_limit.load(),
         (int) job->get_priority());
 #endif // MI_THREAD_POOL_VERBOSE
 
     // adjust current load except for resume jobs
     if( job->get_iid() != Resume_job::IID()) {
         adjust_load( requested_cpu_load, requested_gpu_load);
-        m_current_cpu_load -= requested_cpu_load;
-        m_current_gpu_load -= requested_gpu_load;
+        release_load( requested_cpu_load, requested_gpu_load);
+    }
+
+    // The worker thread searches for the next job right after this call, no need to wake up
+    // another one.
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING) {
+        Local_queue* queue = get_local_queue( thread);
+        ASSERT( M_THREAD_POOL, queue->m_current_job == job);
+        ASSERT( M_THREAD_POOL, !queue->m_suspended);
+        queue->m_current_job = nullptr;
+        return;
     }
 
+    mi::base::Lock::Block block( &m_lock);
+
     // unmap job from thread
     mi::Uint64 thread_id = thread->get_thread_id();
     Job_map::iterator it = m_running_jobs.find( thread_id);
@@ -419,9 +574,11 @@ void Thread_pool::job_execution_finished( Worker_thread* thread, IJob* job)
 
 void Thread_pool::dump_load() const
 {
+    mi::Float32 current_cpu_load, current_gpu_load;
+    unpack_load( m_current_load, current_cpu_load, current_gpu_load);
     LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
         "Current CPU load: %.1f/%.1f, GPU load: %.1f/%.1f",
-        m_current_cpu_load, m_cpu_load_limit, m_current_gpu_load, m_gpu_load_limit);
+        current_cpu_load, m_cpu_load_limit.load(), current_gpu_load, m_gpu_load_limit.load());
 }
 
 void Thread_pool::dump_thread_state_counters() const
@@ -441,6 +598,16 @@ void Thread_pool::dump_thread_state_counters() const
 
 void Thread_pool::submit_job_internal( IJob* job, bool log_asynchronous)
 {
+    // In the work-stealing mode child jobs and resume jobs go into the local queue of the worker
+    // thread, m_lock is not needed.
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING) {
+        Local_queue* queue = get_current_local_queue();
+        if( queue) {
+            submit_job_local( queue, job);
+            return;
+        }
+    }
+
     mi::base::Lock::Block block( &m_lock);
 
     // Submitting new jobs while another thread invokes the destructor is an error.
@@ -460,6 +627,8 @@ void Thread_pool::submit_job_internal( IJob* job, bool log_asynchronous)
         m_job_queue[priority].push_front( make_handle_dup( job));
     else
         m_job_queue[priority].push_back( make_handle_dup( job));
+    m_global_top_priority = get_top_priority( m_job_queue);
+    ++m_work_generation;
 
     // Check whether the job could be executed immediately.
     mi::Float32 requested_cpu_load = job->get_cpu_load();
@@ -470,8 +639,8 @@ void Thread_pool::submit_job_internal( IJob* job, bool log_asynchronous)
         LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
             "Submitted job %p, CPU load %.1f/%.1f/%.1f, GPU load %.1f/%.1f/%.1f, priority %d, "
             "%s%sjob, execution delayed\n", job,
-            requested_cpu_load, m_current_cpu_load, m_cpu_load_limit,
-            requested_gpu_load, m_current_gpu_load, m_gpu_load_limit,
+            requested_cpu_load, get_current_cpu_load(), m_cpu_load_limit.load(),
+            requested_gpu_load, get_current_gpu_load(), m_gpu_load_limit.load(),
             (int) priority,
             resume_job ? "resume " : (child_job ? "child " : "top-level "),
             resume_job ? "" : (log_asynchronous ? "asynchronous " : "synchronous "));
@@ -484,8 +653,8 @@ void Thread_pool::submit_job_internal( IJob* job, bool log_asynchronous)
     LOG::mod_log->info( M_THREAD_POOL, LOG::Mod_log::C_MISC,
         "Submitted job %p, CPU load %.1f/%.1f/%.1f, GPU load %.1f/%.1f/%.1f, priority %d, "
         "%s%sjob, waking up thread\n", job,
-        requested_cpu_load, m_current_cpu_load, m_cpu_load_limit,
-        requested_gpu_load, m_current_gpu_load, m_gpu_load_limit,
+        requested_cpu_load, get_current_cpu_load(), m_cpu_load_limit.load(),
+        requested_gpu_load, get_current_gpu_load(), m_gpu_load_limit.load(),
         (int) priority,
         resume_job ? "resume " : (child_job ? "child " : "top-level "),
         resume_job ? "" : (log_asynchronous ? "asynchronous " : "synchronous "));
@@ -493,8 +662,75 @@ void Thread_pool::submit_job_internal( IJob* job, bool log_asynchronous)
     wake_up_worker_thread();
 }
 
+void Thread_pool::submit_job_local( Local_queue* queue, IJob* job)
+{
+    ASSERT( M_THREAD_POOL, !m_shutdown);
+
+    // Jobs can only be submitted from a suspended worker thread to resume it. The owner does not
+    // take jobs while being suspended, only thieves do, and they steal from the back. Hence, put
+    // resume jobs at the back such that they are taken before any other jobs of this queue.
+    mi::Sint8 priority = job->get_priority();
+    {
+        mi::base::Lock::Block block( &queue->m_lock);
+        if( queue->m_suspended)
+            queue->m_jobs[priority].push_back( make_handle_dup( job));
+        else
+            queue->m_jobs[priority].push_front( make_handle_dup( job));
+        queue->m_top_priority = get_top_priority( queue->m_jobs);
+    }
+    ++m_nr_of_local_jobs;
+    ++m_work_generation;
+
+    mi::Float32 requested_cpu_load = job->get_cpu_load();
+    mi::Float32 requested_gpu_load = job->get_gpu_load();
+    adjust_load( requested_cpu_load, requested_gpu_load);
+    wake_up_worker_thread_if_fits( requested_cpu_load, requested_gpu_load);
+}
+
+void Thread_pool::wake_up_worker_thread_if_fits( mi::Float32 cpu_load, mi::Float32 gpu_load)
+{
+    if( !job_fits_load_limits( cpu_load, gpu_load))
+        return;
+
+    mi::base::Lock::Block block( &m_lock);
+    if( !m_shutdown)
+        wake_up_worker_thread();
+}
+
 bool Thread_pool::suspend_current_job_internal( bool only_for_higher_priority)
 {
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING) {
+
+        Local_queue* queue = get_current_local_queue();
+        if( !queue || !queue->m_current_job)
+            return false;
+        // detect nested suspend calls
+        ASSERT( M_THREAD_POOL, !queue->m_suspended);
+        if( queue->m_suspended)
+            return false;
+
+        IJob* job = queue->m_current_job;
+        mi::Float32 cpu_load = job->get_cpu_load();
+        mi::Float32 gpu_load = job->get_gpu_load();
+        adjust_load( cpu_load, gpu_load);
+
+        if( only_for_higher_priority && get_top_priority() >= job->get_priority())
+            return false;
+
+        --m_thread_state_counter[THREAD_RUNNING];
+        ++m_thread_state_counter[THREAD_SUSPENDED];
+
+        queue->m_suspended = true;
+        release_load( cpu_load, gpu_load);
+
+        // wake up some worker thread if there are jobs in the queues
+        if( get_top_priority() != s_no_priority) {
+            mi::base::Lock::Block block( &m_lock);
+            wake_up_worker_thread();
+        }
+        return true;
+    }
+
     mi::base::Lock::Block block( &m_lock);
 
     // check whether we actually suspend if the flag is set, part 1
@@ -529,8 +765,7 @@ bool Thread_pool::suspend_current_job_internal( bool only_for_higher_priority)
     ++m_thread_state_counter[THREAD_SUSPENDED];
 
     // adjust current load
-    m_current_cpu_load -= cpu_load;
-    m_current_gpu_load -= gpu_load;
+    release_load( cpu_load, gpu_load);
 
     // move job from map of running threads to map of suspended threads
     Job_map::iterator it = m_running_jobs.find( thread_id);
@@ -577,6 +812,13 @@ void Thread_pool::resume_current_job_internal()
     --m_thread_state_counter[THREAD_SUSPENDED];
     ++m_thread_state_counter[THREAD_RUNNING];
 
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING) {
+        Local_queue* queue = get_current_local_queue();
+        ASSERT( M_THREAD_POOL, queue && queue->m_suspended);
+        queue->m_suspended = false;
+        return;
+    }
+
     // move job from map of suspended threads to map of running threads
     mi::base::Lock::Block block( &m_lock);
     Job_map::iterator it = m_suspended_jobs.find( thread_id);
@@ -622,15 +864,95 @@ void Thread_pool::wake_up_worker_thread()
 
 bool Thread_pool::job_fits_load_limits( mi::Float32 cpu_load, mi::Float32 gpu_load) const
 {
-    // The caller is supposed to hold m_lock.
-
     // Clip requested resources against limits to avoid delaying forever jobs with unsatisfiable
     // requirements. Such jobs will only be executed if the current load is 0.0, ignoring the limit.
-    if( cpu_load > m_cpu_load_limit) cpu_load = m_cpu_load_limit;
-    if( gpu_load > m_gpu_load_limit) gpu_load = m_gpu_load_limit;
+    mi::Float32 cpu_load_limit = m_cpu_load_limit;
+    mi::Float32 gpu_load_limit = m_gpu_load_limit;
+    if( cpu_load > cpu_load_limit) cpu_load = cpu_load_limit;
+    if( gpu_load > gpu_load_limit) gpu_load = gpu_load_limit;
+
+    mi::Float32 current_cpu_load, current_gpu_load;
+    unpack_load( m_current_load, current_cpu_load, current_gpu_load);
+    return current_cpu_load + cpu_load <= cpu_load_limit * 1.001
+        && current_gpu_load + gpu_load <= gpu_load_limit * 1.001;
+}
 
-    return m_current_cpu_load + cpu_load <= m_cpu_load_limit * 1.001
-        && m_current_gpu_load + gpu_load <= m_gpu_load_limit * 1.001;
+bool Thread_pool::try_acquire_load( mi::Float32 cpu_load, mi::Float32 gpu_load)
+{
+    mi::Float32 cpu_load_limit = m_cpu_load_limit;
+    mi::Float32 gpu_load_limit = m_gpu_load_limit;
+    mi::Float32 clipped_cpu_load = cpu_load > cpu_load_limit ? cpu_load_limit : cpu_load;
+    mi::Float32 clipped_gpu_load = gpu_load > gpu_load_limit ? gpu_load_limit : gpu_load;
+
+    mi::Uint64 old_value = m_current_load;
+    while( true) {
+        mi::Float32 current_cpu_load, current_gpu_load;
+        unpack_load( old_value, current_cpu_load, current_gpu_load);
+        if(    current_cpu_load + clipped_cpu_load > cpu_load_limit * 1.001
+            || current_gpu_load + clipped_gpu_load > gpu_load_limit * 1.001)
+            return false;
+        mi::Uint64 new_value
+            = pack_load( current_cpu_load + cpu_load, current_gpu_load + gpu_load);
+        if( m_current_load.compare_exchange_weak( old_value, new_value))
+            return true;
+    }
+}
+
+void Thread_pool::release_load( mi::Float32 cpu_load, mi::Float32 gpu_load)
+{
+    mi::Uint64 old_value = m_current_load;
+    while( true) {
+        mi::Float32 current_cpu_load, current_gpu_load;
+        unpack_load( old_value, current_cpu_load, current_gpu_load);
+        mi::Uint64 new_value
+            = pack_load( current_cpu_load - cpu_load, current_gpu_load - gpu_load);
+        if( m_current_load.compare_exchange_weak( old_value, new_value))
+            break;
+    }
+
+    // Jobs that did not fit the load limits before might fit now.
+    ++m_work_generation;
+}
+
+mi::Uint64 Thread_pool::pack_load( mi::Float32 cpu_load, mi::Float32 gpu_load)
+{
+    mi::Uint32 cpu_bits, gpu_bits;
+    memcpy( &cpu_bits, &cpu_load, sizeof( cpu_bits));
+    memcpy( &gpu_bits, &gpu_load, sizeof( gpu_bits));
+    return (static_cast<mi::Uint64>( cpu_bits) << 32) | gpu_bits;
+}
+
+void Thread_pool::unpack_load( mi::Uint64 load, mi::Float32& cpu_load, mi::Float32& gpu_load)
+{
+    mi::Uint32 cpu_bits = static_cast<mi::Uint32>( load >> 32);
+    mi::Uint32 gpu_bits = static_cast<mi::Uint32>( load);
+    memcpy( &cpu_load, &cpu_bits, sizeof( cpu_load));
+    memcpy( &gpu_load, &gpu_bits, sizeof( gpu_load));
+}
+
+Thread_pool::Local_queue* Thread_pool::get_local_queue( Worker_thread* thread)
+{
+    // Only called from the worker thread itself. Since worker threads are owned by exactly one
+    // thread pool and terminate before it is destroyed, the cached queue is always valid.
+    Local_queue* queue = s_current_local_queue;
+    if( queue) {
+        ASSERT( M_THREAD_POOL, queue->m_thread == thread);
+        return queue;
+    }
+
+    queue = new Local_queue( this, thread);
+    mi::base::Lock::Block block( &m_lock);
+    queue->m_next = m_local_queues;
+    m_local_queues = queue;
+
+    s_current_local_queue = queue;
+    return queue;
+}
+
+Thread_pool::Local_queue* Thread_pool::get_current_local_queue() const
+{
+    Local_queue* queue = s_current_local_queue;
+    return queue && queue->m_thread_pool == this ? queue : nullptr;
 }
 
 bool Thread_pool::get_current_job_data(
@@ -640,6 +962,24 @@ bool Thread_pool::get_current_job_data(
     mi::Uint64& thread_id,
     bool suspended) const
 {
+    // In the work-stealing mode the job data is kept in the local queue of the worker thread,
+    // m_lock is not needed.
+    if( m_scheduling_mode == SCHEDULING_WORK_STEALING) {
+        thread_id = THREAD::Thread_id().get_uint();
+        Local_queue* queue = get_current_local_queue();
+        if( !queue || !queue->m_current_job || queue->m_suspended != suspended) {
+            cpu_load = 0.0;
+            gpu_load = 0.0;
+            priority = 0;
+            return false;
+        }
+        cpu_load = queue->m_current_job->get_cpu_load();
+        gpu_load = queue->m_current_job->get_gpu_load();
+        adjust_load( cpu_load, gpu_load);
+        priority = queue->m_current_job->get_priority();
+        return true;
+    }
+
     mi::base::Lock::Block block( &m_lock);
     return get_current_job_data_locked( cpu_load, gpu_load, priority, thread_id, suspended);
 }
@@ -105,6 +105,41 @@ public:
     /// Does not change the flag for delaying upcoming log messages.
     virtual void emit_delayed_log_messages() = 0;
 
+    //@}
+    /// \name Asynchronous dispatch
+    //@{
+
+    /// Policies for messages that do not fit into the queue of the asynchronous dispatch.
+    enum Overflow_policy {
+        OVERFLOW_BLOCK, ///< The emitting thread waits until the queue has space.
+        OVERFLOW_DROP,  ///< The message is discarded silently.
+        OVERFLOW_COUNT  ///< The message is discarded, and a summary warning is emitted later.
+    };
+
+    /// Enables or disables asynchronous dispatch of log messages.
+    ///
+    /// If enabled, emitting threads only format the message and append it to a lock-free queue.
+    /// A background thread drains the queue and invokes the log targets. Fatal messages and
+    /// failed assertions flush the queue and are always dispatched synchronously. Disabling
+    /// flushes all pending messages.
+    ///
+    /// \param enabled      \c true to enable, \c false to disable asynchronous dispatch.
+    /// \param queue_size   The capacity of the queue (rounded up to a power of two).
+    /// \param policy       The policy for messages that do not fit into the queue.
+    virtual void set_async_dispatch(
+        bool enabled, size_t queue_size = 4096, Overflow_policy policy = OVERFLOW_BLOCK) = 0;
+
+    /// Indicates whether asynchronous dispatch is enabled.
+    virtual bool get_async_dispatch() const = 0;
+
+    /// Waits until all messages queued so far have been passed to the log targets.
+    ///
+    /// Does nothing if asynchronous dispatch is disabled.
+    virtual void flush() = 0;
+
+    /// Returns the number of messages discarded due to queue overflows so far.
+    virtual size_t get_dropped_message_count() const = 0;
+
     //@}
     /// \name Interface for the DATA module
     //@{
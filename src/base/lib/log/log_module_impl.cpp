@@ -38,6 +38,7 @@
 #include "log_targets.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -109,11 +110,24 @@ Log_module_impl::Log_module_impl()
     m_log_target_debugger = new Log_target_debugger;
     m_delay_messages = false;
 
+    m_async_enabled = false;
+    m_async_producers = 0;
+    m_async_policy = OVERFLOW_BLOCK;
+    m_async_stop = false;
+    m_async_pushed = 0;
+    m_async_dispatched = 0;
+    m_async_dropped = 0;
+    m_async_dropped_reported = 0;
+    m_async_idle = false;
+    m_async_thread_id = std::thread::id();
+
     mod_log = this;
 }
 
 Log_module_impl::~Log_module_impl()
 {
+    set_async_dispatch( false);
+
     mod_log = nullptr;
     delete m_log_target_debugger;
     delete m_log_target_stderr;
@@ -149,6 +163,19 @@ void Log_module_impl::configure()
             std::string key_name = "severity_for_" + std::string( category_name[c]);
             CONFIG::update_value( registry, key_name, m_sev_by_cat[c]);
         }
+
+        bool async_logging = false;
+        CONFIG::update_value( registry, "async_logging", async_logging);
+        if( async_logging) {
+            int queue_size = 4096;
+            CONFIG::update_value( registry, "async_logging_queue_size", queue_size);
+            int policy = OVERFLOW_BLOCK;
+            CONFIG::update_value( registry, "async_logging_overflow_policy", policy);
+            if( policy < OVERFLOW_BLOCK || policy > OVERFLOW_COUNT)
+                policy = OVERFLOW_BLOCK;
+            set_async_dispatch( true, queue_size > 0 ? queue_size : 4096,
+                static_cast<Overflow_policy>( policy));
+        }
     }
 }
 
@@ -202,6 +229,57 @@ void Log_module_impl::emit_delayed_log_messages()
     emit_delayed_log_messages_internal();
 }
 
+void Log_module_impl::set_async_dispatch(
+    bool enabled, size_t queue_size, Overflow_policy policy)
+{
+    std::lock_guard<std::mutex> config_lock( m_async_config_mutex);
+
+    if( m_async_enabled) {
+        // Stop accepting new messages and wait for emitting threads that are about to push.
+        m_async_enabled = false;
+        while( m_async_producers > 0)
+            std::this_thread::yield();
+
+        // Let the dispatch thread drain the queue and terminate.
+        {
+            std::lock_guard<std::mutex> lock( m_async_mutex);
+            m_async_stop = true;
+        }
+        m_async_condition.notify_one();
+        m_async_thread.join();
+        m_async_thread_id = std::thread::id();
+        m_async_stop = false;
+
+        // Wake up threads waiting in flush().
+        {
+            std::lock_guard<std::mutex> lock( m_async_mutex);
+            m_async_flushed_condition.notify_all();
+        }
+    }
+
+    if( !enabled)
+        return;
+
+    m_async_queue.reset( new Mpsc_queue<Async_message>( queue_size));
+    m_async_policy = policy;
+    m_async_dropped_reported = m_async_dropped;
+    m_async_thread = std::thread( &Log_module_impl::async_dispatch_loop, this);
+    m_async_thread_id = m_async_thread.get_id();
+    m_async_enabled = true;
+}
+
+void Log_module_impl::flush()
+{
+    if( !m_async_enabled || std::this_thread::get_id() == m_async_thread_id.load())
+        return;
+
+    const size_t target = m_async_pushed;
+    std::unique_lock<std::mutex> lock( m_async_mutex);
+    m_async_condition.notify_one();
+    m_async_flushed_condition.wait( lock, [this, target]() {
+        return m_async_dispatched >= target || !m_async_enabled; });
+}
+
 void Log_module_impl::set_host_name( const char* host_name)
 {
     m_host_name = host_name;
@@ -222,7 +300,10 @@ void Log_module_impl::insert_message(
 void Log_module_impl::fatal( const char* mod, Category cat, const mi::base::Message_details& det,
                              const char* fmt, va_list args)
 {
-    message( mod, cat, S_FATAL, det, fmt, args);
+    va_list args_copy;
+    va_copy( args_copy, args);
+    message( mod, cat, S_FATAL, det, fmt, args_copy);
+    va_end( args_copy);
 
     if( !HAL::has_stderr()) {
         char buf[32768];
@@ -301,8 +382,10 @@ void Log_module_impl::assertfailed( const char* mod, const char* expr, const cha
 #endif
     }
     else {
+        flush();
+        const Message_origin origin = make_origin( {});
         mi::base::Lock::Block block( &m_lock);
-        handle_message( mod, C_MAIN, S_ASSERT, {}, buf);
+        handle_message( mod, C_MAIN, S_ASSERT, {}, origin, buf);
     }
     if( m_assert_is_fatal)
         abort();
@@ -315,6 +398,15 @@ void Log_module_impl::message(
     if (!(m_sev_limit & sev) || !(m_sev_by_cat[cat] & sev))
         return;
 
+    if( m_async_enabled) {
+        // Fatal messages bypass the queue since the process terminates right afterwards.
+        if( sev == S_FATAL)
+            flush();
+        else if( async_message( mod, cat, sev, det, fmt, args))
+            return;
+    }
+
+    const Message_origin origin = make_origin( det);
     mi::base::Lock::Block block( &m_lock);
 
     if( !fmt)
@@ -329,7 +421,164 @@ void Log_module_impl::message(
         m_msg_buf[MAX_MSG_SIZE-2] = '.';
         m_msg_buf[MAX_MSG_SIZE-3] = '.';
     }
-    handle_message( mod, cat, sev, det, m_msg_buf);
+    handle_message( mod, cat, sev, det, origin, m_msg_buf);
+}
+
+Log_module_impl::Message_origin Log_module_impl::make_origin(
+    const mi::base::Message_details& det) const
+{
+    Message_origin origin;
+    if( m_prefix & P_TIME)
+        origin.m_wallclock_time = TIME::get_wallclock_time();
+    if( m_prefix & P_TIME_SECONDS)
+        origin.m_time = TIME::get_time();
+    if( m_prefix & P_HOST_THREAD) {
+        THREAD::Thread_attr thread_attr;
+        origin.m_thread_id = thread_attr.get_id();
+    }
+    if( m_prefix & P_CUDA_DEVICE) {
+        char* device = origin.m_cuda_device;
+        const size_t size = sizeof( origin.m_cuda_device);
+        switch (det.device_id) {
+            case mi::base::Message_details::DEVICE_ID_CPU: break; // don't specify
+            case mi::base::Message_details::DEVICE_ID_ALL_CUDA:
+                snprintf( device, size, "C*");
+                break;
+            case mi::base::Message_details::DEVICE_ID_UNKNOWN_CUDA:
+                snprintf( device, size, "C??");
+                break;
+            default:
+                snprintf( device, size, "C%d", det.device_id);
+                break;
+        }
+    }
+    return origin;
+}
+
+bool Log_module_impl::async_message(
+    const char* mod, Category cat, Severity sev, const mi::base::Message_details& det,
+    const char* fmt, va_list args)
+{
+    // Register as producer before re-checking the flag such that set_async_dispatch() does not
+    // stop the dispatch thread while this thread is about to push.
+    ++m_async_producers;
+    if( !m_async_enabled) {
+        --m_async_producers;
+        return false;
+    }
+
+    Async_message message;
+    message.m_mod = mod ? mod : "";
+    message.m_cat = cat;
+    message.m_sev = sev;
+    message.m_details = det;
+    message.m_origin = make_origin( det);
+
+    // Format into a small stack buffer first, and only retry with the exact size if needed.
+    if( !fmt)
+        fmt = "";
+    char buf[1024];
+    va_list args_copy;
+    va_copy( args_copy, args);
+    const int count = vsnprintf( buf, sizeof( buf), fmt, args_copy);
+    va_end( args_copy);
+    ASSERT( M_LOG, count >= 0);
+    if( count < static_cast<int>( sizeof( buf))) {
+        message.m_msg.assign( buf, count >= 0 ? count : 0);
+    } else {
+        const size_t size = std::min( static_cast<size_t>( count), MAX_MSG_SIZE - 1);
+        message.m_msg.resize( size + 1);
+        vsnprintf( &message.m_msg[0], size + 1, fmt, args);
+        message.m_msg.resize( size);
+        if( static_cast<size_t>( count) > size)
+            message.m_msg.replace( size - 3, 3, "...");
+    }
+
+    const bool on_dispatch_thread = std::this_thread::get_id() == m_async_thread_id.load();
+    while( !m_async_queue->try_push( std::move( message))) {
+        // The dispatch thread must not wait for itself, e.g., for messages from log targets.
+        if( m_async_policy != OVERFLOW_BLOCK || on_dispatch_thread) {
+            ++m_async_dropped;
+            --m_async_producers;
+            return true;
+        }
+        std::unique_lock<std::mutex> lock( m_async_mutex);
+        m_async_condition.notify_one();
+        m_async_flushed_condition.wait_for( lock, std::chrono::milliseconds( 1));
+    }
+    ++m_async_pushed;
+
+    if( m_async_idle) {
+        std::lock_guard<std::mutex> lock( m_async_mutex);
+        m_async_condition.notify_one();
+    }
+
+    --m_async_producers;
+    return true;
+}
+
+void Log_module_impl::async_dispatch_loop()
+{
+    while( true) {
+        if( async_dispatch_pending())
+            continue;
+
+        std::unique_lock<std::mutex> lock( m_async_mutex);
+        if( m_async_stop && m_async_queue->is_empty())
+            break;
+        m_async_idle = true;
+        // The timeout covers the race of a push just before the idle flag became visible.
+        m_async_condition.wait_for( lock, std::chrono::milliseconds( 10), [this]() {
+            return m_async_stop || !m_async_queue->is_empty(); });
+        m_async_idle = false;
+    }
+
+    // Report overflows of the final batch.
+    mi::base::Lock::Block block( &m_lock);
+    report_dropped_messages();
+}
+
+bool Log_module_impl::async_dispatch_pending()
+{
+    // Limit the batch size such that synchronous messages get a chance to acquire the lock.
+    const size_t max_batch_size = 256;
+
+    size_t count = 0;
+    {
+        Async_message message;
+        mi::base::Lock::Block block( &m_lock);
+        while( count < max_batch_size && m_async_queue->try_pop( message)) {
+            handle_message( message.m_mod.c_str(), message.m_cat, message.m_sev,
+                message.m_details, message.m_origin, message.m_msg.c_str());
+            ++count;
+        }
+        report_dropped_messages();
+    }
+
+    if( count == 0)
+        return false;
+
+    m_async_dispatched += count;
+    std::lock_guard<std::mutex> lock( m_async_mutex);
+    m_async_flushed_condition.notify_all();
+    return true;
+}
+
+void Log_module_impl::report_dropped_messages()
+{
+    if( m_async_policy != OVERFLOW_COUNT)
+        return;
+
+    const size_t dropped = m_async_dropped;
+    if( dropped == m_async_dropped_reported)
+        return;
+
+    char buf[128];
+    snprintf( buf, sizeof( buf),
+        "Log message queue overflow, discarded %zu message(s).",
+        dropped - m_async_dropped_reported);
+    m_async_dropped_reported = dropped;
+    handle_message( "LOG", C_MISC, S_WARNING, {}, make_origin( {}), buf);
 }
 
 /// Finds the end of the line within [text,text_end) and returns it.
@@ -369,23 +618,24 @@ static const char* find_line_end(
 
 void Log_module_impl::handle_message(
         const char* mod, Category cat, Severity sev, const mi::base::Message_details& det,
-        const char* text)
+        const Message_origin& origin, const char* text)
 {
     ASSERT( M_LOG, text);
 
     if( m_delay_messages) {
-        m_delayed_messages.emplace_back( mod, cat, sev, det, text);
+        m_delayed_messages.emplace_back( mod, cat, sev, det, origin, text);
         return;
     }
 
     if( !m_delayed_messages.empty())
         emit_delayed_log_messages_internal();
 
-    text_message( mod, cat, sev, det, text);
+    text_message( mod, cat, sev, det, origin, text);
 }
 
 void Log_module_impl::text_message(
-    const char* mod, Category cat, Severity sev, const mi::base::Message_details& det, const char* text)
+    const char* mod, Category cat, Severity sev, const mi::base::Message_details& det,
+    const Message_origin& origin, const char* text)
 {
     const size_t len = strlen( text);
     const char* text_end = &text[len];
@@ -398,13 +648,13 @@ void Log_module_impl::text_message(
         const size_t line_len = line_end - line_begin;
         if( line_len <= MAX_LINE_SIZE) {
             // line is short enough, send one line
-            line_message( mod, cat, sev, det, line_begin, line_end);
+            line_message( mod, cat, sev, det, origin, line_begin, line_end);
         } else {
             // split line that is too long
             const char* sub_end = line_begin + MAX_LINE_SIZE;
             while( true) {
                 // send one line of message
-                line_message( mod, cat, sev, det, line_begin, sub_end);
+                line_message( mod, cat, sev, det, origin, line_begin, sub_end);
                 line_begin = sub_end;
                 if( line_begin >= line_end) break;
                 sub_end += MAX_LINE_SIZE;
@@ -438,7 +688,7 @@ static void my_snprintf( char* buffer, int& position, size_t max_size, const cha
 
 void Log_module_impl::line_message(
     const char* mod, Category cat, Severity sev, const mi::base::Message_details& det,
-    const char* line_begin, const char* line_end)
+    const Message_origin& origin, const char* line_begin, const char* line_end)
 {
     char* pfx = m_pfx_buf;
     pfx[0] = '\0';
@@ -449,36 +699,16 @@ void Log_module_impl::line_message(
 
     int position = 0;
 
-    if( m_prefix & P_TIME) {
-        const TIME::Time now = TIME::get_wallclock_time();
-        my_snprintf( pfx, position, MAX_PREFIX_SIZE, "%-s ", now.to_string().c_str());
-    }
+    if( m_prefix & P_TIME)
+        my_snprintf(
+            pfx, position, MAX_PREFIX_SIZE, "%-s ", origin.m_wallclock_time.to_string().c_str());
 
-    if( m_prefix & P_TIME_SECONDS) {
-        const TIME::Time now = TIME::get_time();
-        my_snprintf( pfx, position, MAX_PREFIX_SIZE, "%3.3f ", now.get_seconds());
-    }
-    if( m_prefix & P_HOST_THREAD) {
-        THREAD::Thread_attr thread_attr;
-        my_snprintf( pfx, position, MAX_PREFIX_SIZE,"%3d.%-3u ", m_host_id, thread_attr.get_id());
-    }
-    if( m_prefix & P_CUDA_DEVICE) {
-        THREAD::Thread_attr thread_attr;
-        std::string device;
-        switch (det.device_id) {
-            case mi::base::Message_details::DEVICE_ID_CPU: break; // don't specify
-            case mi::base::Message_details::DEVICE_ID_ALL_CUDA:
-                device = "C*";
-                break;
-            case mi::base::Message_details::DEVICE_ID_UNKNOWN_CUDA:
-                device = "C??";
-                break;
-            default:
-                device = "C" + std::to_string(det.device_id);
-                break;
-        }
-        my_snprintf( pfx, position, MAX_PREFIX_SIZE, "%-3s ", device.c_str());
-    }
+    if( m_prefix & P_TIME_SECONDS)
+        my_snprintf( pfx, position, MAX_PREFIX_SIZE, "%3.3f ", origin.m_time.get_seconds());
+    if( m_prefix & P_HOST_THREAD)
+        my_snprintf( pfx, position, MAX_PREFIX_SIZE,"%3d.%-3u ", m_host_id, origin.m_thread_id);
+    if( m_prefix & P_CUDA_DEVICE)
+        my_snprintf( pfx, position, MAX_PREFIX_SIZE, "%-3s ", origin.m_cuda_device);
     if( m_prefix & P_TAGS) {
         constexpr char flags[] = "CUIAVRMFS!";
         constexpr unsigned FLAG_COUNT = sizeof(flags)-1;
@@ -552,7 +782,7 @@ void Log_module_impl::emit_delayed_log_messages_internal()
     for( mi::Size i = 0; i < m_delayed_messages.size(); ++i) {
         const Message& m = m_delayed_messages[i];
         text_message(
-            m.m_mod.c_str(), m.m_cat, m.m_sev, m.m_details, m.m_msg.c_str());
+            m.m_mod.c_str(), m.m_cat, m.m_sev, m.m_details, m.m_origin, m.m_msg.c_str());
     }
 
     m_delayed_messages.clear();
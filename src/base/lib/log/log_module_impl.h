@@ -36,9 +36,18 @@
 #define BASE_LIB_LOG_LOG_MODULE_IMPL_H
 
 #include "i_log_module.h"
+#include "log_mpsc_queue.h"
 
 #include <mi/base/lock.h>
 
+#include <base/hal/time/i_time.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 namespace MI {
@@ -61,7 +70,7 @@ public:
 
     bool init() { return true; }
 
-    void exit() { }
+    void exit() { set_async_dispatch( false); }
 
     // methods of Log_module
 
@@ -89,6 +98,15 @@ public:
 
     void emit_delayed_log_messages();
 
+    void set_async_dispatch(
+        bool enabled, size_t queue_size = 4096, Overflow_policy policy = OVERFLOW_BLOCK);
+
+    bool get_async_dispatch() const { return m_async_enabled; }
+
+    void flush();
+
+    size_t get_dropped_message_count() const { return m_async_dropped; }
+
     void set_host_id( unsigned int host_id) { m_host_id = host_id; }
 
     void set_host_name( const char* host_name);
@@ -139,6 +157,50 @@ public:
         const char* mod, const char* fmt, const char* file, int line);
 
 private:
+    /// The parts of the message prefix that depend on the emitting thread and the time of
+    /// emission. Captured by the emitting thread such that asynchronous dispatch produces the same
+    /// prefix.
+    struct Message_origin
+    {
+        TIME::Time m_wallclock_time; ///< Used for #P_TIME.
+        TIME::Time m_time;           ///< Used for #P_TIME_SECONDS.
+        int m_thread_id = 0;         ///< Used for #P_HOST_THREAD.
+        char m_cuda_device[16] = {}; ///< Used for #P_CUDA_DEVICE.
+    };
+
+    /// Represents a message in the queue of the asynchronous dispatch.
+    struct Async_message
+    {
+        std::string m_mod;
+        Category m_cat = C_MAIN;
+        Severity m_sev = S_INFO;
+        mi::base::Message_details m_details;
+        std::string m_msg;
+        Message_origin m_origin;
+    };
+
+    /// Captures the origin of a message with details \p det emitted by the calling thread.
+    Message_origin make_origin( const mi::base::Message_details& det) const;
+
+    /// Formats the message and appends it to #m_async_queue. Used by #message() if asynchronous
+    /// dispatch is enabled.
+    ///
+    /// \return   \c false if the message was not queued because asynchronous dispatch got
+    ///           disabled concurrently, \c true otherwise (including dropped messages).
+    bool async_message(
+        const char* mod, Category cat, Severity sev, const mi::base::Message_details&,
+        const char* fmt, va_list args);
+
+    /// Main function of the thread draining #m_async_queue.
+    void async_dispatch_loop();
+
+    /// Passes all messages from #m_async_queue to #handle_message(). Returns \c true if at least
+    /// one message was dispatched. Called by the dispatch thread only.
+    bool async_dispatch_pending();
+
+    /// Emits a warning about messages discarded due to #OVERFLOW_COUNT. Needs #m_lock.
+    void report_dropped_messages();
+
     /// Inserts the arguments \p args into the format string \p fmt and calls #text_message().
     ///
     /// Used by #fatal() ... #vdebug().
@@ -149,17 +211,17 @@ private:
     /// Delays, emits delayed, or passes on log message(s).
     void handle_message(
             const char* mod, Category cat, Severity sev, const mi::base::Message_details&,
-            const char* text);
+            const Message_origin& origin, const char* text);
 
     /// Splits \p text into lines and calls #line_message().
     void text_message(
             const char* mod, Category cat, Severity sev, const mi::base::Message_details&,
-            const char* text);
+            const Message_origin& origin, const char* text);
 
     /// Generates the message prefix and calls #insert_message_internal().
     void line_message(
         const char* mod, Category cat, Severity sev, const mi::base::Message_details&,
-        const char* line_begin, const char* line_end);
+        const Message_origin& origin, const char* line_begin, const char* line_end);
 
     /// Invokes the registered log targets and/or calls #std_message() for the message.
     void insert_message_internal(
@@ -192,14 +254,16 @@ private:
         Message(
                 const std::string& mod,
                 Category cat, Severity sev, const mi::base::Message_details& det,
-                const std::string& msg)
-          : m_mod( mod), m_cat( cat), m_sev( sev), m_details( det), m_msg( msg) { }
+                const Message_origin& origin, const std::string& msg)
+          : m_mod( mod), m_cat( cat), m_sev( sev), m_details( det), m_origin( origin),
+            m_msg( msg) { }
 
         /// Fields
         std::string m_mod;
         Category m_cat;
         Severity m_sev;
         mi::base::Message_details m_details;
+        Message_origin m_origin;
         std::string m_msg;
     };
 
@@ -225,6 +289,44 @@ private:
     /// Lock used for the various buffers and for #m_targets.
     mi::base::Lock m_lock;
 
+    /// \name Asynchronous dispatch
+    //@{
+
+    /// Serializes #set_async_dispatch() calls.
+    std::mutex m_async_config_mutex;
+    /// Is asynchronous dispatch enabled? Checked by emitting threads without any lock.
+    std::atomic<bool> m_async_enabled;
+    /// Number of emitting threads currently inside #async_message().
+    std::atomic<size_t> m_async_producers;
+    /// The queue of formatted messages.
+    std::unique_ptr<Mpsc_queue<Async_message>> m_async_queue;
+    /// The overflow policy.
+    Overflow_policy m_async_policy;
+    /// The thread draining #m_async_queue.
+    std::thread m_async_thread;
+    /// ID of #m_async_thread, readable without synchronization.
+    std::atomic<std::thread::id> m_async_thread_id;
+    /// Requests the dispatch thread to terminate once the queue is empty.
+    std::atomic<bool> m_async_stop;
+    /// Number of messages appended to the queue.
+    std::atomic<size_t> m_async_pushed;
+    /// Number of messages passed to the log targets by the dispatch thread.
+    std::atomic<size_t> m_async_dispatched;
+    /// Number of messages discarded due to overflows.
+    std::atomic<size_t> m_async_dropped;
+    /// Number of discarded messages already mentioned in a summary warning.
+    size_t m_async_dropped_reported;
+    /// Is the dispatch thread sleeping on #m_async_condition?
+    std::atomic<bool> m_async_idle;
+    /// Mutex for #m_async_condition and #m_async_flushed_condition.
+    std::mutex m_async_mutex;
+    /// Wakes up the dispatch thread.
+    std::condition_variable m_async_condition;
+    /// Wakes up threads in #flush() or blocked on a full queue.
+    std::condition_variable m_async_flushed_condition;
+
+    //@}
+
     /// Maps categories to strings.
     static const char* const category_name[/*NUM_OF_CATEGORIES*/];
 };
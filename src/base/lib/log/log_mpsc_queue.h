@@ -0,0 +1,152 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/// \file
+/// \brief Bounded lock-free queue used for asynchronous log dispatch.
+
+#ifndef BASE_LIB_LOG_LOG_MPSC_QUEUE_H
+#define BASE_LIB_LOG_LOG_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace MI {
+
+namespace LOG {
+
+/// Bounded multi-producer single-consumer queue.
+///
+/// Every cell carries a sequence number that tells producers and the consumer whether the cell
+/// is free or filled for a given position. Producers claim a position with a CAS on the enqueue
+/// position, the single consumer owns the dequeue position. Neither side takes a lock.
+template <typename T>
+class Mpsc_queue
+{
+public:
+    /// Constructor.
+    ///
+    /// \param capacity   The number of elements the queue can hold, rounded up to a power of two.
+    explicit Mpsc_queue( size_t capacity)
+    {
+        size_t size = 2;
+        while( size < capacity)
+            size *= 2;
+
+        m_cells.reset( new Cell[size]);
+        for( size_t i = 0; i < size; ++i)
+            m_cells[i].m_sequence.store( i, std::memory_order_relaxed);
+        m_mask = size - 1;
+        m_enqueue_pos.store( 0, std::memory_order_relaxed);
+        m_dequeue_pos = 0;
+    }
+
+    Mpsc_queue( const Mpsc_queue&) = delete;
+    Mpsc_queue& operator=( const Mpsc_queue&) = delete;
+
+    /// Returns the number of elements the queue can hold.
+    size_t get_capacity() const { return m_mask + 1; }
+
+    /// Appends an element. Can be called from any thread.
+    ///
+    /// \return   \c false if the queue is full, \c true otherwise.
+    bool try_push( T&& value)
+    {
+        Cell* cell;
+        size_t pos = m_enqueue_pos.load( std::memory_order_relaxed);
+        for( ;;) {
+            cell = &m_cells[pos & m_mask];
+            const size_t sequence = cell->m_sequence.load( std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>( sequence) - static_cast<intptr_t>( pos);
+            if( diff == 0) {
+                if( m_enqueue_pos.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            } else if( diff < 0) {
+                return false;
+            } else {
+                pos = m_enqueue_pos.load( std::memory_order_relaxed);
+            }
+        }
+
+        cell->m_value = std::move( value);
+        cell->m_sequence.store( pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Removes the oldest element. Must only be called from the consumer thread.
+    ///
+    /// \return   \c false if the queue is empty, \c true otherwise.
+    bool try_pop( T& value)
+    {
+        Cell& cell = m_cells[m_dequeue_pos & m_mask];
+        const size_t sequence = cell.m_sequence.load( std::memory_order_acquire);
+        if( sequence != m_dequeue_pos + 1)
+            return false;
+
+        value = std::move( cell.m_value);
+        cell.m_sequence.store( m_dequeue_pos + m_mask + 1, std::memory_order_release);
+        ++m_dequeue_pos;
+        return true;
+    }
+
+    /// Indicates whether the next element is not yet available. Must only be called from the
+    /// consumer thread.
+    bool is_empty() const
+    {
+        const Cell& cell = m_cells[m_dequeue_pos & m_mask];
+        return cell.m_sequence.load( std::memory_order_acquire) != m_dequeue_pos + 1;
+    }
+
+private:
+    struct Cell
+    {
+        std::atomic<size_t> m_sequence;
+        T m_value;
+    };
+
+    /// The cells.
+    std::unique_ptr<Cell[]> m_cells;
+
+    /// Mask to map positions to cells.
+    size_t m_mask;
+
+    /// Next position to write, shared by all producers.
+    alignas(64) std::atomic<size_t> m_enqueue_pos;
+
+    /// Next position to read, owned by the consumer.
+    alignas(64) size_t m_dequeue_pos;
+};
+
+} // namespace LOG
+
+} // namespace MI
+
+#endif // BASE_LIB_LOG_LOG_MPSC_QUEUE_H
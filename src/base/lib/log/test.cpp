@@ -0,0 +1,298 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/// \file
+/// \brief Regression test for the LOG module
+
+#include "pch.h"
+
+#define MI_TEST_AUTO_SUITE_NAME "Regression Test Suite for base/lib/log"
+#define MI_TEST_IMPLEMENT_TEST_MAIN_INSTEAD_OF_MAIN
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <base/system/test/i_test_auto_driver.h>
+#include <base/system/test/i_test_auto_case.h>
+
+#include <base/system/main/access_module.h>
+#include <base/hal/time/i_time.h>
+
+#include "i_log_logger.h"
+#include "i_log_module.h"
+#include "i_log_target.h"
+
+using namespace MI;
+
+/// A log target that records all messages.
+///
+/// Optionally blocks in #message() until released, to simulate a slow target.
+class Recording_target : public LOG::ILog_target
+{
+public:
+    bool message(
+        const char* mod,
+        LOG::ILogger::Category cat,
+        LOG::ILogger::Severity sev,
+        const mi::base::Message_details&,
+        const char* pfx,
+        const char* msg)
+    {
+        m_entered = true;
+        while( m_blocked)
+            std::this_thread::yield();
+
+        std::lock_guard<std::mutex> lock( m_mutex);
+        if( m_record) {
+            m_messages.emplace_back( msg);
+            m_prefixes.emplace_back( pfx);
+        }
+        ++m_count;
+        return true;
+    }
+
+    std::vector<std::string> get_messages()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex);
+        return m_messages;
+    }
+
+    std::vector<std::string> get_prefixes()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex);
+        return m_prefixes;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock( m_mutex);
+        m_messages.clear();
+        m_prefixes.clear();
+        m_count = 0;
+        m_entered = false;
+    }
+
+    std::atomic<bool> m_blocked{ false };
+    std::atomic<bool> m_entered{ false };
+    bool m_record = true;
+    size_t m_count = 0;
+
+private:
+    std::mutex m_mutex;
+    std::vector<std::string> m_messages;
+    std::vector<std::string> m_prefixes;
+};
+
+/// Emits messages from several threads and checks that all of them arrive in per-thread order.
+void test_async_order(
+    SYSTEM::Access_module<LOG::Log_module>& log_module, Recording_target* target)
+{
+    const int thread_count = 4;
+    const int message_count = 1000;
+
+    target->clear();
+    log_module->set_async_dispatch( true, 64, LOG::Log_module::OVERFLOW_BLOCK);
+    MI_CHECK( log_module->get_async_dispatch());
+
+    std::vector<std::thread> threads;
+    for( int t = 0; t < thread_count; ++t)
+        threads.emplace_back( [t]() {
+            for( int i = 0; i < message_count; ++i)
+                LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC, "%d %d", t, i);
+        });
+    for( auto& thread: threads)
+        thread.join();
+
+    log_module->flush();
+    const std::vector<std::string> messages = target->get_messages();
+    MI_CHECK_EQUAL( messages.size(), size_t( thread_count * message_count));
+
+    std::vector<int> next( thread_count, 0);
+    for( const std::string& message: messages) {
+        int t = -1;
+        int i = -1;
+        MI_CHECK_EQUAL( sscanf( message.c_str(), "%d %d", &t, &i), 2);
+        MI_CHECK( t >= 0 && t < thread_count);
+        MI_CHECK_EQUAL( i, next[t]);
+        next[t] = i + 1;
+    }
+
+    // Messages longer than the formatting buffer on the stack.
+    target->clear();
+    const std::string long_message( 5000, 'x');
+    LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC, "%s", long_message.c_str());
+    log_module->flush();
+    MI_CHECK_EQUAL( target->get_messages().size(), size_t( 1));
+    MI_CHECK( target->get_messages()[0] == long_message);
+
+    log_module->set_async_dispatch( false);
+    MI_CHECK( !log_module->get_async_dispatch());
+}
+
+/// Overflows the queue while the target blocks the dispatch thread.
+void test_async_overflow(
+    SYSTEM::Access_module<LOG::Log_module>& log_module,
+    Recording_target* target,
+    LOG::Log_module::Overflow_policy policy)
+{
+    target->clear();
+    const size_t dropped_before = log_module->get_dropped_message_count();
+    log_module->set_async_dispatch( true, 8, policy);
+
+    // Block the dispatch thread in the target such that the queue is empty afterwards.
+    target->m_blocked = true;
+    LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC, "first");
+    while( !target->m_entered)
+        std::this_thread::yield();
+
+    for( int i = 0; i < 100; ++i)
+        LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC, "%d", i);
+    MI_CHECK_EQUAL( log_module->get_dropped_message_count() - dropped_before, size_t( 92));
+
+    target->m_blocked = false;
+    log_module->flush();
+    log_module->set_async_dispatch( false);
+
+    // The first message and a full queue, plus the summary warning for OVERFLOW_COUNT.
+    const std::vector<std::string> messages = target->get_messages();
+    MI_CHECK_EQUAL( messages.size(), size_t( policy == LOG::Log_module::OVERFLOW_COUNT ? 10 : 9));
+    MI_CHECK( messages[0] == "first");
+    MI_CHECK( messages[1] == "0");
+    MI_CHECK( messages[8] == "7");
+    if( policy == LOG::Log_module::OVERFLOW_COUNT)
+        MI_CHECK( strstr( messages[9].c_str(), "discarded 92 message") != nullptr);
+}
+
+/// Checks that the CUDA device prefix of asynchronously dispatched messages matches the one of
+/// synchronously dispatched messages.
+void test_async_device_prefix(
+    SYSTEM::Access_module<LOG::Log_module>& log_module, Recording_target* target)
+{
+    const unsigned int old_prefix = log_module->get_prefix();
+    log_module->set_prefix( LOG::ILogger::P_CUDA_DEVICE);
+
+    const mi::Sint32 devices[] = {
+        mi::base::Message_details::DEVICE_ID_CPU,
+        mi::base::Message_details::DEVICE_ID_ALL_CUDA,
+        mi::base::Message_details::DEVICE_ID_UNKNOWN_CUDA,
+        3 };
+
+    std::vector<std::string> prefixes[2];
+    for( int async = 0; async <= 1; ++async) {
+        target->clear();
+        if( async)
+            log_module->set_async_dispatch( true, 64, LOG::Log_module::OVERFLOW_BLOCK);
+        for( mi::Sint32 device: devices)
+            LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC,
+                mi::base::Message_details().device( device), "device %d", device);
+        log_module->set_async_dispatch( false);
+        prefixes[async] = target->get_prefixes();
+    }
+
+    log_module->set_prefix( old_prefix);
+
+    MI_CHECK_EQUAL( prefixes[0].size(), size_t( 4));
+    MI_CHECK( prefixes[0] == prefixes[1]);
+    MI_CHECK_EQUAL( prefixes[0][0].substr( 0, 4), std::string( "    "));
+    MI_CHECK_EQUAL( prefixes[0][1].substr( 0, 4), std::string( "C*  "));
+    MI_CHECK_EQUAL( prefixes[0][2].substr( 0, 4), std::string( "C?? "));
+    MI_CHECK_EQUAL( prefixes[0][3].substr( 0, 4), std::string( "C3  "));
+}
+
+/// Measures the time spent by emitting threads per message for synchronous and asynchronous
+/// dispatch.
+///
+/// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_dispatch(
+    SYSTEM::Access_module<LOG::Log_module>& log_module, Recording_target* target)
+{
+    const int message_count = 20000;
+    const int thread_counts[] = { 1, 2, 4, 8 };
+
+    target->m_record = false;
+    std::vector<std::string> results;
+
+    for( int async = 0; async <= 1; ++async) {
+        for( int thread_count: thread_counts) {
+            if( async)
+                log_module->set_async_dispatch( true, 65536, LOG::Log_module::OVERFLOW_BLOCK);
+
+            const TIME::Time start = TIME::get_time();
+            std::vector<std::thread> threads;
+            for( int t = 0; t < thread_count; ++t)
+                threads.emplace_back( [t]() {
+                    for( int i = 0; i < message_count; ++i)
+                        LOG::mod_log->info(
+                            M_MAIN, LOG::Mod_log::C_MISC, "Benchmark message %d from %d", i, t);
+                });
+            for( auto& thread: threads)
+                thread.join();
+            const TIME::Time end = TIME::get_time();
+
+            log_module->set_async_dispatch( false);
+
+            const double ns_per_message = (end - start).get_seconds() * 1e9
+                / (static_cast<double>( message_count) * thread_count);
+            char buf[256];
+            snprintf( buf, sizeof( buf), "Benchmark %-5s dispatch, %d thread(s): %.0f ns/message",
+                async ? "async" : "sync", thread_count, ns_per_message);
+            results.push_back( buf);
+        }
+    }
+
+    target->m_record = true;
+    log_module->remove_log_target( target);
+    for( const std::string& result: results)
+        LOG::mod_log->info( M_MAIN, LOG::Mod_log::C_MISC, "%s", result.c_str());
+    log_module->add_log_target( target);
+}
+
+MI_TEST_AUTO_FUNCTION( test_log_module )
+{
+    SYSTEM::Access_module<LOG::Log_module> log_module( false);
+
+    Recording_target target;
+    log_module->add_log_target( &target);
+
+    test_async_order( log_module, &target);
+    test_async_overflow( log_module, &target, LOG::Log_module::OVERFLOW_DROP);
+    test_async_overflow( log_module, &target, LOG::Log_module::OVERFLOW_COUNT);
+    test_async_device_prefix( log_module, &target);
+    if( getenv( "MI_TEST_RUN_BENCHMARKS"))
+        benchmark_dispatch( log_module, &target);
+
+    log_module->remove_log_target( &target);
+}
+
+MI_TEST_MAIN_CALLING_TEST_MAIN();
@@ -98,6 +98,7 @@ class IWriter;
 
 namespace MI {
 
+namespace DB { class Database; }
 namespace SYSTEM { class Module_registration_entry; }
 namespace SERIAL { class Serializer; class Deserializer; }
 
@@ -106,6 +107,15 @@ namespace IMAGE {
 class IMdl_container_callback;
 class IMipmap;
 
+/// The filters supported for the computation of miplevels.
+///
+/// \see Image_module::set_mipmap_filter()
+enum Mipmap_filter {
+    MIPMAP_FILTER_BOX,     ///< 2x2 box filter (default).
+    MIPMAP_FILTER_LANCZOS, ///< Lanczos-3 windowed sinc filter.
+    MIPMAP_FILTER_KAISER   ///< Kaiser windowed sinc filter (alpha = 4, radius 3).
+};
+
 /// Public interface of the IMAGE module.
 class Image_module : public SYSTEM::IModule
 {
@@ -702,8 +712,26 @@ public:
     /// ... or \c NULL if no callback is set.
     virtual IMdl_container_callback* get_mdl_container_callback() const = 0;
 
+    /// Sets the database whose thread pool is used to compute miplevels in parallel.
+    ///
+    /// Pass \c NULL to clear the database (miplevels are then computed by the calling thread).
+    /// Not thread-safe.
+    virtual void set_database( DB::Database* database) = 0;
+
+    /// Sets the filter used by #create_miplevel().
+    ///
+    /// The default is taken from the registry key \c "mipmap_filter" (\c "box", \c "lanczos", or
+    /// \c "kaiser"), or #MIPMAP_FILTER_BOX if not set. Not thread-safe.
+    virtual void set_mipmap_filter( Mipmap_filter filter) = 0;
+
+    /// Returns the filter used by #create_miplevel().
+    virtual Mipmap_filter get_mipmap_filter() const = 0;
+
     /// Creates the next miplevel from the given canvas.
     ///
+    /// The pixels are computed in parallel on the thread pool of the database set via
+    /// #set_database() (if any), using the filter set via #set_mipmap_filter().
+    ///
     /// \param prev_canvas      The canvas to create a miplevel from.
     /// \param gamma_override   Canvas gamma override. If it is different from zero
     ///                         it is used instead of the canvas gamma.
@@ -85,6 +85,16 @@ public:
     ///
     /// Used to implement DB::Element_base::get_size() for DBIMAGE::Image.
     virtual mi::Size get_size() const = 0;
+
+    /// Releases memory that can be restored when needed again.
+    ///
+    /// Destroys computed miplevels (they are recomputed on demand) and releases the tiles of
+    /// unmodified file-based miplevels (they are reloaded on demand).
+    ///
+    /// Used to implement DB::Element_base::evict_reloadable_data() for DBIMAGE::Image_impl.
+    ///
+    /// \return   \c true if some memory was released, \c false otherwise.
+    virtual bool evict_reloadable_data() const = 0;
 };
 
 } // namespace IMAGE
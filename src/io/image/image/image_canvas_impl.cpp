@@ -716,6 +716,7 @@ mi::neuraylib::ITile* Canvas_impl::get_tile( mi::Uint32 layer)
         return nullptr;
 
     mi::base::Lock::Block block( &m_lock);
+    m_tiles_modified = true;
 
     if( m_tiles[layer] == nullptr) {
 
@@ -738,6 +739,8 @@ mi::Size Canvas_impl::get_size() const
 {
     mi::Size size = sizeof( *this);
 
+    mi::base::Lock::Block block( &m_lock);
+
     size += m_nr_of_layers * sizeof( mi::base::Handle<mi::neuraylib::ITile>); // m_tiles
 
     for( mi::Uint32 i = 0; i < m_nr_of_layers; ++i)          // m_tiles[i]
@@ -760,10 +763,17 @@ bool Canvas_impl::release_tiles() const
         return false;
 
     mi::base::Lock::Block block( &m_lock);
+    if( m_tiles_modified)
+        return false;
+
+    bool result = false;
     for( mi::Uint32 z = 0; z < m_nr_of_layers; ++z)
-        m_tiles[z] = nullptr;
+        if( m_tiles[z]) {
+            m_tiles[z] = nullptr;
+            result = true;
+        }
 
-    return true;
+    return result;
 }
 
 bool Canvas_impl::supports_lazy_loading() const
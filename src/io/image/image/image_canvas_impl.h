@@ -66,8 +66,9 @@ public:
 
     /// Releases the allocated tile memory.
     ///
-    /// \return   \c true on success, \c false, if the canvas does not support lazy loading and
-    ///           therefore cannot simply free its data.
+    /// \return   \c true if tile memory was released, \c false otherwise, e.g., if the canvas does
+    ///           not support lazy loading (or mutable tiles have been requested) and therefore
+    ///           cannot simply free its data.
     virtual bool release_tiles() const = 0;
 };
 
@@ -378,6 +379,12 @@ private:
     /// \note Any access needs to be protected by m_lock.
     mutable std::vector<mi::base::Handle<mi::neuraylib::ITile>> m_tiles;
 
+    /// Indicates whether mutable tiles have been handed out. Such tiles might have been modified
+    /// and can no longer be released and reloaded from the file.
+    ///
+    /// \note Any access needs to be protected by m_lock.
+    bool m_tiles_modified = false;
+
     /// The lock that protects m_tiles;
     mutable mi::base::Lock m_lock;
 
@@ -470,6 +470,30 @@ mi::Size Mipmap_impl::get_size() const
     return size;
 }
 
+bool Mipmap_impl::evict_reloadable_data() const
+{
+    mi::base::Lock::Block block( &m_lock);
+
+    bool result = false;
+
+    // destroy computed miplevels (the base level is never computed)
+    const mi::Uint32 first_computed_level = std::max( 1u, m_nr_of_provided_levels);
+    for( mi::Uint32 i = first_computed_level; i <= m_last_created_level; ++i) {
+        m_levels[i] = nullptr;
+        result = true;
+    }
+    m_last_created_level = std::min( m_last_created_level, first_computed_level-1);
+
+    // release tiles of provided miplevels that support lazy loading
+    for( mi::Uint32 i = 0; i <= m_last_created_level; ++i) {
+        mi::base::Handle<const ICanvas> canvas_internal( m_levels[i]->get_interface<ICanvas>());
+        if( canvas_internal && canvas_internal->release_tiles())
+            result = true;
+    }
+
+    return result;
+}
+
 } // namespace IMAGE
 
 } // namespace MI
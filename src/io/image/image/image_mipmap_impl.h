@@ -195,6 +195,8 @@ public:
 
     mi::Size get_size() const;
 
+    bool evict_reloadable_data() const;
+
 private:
 
     /// The number of miplevels of this mipmap.
@@ -35,9 +35,13 @@
 #include <mi/neuraylib/iplugin_api.h>
 #include <mi/math/color.h>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <functional>
 #include <iomanip>
 #include <limits>
+#include <memory>
 #include <sstream>
 #include <queue>
 
@@ -50,7 +54,11 @@
 #include <base/hal/disk/disk_file_reader_writer_impl.h>
 #include <base/hal/disk/disk_memory_reader_writer_impl.h>
 #include <base/hal/hal/i_hal_ospath.h>
+#include <base/data/db/i_db_database.h>
+#include <base/data/db/i_db_fragmented_job.h>
 #include <base/data/serial/i_serializer.h>
+#include <base/lib/config/config.h>
+#include <base/util/registry/i_config_registry.h>
 
 #include "i_image_pixel_conversion.h"
 #include "i_image_utilities.h"
@@ -119,6 +127,21 @@ bool Image_module_impl::init()
         descriptor = m_plug_module->get_plugin( ++index);
     }
 
+    SYSTEM::Access_module<CONFIG::Config_module> config_module( /*deferred*/ false);
+    const CONFIG::Config_registry& registry = config_module->get_configuration();
+    std::string filter;
+    if( registry.get_value( "mipmap_filter", filter)) {
+        if( filter == "box")
+            m_mipmap_filter = MIPMAP_FILTER_BOX;
+        else if( filter == "lanczos")
+            m_mipmap_filter = MIPMAP_FILTER_LANCZOS;
+        else if( filter == "kaiser")
+            m_mipmap_filter = MIPMAP_FILTER_KAISER;
+        else
+            LOG::mod_log->warning( M_IMAGE, LOG::Mod_log::C_IO,
+                "Invalid value \"%s\" for \"mipmap_filter\", using \"box\".", filter.c_str());
+    }
+
     return true;
 }
 
@@ -1552,14 +1575,338 @@ void apply_gamma(mi::math::Color& c, mi::Float32 gamma)
 #endif
 }
 
+/// Gamma decoding and encoding of 8-bit channels via lookup tables.
+class Gamma_lut_8
+{
+public:
+    /// Constructor.
+    ///
+    /// \param gamma   The gamma value used for decoding (its inverse is used for encoding).
+    /// \param scale   Maps [0,1] to the encoded values before truncation: 256 for channels
+    ///                quantized via quantize_unsigned(), 255 for PT_SINT8.
+    Gamma_lut_8( mi::Float32 gamma, mi::Float32 scale)
+    {
+        for( mi::Uint32 i = 0; i < 256; ++i) {
+            const mi::Float32 value = mi::Float32( i) * mi::Float32( 1.0/255.0);
+            m_decode[i] = gamma == 1.0f ? value : std::pow( value, gamma);
+        }
+        // The encoded value is the number of thresholds not larger than the linear value.
+        for( mi::Uint32 k = 1; k < 256; ++k) {
+            const mi::Float32 value = mi::Float32( k) / scale;
+            m_thresholds[k-1] = gamma == 1.0f ? value : std::pow( value, gamma);
+        }
+    }
+
+    mi::Float32 decode( mi::Uint8 value) const { return m_decode[value]; }
+
+    mi::Uint8 encode( mi::Float32 value) const
+    {
+        return mi::Uint8( std::upper_bound( m_thresholds, m_thresholds + 255, value)
+            - m_thresholds);
+    }
+
+private:
+    mi::Float32 m_decode[256];
+    mi::Float32 m_thresholds[255];
+};
+
+/// Computes the rows [y_begin,y_end) of a miplevel from 8-bit data with C channels using a 2x2
+/// box filter.
+template <mi::Uint32 C>
+void downsample_box_uint8(
+    const mi::Uint8* src,
+    mi::Uint8* dest,
+    mi::Uint32 prev_width,
+    mi::Uint32 prev_height,
+    mi::Uint32 width,
+    mi::Uint32 y_begin,
+    mi::Uint32 y_end,
+    const Gamma_lut_8& lut)
+{
+    for( mi::Uint32 y = y_begin; y < y_end; ++y) {
+
+        const mi::Uint8* row0 = src + static_cast<mi::Size>( 2*y) * prev_width * C;
+        const bool has_row1 = 2*y+1 < prev_height;
+        const mi::Uint8* row1 = has_row1 ? row0 + static_cast<mi::Size>( prev_width) * C : row0;
+        mi::Uint8* d = dest + static_cast<mi::Size>( y) * width * C;
+
+        for( mi::Uint32 x = 0; x < width; ++x) {
+            const mi::Uint32 px0 = 2*x;
+            const bool has_col1 = px0+1 < prev_width;
+            const mi::Uint32 px1 = has_col1 ? px0+1 : px0;
+            const mi::Float32 inv_n = 1.0f / mi::Float32( (has_row1 ? 2 : 1) * (has_col1 ? 2 : 1));
+
+            for( mi::Uint32 c = 0; c < C; ++c) {
+                mi::Float32 sum = lut.decode( row0[px0*C+c]);
+                if( has_col1)
+                    sum += lut.decode( row0[px1*C+c]);
+                if( has_row1) {
+                    sum += lut.decode( row1[px0*C+c]);
+                    if( has_col1)
+                        sum += lut.decode( row1[px1*C+c]);
+                }
+                d[x*C+c] = lut.encode( sum * inv_n);
+            }
+        }
+    }
+}
+
+/// Computes the rows [y_begin,y_end) of a miplevel from float data with C channels using a 2x2
+/// box filter.
+template <mi::Uint32 C>
+void downsample_box_float(
+    const mi::Float32* src,
+    mi::Float32* dest,
+    mi::Uint32 prev_width,
+    mi::Uint32 prev_height,
+    mi::Uint32 width,
+    mi::Uint32 y_begin,
+    mi::Uint32 y_end,
+    mi::Float32 gamma)
+{
+    const mi::Float32 inv_gamma = 1.0f / gamma;
+
+    for( mi::Uint32 y = y_begin; y < y_end; ++y) {
+
+        const mi::Float32* row0 = src + static_cast<mi::Size>( 2*y) * prev_width * C;
+        const bool has_row1 = 2*y+1 < prev_height;
+        const mi::Float32* row1
+            = has_row1 ? row0 + static_cast<mi::Size>( prev_width) * C : row0;
+        mi::Float32* d = dest + static_cast<mi::Size>( y) * width * C;
+
+        if( gamma == 1.0f && has_row1 && 2*width <= prev_width) {
+            // common case, written such that the compiler can vectorize it
+            for( mi::Uint32 x = 0; x < width; ++x)
+                for( mi::Uint32 c = 0; c < C; ++c)
+                    d[x*C+c] = 0.25f * (row0[2*x*C+c] + row0[(2*x+1)*C+c]
+                                      + row1[2*x*C+c] + row1[(2*x+1)*C+c]);
+            continue;
+        }
+
+        for( mi::Uint32 x = 0; x < width; ++x) {
+            const mi::Uint32 px0 = 2*x;
+            const bool has_col1 = px0+1 < prev_width;
+            const mi::Uint32 px1 = has_col1 ? px0+1 : px0;
+            const mi::Float32 inv_n = 1.0f / mi::Float32( (has_row1 ? 2 : 1) * (has_col1 ? 2 : 1));
+
+            for( mi::Uint32 c = 0; c < C; ++c) {
+                mi::Float32 v[4] = {
+                    row0[px0*C+c], row0[px1*C+c], row1[px0*C+c], row1[px1*C+c] };
+                if( gamma != 1.0f)
+                    for( mi::Float32& vi : v)
+                        vi = mi::math::fast_pow( vi, gamma);
+                mi::Float32 sum = v[0];
+                if( has_col1)
+                    sum += v[1];
+                if( has_row1) {
+                    sum += v[2];
+                    if( has_col1)
+                        sum += v[3];
+                }
+                sum *= inv_n;
+                d[x*C+c] = gamma != 1.0f ? mi::math::fast_pow( sum, inv_gamma) : sum;
+            }
+        }
+    }
+}
+
+/// Computes the rows [y_begin,y_end) of a miplevel for arbitrary pixel types using a 2x2 box
+/// filter (slow path via ITile::get_pixel() and ITile::set_pixel()).
+void downsample_box_generic(
+    const mi::neuraylib::ITile* prev_tile,
+    mi::neuraylib::ITile* tile,
+    mi::Uint32 prev_width,
+    mi::Uint32 prev_height,
+    mi::Uint32 width,
+    mi::Uint32 y_begin,
+    mi::Uint32 y_end,
+    mi::Float32 gamma)
+{
+    constexpr mi::Uint32 offsets_x[4] = { 0, 1, 0, 1 };
+    constexpr mi::Uint32 offsets_y[4] = { 0, 0, 1, 1 };
+
+    const mi::Float32 inv_gamma = 1.0f / gamma;
+
+    for( mi::Uint32 y = y_begin; y < y_end; ++y) {
+        for( mi::Uint32 x = 0; x < width; ++x) {
+
+            // The current pixel (x,y) corresponds to the at most four pixels
+            // [2x,2x+1] x [2y,2y+1] of the previous miplevel.
+            mi::math::Color color( 0.0f, 0.0f, 0.0f, 0.0f);
+            mi::Uint32 nr_of_summands = 0;
+
+            for( mi::Uint32 i = 0; i < 4; ++i) {
+                const mi::Uint32 prev_x = 2*x + offsets_x[i];
+                if( prev_x >= prev_width)
+                    continue;
+                const mi::Uint32 prev_y = 2*y + offsets_y[i];
+                if( prev_y >= prev_height)
+                    continue;
+
+                mi::math::Color prev_color;
+                prev_tile->get_pixel( prev_x, prev_y, &prev_color.r);
+                apply_gamma( prev_color, gamma);
+                color += prev_color;
+                nr_of_summands += 1;
+            }
+            color /= static_cast<mi::Float32>( nr_of_summands);
+            apply_gamma( color, inv_gamma);
+
+            tile->set_pixel( x, y, &color.r);
+        }
+    }
+}
+
+/// Radius (in pixels of the destination miplevel) of the windowed sinc filters.
+const mi::Float32 s_filter_radius = 3.0f;
+
+/// Zeroth order modified Bessel function of the first kind (for the Kaiser window).
+mi::Float64 bessel_i0( mi::Float64 x)
+{
+    mi::Float64 sum = 1.0;
+    mi::Float64 term = 1.0;
+    const mi::Float64 q = x * x * 0.25;
+    for( mi::Uint32 k = 1; k < 32; ++k) {
+        term *= q / (mi::Float64( k) * mi::Float64( k));
+        sum += term;
+        if( term < sum * 1e-12)
+            break;
+    }
+    return sum;
+}
+
+/// Evaluates the windowed sinc filter kernel of the given filter.
+mi::Float32 filter_kernel( Mipmap_filter filter, mi::Float32 x)
+{
+    x = std::abs( x);
+    if( x >= s_filter_radius)
+        return 0.0f;
+
+    const mi::Float64 pi_x = MI_PI * x;
+    const mi::Float64 sinc = x < 1e-6f ? 1.0 : sin( pi_x) / pi_x;
+
+    if( filter == MIPMAP_FILTER_LANCZOS) {
+        const mi::Float64 pi_x_a = pi_x / s_filter_radius;
+        const mi::Float64 window = x < 1e-6f ? 1.0 : sin( pi_x_a) / pi_x_a;
+        return mi::Float32( sinc * window);
+    }
+
+    ASSERT( M_IMAGE, filter == MIPMAP_FILTER_KAISER);
+    const mi::Float64 alpha = 4.0;
+    const mi::Float64 t = x / s_filter_radius;
+    return mi::Float32( sinc * bessel_i0( alpha * sqrt( 1.0 - t*t)) / bessel_i0( alpha));
+}
+
+/// Precomputed, normalized filter weights for one dimension.
+struct Filter_weights
+{
+    /// First source index for each destination index.
+    std::vector<mi::Uint32> m_first;
+    /// Weights for each destination index, m_taps many per destination index. The source index of
+    /// the i-th weight is m_first + i, clamped to the valid range.
+    std::vector<mi::Float32> m_weights;
+    mi::Uint32 m_taps = 0;
+    mi::Uint32 m_src_size = 0;
+
+    Filter_weights( Mipmap_filter filter, mi::Uint32 src_size, mi::Uint32 dest_size)
+      : m_first( dest_size), m_src_size( src_size)
+    {
+        const mi::Float32 scale = mi::Float32( src_size) / mi::Float32( dest_size);
+        const mi::Float32 filter_scale = std::max( scale, 1.0f);
+        const mi::Float32 support = s_filter_radius * filter_scale;
+        m_taps = mi::Uint32( std::ceil( 2.0f * support)) + 1;
+        m_weights.resize( static_cast<mi::Size>( dest_size) * m_taps);
+
+        for( mi::Uint32 d = 0; d < dest_size; ++d) {
+            const mi::Float32 center = (mi::Float32( d) + 0.5f) * scale;
+            const mi::Sint32 first = mi::Sint32( std::floor( center - support));
+            m_first[d] = mi::Uint32( first); // negative values wrap, see source_index()
+            mi::Float32* w = &m_weights[static_cast<mi::Size>( d) * m_taps];
+            mi::Float32 sum = 0.0f;
+            for( mi::Uint32 i = 0; i < m_taps; ++i) {
+                const mi::Float32 pos = mi::Float32( first + mi::Sint32( i)) + 0.5f;
+                w[i] = filter_kernel( filter, (pos - center) / filter_scale);
+                sum += w[i];
+            }
+            for( mi::Uint32 i = 0; i < m_taps; ++i)
+                w[i] /= sum;
+        }
+    }
+
+    /// Returns the clamped source index of the i-th tap for destination index d.
+    mi::Uint32 source_index( mi::Uint32 d, mi::Uint32 i) const
+    {
+        const mi::Sint32 index = mi::Sint32( m_first[d]) + mi::Sint32( i);
+        return mi::Uint32( std::min( std::max( index, 0), mi::Sint32( m_src_size) - 1));
+    }
+
+    const mi::Float32* get_weights( mi::Uint32 d) const
+    { return &m_weights[static_cast<mi::Size>( d) * m_taps]; }
+};
+
+/// Executes a function for a range of rows, possibly split into several fragments.
+class Miplevel_job : public DB::Fragmented_job
+{
+public:
+    Miplevel_job(
+        const std::function<void( mi::Uint32, mi::Uint32)>& compute_rows, mi::Uint32 rows)
+      : m_compute_rows( compute_rows), m_rows( rows) { }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        const mi::Uint32 begin = mi::Uint32( m_rows * index / count);
+        const mi::Uint32 end   = mi::Uint32( m_rows * (index+1) / count);
+        m_compute_rows( begin, end);
+    }
+
+private:
+    const std::function<void( mi::Uint32, mi::Uint32)>& m_compute_rows;
+    mi::Size m_rows;
+};
+
+/// Minimum number of pixels per fragment when computing miplevels in parallel.
+const mi::Size s_min_pixels_per_fragment = 16384;
+
 } // namespace
 
+void Image_module_impl::execute_rows(
+    mi::Uint32 rows,
+    mi::Uint32 pixels_per_row,
+    const std::function<void( mi::Uint32, mi::Uint32)>& compute_rows) const
+{
+    const mi::Size pixels = static_cast<mi::Size>( rows) * pixels_per_row;
+    const mi::Size count = std::min<mi::Size>( rows, pixels / s_min_pixels_per_fragment);
+    if( !m_database || count <= 1) {
+        compute_rows( 0, rows);
+        return;
+    }
+
+    Miplevel_job job( compute_rows, rows);
+    m_database->execute_fragmented( &job, count);
+}
+
+void Image_module_impl::set_database( DB::Database* database)
+{
+    m_database = database;
+}
+
+void Image_module_impl::set_mipmap_filter( Mipmap_filter filter)
+{
+    m_mipmap_filter = filter;
+}
+
+Mipmap_filter Image_module_impl::get_mipmap_filter() const
+{
+    return m_mipmap_filter;
+}
+
 mi::neuraylib::ICanvas* Image_module_impl::create_miplevel(
     const mi::neuraylib::ICanvas* prev_canvas, float gamma_override) const
 {
-    // NOTE: This implementation creates the new miplevel tile by tile. For each tile, it retrieves
-    // the at most four needed tiles from the previous miplevel *once* (and not for every pixel).
-    // Remember that tile lookups require locks (and reference counts).
     ASSERT(M_IMAGE, prev_canvas);
 
     // Get properties of previous miplevel
@@ -1583,74 +1930,175 @@ mi::neuraylib::ICanvas* Image_module_impl::create_miplevel(
         pixel_type, width, height, layers,
         get_canvas_is_cubemap(prev_canvas), prev_canvas->get_gamma());
 
-    constexpr mi::Uint32 offsets_x[4] = { 0, 1, 0, 1 };
-    constexpr mi::Uint32 offsets_y[4] = { 0, 0, 1, 1 };
+    for (mi::Uint32 layer = 0; layer < layers; ++layer) {
 
-    const mi::Float32 inv_gamma = 1.0f / gamma;
+        mi::base::Handle<mi::neuraylib::ITile> tile(canvas->get_tile(layer));
+        mi::base::Handle<const mi::neuraylib::ITile> prev_tile(prev_canvas->get_tile(layer));
+        ASSERT(M_IMAGE, prev_tile);
 
-    // Loop over the tiles and compute the pixel data for each tile
-    for (mi::Uint32 tile_z = 0; tile_z < layers; ++tile_z) {
+        if (m_mipmap_filter != MIPMAP_FILTER_BOX) {
+            create_miplevel_layer_filtered(
+                prev_tile.get(), tile.get(), pixel_type, prev_width, prev_height,
+                width, height, gamma);
+            continue;
+        }
 
-        // The current tile covers pixels in the range [0,x_end) x [0,y_end)
-        // from the canvas for this miplevel.
-        const mi::Uint32 x_end = width;
-        const mi::Uint32 y_end = height;
+        const void* src = prev_tile->get_data();
+        void* dest = tile->get_data();
 
-        // Lookup tile for this miplevel
-        mi::base::Handle<mi::neuraylib::ITile> tile(canvas->get_tile());
+        // Typed fast paths for the common pixel types, the generic path for all others.
+        std::function<void(mi::Uint32, mi::Uint32)> compute_rows;
+        std::unique_ptr<Gamma_lut_8> lut;
+        switch (pixel_type) {
+        case PT_SINT8:
+            lut.reset(new Gamma_lut_8(gamma, 255.0f));
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_uint8<1>(static_cast<const mi::Uint8*>(src),
+                    static_cast<mi::Uint8*>(dest), prev_width, prev_height, width,
+                    begin, end, *lut);
+            };
+            break;
+        case PT_RGB:
+            lut.reset(new Gamma_lut_8(gamma, 256.0f));
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_uint8<3>(static_cast<const mi::Uint8*>(src),
+                    static_cast<mi::Uint8*>(dest), prev_width, prev_height, width,
+                    begin, end, *lut);
+            };
+            break;
+        case PT_RGBA:
+        case PT_SINT32: // treated as PT_RGBA
+            lut.reset(new Gamma_lut_8(gamma, 256.0f));
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_uint8<4>(static_cast<const mi::Uint8*>(src),
+                    static_cast<mi::Uint8*>(dest), prev_width, prev_height, width,
+                    begin, end, *lut);
+            };
+            break;
+        case PT_FLOAT32:
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_float<1>(static_cast<const mi::Float32*>(src),
+                    static_cast<mi::Float32*>(dest), prev_width, prev_height, width,
+                    begin, end, gamma);
+            };
+            break;
+        case PT_FLOAT32_2:
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_float<2>(static_cast<const mi::Float32*>(src),
+                    static_cast<mi::Float32*>(dest), prev_width, prev_height, width,
+                    begin, end, gamma);
+            };
+            break;
+        case PT_FLOAT32_3:
+        case PT_RGB_FP:
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_float<3>(static_cast<const mi::Float32*>(src),
+                    static_cast<mi::Float32*>(dest), prev_width, prev_height, width,
+                    begin, end, gamma);
+            };
+            break;
+        case PT_FLOAT32_4:
+        case PT_COLOR:
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_float<4>(static_cast<const mi::Float32*>(src),
+                    static_cast<mi::Float32*>(dest), prev_width, prev_height, width,
+                    begin, end, gamma);
+            };
+            break;
+        default:
+            compute_rows = [&](mi::Uint32 begin, mi::Uint32 end) {
+                downsample_box_generic(prev_tile.get(), tile.get(),
+                    prev_width, prev_height, width, begin, end, gamma);
+            };
+            break;
+        }
 
-        // Lookup involved tiles from the previous miplevel (note that these tiles are not
-        // necessarily distinct).
-        mi::base::Handle<const mi::neuraylib::ITile> prev_tile( prev_canvas->get_tile());
-        ASSERT(M_IMAGE, prev_tile);
+        execute_rows(height, width, compute_rows);
+    }
+    return canvas;
+}
 
-        // Loop over the pixels of this tile and compute the value for each pixel
-        for (mi::Uint32 y = 0; y < y_end; ++y) {
-            for (mi::Uint32 x = 0; x < x_end; ++x) {
-
-                // The current pixel (x,y) corresponds to the four pixels
-                // [prev_x, prev_x+1] x [prev_y,prev_y+1] in the tiles of the previous
-                // layer. Note that all four pixels might actually be in a different tile.
-                const mi::Uint32 prev_x = 2 * x;
-                const mi::Uint32 prev_y = 2 * y;
-
-                mi::math::Color color(0.0f, 0.0f, 0.0f, 0.0f);
-                mi::Uint32 nr_of_summands = 0;
-
-                // Loop over the at most four pixels corresponding to pixel (x,y)
-                for (mi::Uint32 i = 0; i < 4; ++i) {
-
-                    // Find tile of pixel
-                    // (prev_x + offsets_x[i], prev_y + offsets_y[i]) and its coordinates
-                    // with respect to that tile.
-                    const mi::Uint32 prev_actual_x = prev_x + offsets_x[i];
-                    if (prev_actual_x >= prev_width)
-                        continue;
-                    const mi::Uint32 prev_actual_y = prev_y + offsets_y[i];
-                    if (prev_actual_y >= prev_height)
-                        continue;
-
-                    // The pixel (prev_x + offsets_x[i], prev_y + offsets_y[i]) actually
-                    // is pixel (prev_actual_x, prev_actual_y) in tile
-                    // prev_tiles[prev_tile_id].
-                    mi::math::Color prev_color;
-                    prev_tile->get_pixel(
-                            prev_actual_x, prev_actual_y, &prev_color.r);
-                    if (gamma != 1.0f) {
-                        apply_gamma(prev_color, gamma);
-                    }
-                    color += prev_color;
-                    nr_of_summands += 1;
+void Image_module_impl::create_miplevel_layer_filtered(
+    const mi::neuraylib::ITile* prev_tile,
+    mi::neuraylib::ITile* tile,
+    Pixel_type pixel_type,
+    mi::Uint32 prev_width,
+    mi::Uint32 prev_height,
+    mi::Uint32 width,
+    mi::Uint32 height,
+    mi::Float32 gamma) const
+{
+    // The filter is separable: the horizontal pass filters each row of the previous miplevel
+    // (after conversion to linear PT_COLOR), the vertical pass combines these rows into the rows
+    // of this miplevel and converts them back.
+    const Filter_weights weights_x(m_mipmap_filter, prev_width, width);
+    const Filter_weights weights_y(m_mipmap_filter, prev_height, height);
+
+    const mi::Uint32 prev_bpp = get_bytes_per_pixel(pixel_type);
+    const char* src = static_cast<const char*>(prev_tile->get_data());
+    char* dest = static_cast<char*>(tile->get_data());
+
+    // Negative values due to the filter lobes are clamped for pixel types that cannot represent
+    // them and if gamma encoding is required.
+    const bool clamp_negative = gamma != 1.0f
+        || get_bytes_per_component(pixel_type) != 4 || pixel_type == PT_SINT32;
+    const mi::Float32 inv_gamma = 1.0f / gamma;
+
+    std::vector<mi::math::Color> horizontal(static_cast<mi::Size>(prev_height) * width);
+
+    std::function<void(mi::Uint32, mi::Uint32)> horizontal_pass
+        = [&](mi::Uint32 begin, mi::Uint32 end)
+    {
+        std::vector<mi::math::Color> row(prev_width);
+        for (mi::Uint32 y = begin; y < end; ++y) {
+            convert(src + static_cast<mi::Size>(y) * prev_width * prev_bpp, &row[0].r,
+                pixel_type, PT_COLOR, prev_width);
+            if (gamma != 1.0f)
+                for (mi::math::Color& c : row)
+                    apply_gamma(c, gamma);
+
+            mi::math::Color* h = &horizontal[static_cast<mi::Size>(y) * width];
+            for (mi::Uint32 x = 0; x < width; ++x) {
+                const mi::Float32* w = weights_x.get_weights(x);
+                mi::math::Color sum(0.0f, 0.0f, 0.0f, 0.0f);
+                for (mi::Uint32 i = 0; i < weights_x.m_taps; ++i)
+                    sum += row[weights_x.source_index(x, i)] * w[i];
+                h[x] = sum;
+            }
+        }
+    };
+    execute_rows(prev_height, prev_width, horizontal_pass);
+
+    const mi::Uint32 bpp = get_bytes_per_pixel(pixel_type);
+    std::function<void(mi::Uint32, mi::Uint32)> vertical_pass
+        = [&](mi::Uint32 begin, mi::Uint32 end)
+    {
+        std::vector<mi::math::Color> row(width);
+        for (mi::Uint32 y = begin; y < end; ++y) {
+            const mi::Float32* w = weights_y.get_weights(y);
+            for (mi::Uint32 x = 0; x < width; ++x)
+                row[x] = mi::math::Color(0.0f, 0.0f, 0.0f, 0.0f);
+            for (mi::Uint32 i = 0; i < weights_y.m_taps; ++i) {
+                const mi::math::Color* h
+                    = &horizontal[static_cast<mi::Size>(weights_y.source_index(y, i)) * width];
+                for (mi::Uint32 x = 0; x < width; ++x)
+                    row[x] += h[x] * w[i];
+            }
+            for (mi::math::Color& c : row) {
+                if (clamp_negative) {
+                    c.r = std::max(c.r, 0.0f);
+                    c.g = std::max(c.g, 0.0f);
+                    c.b = std::max(c.b, 0.0f);
+                    c.a = std::max(c.a, 0.0f);
                 }
-                color /= static_cast<mi::Float32>(nr_of_summands);
                 if (gamma != 1.0f)
-                    apply_gamma(color, inv_gamma);
-
-                tile->set_pixel(x, y, &color.r);
+                    apply_gamma(c, inv_gamma);
             }
+            convert(&row[0].r, dest + static_cast<mi::Size>(y) * width * bpp,
+                PT_COLOR, pixel_type, width);
         }
-    }
-    return canvas;
+    };
+    execute_rows(height, width, vertical_pass);
 }
 
 } // namespace IMAGE
@@ -34,6 +34,7 @@
 #include <mi/base/handle.h>
 #include <mi/base/lock.h>
 
+#include <functional>
 #include <vector>
 #include <base/system/main/access_module.h>
 
@@ -230,6 +231,12 @@ public:
 
     IMdl_container_callback* get_mdl_container_callback() const;
 
+    void set_database( DB::Database* database);
+
+    void set_mipmap_filter( Mipmap_filter filter);
+
+    Mipmap_filter get_mipmap_filter() const;
+
     mi::neuraylib::ICanvas* create_miplevel(
         const mi::neuraylib::ICanvas* prev_canvas, float gamma_override) const;
 
@@ -270,6 +277,24 @@ private:
     /// Indicates whether the given canvas is a cubemap or not.
     static bool get_canvas_is_cubemap( const mi::neuraylib::ICanvas* canvas);
 
+    /// Invokes \p compute_rows for the row range [0,rows), split into several fragments executed
+    /// on the thread pool of #m_database if the number of pixels is large enough.
+    void execute_rows(
+        mi::Uint32 rows,
+        mi::Uint32 pixels_per_row,
+        const std::function<void( mi::Uint32, mi::Uint32)>& compute_rows) const;
+
+    /// Computes one layer of a miplevel using the windowed sinc filter #m_mipmap_filter.
+    void create_miplevel_layer_filtered(
+        const mi::neuraylib::ITile* prev_tile,
+        mi::neuraylib::ITile* tile,
+        Pixel_type pixel_type,
+        mi::Uint32 prev_width,
+        mi::Uint32 prev_height,
+        mi::Uint32 width,
+        mi::Uint32 height,
+        mi::Float32 gamma) const;
+
     /// Access to the PLUG module
     SYSTEM::Access_module<PLUG::Plug_module> m_plug_module;
 
@@ -283,6 +308,12 @@ private:
 
     /// Callback to support lazy loading of images in MDL containers.
     mi::base::Handle<IMdl_container_callback> m_mdl_container_callback;
+
+    /// The database whose thread pool is used to compute miplevels (or \c NULL).
+    DB::Database* m_database = nullptr;
+
+    /// The filter used to compute miplevels.
+    Mipmap_filter m_mipmap_filter = MIPMAP_FILTER_BOX;
 };
 
 } // namespace IMAGE
@@ -40,7 +40,9 @@
 
 #include <mi/base/handle.h>
 #include <mi/neuraylib/icanvas.h>
+#include <mi/neuraylib/itile.h>
 
+#include <cmath>
 #include <sstream>
 #include <base/system/main/access_module.h>
 #include <base/lib/mem/mem.h>
@@ -98,4 +100,149 @@ MI_TEST_AUTO_FUNCTION( test_mipmap )
     }
 }
 
+// Computes the expected miplevel of \p prev_canvas via get_pixel()/set_pixel() and compares it
+// with the result of Image_module::create_miplevel().
+void check_box_miplevel(
+    const IMAGE::Image_module* image_module,
+    const mi::neuraylib::ICanvas* prev_canvas,
+    float tolerance)
+{
+    mi::base::Handle<mi::neuraylib::ICanvas> canvas(
+        image_module->create_miplevel( prev_canvas, 0.0f));
+    MI_CHECK( canvas);
+
+    const mi::Uint32 prev_width  = prev_canvas->get_resolution_x();
+    const mi::Uint32 prev_height = prev_canvas->get_resolution_y();
+    const mi::Uint32 width       = canvas->get_resolution_x();
+    const mi::Uint32 height      = canvas->get_resolution_y();
+    MI_CHECK_EQUAL( width, std::max( prev_width/2, 1u));
+    MI_CHECK_EQUAL( height, std::max( prev_height/2, 1u));
+    MI_CHECK_EQUAL( canvas->get_layers_size(), prev_canvas->get_layers_size());
+    MI_CHECK_EQUAL_CSTR( canvas->get_type(), prev_canvas->get_type());
+
+    const IMAGE::Pixel_type pixel_type
+        = IMAGE::convert_pixel_type_string_to_enum( prev_canvas->get_type());
+    const mi::Float32 gamma = prev_canvas->get_gamma();
+
+    mi::base::Handle<mi::neuraylib::ICanvas> expected_canvas( image_module->create_canvas(
+        pixel_type, width, height, canvas->get_layers_size(), false, gamma));
+
+    for( mi::Uint32 z = 0; z < canvas->get_layers_size(); ++z) {
+
+        mi::base::Handle<const mi::neuraylib::ITile> prev_tile( prev_canvas->get_tile( z));
+        mi::base::Handle<const mi::neuraylib::ITile> tile( canvas->get_tile( z));
+        mi::base::Handle<mi::neuraylib::ITile> expected_tile( expected_canvas->get_tile( z));
+
+        for( mi::Uint32 y = 0; y < height; ++y)
+            for( mi::Uint32 x = 0; x < width; ++x) {
+
+                mi::Float32 sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+                mi::Uint32 n = 0;
+                for( mi::Uint32 py = 2*y; py < std::min( 2*y+2, prev_height); ++py)
+                    for( mi::Uint32 px = 2*x; px < std::min( 2*x+2, prev_width); ++px) {
+                        mi::Float32 value[4];
+                        prev_tile->get_pixel( px, py, value);
+                        for( mi::Uint32 c = 0; c < 4; ++c)
+                            sum[c] += std::pow( value[c], gamma);
+                        ++n;
+                    }
+                for( mi::Uint32 c = 0; c < 4; ++c)
+                    sum[c] = std::pow( sum[c] / mi::Float32( n), 1.0f / gamma);
+                expected_tile->set_pixel( x, y, sum);
+
+                mi::Float32 expected[4], actual[4];
+                expected_tile->get_pixel( x, y, expected);
+                tile->get_pixel( x, y, actual);
+                for( mi::Uint32 c = 0; c < 4; ++c)
+                    MI_CHECK_CLOSE( expected[c], actual[c], tolerance);
+            }
+    }
+}
+
+MI_TEST_AUTO_FUNCTION( test_create_miplevel )
+{
+    SYSTEM::Access_module<MEM::Mem_module> mem_module( false);
+    SYSTEM::Access_module<LOG::Log_module> log_module( false);
+    SYSTEM::Access_module<IMAGE::Image_module> image_module( false);
+
+    // Box filter, with typed fast paths and the generic path (PT_RGBE, PT_RGBA_16), odd
+    // resolutions, and several layers with different content.
+    const IMAGE::Pixel_type pixel_types[] = {
+        IMAGE::PT_SINT8, IMAGE::PT_RGB, IMAGE::PT_RGBA, IMAGE::PT_FLOAT32, IMAGE::PT_FLOAT32_2,
+        IMAGE::PT_RGB_FP, IMAGE::PT_COLOR, IMAGE::PT_RGBE, IMAGE::PT_RGBA_16 };
+    const mi::Float32 gammas[] = { 1.0f, 2.2f };
+    const mi::Uint32 resolutions[][2] = { { 7, 5 }, { 16, 1 }, { 1, 9 }, { 300, 301 } };
+
+    for( IMAGE::Pixel_type pixel_type : pixel_types)
+        for( mi::Float32 gamma : gammas)
+            for( const auto& resolution : resolutions) {
+
+                mi::base::Handle<mi::neuraylib::ICanvas> canvas( image_module->create_canvas(
+                    pixel_type, resolution[0], resolution[1], 2, false, gamma));
+
+                mi::Uint32 seed = 1;
+                for( mi::Uint32 z = 0; z < 2; ++z) {
+                    mi::base::Handle<mi::neuraylib::ITile> tile( canvas->get_tile( z));
+                    for( mi::Uint32 y = 0; y < resolution[1]; ++y)
+                        for( mi::Uint32 x = 0; x < resolution[0]; ++x) {
+                            mi::Float32 value[4];
+                            for( mi::Float32& v : value) {
+                                seed = seed * 1664525u + 1013904223u;
+                                v = mi::Float32( seed >> 8) / mi::Float32( 1u << 24);
+                            }
+                            if( pixel_type == IMAGE::PT_SINT8)
+                                value[1] = value[2] = value[0];
+                            tile->set_pixel( x, y, value);
+                        }
+                }
+
+                // 8-bit types are off by at most one quantization step (the LUTs use the exact
+                // pow()), other types with gamma differ due to the approximation of pow(), and
+                // PT_RGBE additionally due to the shared exponent.
+                const bool is_8bit = IMAGE::get_bytes_per_component( pixel_type) == 1
+                    && pixel_type != IMAGE::PT_RGBE;
+                const float tolerance = pixel_type == IMAGE::PT_RGBE ? 4.01f/255.0f
+                    : is_8bit ? 1.01f/255.0f : gamma != 1.0f ? 1e-2f : 1e-4f;
+                check_box_miplevel( image_module.get(), canvas.get(), tolerance);
+            }
+
+    // Windowed sinc filters preserve constant images.
+    const IMAGE::Mipmap_filter filters[] = {
+        IMAGE::MIPMAP_FILTER_LANCZOS, IMAGE::MIPMAP_FILTER_KAISER };
+    for( IMAGE::Mipmap_filter filter : filters) {
+
+        image_module->set_mipmap_filter( filter);
+        MI_CHECK_EQUAL( image_module->get_mipmap_filter(), filter);
+
+        for( IMAGE::Pixel_type pixel_type : { IMAGE::PT_RGBA, IMAGE::PT_COLOR }) {
+
+            mi::base::Handle<mi::neuraylib::ICanvas> canvas( image_module->create_canvas(
+                pixel_type, 37, 20, 1, false, 1.0f));
+            mi::base::Handle<mi::neuraylib::ITile> tile( canvas->get_tile());
+            const mi::Float32 value[4] = { 0.2f, 0.4f, 0.6f, 1.0f };
+            for( mi::Uint32 y = 0; y < 20; ++y)
+                for( mi::Uint32 x = 0; x < 37; ++x)
+                    tile->set_pixel( x, y, value);
+
+            mi::base::Handle<mi::neuraylib::ICanvas> miplevel(
+                image_module->create_miplevel( canvas.get(), 0.0f));
+            MI_CHECK_EQUAL( miplevel->get_resolution_x(), 18);
+            MI_CHECK_EQUAL( miplevel->get_resolution_y(), 10);
+
+            mi::Float32 expected[4];
+            tile->get_pixel( 0, 0, expected);
+            mi::base::Handle<const mi::neuraylib::ITile> miplevel_tile( miplevel->get_tile());
+            for( mi::Uint32 y = 0; y < 10; ++y)
+                for( mi::Uint32 x = 0; x < 18; ++x) {
+                    mi::Float32 actual[4];
+                    miplevel_tile->get_pixel( x, y, actual);
+                    for( mi::Uint32 c = 0; c < 4; ++c)
+                        MI_CHECK_CLOSE( expected[c], actual[c], 1.01f/255.0f);
+                }
+        }
+    }
+
+    image_module->set_mipmap_filter( IMAGE::MIPMAP_FILTER_BOX);
+}
+
 MI_TEST_MAIN_CALLING_TEST_MAIN();
@@ -42,6 +42,7 @@
 #include <base/lib/path/i_path.h>
 #include <base/data/serial/i_serializer.h>
 #include <base/data/db/i_db_access.h>
+#include <base/data/db/i_db_fragmented_job.h>
 #include <base/data/db/i_db_transaction.h>
 #include <base/util/string_utils/i_string_utils.h>
 #include <io/image/image/i_image.h>
@@ -67,6 +68,59 @@ std::string hash_to_string( const mi::base::Uuid& hash)
     return buffer;
 }
 
+/// Decodes the uv-tiles of an image set in parallel, one uv-tile per fragment.
+///
+/// Each fragment writes only the mipmap handle and the error code of its own uv-tile, hence no
+/// synchronization is needed.
+class Decode_uvtiles_job : public DB::Fragmented_job
+{
+public:
+    /// Constructor.
+    ///
+    /// \param image_set   The image set to decode.
+    /// \param tiles       The pairs of frame ID and uv-tile ID to decode.
+    /// \param frames      The frames that receive the mipmaps. Need to be resized already.
+    Decode_uvtiles_job(
+        const Image_set* image_set,
+        const std::vector<std::pair<mi::Size, mi::Size>>& tiles,
+        Frames& frames)
+      : m_image_set( image_set)
+      , m_tiles( tiles)
+      , m_frames( frames)
+      , m_errors( tiles.size(), 0)
+    {
+    }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        const mi::Size f = m_tiles[index].first;
+        const mi::Size i = m_tiles[index].second;
+        m_frames[f].m_uvtiles[i].m_mipmap
+            = m_image_set->create_mipmap( f, i, m_errors[index]);
+    }
+
+    /// Returns the error code of the first failed uv-tile (in the order of \p tiles), or 0.
+    ///
+    /// Independent of the execution order of the fragments.
+    mi::Sint32 get_first_error() const
+    {
+        for( mi::Sint32 errors: m_errors)
+            if( errors != 0)
+                return errors;
+        return 0;
+    }
+
+private:
+    const Image_set* m_image_set;
+    const std::vector<std::pair<mi::Size, mi::Size>>& m_tiles;
+    Frames& m_frames;
+    std::vector<mi::Sint32> m_errors;
+};
+
 } // namespace
 
 IMAGE::IMipmap* Image_set::create_mipmap( mi::Size f, mi::Size i, mi::Sint32& errors) const
@@ -530,6 +584,14 @@ mi::Sint32 Image::reset_image_set(
     Frames_filenames tmp_frames_filenames;
     Frame_to_id tmp_frame_to_id;
 
+    // Frame ID and uv-tile ID of all uv-tiles to decode. Decoding is independent per uv-tile and
+    // done after the loop below.
+    std::vector<std::pair<mi::Size, mi::Size>> tiles;
+
+    // Decoding in parallel requires independent readers per uv-tile. This is guaranteed for
+    // file-based uv-tiles only.
+    bool all_file_based = !image_set->is_mdl_container();
+
     // Convert data from image set into temporary variables
     for( mi::Size f = 0; f < number_of_frames; ++f) {
 
@@ -576,13 +638,12 @@ mi::Sint32 Image::reset_image_set(
             Uvtile& tile = frame.m_uvtiles[i];
             tile.m_u = u;
             tile.m_v = v;
-            mi::Sint32 errors = 0;
-            tile.m_mipmap = image_set->create_mipmap( f, i, errors);
-            if( errors != 0)
-                return errors;
+            tiles.emplace_back( f, i);
 
             Uvfilenames& filenames = frame_filenames[i];
             filenames.m_resolved_filename    = image_set->get_resolved_filename( f, i);
+            if( filenames.m_resolved_filename.empty())
+                all_file_based = false;
             filenames.m_container_membername = image_set->get_container_membername( f, i);
             if( !filenames.m_container_membername.empty())
                 filenames.m_resolved_container_membername
@@ -597,6 +658,24 @@ mi::Sint32 Image::reset_image_set(
         tmp_frame_to_id[frame_number] = f;
     }
 
+    // Decode the uv-tiles. Errors are reported for the first failed uv-tile in frame/uv-tile
+    // order, independent of the order in which the fragments are executed.
+    if( transaction && all_file_based && tiles.size() > 1) {
+        Decode_uvtiles_job job( image_set, tiles, tmp_frames);
+        transaction->execute_fragmented( &job, tiles.size());
+        const mi::Sint32 errors = job.get_first_error();
+        if( errors != 0)
+            return errors;
+    } else {
+        for( const auto& tile: tiles) {
+            mi::Sint32 errors = 0;
+            tmp_frames[tile.first].m_uvtiles[tile.second].m_mipmap
+                = image_set->create_mipmap( tile.first, tile.second, errors);
+            if( errors != 0)
+                return errors;
+        }
+    }
+
     reset_shared(
         transaction, tmp_is_animated, tmp_is_uvtile, tmp_frames, tmp_frame_to_id, impl_hash);
 
@@ -1818,6 +1897,18 @@ size_t Image_impl::get_size() const
     return s;
 }
 
+bool Image_impl::evict_reloadable_data()
+{
+    bool result = false;
+
+    for( const auto& frame: m_frames)
+        for( const auto& uvtile: frame.m_uvtiles)
+            if( uvtile.m_mipmap && uvtile.m_mipmap->evict_reloadable_data())
+                result = true;
+
+    return result;
+}
+
 DB::Journal_type Image_impl::get_journal_flags() const
 {
     return DB::Journal_type(
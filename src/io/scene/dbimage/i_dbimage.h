@@ -746,6 +746,8 @@ public:
 
     size_t get_size() const;
 
+    bool evict_reloadable_data();
+
     DB::Journal_type get_journal_flags() const;
 
     Uint bundle( DB::Tag* results, Uint size) const { return 0; }
@@ -129,6 +129,59 @@ private:
     const std::vector<mi::base::Handle<const mi::neuraylib::ICanvas>>& m_canvases;
 };
 
+// Implementation of Image_set that puts the given files on the u-v diagonal.
+class Test_file_image_set : public DBIMAGE::Image_set
+{
+public:
+    Test_file_image_set( const std::vector<std::string>& filenames)
+      : m_filenames( filenames) { }
+
+    bool is_mdl_container() const { return false; }
+
+    const char* get_original_filename() const { return ""; }
+
+    const char* get_container_filename() const { return ""; }
+
+    const char* get_mdl_file_path() const { return ""; }
+
+    const char* get_selector() const { return nullptr; }
+
+    const char* get_image_format() const { return ""; }
+
+    bool is_animated() const { return false; }
+
+    bool is_uvtile() const { return true; }
+
+    mi::Size get_length() const { return 1; }
+
+    mi::Size get_frame_number( mi::Size f) const { return 0; }
+
+    mi::Size get_frame_length( mi::Size f) const { return m_filenames.size(); }
+
+    void get_uvtile_uv( mi::Size f, mi::Size i, mi::Sint32 &u, mi::Sint32 &v) const
+    {
+        if( f > 0 || i >= m_filenames.size())
+            return;
+
+        u = static_cast<mi::Sint32>( i);
+        v = static_cast<mi::Sint32>( i);
+    }
+
+    const char* get_resolved_filename( mi::Size f, mi::Size i) const
+    {
+        return i < m_filenames.size() ? m_filenames[i].c_str() : "";
+    }
+
+    const char* get_container_membername( mi::Size f, mi::Size i) const { return ""; }
+
+    mi::neuraylib::IReader* open_reader( mi::Size f, mi::Size i) const { return nullptr; }
+
+    mi::neuraylib::ICanvas* get_canvas( mi::Size f, mi::Size i) const { return nullptr; }
+
+private:
+    const std::vector<std::string>& m_filenames;
+};
+
 
 // Checks whether \p image represents $MI_DATA/io/image/image/test_mipmap.png.
 //
@@ -705,6 +758,48 @@ void check_uvtiles( DB::Transaction* transaction)
     }
 }
 
+// Returns the error code of reset_image_set() for a set with the given files.
+mi::Sint32 reset_file_image_set(
+    DB::Transaction* transaction, const std::vector<std::string>& filenames)
+{
+    mi::base::Uuid unknown_hash{0,0,0,0};
+
+    Test_file_image_set file_set( filenames);
+    DBIMAGE::Image image;
+    return image.reset_image_set( transaction, &file_set, unknown_hash);
+}
+
+// Checks that the error of the first broken uv-tile (in uv-tile order) is reported if several
+// uv-tiles are decoded in parallel, independent of the order in which they fail.
+void check_uvtiles_errors( DB::Transaction* transaction)
+{
+    const std::string good = TEST::mi_src_path( "io/image/image/tests/test_uvtile_u0_v0.png");
+    const std::string missing = TEST::mi_src_path( "io/image/image/tests/does_not_exist.png");
+    const std::string unsupported = TEST::mi_src_path( "io/scene/dbimage/test.cpp");
+
+    // Single uv-tiles are decoded serially.
+    MI_CHECK_EQUAL( reset_file_image_set( transaction, { good }), 0);
+    const mi::Sint32 missing_error = reset_file_image_set( transaction, { missing });
+    const mi::Sint32 unsupported_error = reset_file_image_set( transaction, { unsupported });
+    MI_CHECK_NOT_EQUAL( missing_error, 0);
+    MI_CHECK_NOT_EQUAL( unsupported_error, 0);
+    MI_CHECK_NOT_EQUAL( missing_error, unsupported_error);
+
+    // Repeat a few times to vary the execution order of the fragments.
+    for( int i = 0; i < 10; ++i) {
+        MI_CHECK_EQUAL( reset_file_image_set(
+            transaction, { good, good, good, good }), 0);
+        MI_CHECK_EQUAL( reset_file_image_set(
+            transaction, { good, missing, good, unsupported }), missing_error);
+        MI_CHECK_EQUAL( reset_file_image_set(
+            transaction, { good, unsupported, good, missing }), unsupported_error);
+        MI_CHECK_EQUAL( reset_file_image_set(
+            transaction, { good, good, good, missing }), missing_error);
+        MI_CHECK_EQUAL( reset_file_image_set(
+            transaction, { unsupported, good, good, good }), unsupported_error);
+    }
+}
+
 void check_animated_uvtiles( DB::Transaction* transaction)
 {
     mi::base::Uuid unknown_hash{0,0,0,0};
@@ -930,6 +1025,7 @@ MI_TEST_AUTO_FUNCTION( test_dbimage )
     check_simple_creation( transaction);
     check_animated_textures( transaction);
     check_uvtiles( transaction);
+    check_uvtiles_errors( transaction);
     check_animated_uvtiles( transaction);
     check_mdle( transaction);
     check_sharing( transaction, "test_simple.png");
@@ -39,8 +39,12 @@
 #include <base/data/db/i_db_tag.h>
 #include <base/data/db/i_db_transaction.h>
 
+#include <list>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <set>
+#include <unordered_map>
 
 #include "i_mdl_elements_expression.h"
 #include "i_mdl_elements_resource_tag_tuple.h"
@@ -246,6 +250,87 @@ private:
     std::set<Mdl_tag_ident> m_module_idents;
 };
 
+/// Process-wide memoization of compiled materials.
+///
+/// Entries are keyed by an opaque string computed by the material instance (see
+/// Mdl_function_call::create_compiled_material()). The cache holds prototypes and hands out
+/// copies, i.e., cached results are shared, but callers own the returned instances. The least
+/// recently used entries are evicted when the sum of the sizes of all entries exceeds the
+/// configured limit.
+class Mdl_compiled_material_cache
+{
+public:
+    /// Statistics of the cache.
+    struct Statistics
+    {
+        size_t hits = 0;      ///< Number of successful lookups.
+        size_t misses = 0;    ///< Number of failed lookups.
+        size_t evictions = 0; ///< Number of evicted entries.
+        size_t entries = 0;   ///< Number of entries currently held.
+        size_t size = 0;      ///< Approximate number of bytes currently held.
+    };
+
+    /// Constructor.
+    ///
+    /// \param max_size   The maximum approximate size of all entries in bytes.
+    explicit Mdl_compiled_material_cache( size_t max_size);
+
+    Mdl_compiled_material_cache( const Mdl_compiled_material_cache&) = delete;
+    Mdl_compiled_material_cache& operator=( const Mdl_compiled_material_cache&) = delete;
+
+    /// Looks up a compiled material.
+    ///
+    /// \param key        The cache key.
+    /// \return           A copy of the cached compiled material, or \c NULL if there is no entry
+    ///                   for \p key.
+    Mdl_compiled_material* lookup( const std::string& key);
+
+    /// Inserts a compiled material.
+    ///
+    /// Does nothing if \p material is larger than the maximum size of the cache. Replaces an
+    /// existing entry with the same key.
+    ///
+    /// \param key        The cache key.
+    /// \param material   The compiled material. The cache stores a copy.
+    void insert( const std::string& key, const Mdl_compiled_material* material);
+
+    /// Removes all entries. Does not reset the statistics.
+    void clear();
+
+    /// Returns the statistics of the cache.
+    void get_statistics( Statistics& stats) const;
+
+private:
+    /// Evicts least recently used entries until the size does not exceed \p max_size.
+    ///
+    /// Assumes that #m_mutex is locked.
+    void shrink( size_t max_size);
+
+    struct Entry
+    {
+        std::string m_key;
+        std::shared_ptr<const Mdl_compiled_material> m_material;
+        size_t m_size;
+    };
+
+    using Entry_list = std::list<Entry>;
+
+    /// The entries, most recently used first.
+    Entry_list m_entries;
+
+    /// Maps keys to entries in #m_entries.
+    std::unordered_map<std::string, Entry_list::iterator> m_map;
+
+    /// The maximum size of all entries.
+    size_t m_max_size;
+
+    /// The statistics.
+    Statistics m_stats;
+
+    /// Lock for all members above.
+    mutable std::mutex m_mutex;
+};
+
 } // namespace MDL
 
 } // namespace MI
@@ -315,6 +315,22 @@ private:
         mi::Uint32 level,
         Execution_context* context);
 
+    /// Computes the key for the compiled material cache.
+    ///
+    /// The key covers the definition, the arguments, the tag versions of all DB elements
+    /// (transitively) referenced by the arguments, the compilation mode, and all context options
+    /// that affect material compilation.
+    ///
+    /// \param transaction         The transaction.
+    /// \param class_compilation   Flag that selects class compilation instead of instance
+    ///                            compilation.
+    /// \param context             The execution context.
+    /// \return                    The cache key.
+    std::string compute_compiled_material_cache_key(
+        DB::Transaction* transaction,
+        bool class_compilation,
+        Execution_context* context) const;
+
     mi::base::Handle<IType_factory> m_tf;        ///< The type factory.
     mi::base::Handle<IValue_factory> m_vf;       ///< The value factory.
     mi::base::Handle<IExpression_factory> m_ef;  ///< The expression factory.
@@ -337,6 +353,8 @@ private:
     mi::base::Handle<const IType> m_return_type;                     // (*)
     mi::base::Handle<IExpression_list> m_arguments;
     mi::base::Handle<const IExpression_list> m_enable_if_conditions; // (*)
+
+    Validity_cache m_validity_cache;             ///< The cached result of is_valid().
 };
 
 } // namespace MDL
@@ -429,6 +429,7 @@ private:
     std::string m_module_db_name;                 ///< The DB name of the corresponding module.
     DB::Tag m_function_tag;                       ///< The tag of this function definition.
     Mdl_ident m_function_ident;                   ///< The identifier of this function definition.
+    Validity_cache m_validity_cache;              ///< The cached result of is_valid().
     mi::mdl::IDefinition::Semantics m_mdl_semantic;  ///< The MDL semantic.
     mi::neuraylib::IFunction_definition::Semantics m_semantic;  ///< The semantic.
     std::string m_mdl_name;                       ///< The MDL name of this function definition.
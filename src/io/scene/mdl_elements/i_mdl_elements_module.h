@@ -441,6 +441,8 @@ private:
 
     std::vector<Mdl_tag_ident> m_imports;            ///< The imported modules.
 
+    Validity_cache m_validity_cache;                 ///< The cached result of is_valid().
+
     mi::base::Handle<IType_list> m_exported_types;   ///< The exported user defined types.
     mi::base::Handle<IType_list> m_local_types;      ///< The local user defined types.
     mi::base::Handle<IValue_list> m_constants;       ///< The constants.
@@ -508,6 +508,52 @@ Mdl_compiled_material* get_default_compiled_material( DB::Transaction* transacti
 /// ignored. Returns the name of the \c ::&lt;builtins&gt; module for all other types.
 std::string get_mdl_module_name( const IType* type);
 
+// **********  Validity tracking *******************************************************************
+
+// Validity checks of modules, definitions, and function calls visit all imports and arguments
+// recursively, which is costly for deep graphs that are checked again and again, e.g., when
+// compiling materials during interactive editing. Therefore, the positive result of such a check
+// is cached per DB element together with the validity generation and the transaction.
+//
+// The validity generation is bumped by all edits that might change the result of a validity
+// check: module reloads, edits of call-typed arguments, repairs, and overwriting function calls.
+// Within one transaction, the view on the DB only changes due to edits of that transaction.
+// Hence, a cached positive result stays correct as long as the generation does not change.
+
+/// Returns the current validity generation.
+mi::Uint32 get_validity_generation();
+
+/// Starts a new validity generation, i.e., invalidates all cached validity checks.
+void bump_validity_generation();
+
+/// Caches the positive result of the validity check of a DB element.
+///
+/// Copies start with an empty cache.
+class Validity_cache
+{
+public:
+    Validity_cache() = default;
+
+    Validity_cache( const Validity_cache&) { }
+
+    Validity_cache& operator=( const Validity_cache&) { m_stamp = 0; return *this; }
+
+    /// Indicates whether a positive result is cached for \p transaction and the current
+    /// validity generation.
+    bool is_valid( DB::Transaction* transaction) const;
+
+    /// Caches a positive result for \p transaction.
+    ///
+    /// \param transaction   The transaction used for the check.
+    /// \param generation    The validity generation at the start of the check. Edits during the
+    ///                      check are thus not missed.
+    void set_valid( DB::Transaction* transaction, mi::Uint32 generation) const;
+
+private:
+    /// The generation in the upper and the transaction ID in the lower 32 bits, or 0.
+    mutable std::atomic<mi::Uint64> m_stamp{ 0};
+};
+
 /// Represents an MDL compiler message. Similar to mi::mdl::IMessage.
 class Message
 {
@@ -610,6 +656,7 @@ private:
 #define MDL_CTX_OPTION_DEPRECATED_REPLACE_EXISTING         "replace_existing"
 #define MDL_CTX_OPTION_TARGET_MATERIAL_MODEL_MODE          "target_material_model_mode"
 #define MDL_CTX_OPTION_USER_DATA                           "user_data"
+#define MDL_CTX_OPTION_USE_COMPILED_MATERIAL_CACHE         "use_compiled_material_cache"
 // Not documented in the API (used by the module transformer, but not for general use).
 #define MDL_CTX_OPTION_KEEP_ORIGINAL_RESOURCE_FILE_PATHS   "keep_original_resource_file_paths"
 
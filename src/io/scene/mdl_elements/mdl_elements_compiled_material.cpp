@@ -649,6 +649,90 @@ void Mdl_compiled_material::get_scene_element_references( DB::Tag_set* result) c
         result->insert( mod.first);
 }
 
+Mdl_compiled_material_cache::Mdl_compiled_material_cache( size_t max_size)
+  : m_max_size( max_size)
+{
+}
+
+Mdl_compiled_material* Mdl_compiled_material_cache::lookup( const std::string& key)
+{
+    std::shared_ptr<const Mdl_compiled_material> material;
+
+    {
+        std::lock_guard<std::mutex> lock( m_mutex);
+
+        auto it = m_map.find( key);
+        if( it == m_map.end()) {
+            ++m_stats.misses;
+            return nullptr;
+        }
+
+        // move entry to the front of the LRU list
+        m_entries.splice( m_entries.begin(), m_entries, it->second);
+        material = it->second->m_material;
+        ++m_stats.hits;
+    }
+
+    // copy outside the lock, the prototype is immutable
+    return new Mdl_compiled_material( *material);
+}
+
+void Mdl_compiled_material_cache::insert(
+    const std::string& key, const Mdl_compiled_material* material)
+{
+    size_t size = material->get_size() + key.size();
+    if( size > m_max_size)
+        return;
+
+    std::shared_ptr<const Mdl_compiled_material> copy(
+        std::make_shared<Mdl_compiled_material>( *material));
+
+    std::lock_guard<std::mutex> lock( m_mutex);
+
+    auto it = m_map.find( key);
+    if( it != m_map.end()) {
+        m_stats.size -= it->second->m_size;
+        m_entries.erase( it->second);
+        m_map.erase( it);
+    }
+
+    shrink( m_max_size - size);
+
+    m_entries.push_front( Entry{ key, copy, size});
+    m_map[key] = m_entries.begin();
+    m_stats.size += size;
+    m_stats.entries = m_entries.size();
+}
+
+void Mdl_compiled_material_cache::clear()
+{
+    std::lock_guard<std::mutex> lock( m_mutex);
+
+    m_map.clear();
+    m_entries.clear();
+    m_stats.size = 0;
+    m_stats.entries = 0;
+}
+
+void Mdl_compiled_material_cache::get_statistics( Statistics& stats) const
+{
+    std::lock_guard<std::mutex> lock( m_mutex);
+
+    stats = m_stats;
+}
+
+void Mdl_compiled_material_cache::shrink( size_t max_size)
+{
+    while( !m_entries.empty() && m_stats.size > max_size) {
+        const Entry& entry = m_entries.back();
+        m_stats.size -= entry.m_size;
+        m_map.erase( entry.m_key);
+        m_entries.pop_back();
+        ++m_stats.evictions;
+    }
+    m_stats.entries = m_entries.size();
+}
+
 } // namespace MDL
 
 } // namespace MI
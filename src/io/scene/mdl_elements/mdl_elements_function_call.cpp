@@ -58,6 +58,7 @@
 #include <base/data/db/i_db_transaction_wrapper.h>
 #include <base/data/db/i_db_info.h>
 #include <base/data/serial/i_serializer.h>
+#include <base/data/serial/i_serial_buffer_serializer.h>
 #include <base/util/registry/i_config_registry.h>
 #include <base/util/string_utils/i_string_utils.h>
 #include <io/scene/scene/i_scene_journal_types.h>
@@ -209,6 +210,12 @@ bool Mdl_function_call::is_valid(
 bool Mdl_function_call::is_valid(
     DB::Transaction* transaction, DB::Tag_set& tags_seen, Execution_context* context) const
 {
+    // A cached positive result implies that the graph below this call is acyclic, in particular,
+    // it does not contain any of the calls in \p tags_seen.
+    if( m_validity_cache.is_valid( transaction))
+        return true;
+    mi::Uint32 generation = get_validity_generation();
+
     DB::Tag module_tag = get_module( transaction);
     DB::Access<Mdl_module> module(module_tag, transaction);
     if (!module->is_valid(transaction, context))
@@ -248,6 +255,8 @@ bool Mdl_function_call::is_valid(
             tags_seen.erase(call_tag);
         }
     }
+
+    m_validity_cache.set_valid( transaction, generation);
     return true;
 }
 
@@ -261,6 +270,9 @@ mi::Sint32 Mdl_function_call::repair(
     if (m_immutable) // immutable calls cannot be changed.
         return -3;
 
+    // repairing might change the call graph
+    bump_validity_generation();
+
     ASSERT(M_SCENE, m_module_tag);
     DB::Access<Mdl_module> module(m_module_tag, transaction);
     // cannot restore if we refer to an invalid module
@@ -452,6 +464,12 @@ mi::Sint32 Mdl_function_call::set_argument(
         ASSERT( M_SCENE, argument_copy); // should always succeed.
     }
 
+    // Changes of the call graph invalidate cached validity results of the callers.
+    mi::base::Handle<const IExpression> old_argument( m_arguments->get_expression( index));
+    if(    old_argument->get_kind() == IExpression::EK_CALL
+        || argument_copy->get_kind() == IExpression::EK_CALL)
+        bump_validity_generation();
+
     m_arguments->set_expression( index, argument_copy.get());
     return 0;
 }
@@ -513,6 +531,12 @@ mi::Sint32 Mdl_function_call::reset_argument(
          argument = m_ef->create_constant( value.get());
     }
 
+    // Changes of the call graph invalidate cached validity results of the callers.
+    mi::base::Handle<const IExpression> old_argument( m_arguments->get_expression( index));
+    if(    old_argument->get_kind() == IExpression::EK_CALL
+        || argument->get_kind() == IExpression::EK_CALL)
+        bump_validity_generation();
+
     m_arguments->set_expression( index, argument.get());
     return 0;
 }
@@ -897,6 +921,20 @@ Mdl_compiled_material* Mdl_function_call::create_compiled_material(
         return nullptr;
     }
 
+    MDL::Mdl_compiled_material_cache* cache = nullptr;
+    std::string cache_key;
+    if( context->get_option<bool>( MDL_CTX_OPTION_USE_COMPILED_MATERIAL_CACHE)) {
+        SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+        cache = mdlc_module->get_compiled_material_cache();
+        if( cache) {
+            cache_key = compute_compiled_material_cache_key(
+                transaction, class_compilation, context);
+            Mdl_compiled_material* cached = cache->lookup( cache_key);
+            if( cached)
+                return cached;
+        }
+    }
+
     mi::base::Handle<const mi::mdl::IGenerated_code_dag::IMaterial_instance> instance(
         create_dag_material_instance(
             transaction,
@@ -918,9 +956,105 @@ Mdl_compiled_material* Mdl_function_call::create_compiled_material(
         = context->get_option<mi::Float32>( MDL_CTX_OPTION_WAVELENGTH_MAX);
     bool resolve_resources = context->get_option<bool>( MDL_CTX_OPTION_RESOLVE_RESOURCES);
 
-    return new Mdl_compiled_material(
+    Mdl_compiled_material* result = new Mdl_compiled_material(
         transaction, instance.get(), module_name,
         mdl_meters_per_scene_unit, mdl_wavelength_min, mdl_wavelength_max, resolve_resources);
+
+    if( cache)
+        cache->insert( cache_key, result);
+
+    return result;
+}
+
+namespace {
+
+/// Appends the raw bytes of \p value to \p key.
+template <typename T>
+void append_to_key( std::string& key, const T& value)
+{
+    key.append( reinterpret_cast<const char*>( &value), sizeof( value));
+}
+
+/// Appends a tag and its tag version to \p key.
+void append_tag_version_to_key( std::string& key, DB::Transaction* transaction, DB::Tag tag)
+{
+    DB::Tag_version version = transaction->get_tag_version( tag);
+    append_to_key( key, tag.get_uint());
+    append_to_key( key, version.m_transaction_id.get_uint());
+    append_to_key( key, version.m_version);
+}
+
+} // namespace
+
+std::string Mdl_function_call::compute_compiled_material_cache_key(
+    DB::Transaction* transaction,
+    bool class_compilation,
+    Execution_context* context) const
+{
+    std::string key;
+
+    // definition and compilation mode
+    append_tag_version_to_key( key, transaction, m_module_tag);
+    append_tag_version_to_key( key, transaction, m_definition_tag);
+    append_to_key( key, m_definition_ident);
+    append_to_key( key, class_compilation);
+
+    // options that affect material compilation
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_METERS_PER_SCENE_UNIT));
+    append_to_key( key, context->get_option<mi::Float32>( MDL_CTX_OPTION_METERS_PER_SCENE_UNIT));
+    append_to_key( key, context->get_option<mi::Float32>( MDL_CTX_OPTION_WAVELENGTH_MIN));
+    append_to_key( key, context->get_option<mi::Float32>( MDL_CTX_OPTION_WAVELENGTH_MAX));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_TERNARY_ON_DF));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_REMOVE_DEAD_PARAMETERS));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_ALL_BOOL_PARAMETERS));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_ALL_ENUM_PARAMETERS));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_TRIVIAL_CUTOUT_OPACITY));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_FOLD_TRANSPARENT_LAYERS));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_IGNORE_NOINLINE));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_TARGET_MATERIAL_MODEL_MODE));
+    append_to_key( key, context->get_option<bool>( MDL_CTX_OPTION_RESOLVE_RESOURCES));
+
+    mi::base::Handle<const mi::IArray> fold_parameters(
+        context->get_interface_option<const mi::IArray>( MDL_CTX_OPTION_FOLD_PARAMETERS));
+    mi::Size n_fold = fold_parameters ? fold_parameters->get_length() : 0;
+    append_to_key( key, n_fold);
+    for( mi::Size i = 0; i < n_fold; ++i) {
+        mi::base::Handle<const mi::IString> element( fold_parameters->get_element<mi::IString>( i));
+        // invalid elements are reported by create_dag_material_instance() on the cache miss
+        if( element)
+            key.append( element->get_c_str()).push_back( '\0');
+    }
+
+    // arguments of this call (which might not be stored in the DB)
+    SERIAL::Buffer_serializer serializer;
+    m_ef->serialize_list( &serializer, m_arguments.get());
+    key.append(
+        reinterpret_cast<const char*>( serializer.get_buffer()), serializer.get_buffer_size());
+
+    // tag versions of all referenced DB elements, recursively for function calls
+    DB::Tag_set references;
+    collect_references( m_arguments.get(), &references);
+    DB::Tag_set visited;
+    std::vector<DB::Tag> stack( references.begin(), references.end());
+    while( !stack.empty()) {
+        DB::Tag tag = stack.back();
+        stack.pop_back();
+        if( !visited.insert( tag).second)
+            continue;
+
+        append_tag_version_to_key( key, transaction, tag);
+
+        if( transaction->get_class_id( tag) != ID_MDL_FUNCTION_CALL)
+            continue;
+
+        DB::Access<Mdl_function_call> call( tag, transaction);
+        mi::base::Handle<const IExpression_list> arguments( call->get_arguments());
+        DB::Tag_set call_references;
+        collect_references( arguments.get(), &call_references);
+        stack.insert( stack.end(), call_references.begin(), call_references.end());
+    }
+
+    return key;
 }
 
 const mi::mdl::IGenerated_code_dag::IMaterial_instance*
@@ -1118,6 +1118,10 @@ bool Mdl_function_definition::is_valid(
     DB::Transaction* transaction,
     Execution_context* context) const
 {
+    if (m_validity_cache.is_valid(transaction))
+        return true;
+    mi::Uint32 generation = get_validity_generation();
+
     DB::Tag module_tag = get_module(transaction);
     DB::Access<Mdl_module> module(module_tag, transaction);
     if (!module->is_valid(transaction, context))
@@ -1148,6 +1152,8 @@ bool Mdl_function_definition::is_valid(
         if (!fcall->is_valid(transaction, tags_seen, context))
             return false;
     }
+
+    m_validity_cache.set_valid(transaction, generation);
     return true;
 }
 
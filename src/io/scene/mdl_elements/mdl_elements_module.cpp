@@ -42,6 +42,10 @@
 #include "mdl_elements_expression.h"
 #include "mdl_elements_utilities.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <map>
 #include <mutex>
 #include <sstream>
 #include <thread>
@@ -58,6 +62,7 @@
 #include <boost/core/ignore_unused.hpp>
 #include <base/lib/log/i_log_logger.h>
 #include <base/data/db/i_db_access.h>
+#include <base/data/db/i_db_fragmented_job.h>
 #include <base/data/db/i_db_transaction.h>
 #include <base/data/serial/i_serial_buffer_serializer.h>
 #include <base/data/serial/i_serializer.h>
@@ -199,6 +204,255 @@ private:
     std::set<std::string> m_registered_builtins;
 };
 
+/// Loads the import closure of a module on the DB thread pool.
+///
+/// The import graph is discovered via mi::mdl::IMDL::get_module_imports(), and each module is
+/// loaded as soon as all its discovered imports are in the DB. Every load uses its own module
+/// cache, i.e., its own loading context, hence the wait queue deduplicates it against concurrent
+/// loads from other threads. The top-level module itself is not loaded. Modules that fail to load
+/// here, depend on such modules, or are part of an import loop, are left to the regular load of
+/// the top-level module, which reports all errors in the caller's context.
+///
+/// The imports of the top-level module are discovered on the calling thread by
+/// #discover_top_module() before the job is started.
+class Import_closure_job : public DB::Fragmented_job
+{
+public:
+    Import_closure_job(
+        DB::Transaction* transaction,
+        mi::mdl::IMDL* mdl,
+        Mdl_module_wait_queue* wait_queue,
+        const Execution_context* context,
+        const std::string& top_module)
+      : m_transaction( transaction)
+      , m_mdl( mdl, mi::base::DUP_INTERFACE)
+      , m_wait_queue( wait_queue)
+      , m_context( context)
+      , m_top_module( top_module)
+    {
+        m_nodes[top_module];
+    }
+
+    /// Discovers the imports of the top-level module.
+    ///
+    /// Returns the number of imported modules that are not yet in the DB.
+    size_t discover_top_module()
+    {
+        discover( m_top_module);
+        return m_nodes.size() - 1;
+    }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        for( ;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock( m_mutex);
+                while( m_tasks.empty() && m_active > 0)
+                    m_condition.wait( lock);
+                if( m_tasks.empty())
+                    return;
+                task = m_tasks.front();
+                m_tasks.pop_front();
+                ++m_active;
+            }
+
+            if( task.load)
+                load( task.name);
+            else
+                discover( task.name);
+
+            {
+                std::unique_lock<std::mutex> lock( m_mutex);
+                --m_active;
+            }
+            m_condition.notify_all();
+        }
+    }
+
+    /// Returns the number of modules loaded by this job.
+    size_t get_loaded_count() const { return m_loaded_count; }
+
+    /// Adds the messages of all successful loads to \p context.
+    void add_messages( Execution_context* context) const
+    {
+        for( const auto& message: m_messages)
+            context->add_message( message);
+    }
+
+private:
+    struct Task
+    {
+        std::string name;
+        bool load;
+    };
+
+    struct Node
+    {
+        std::vector<std::string> dependents;
+        size_t pending = 0;
+        bool discovered = false;
+        bool done = false;
+        bool failed = false;
+    };
+
+    /// Creates a module cache for one discovery or load task.
+    void setup_module_cache( Module_cache& module_cache) const
+    {
+        mi::base::Handle<const mi::neuraylib::IMdl_loading_wait_handle_factory> factory(
+            m_context->get_interface_option<const mi::neuraylib::IMdl_loading_wait_handle_factory>(
+                MDL_CTX_OPTION_LOADING_WAIT_HANDLE_FACTORY));
+        if( factory)
+            module_cache.set_wait_handle_factory( factory.get());
+    }
+
+    /// Parses \p name and adds its imports to the graph.
+    void discover( const std::string& name)
+    {
+        Module_cache module_cache( m_transaction, m_wait_queue, {});
+        setup_module_cache( module_cache);
+
+        Execution_context context( *m_context);
+        mi::base::Handle<mi::mdl::IThread_context> ctx(
+            create_thread_context( m_mdl.get(), &context));
+        mi::base::Handle<const mi::mdl::IModule_imports> imports(
+            m_mdl->get_module_imports( ctx.get(), name.c_str(), &module_cache));
+
+        std::unique_lock<std::mutex> lock( m_mutex);
+
+        Node& node = m_nodes[name];
+        node.discovered = true;
+        if( !imports && name != m_top_module)
+            node.failed = true;
+        for( size_t i = 0, n = imports ? imports->get_import_count() : 0; i < n; ++i) {
+            std::string import = imports->get_import_name( i);
+
+            auto it = m_nodes.find( import);
+            if( it == m_nodes.end()) {
+                // modules already in the DB are not part of the graph
+                if( module_cache.lookup_db( import.c_str()))
+                    continue;
+                it = m_nodes.emplace( import, Node()).first;
+                m_tasks.push_back( Task{ import, /*load*/ false});
+            } else if( it->second.done) {
+                if( it->second.failed)
+                    node.failed = true;
+                continue;
+            }
+            it->second.dependents.push_back( name);
+            ++node.pending;
+        }
+        schedule( name, node);
+    }
+
+    /// Loads \p name, all its discovered imports are processed already.
+    void load( const std::string& name)
+    {
+        Module_cache module_cache( m_transaction, m_wait_queue, {});
+        setup_module_cache( module_cache);
+
+        Execution_context context( *m_context);
+        context.clear_messages();
+        context.set_result( 0);
+
+        Module_loaded_callback cb(
+            &Mdl_module::create_module_internal,
+            m_transaction,
+            m_mdl.get(),
+            &module_cache,
+            &context);
+        module_cache.set_module_loading_callback( &cb);
+
+        mi::base::Handle<mi::mdl::IThread_context> ctx(
+            create_thread_context( m_mdl.get(), &context));
+        mi::base::Handle<const mi::mdl::IModule> module(
+            m_mdl->load_module( ctx.get(), name.c_str(), &module_cache));
+
+        bool success = module && module->is_valid() && context.get_result() >= 0;
+
+        std::unique_lock<std::mutex> lock( m_mutex);
+        if( success) {
+            ++m_loaded_count;
+            for( mi::Size i = 0, n = context.get_messages_count(); i < n; ++i)
+                m_messages.push_back( context.get_message( i));
+        }
+        finish( name, !success);
+    }
+
+    /// Marks \p name as processed and schedules its dependents. Needs m_mutex.
+    void finish( const std::string& name, bool failed)
+    {
+        Node& node = m_nodes[name];
+        node.done = true;
+        node.failed = failed;
+        for( const std::string& dependent_name: node.dependents) {
+            Node& dependent = m_nodes[dependent_name];
+            if( failed)
+                dependent.failed = true;
+            --dependent.pending;
+            schedule( dependent_name, dependent);
+        }
+    }
+
+    /// Schedules \p node for loading if it is ready. Needs m_mutex.
+    void schedule( const std::string& name, Node& node)
+    {
+        if( !node.discovered || node.pending > 0 || name == m_top_module)
+            return;
+
+        if( node.failed)
+            finish( name, /*failed*/ true);
+        else
+            m_tasks.push_back( Task{ name, /*load*/ true});
+    }
+
+    DB::Transaction* m_transaction;
+    mi::base::Handle<mi::mdl::IMDL> m_mdl;
+    Mdl_module_wait_queue* m_wait_queue;
+    const Execution_context* m_context;
+    std::string m_top_module;
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<Task> m_tasks;
+    std::map<std::string, Node> m_nodes;
+    size_t m_active = 0;
+    size_t m_loaded_count = 0;
+    std::vector<Message> m_messages;
+};
+
+/// Loads the import closure of \p core_module_name in parallel, see #Import_closure_job.
+///
+/// The job is skipped if all direct imports are in the DB already. Otherwise, its number of
+/// fragments is bounded by the number of missing direct imports.
+///
+/// Returns the number of modules loaded.
+size_t load_import_closure(
+    DB::Transaction* transaction,
+    mi::mdl::IMDL* mdl,
+    Mdl_module_wait_queue* wait_queue,
+    const std::string& core_module_name,
+    Execution_context* context)
+{
+    size_t count = std::thread::hardware_concurrency();
+    if( count <= 1)
+        return 0;
+
+    Import_closure_job job( transaction, mdl, wait_queue, context, core_module_name);
+    size_t missing = job.discover_top_module();
+    if( missing == 0)
+        return 0;
+
+    transaction->execute_fragmented( &job, std::min( count, missing));
+
+    job.add_messages( context);
+    return job.get_loaded_count();
+}
+
 }  // anonymous
 
 mi::Sint32 Mdl_module::create_module(
@@ -284,6 +538,15 @@ mi::Sint32 Mdl_module::create_module(
     }
 
     Mdl_module_wait_queue* wait_queue = mdlc_module->get_module_wait_queue();
+
+    // Load the imports of the module in parallel first, the module itself is loaded below
+    if( !mdle_module && mdlc_module->get_parallel_import_loading()) {
+        size_t loaded = load_import_closure(
+            transaction, mdl.get(), wait_queue, core_load_module_arg, context);
+        LOG::mod_log->debug( M_SCENE, LOG::Mod_log::C_DATABASE,
+            "Module (imports loaded in parallel): %zu", loaded);
+    }
+
     Module_cache module_cache( transaction, wait_queue, {});
 
     // Set a custom wait handle factory if specified in the context
@@ -438,6 +701,9 @@ mi::mdl::IGenerated_code_dag* generate_dag(
     options.set_option(MDL_CG_DAG_OPTION_INCLUDE_LOCAL_ENTITIES, "true");
     // We enable unsafe math optimizations in neuray
     options.set_option(MDL_CG_DAG_OPTION_UNSAFE_MATH_OPTIMIZATIONS, "true");
+    // Most bodies are never accessed, build them on first access. The DAG retains the import
+    // entries restored below for that.
+    options.set_option(MDL_CG_DAG_OPTION_LAZY_BODIES, "true");
 
     const std::string internal_space =
         context->get_option<std::string>(MDL_CTX_OPTION_INTERNAL_SPACE);
@@ -1431,6 +1697,10 @@ bool Mdl_module::is_valid(
 
     if (is_standard_module())
         return true;
+    if (m_validity_cache.is_valid(transaction))
+        return true;
+    mi::Uint32 generation = get_validity_generation();
+
     for (const auto& import : m_imports) {
         DB::Access<Mdl_module> module(import.first, transaction);
         if (module->get_ident() != import.second) {
@@ -1448,6 +1718,8 @@ bool Mdl_module::is_valid(
             return false;
         }
     }
+
+    m_validity_cache.set_valid(transaction, generation);
     return true;
 }
 
@@ -1655,6 +1927,9 @@ mi::Sint32 Mdl_module::reload_module_internal(
     const mi::mdl::IModule* module,
     Execution_context* context)
 {
+    // reloading changes the identifier of this module
+    bump_validity_generation();
+
     // check imports
     //
     // This should use the DAG imports to avoid missing additional imports that might occur, e.g.
@@ -2378,6 +2378,40 @@ Mdl_compiled_material* get_default_compiled_material( DB::Transaction* transacti
     return cm;
 }
 
+namespace {
+
+/// The validity generation, see get_validity_generation(). Starts at 1, such that a valid stamp
+/// in Validity_cache is never 0.
+std::atomic<mi::Uint32> g_validity_generation( 1);
+
+mi::Uint64 get_validity_stamp( DB::Transaction* transaction, mi::Uint32 generation)
+{
+    return (static_cast<mi::Uint64>( generation) << 32) | transaction->get_id().get_uint();
+}
+
+} // namespace
+
+mi::Uint32 get_validity_generation()
+{
+    return g_validity_generation;
+}
+
+void bump_validity_generation()
+{
+    if( ++g_validity_generation == 0)
+        ++g_validity_generation;
+}
+
+bool Validity_cache::is_valid( DB::Transaction* transaction) const
+{
+    return m_stamp == get_validity_stamp( transaction, g_validity_generation);
+}
+
+void Validity_cache::set_valid( DB::Transaction* transaction, mi::Uint32 generation) const
+{
+    m_stamp = get_validity_stamp( transaction, generation);
+}
+
 std::string get_mdl_module_name( const IType* type)
 {
     IType::Kind kind = type->get_kind();
@@ -5842,6 +5876,13 @@ void Resource_updater::update_resource_literals()
             update_resource_literals( parameter_default);
         }
 
+        // traverse the declaration if the body is built on first access, building it here
+        // would defeat the purpose
+        if( m_code_dag->is_material_value_pending( i)) {
+            update_resource_literals( m_code_dag->get_material_name( i));
+            continue;
+        }
+
         // traverse body
         const mi::mdl::DAG_node* body = m_code_dag->get_material_value( i);
         update_resource_literals( body);
@@ -5900,24 +5941,32 @@ void Resource_updater::update_resource_literals( const mi::mdl::DAG_node* node)
             if( call->get_semantic() != mi::mdl::IDefinition::DS_UNKNOWN)
                 return;
 
-            const char* signature = nullptr;
-            mi::base::Handle<const mi::mdl::IModule> owner;
+            update_resource_literals( call->get_name());
+            return;
+        }
+    }
+}
 
-            {
-                std::unique_lock<std::mutex> lock( DETAIL::g_transaction_mutex);
-                signature = call->get_name();
-                owner = m_resolver.get_owner_module( signature);
-                if( !owner)
-                    return;
-            }
+void Resource_updater::update_resource_literals( const char* signature)
+{
+    mi::base::Handle<const mi::mdl::IModule> owner;
 
-            const mi::mdl::Module* owner_impl = mi::mdl::impl_cast<mi::mdl::Module>( owner.get());
-            const mi::mdl::IDefinition* def
-                = owner_impl->find_signature( signature, /*only_exported*/ false);
-            update_resource_literals( owner_impl, def);
+    {
+        std::unique_lock<std::mutex> lock( DETAIL::g_transaction_mutex);
+        owner = m_resolver.get_owner_module( signature);
+        if( !owner)
             return;
-        }
     }
+
+    const mi::mdl::Module* owner_impl = mi::mdl::impl_cast<mi::mdl::Module>( owner.get());
+    const mi::mdl::IDefinition* def
+        = owner_impl->find_signature( signature, /*only_exported*/ false);
+    if( !def)
+        return;
+
+    // traverse the declaration in the module that contains it, e.g., for re-exported entities
+    mi::base::Handle<const mi::mdl::IModule> orig_owner( owner_impl->get_owner_module( def));
+    update_resource_literals( orig_owner.get(), owner_impl->get_original_definition( def));
 }
 
 void Resource_updater::update_resource_literals(
@@ -7862,6 +7911,7 @@ Execution_context::Execution_context( bool add_defaults)
     ADD3( MDL_CTX_OPTION_TARGET_MATERIAL_MODEL_MODE, false, false);
     ADD3( MDL_CTX_OPTION_KEEP_ORIGINAL_RESOURCE_FILE_PATHS, false, false);
     ADD3( MDL_CTX_OPTION_USER_DATA, empty_handle, true);
+    ADD3( MDL_CTX_OPTION_USE_COMPILED_MATERIAL_CACHE, false, false);
 
 #undef ADD3
 #undef ADD4
@@ -809,6 +809,7 @@ public:
 
 private:
     void update_resource_literals( const mi::mdl::DAG_node* node);
+    void update_resource_literals( const char* signature);
     void update_resource_literals( const mi::mdl::IModule* owner, const mi::mdl::IDefinition* def);
     void update_resource_literals( const mi::mdl::IDefinition* def);
     void update_resource_literals( const mi::mdl::IValue_resource* resource);
@@ -38,7 +38,14 @@
 #include <base/system/test/i_test_auto_driver.h>
 #include <base/system/test/i_test_auto_case.h>
 
+#include <algorithm>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 #include <tuple>
+#include <vector>
+
+#include <boost/filesystem.hpp>
 
 #include "i_mdl_elements_compiled_material.h"
 #include "i_mdl_elements_function_call.h"
@@ -51,14 +58,18 @@
 
 #include <mi/base/handle.h>
 #include <mi/neuraylib/istring.h>
+#include <mi/mdl/mdl_code_generators.h>
+#include <mi/mdl/mdl_generated_dag.h>
 #include <mi/mdl/mdl_mdl.h>
 #include <mi/mdl/mdl_modules.h>
+#include <mi/mdl/mdl_printers.h>
 #include <mi/mdl/mdl_distiller_rules.h>
 #include <base/hal/hal/i_hal_ospath.h>
 #include <base/hal/time/i_time.h>
 #include <base/hal/thread/i_thread_thread.h>
 #include <base/hal/thread/i_thread_condition.h>
 #include <base/lib/config/config.h>
+#include <base/lib/log/i_log_logger.h>
 #include <base/lib/log/i_log_target.h>
 #include <base/lib/path/i_path.h>
 #include <base/lib/plug/i_plug.h>
@@ -66,7 +77,13 @@
 #include <base/data/db/i_db_database.h>
 #include <base/data/db/i_db_scope.h>
 #include <base/data/db/i_db_transaction.h>
+#include <mdl/compiler/compilercore/compilercore_allocator.h>
 #include <mdl/compiler/compilercore/compilercore_comparator.h>
+#include <mdl/compiler/compilercore/compilercore_search_path_index.h>
+#include <mdl/compiler/compilercore/compilercore_serializer.h>
+#include <mdl/compiler/compilercore/compilercore_streams.h>
+#include <mdl/compiler/compilercore/compilercore_tools.h>
+#include <mdl/integration/mdlnr/i_mdlnr.h>
 #include <io/scene/bsdf_measurement/i_bsdf_measurement.h>
 #include <io/scene/dbimage/i_dbimage.h>
 #include <io/scene/lightprofile/i_lightprofile.h>
@@ -75,6 +92,8 @@
 
 using namespace MI;
 
+namespace fs = boost::filesystem;
+
 #undef MI_CHECK_CTX
 #undef MI_CHECK_CTX_RESULT
 
@@ -528,6 +547,566 @@ void test_resources_and_hashes_modify_image( DB::Transaction* transaction,
     MI_CHECK( hash_cc == hash_cc2);
 }
 
+// Check that the compiled material cache serves repeated compilations and takes edits of
+// referenced DB elements into account.
+void test_compiled_material_cache( DB::Transaction* transaction)
+{
+    SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+    DB::Tag mi_tag = transaction->name_to_tag( "mdl::mdl_elements::test_misc::mi_textured");
+
+    MDL::Execution_context context;
+    context.set_option( MDL_CTX_OPTION_USE_COMPILED_MATERIAL_CACHE, true);
+
+    mi::Size hits = mdlc_module->get_compiled_material_cache_statistic( "hits");
+    mi::Size misses = mdlc_module->get_compiled_material_cache_statistic( "misses");
+
+    mi::base::Uuid hash_ic, hash_cc;
+    get_hash_values( transaction, mi_tag, hash_ic, hash_cc, &context);
+    MI_CHECK_EQUAL( hits, mdlc_module->get_compiled_material_cache_statistic( "hits"));
+    MI_CHECK_EQUAL( misses + 2, mdlc_module->get_compiled_material_cache_statistic( "misses"));
+
+    // unchanged material instance
+    mi::base::Uuid hash_ic2, hash_cc2;
+    get_hash_values( transaction, mi_tag, hash_ic2, hash_cc2, &context);
+    MI_CHECK( hash_ic == hash_ic2);
+    MI_CHECK( hash_cc == hash_cc2);
+    MI_CHECK_EQUAL( hits + 2, mdlc_module->get_compiled_material_cache_statistic( "hits"));
+    MI_CHECK_EQUAL( misses + 2, mdlc_module->get_compiled_material_cache_statistic( "misses"));
+
+    // edit texture to modify gamma
+    {
+        DB::Access<MDL::Mdl_function_call> mi( mi_tag, transaction);
+        mi::base::Handle<const MDL::IExpression_list> arguments( mi->get_arguments());
+        mi::base::Handle<const MDL::IExpression> argument( arguments->get_expression( "t"));
+        mi::base::Handle<const MDL::IExpression_constant> argument_constant(
+            argument->get_interface<MDL::IExpression_constant>());
+        mi::base::Handle<const MDL::IValue_texture> value(
+            argument_constant->get_value<MDL::IValue_texture>());
+        DB::Edit<TEXTURE::Texture> texture( value->get_value(), transaction);
+        texture->set_gamma( texture->get_gamma() + 1.0f);
+    }
+
+    mi::base::Uuid hash_ic3, hash_cc3;
+    get_hash_values( transaction, mi_tag, hash_ic3, hash_cc3, &context);
+    MI_CHECK( hash_ic != hash_ic3);
+    MI_CHECK( hash_cc == hash_cc3);
+    MI_CHECK_EQUAL( hits + 2, mdlc_module->get_compiled_material_cache_statistic( "hits"));
+    MI_CHECK_EQUAL( misses + 4, mdlc_module->get_compiled_material_cache_statistic( "misses"));
+}
+
+void create_function_call(
+    DB::Transaction* transaction, const char* definition_name, const char* call_name)
+{
+    DB::Tag tag = transaction->name_to_tag( definition_name);
+    DB::Access<MDL::Mdl_function_definition> fd( tag, transaction);
+    MDL::Mdl_function_call* fc = fd->create_function_call( transaction, nullptr);
+    MI_CHECK( fc);
+    transaction->store( fc, call_name, 255);
+}
+
+// Check that validity checks are cached, that only edits of the call graph invalidate them, and that
+// a cached result flips after edits of nested calls, module reloads, and repairs.
+void test_validity_cache( DB::Transaction* transaction)
+{
+    DB::Tag mi_tag = transaction->name_to_tag( "mdl::mdl_elements::test_misc::mi_textured");
+    MDL::Execution_context context;
+
+    DB::Access<MDL::Mdl_function_call> mi( mi_tag, transaction);
+    MI_CHECK( mi->is_valid( transaction, &context));
+    mi::Uint32 generation = MDL::get_validity_generation();
+    MI_CHECK( mi->is_valid( transaction, &context));
+    MI_CHECK_EQUAL( generation, MDL::get_validity_generation());
+
+    // resetting a constant argument keeps the call graph unchanged
+    {
+        DB::Edit<MDL::Mdl_function_call> mi_edit( mi_tag, transaction);
+        MI_CHECK_EQUAL( 0, mi_edit->reset_argument( transaction, "t"));
+    }
+    MI_CHECK_EQUAL( generation, MDL::get_validity_generation());
+
+    DB::Access<MDL::Mdl_function_call> mi2( mi_tag, transaction);
+    MI_CHECK( mi2->is_valid( transaction, &context));
+
+    // explicit invalidation forces a full check which still succeeds
+    MDL::bump_validity_generation();
+    MI_CHECK( generation != MDL::get_validity_generation());
+    MI_CHECK( mi2->is_valid( transaction, &context));
+
+    // Set up a module from string with two calls, where "outer" uses "inner" as argument.
+    mi::base::Handle<mi::neuraylib::IReader> reader(
+        MDL::create_reader( "mdl 1.6; export int f(int a = 1) { return a; }"));
+    MI_CHECK_EQUAL( 0, MDL::Mdl_module::create_module(
+        transaction, "::test_validity_cache", reader.get(), &context));
+    create_function_call( transaction, "mdl::test_validity_cache::f(int)", "vc_inner");
+    create_function_call( transaction, "mdl::test_validity_cache::f(int)", "vc_outer");
+    DB::Tag inner_tag = transaction->name_to_tag( "vc_inner");
+    DB::Tag outer_tag = transaction->name_to_tag( "vc_outer");
+
+    mi::base::Handle<MDL::IExpression_factory> ef( MDL::get_expression_factory());
+    mi::base::Handle<const MDL::IType> type_int;
+    {
+        DB::Access<MDL::Mdl_function_call> inner( inner_tag, transaction);
+        type_int = inner->get_return_type();
+    }
+    mi::base::Handle<MDL::IExpression> inner_expr( ef->create_call( type_int.get(), inner_tag));
+    mi::base::Handle<MDL::IExpression> outer_expr( ef->create_call( type_int.get(), outer_tag));
+    {
+        DB::Edit<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK_EQUAL( 0, outer->set_argument( transaction, "a", inner_expr.get()));
+    }
+    {
+        DB::Access<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK( outer->is_valid( transaction, &context));
+        MI_CHECK( outer->is_valid( transaction, &context));
+    }
+
+    // set_argument() on the nested call creates a cycle, the cached result of "outer" flips
+    generation = MDL::get_validity_generation();
+    {
+        DB::Edit<MDL::Mdl_function_call> inner( inner_tag, transaction);
+        MI_CHECK_EQUAL( 0, inner->set_argument( transaction, "a", outer_expr.get()));
+    }
+    MI_CHECK( generation != MDL::get_validity_generation());
+    {
+        DB::Access<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK( !outer->is_valid( transaction, &context));
+    }
+
+    // reset_argument() on the nested call removes the cycle again
+    generation = MDL::get_validity_generation();
+    {
+        DB::Edit<MDL::Mdl_function_call> inner( inner_tag, transaction);
+        MI_CHECK_EQUAL( 0, inner->reset_argument( transaction, "a"));
+    }
+    MI_CHECK( generation != MDL::get_validity_generation());
+    {
+        DB::Access<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK( outer->is_valid( transaction, &context));
+        MI_CHECK( outer->is_valid( transaction, &context));
+    }
+
+    // reloading the module with a changed default changes the definition identifier, the cached
+    // result of "outer" flips
+    generation = MDL::get_validity_generation();
+    {
+        reader = MDL::create_reader( "mdl 1.6; export int f(int a = 2) { return a; }");
+        DB::Edit<MDL::Mdl_module> module(
+            transaction->name_to_tag( "mdl::test_validity_cache"), transaction);
+        MI_CHECK_EQUAL( 0, module->reload_from_string(
+            transaction, reader.get(), /*recursive*/ false, &context));
+    }
+    MI_CHECK( generation != MDL::get_validity_generation());
+    {
+        DB::Access<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK( !outer->is_valid( transaction, &context));
+        DB::Access<MDL::Mdl_function_call> inner( inner_tag, transaction);
+        MI_CHECK( !inner->is_valid( transaction, &context));
+    }
+
+    // repair() promotes both calls to the new definition, the cached result flips back
+    context.clear_messages();
+    for( DB::Tag tag: { inner_tag, outer_tag}) {
+        generation = MDL::get_validity_generation();
+        DB::Edit<MDL::Mdl_function_call> call( tag, transaction);
+        MI_CHECK_EQUAL( 0, call->repair(
+            transaction, /*repair_invalid_calls*/ false, /*remove_invalid_calls*/ false,
+            /*level*/ 0, &context));
+        MI_CHECK( generation != MDL::get_validity_generation());
+    }
+    {
+        DB::Access<MDL::Mdl_function_call> outer( outer_tag, transaction);
+        MI_CHECK( outer->is_valid( transaction, &context));
+    }
+}
+
+// Writes \p data to the file \p path and sets its modification time to \p mtime.
+void write_file_with_mtime( const fs::path& path, const std::string& data, time_t mtime)
+{
+    {
+        std::ofstream file( path.string(), std::ios::binary | std::ios::trunc);
+        file << data;
+    }
+    fs::last_write_time( path, mtime);
+}
+
+// Check archive contents and masks, and when the search path index rereads cached data.
+void test_search_path_index()
+{
+    SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+    mi::base::Handle<mi::mdl::IMDL> mdl( mdlc_module->get_mdl());
+    mi::base::Handle<mi::base::IAllocator> alloc( mdl->get_mdl_allocator());
+    mi::mdl::Search_path_index index( alloc.get());
+
+    fs::path dir = fs::path( "data") / "search_path_index";
+    fs::remove_all( dir);
+    fs::create_directories( dir);
+    std::string dir_name = dir.string();
+    std::string archive = (dir / "test_archives.mdr").string();
+
+    // An archive and a variant of the same size with a renamed entry.
+    std::string original;
+    {
+        std::ifstream file(
+            TEST::mi_src_path( "io/scene/mdl_elements/test_archives.mdr"), std::ios::binary);
+        std::ostringstream ss;
+        ss << file.rdbuf();
+        original = ss.str();
+    }
+    std::string renamed = original;
+    for( size_t pos = renamed.find( "test_in_archive.png"); pos != std::string::npos;
+         pos = renamed.find( "test_in_archive.png", pos))
+        renamed.replace( pos + 16, 3, "jpg");
+    MI_CHECK_EQUAL( renamed.size(), original.size());
+    MI_CHECK( renamed != original);
+
+    time_t past   = time( nullptr) - 100;
+    time_t future = time( nullptr) + 100;
+    write_file_with_mtime( archive, original, past);
+    fs::last_write_time( dir, past);
+
+    bool opened = false;
+    mi::mdl::MDL_zip_container_error_code err = mi::mdl::EC_OK;
+    auto contains = [&]( const char* name, bool is_mask) {
+        return index.archive_contains( archive.c_str(), name, is_mask, opened, err);
+    };
+
+    // directory listing
+    mi::mdl::vector<mi::mdl::string>::Type archives( alloc.get());
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 1);
+    MI_CHECK_EQUAL( std::string( archives[0].c_str()), "test_archives.mdr");
+    MI_CHECK( !index.get_archives( (dir / "missing").string().c_str(), archives));
+    MI_CHECK( archives.empty());
+
+    // archive contents and masks
+    MI_CHECK( contains( "test_archives.mdl", false));
+    MI_CHECK( opened);
+    MI_CHECK( contains( "test_archives/test_in_archive.png", false));
+    MI_CHECK( !contains( "test_archives/test_in_archive.jpg", false));
+    MI_CHECK( !contains( "test_archives/test_in_archive", false));
+    MI_CHECK( contains( "test_archives/test_in_archive-?.png", true));
+    MI_CHECK( !contains( "test_archives/test_in_archive-?.jpg", true));
+    MI_CHECK( !index.archive_contains(
+        (dir / "missing.mdr").string().c_str(), "test_archives.mdl", false, opened, err));
+    MI_CHECK( !opened);
+    MI_CHECK_EQUAL( err, mi::mdl::EC_CONTAINER_NOT_EXIST);
+
+    // An archive with unchanged size and modification time is served from the cache ...
+    write_file_with_mtime( archive, renamed, past);
+    MI_CHECK( contains( "test_archives/test_in_archive.png", false));
+    MI_CHECK( opened);
+
+    // ... but reread after its modification time changed.
+    fs::last_write_time( archive, past + 1);
+    MI_CHECK( contains( "test_archives/test_in_archive.jpg", false));
+    MI_CHECK( !contains( "test_archives/test_in_archive.png", false));
+
+    // Data read in the same second the archive was modified is reread, even if neither size nor
+    // modification time change. A modification time in the future simulates this reliably.
+    write_file_with_mtime( archive, original, future);
+    MI_CHECK( contains( "test_archives/test_in_archive.png", false));
+    write_file_with_mtime( archive, renamed, future);
+    MI_CHECK( contains( "test_archives/test_in_archive.jpg", false));
+
+    // A new archive in an unchanged directory is not seen ...
+    write_file_with_mtime( dir / "other.mdr", original, past);
+    fs::last_write_time( dir, past);
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 1);
+
+    // ... until the modification time of the directory changes ...
+    fs::last_write_time( dir, past + 1);
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 2);
+
+    // ... or the index is invalidated.
+    write_file_with_mtime( dir / "third.mdr", original, past);
+    fs::last_write_time( dir, past + 1);
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 2);
+    index.invalidate();
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 3);
+
+    // Same-second rule for directories.
+    fs::last_write_time( dir, future);
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 3);
+    fs::remove( dir / "third.mdr");
+    fs::last_write_time( dir, future);
+    MI_CHECK( index.get_archives( dir_name.c_str(), archives));
+    MI_CHECK_EQUAL( archives.size(), 2);
+
+    fs::remove_all( dir);
+}
+
+// Returns \p value printed by the MDL printer.
+std::string print_value( mi::mdl::IMDL* mdl, const mi::mdl::IValue* value)
+{
+    mi::base::Handle<mi::base::IAllocator> alloc( mdl->get_mdl_allocator());
+    mi::mdl::Allocator_builder builder( alloc.get());
+    mi::base::Handle<mi::mdl::Buffer_output_stream> stream(
+        builder.create<mi::mdl::Buffer_output_stream>( alloc.get()));
+    mi::base::Handle<mi::mdl::IPrinter> printer( mdl->create_printer( stream.get()));
+    printer->print( value);
+    return std::string( stream->get_data(), stream->get_data_size());
+}
+
+// Indicates whether the DAG node factory might have swapped the arguments of \p call. Their order
+// depends on the node IDs then, which differ between DAGs.
+bool is_symmetric_call( const mi::mdl::DAG_call* call)
+{
+    mi::mdl::IDefinition::Semantics sema = call->get_semantic();
+    if( sema < mi::mdl::IDefinition::DS_OP_BASE || sema > mi::mdl::IDefinition::DS_OP_END)
+        return false;
+    if( call->get_argument_count() != 2)
+        return false;
+    const mi::mdl::IType* type = call->get_argument( 0)->get_type()->skip_type_alias();
+    if( type != call->get_argument( 1)->get_type()->skip_type_alias())
+        return false;
+    if( mi::mdl::is<mi::mdl::IType_matrix>( type))
+        return false;
+
+    switch( mi::mdl::semantic_to_operator( sema)) {
+        case mi::mdl::IExpression::OK_MULTIPLY:
+        case mi::mdl::IExpression::OK_PLUS:
+        case mi::mdl::IExpression::OK_EQUAL:
+        case mi::mdl::IExpression::OK_NOT_EQUAL:
+        case mi::mdl::IExpression::OK_BITWISE_AND:
+        case mi::mdl::IExpression::OK_BITWISE_XOR:
+        case mi::mdl::IExpression::OK_BITWISE_OR:
+        case mi::mdl::IExpression::OK_LOGICAL_AND:
+        case mi::mdl::IExpression::OK_LOGICAL_OR:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Returns the DAG IR node \p node with its arguments in a form suitable for comparisons.
+std::string print_dag_node( mi::mdl::IMDL* mdl, const mi::mdl::DAG_node* node)
+{
+    if( !node)
+        return "<null>";
+
+    switch( node->get_kind()) {
+        case mi::mdl::DAG_node::EK_CONSTANT:
+            return print_value( mdl, mi::mdl::cast<mi::mdl::DAG_constant>( node)->get_value());
+        case mi::mdl::DAG_node::EK_TEMPORARY:
+            return "t" + std::to_string(
+                mi::mdl::cast<mi::mdl::DAG_temporary>( node)->get_index());
+        case mi::mdl::DAG_node::EK_PARAMETER:
+            return "p" + std::to_string(
+                mi::mdl::cast<mi::mdl::DAG_parameter>( node)->get_index());
+        case mi::mdl::DAG_node::EK_CALL: {
+            const mi::mdl::DAG_call* call = mi::mdl::cast<mi::mdl::DAG_call>( node);
+            std::vector<std::string> arguments;
+            for( int i = 0, n = call->get_argument_count(); i < n; ++i)
+                arguments.push_back( print_dag_node( mdl, call->get_argument( i)));
+            if( is_symmetric_call( call))
+                std::sort( arguments.begin(), arguments.end());
+
+            std::string result = std::string( call->get_name()) + "(";
+            for( size_t i = 0; i < arguments.size(); ++i)
+                result += (i > 0 ? ", " : "") + arguments[i];
+            return result + ")";
+        }
+    }
+    return "<invalid>";
+}
+
+// Returns the temporaries and the body of the material or function \p index of \p dag. The
+// temporaries are accessed first.
+std::string print_body(
+    mi::mdl::IMDL* mdl, const mi::mdl::IGenerated_code_dag* dag, size_t index, bool is_material)
+{
+    std::string result;
+    size_t n = is_material
+        ? dag->get_material_temporary_count( index) : dag->get_function_temporary_count( index);
+    for( size_t i = 0; i < n; ++i) {
+        const char* name = is_material
+            ? dag->get_material_temporary_name( index, i)
+            : dag->get_function_temporary_name( index, i);
+        const mi::mdl::DAG_node* temporary = is_material
+            ? dag->get_material_temporary( index, i) : dag->get_function_temporary( index, i);
+        result += std::string( name ? name : "<unnamed>") + " = ";
+        result += print_dag_node( mdl, temporary) + "\n";
+    }
+    const mi::mdl::DAG_node* body = is_material
+        ? dag->get_material_value( index) : dag->get_function_body( index);
+    return result + print_dag_node( mdl, body);
+}
+
+// Serializes \p dag, and returns the deserialized copy.
+const mi::mdl::IGenerated_code_dag* serialize_and_deserialize_code_dag(
+    mi::mdl::IMDL* mdl, const mi::mdl::IGenerated_code_dag* dag)
+{
+    mi::base::Handle<mi::base::IAllocator> alloc( mdl->get_mdl_allocator());
+    mi::mdl::Buffer_serializer serializer( alloc.get());
+    mdl->serialize_code_dag( dag, &serializer);
+
+    mi::mdl::Buffer_deserializer deserializer(
+        alloc.get(), serializer.get_data(), serializer.get_size());
+    return mdl->deserialize_code_dag( &deserializer);
+}
+
+// Compiles \p module into a DAG like the MDL integration does, with or without lazily built
+// bodies.
+const mi::mdl::IGenerated_code_dag* compile_code_dag(
+    mi::mdl::IMDL* mdl, const mi::mdl::IModule* module, bool lazy_bodies)
+{
+    mi::base::Handle<mi::mdl::ICode_generator_dag> generator_dag
+        = mi::base::make_handle( mdl->load_code_generator( "dag"))
+        .get_interface<mi::mdl::ICode_generator_dag>();
+
+    mi::mdl::Options& options = generator_dag->access_options();
+    options.set_option( MDL_CG_DAG_OPTION_NO_LOCAL_FUNC_CALLS, "false");
+    options.set_option( MDL_CG_DAG_OPTION_INCLUDE_LOCAL_ENTITIES, "true");
+    options.set_option( MDL_CG_DAG_OPTION_UNSAFE_MATH_OPTIMIZATIONS, "true");
+    options.set_option( MDL_CG_DAG_OPTION_LAZY_BODIES, lazy_bodies ? "true" : "false");
+
+    mi::base::Handle<mi::mdl::IGenerated_code> code( generator_dag->compile( module));
+    return code->get_interface<mi::mdl::IGenerated_code_dag>();
+}
+
+// Checks that the bodies and temporaries of \p dag match the ones of \p expected.
+void check_bodies(
+    mi::mdl::IMDL* mdl,
+    const mi::mdl::IGenerated_code_dag* expected,
+    const mi::mdl::IGenerated_code_dag* dag)
+{
+    // Access in reverse order, and functions through their body first.
+    size_t material_count = expected->get_material_count();
+    MI_CHECK_EQUAL( material_count, dag->get_material_count());
+    for( size_t i = material_count; i-- > 0; ) {
+        MI_CHECK_EQUAL_CSTR( expected->get_material_name( i), dag->get_material_name( i));
+        MI_CHECK( dag->get_material_value( i));
+        MI_CHECK_EQUAL(
+            print_body( mdl, expected, i, true), print_body( mdl, dag, i, true));
+    }
+
+    size_t function_count = expected->get_function_count();
+    MI_CHECK_EQUAL( function_count, dag->get_function_count());
+    for( size_t i = function_count; i-- > 0; ) {
+        MI_CHECK_EQUAL_CSTR( expected->get_function_name( i), dag->get_function_name( i));
+        MI_CHECK_EQUAL(
+            print_dag_node( mdl, expected->get_function_body( i)),
+            print_dag_node( mdl, dag->get_function_body( i)));
+        MI_CHECK_EQUAL(
+            print_body( mdl, expected, i, false), print_body( mdl, dag, i, false));
+    }
+}
+
+// Returns the number of material and function bodies of \p dag which are not built yet.
+size_t count_pending_bodies( const mi::mdl::IGenerated_code_dag* dag)
+{
+    size_t result = 0;
+    for( size_t i = 0, n = dag->get_material_count(); i < n; ++i)
+        result += dag->is_material_value_pending( i) ? 1 : 0;
+    for( size_t i = 0, n = dag->get_function_count(); i < n; ++i)
+        result += dag->is_function_body_pending( i) ? 1 : 0;
+    return result;
+}
+
+// Checks that a DAG with lazily built bodies matches the DAG compiled eagerly.
+void check_lazy_bodies( mi::mdl::IMDL* mdl, const mi::mdl::IModule* module)
+{
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> eager(
+        compile_code_dag( mdl, module, /*lazy_bodies*/ false));
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> lazy(
+        compile_code_dag( mdl, module, /*lazy_bodies*/ true));
+    MI_CHECK( eager->is_valid());
+    MI_CHECK( lazy->is_valid());
+    MI_CHECK_NOT_EQUAL( 0, count_pending_bodies( lazy.get()));
+    MI_CHECK_EQUAL( 0, count_pending_bodies( eager.get()));
+
+    check_bodies( mdl, eager.get(), lazy.get());
+    MI_CHECK_EQUAL( 0, count_pending_bodies( lazy.get()));
+    MI_CHECK_EQUAL( 0, lazy->access_messages().get_error_message_count());
+
+    // Serialization builds all pending bodies. The data itself differs from the eager DAG since
+    // nodes are shared differently, hence compare the deserialized DAGs.
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> lazy2(
+        compile_code_dag( mdl, module, /*lazy_bodies*/ true));
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> eager_copy(
+        serialize_and_deserialize_code_dag( mdl, eager.get()));
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> lazy_copy(
+        serialize_and_deserialize_code_dag( mdl, lazy2.get()));
+    check_bodies( mdl, eager.get(), eager_copy.get());
+    check_bodies( mdl, eager.get(), lazy_copy.get());
+}
+
+// Check that lazily built DAG bodies match eagerly built ones.
+void test_lazy_bodies( DB::Transaction* transaction)
+{
+    SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+    mi::base::Handle<mi::mdl::IMDL> mdl( mdlc_module->get_mdl());
+
+    for( const char* name: { "mdl::mdl_elements::test_misc", "mdl::nvidia::core_definitions"}) {
+        DB::Tag tag = transaction->name_to_tag( name);
+        DB::Access<MDL::Mdl_module> module( tag, transaction);
+        mi::base::Handle<const mi::mdl::IModule> mdl_module( module->get_mdl_module());
+
+        // lazily built bodies need the import entries
+        MDL::Module_cache module_cache( transaction, mdlc_module->get_module_wait_queue(), {});
+        MI_CHECK( mdl_module->restore_import_entries( &module_cache));
+        check_lazy_bodies( mdl.get(), mdl_module.get());
+        mdl_module->drop_import_entries();
+    }
+
+    // The MDL integration compiles with lazily built bodies, most bodies of a catalog module are
+    // never accessed.
+    DB::Tag tag = transaction->name_to_tag( "mdl::nvidia::core_definitions");
+    DB::Access<MDL::Mdl_module> module( tag, transaction);
+    mi::base::Handle<const mi::mdl::IGenerated_code_dag> code_dag( module->get_code_dag());
+    MI_CHECK_NOT_EQUAL( 0, count_pending_bodies( code_dag.get()));
+}
+
+/// Compares the time to compile a catalog module into a DAG, and the memory used by the DAG,
+/// for eagerly and lazily built bodies. For lazily built bodies, the memory is also measured after
+/// all bodies have been built.
+///
+/// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_lazy_bodies( DB::Transaction* transaction)
+{
+    const int iterations = 20;
+
+    SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+    mi::base::Handle<mi::mdl::IMDL> mdl( mdlc_module->get_mdl());
+
+    DB::Tag tag = transaction->name_to_tag( "mdl::nvidia::core_definitions");
+    DB::Access<MDL::Mdl_module> module( tag, transaction);
+    mi::base::Handle<const mi::mdl::IModule> mdl_module( module->get_mdl_module());
+
+    MDL::Module_cache module_cache( transaction, mdlc_module->get_module_wait_queue(), {});
+    MI_CHECK( mdl_module->restore_import_entries( &module_cache));
+
+    for( bool lazy_bodies: { false, true}) {
+        size_t memory_size = 0;
+        TIME::Time start = TIME::get_time();
+        for( int i = 0; i < iterations; ++i) {
+            mi::base::Handle<const mi::mdl::IGenerated_code_dag> dag(
+                compile_code_dag( mdl.get(), mdl_module.get(), lazy_bodies));
+            memory_size = dag->get_memory_size();
+        }
+        double compile_time = (TIME::get_time() - start).get_seconds() / iterations;
+
+        mi::base::Handle<const mi::mdl::IGenerated_code_dag> dag(
+            compile_code_dag( mdl.get(), mdl_module.get(), lazy_bodies));
+        for( size_t i = 0, n = dag->get_material_count(); i < n; ++i)
+            dag->get_material_value( i);
+        for( size_t i = 0, n = dag->get_function_count(); i < n; ++i)
+            dag->get_function_body( i);
+
+        LOG::mod_log->info( M_SCENE, LOG::Mod_log::C_DATABASE,
+            "Benchmark %-5s bodies: %7.2f ms per compilation, %9zu bytes, %9zu bytes with all "
+            "bodies", lazy_bodies ? "lazy" : "eager", 1000.0 * compile_time, memory_size,
+            dag->get_memory_size());
+    }
+
+    mdl_module->drop_import_entries();
+}
+
 void test_module_names( DB::Transaction* transaction, MDL::Execution_context* context)
 {
     // check forbidden module names
@@ -2070,16 +2649,6 @@ void test_module_pointers( DB::Database* database, DB::Scope* scope)
     delete[] threads;
 }
 
-void create_function_call(
-    DB::Transaction* transaction, const char* definition_name, const char* call_name)
-{
-    DB::Tag tag = transaction->name_to_tag( definition_name);
-    DB::Access<MDL::Mdl_function_definition> fd( tag, transaction);
-    MDL::Mdl_function_call* fc = fd->create_function_call( transaction, nullptr);
-    MI_CHECK( fc);
-    transaction->store( fc, call_name, 255);
-}
-
 void test_main( DB::Scope* global_scope)
 {
     MDL::Execution_context context;
@@ -2146,8 +2715,13 @@ void test_main( DB::Scope* global_scope)
     test_resources_and_hashes_modify_texture( transaction, &context);
     test_resources_and_hashes_modify_image( transaction, &context);
 
+    test_compiled_material_cache( transaction);
+    test_validity_cache( transaction);
+
     test_module_names( transaction, &context);
 
+    test_search_path_index();
+
     SYSTEM::Access_module<PATH::Path_module> path_module( false);
     std::string path = TEST::mi_src_path( "io/scene/mdl_elements");
     MI_CHECK_EQUAL( 0, path_module->add_path( PATH::MDL, path));
@@ -2166,6 +2740,10 @@ void test_main( DB::Scope* global_scope)
 
     test_module_comparator( transaction, &context);
 
+    test_lazy_bodies( transaction);
+    if( getenv( "MI_TEST_RUN_BENCHMARKS"))
+        benchmark_lazy_bodies( transaction);
+
     test_create_value_with_range_annotation( transaction, &context);
 
     test_factory_compare_deep_call_comparisons( transaction, &context);
@@ -2178,6 +2756,70 @@ void test_main( DB::Scope* global_scope)
     transaction->commit();
 }
 
+// Appends the DB name of the module \p db_name, the DB names of its imports and definitions, and
+// whether these definitions are in the DB to \p contents.
+void append_module_contents(
+    DB::Transaction* transaction, const char* db_name, std::vector<std::string>& contents)
+{
+    DB::Tag tag = transaction->name_to_tag( db_name);
+    MI_CHECK( tag);
+    if( !tag)
+        return;
+
+    DB::Access<MDL::Mdl_module> module( tag, transaction);
+    contents.push_back( db_name);
+    for( mi::Size i = 0, n = module->get_import_count(); i < n; ++i)
+        contents.push_back( transaction->tag_to_name( module->get_import( i)));
+    for( mi::Size i = 0, n = module->get_function_count(); i < n; ++i) {
+        const char* name = module->get_function_name( transaction, i);
+        contents.push_back( name);
+        contents.push_back( transaction->name_to_tag( name) ? "in DB" : "missing");
+    }
+    for( mi::Size i = 0, n = module->get_material_count(); i < n; ++i) {
+        const char* name = module->get_material_name( transaction, i);
+        contents.push_back( name);
+        contents.push_back( transaction->name_to_tag( name) ? "in DB" : "missing");
+    }
+}
+
+// Loads a module with a diamond-shaped import graph with and without loading its imports in
+// parallel first, and checks that both loads create the same DB elements.
+void test_import_closure( DB::Scope* global_scope)
+{
+    SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module( false);
+
+    const char* modules[] = {
+        "mdl::mdl_elements::test_import_closure",
+        "mdl::mdl_elements::test_import_closure_a",
+        "mdl::mdl_elements::test_import_closure_b",
+        "mdl::mdl_elements::test_import_closure_c"
+    };
+
+    std::vector<std::string> contents[2];
+    for( int parallel = 0; parallel < 2; ++parallel) {
+
+        mdlc_module->set_parallel_import_loading( parallel != 0);
+
+        DB::Transaction* transaction = global_scope->start_transaction();
+        MDL::Execution_context context;
+        mi::Sint32 result = MDL::Mdl_module::create_module(
+            transaction, "::mdl_elements::test_import_closure", &context);
+        MI_CHECK_EQUAL( 0, result);
+        MI_CHECK_EQUAL( 0, context.get_error_messages_count());
+
+        for( const char* module: modules)
+            append_module_contents( transaction, module, contents[parallel]);
+
+        // discard all modules such that the next iteration loads them again
+        transaction->abort();
+    }
+
+    mdlc_module->set_parallel_import_loading( true);
+
+    MI_CHECK_EQUAL( contents[0].size(), contents[1].size());
+    MI_CHECK( contents[0] == contents[1]);
+    MI_CHECK( std::find( contents[0].begin(), contents[0].end(), "missing") == contents[0].end());
+}
 
 void test_multithreading( DB::Database* database, DB::Scope* global_scope)
 {
@@ -2221,6 +2863,7 @@ MI_TEST_AUTO_FUNCTION( test )
 
     test_main( scope);
 
+    test_import_closure( scope);
 
     test_multithreading( database, scope);
 }
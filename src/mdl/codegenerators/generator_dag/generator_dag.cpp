@@ -256,6 +256,10 @@ Code_generator_dag::Code_generator_dag(
         MDL_CG_DAG_OPTION_TARGET_MATERIAL_MODE,
         "false",
         "Enable target mode compilation");
+    m_options.add_option(
+        MDL_CG_DAG_OPTION_LAZY_BODIES,
+        "false",
+        "Build material and function bodies on first access");
 }
 
 char const *Code_generator_dag::get_target_language() const
@@ -284,6 +288,12 @@ IGenerated_code_dag *Code_generator_dag::compile(IModule const *module)
     if (m_options.get_bool_option(MDL_CG_DAG_OPTION_TARGET_MATERIAL_MODE)) {
         options |= Generated_code_dag::TARGET_MATERIAL_MODEL_MODE;
     }
+    if (m_options.get_bool_option(MDL_CG_DAG_OPTION_LAZY_BODIES) &&
+        (options & Generated_code_dag::FORBID_LOCAL_FUNC_CALLS) == 0)
+    {
+        // errors about forbidden calls are detected while building the bodies
+        options |= Generated_code_dag::LAZY_BODIES;
+    }
 
     Generated_code_dag *result = m_builder.create<Generated_code_dag>(
         m_builder.get_allocator(),
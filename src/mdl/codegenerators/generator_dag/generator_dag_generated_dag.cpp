@@ -897,6 +897,7 @@ Generated_code_dag::Generated_code_dag(
 , m_needs_anno(false)
 , m_mark_generated((options & MARK_GENERATED_ENTITIES) != 0)
 , m_error_detected(false)
+, m_lazy_messages(alloc, module != NULL ? impl_cast<Module>(module)->get_msg_name() : "")
 , m_resource_tag_map(alloc)
 , m_resource_tagger(m_resource_tag_map)
 {
@@ -915,6 +916,15 @@ Generated_code_dag::Generated_code_dag(
     }
 }
 
+// Destructor.
+Generated_code_dag::~Generated_code_dag()
+{
+    if (m_lazy_module) {
+        // release the import entries retained for building lazy bodies
+        m_lazy_module->drop_import_entries();
+    }
+}
+
 // Get the material info for a given material index or NULL if the index is out of range.
 Generated_code_dag::Material_info *Generated_code_dag::get_material_info(
     size_t material_index)
@@ -1416,7 +1426,13 @@ void Generated_code_dag::compile_function(
         // convert the function body
         IExpression const *expr = get_single_expr_body(func_decl);
 
-        func.set_body(expr != NULL ? dag_builder.expr_to_dag(expr) : NULL);
+        if (expr != NULL && (m_options & LAZY_BODIES) != 0) {
+            // defer the body and its temporaries to the first access
+            Arena_builder builder(m_arena);
+            func.m_lazy = builder.create<Lazy_body>(module, f_def);
+        } else {
+            func.set_body(expr != NULL ? dag_builder.expr_to_dag(expr) : NULL);
+        }
 
         collect_callees(func, f_node);
     }
@@ -1425,10 +1441,66 @@ void Generated_code_dag::compile_function(
 
     m_functions.push_back(func);
 
-    build_function_temporaries(m_current_function_index);
+    if (func.m_lazy == NULL) {
+        build_function_temporaries(m_current_function_index);
+    }
     ++m_current_function_index;
 }
 
+// Build the body and the temporaries of a function compiled with LAZY_BODIES.
+void Generated_code_dag::build_lazy_function_body(
+    int             func_index,
+    Lazy_body const *lazy)
+{
+    IModule const     *module = lazy->m_owner;
+    IDefinition const *f_def  = lazy->m_def;
+
+    IDefinition const  *orig_f_def = module->get_original_definition(f_def);
+    IDeclaration const *proto_decl = orig_f_def->get_prototype_declaration();
+    IDeclaration const *func_decl  = orig_f_def->get_declaration();
+
+    mi::base::Handle<IModule const> orig_module(module->get_owner_module(f_def));
+
+    if (proto_decl == NULL) {
+        proto_decl = func_decl;
+    }
+
+    DAG_builder dag_builder(get_allocator(), m_node_factory, m_mangler);
+
+    // the rest of the processing is done inside the owner module
+    Module_scope scope(dag_builder, orig_module.get());
+
+    // We are starting a new DAG. Ensure CSE will not find old expressions.
+    m_node_factory.identify_clear();
+
+    // the parameters are accessible inside the body, see compile_function()
+    if (proto_decl->get_kind() == IDeclaration::DK_FUNCTION) {
+        IDeclaration_function const *fun_decl = cast<IDeclaration_function>(proto_decl);
+
+        if (fun_decl->is_preset()) {
+            mi::base::Handle<IModule const> handle = orig_module;
+            fun_decl = skip_presets(fun_decl, handle);
+        }
+        for (size_t k = 0, n = fun_decl->get_parameter_count(); k < n; ++k) {
+            dag_builder.make_accessible(fun_decl->get_parameter(k));
+        }
+    }
+
+    // convert the function body
+    IExpression const *expr = get_single_expr_body(func_decl);
+    MDL_ASSERT(expr != NULL);
+
+    DAG_node const *body = dag_builder.expr_to_dag(expr);
+
+    // errors are reported through the lazy messages, the body is dropped then
+    if (!report_lazy_body_errors(dag_builder, f_def)) {
+        m_functions[func_index].set_body(body);
+        build_function_temporaries(func_index);
+    }
+
+    m_node_factory.identify_clear();
+}
+
 // Compile an annotation (declaration).
 void Generated_code_dag::compile_annotation(
     IModule const         *module,
@@ -2007,44 +2079,204 @@ void Generated_code_dag::compile_material(
             compute_control_dependencies(mat);
 
             // convert the material body
-            IStatement_expression const *expr_stmt =
-                cast<IStatement_expression>(mat_decl->get_body());
+            if ((m_options & LAZY_BODIES) != 0) {
+                // defer the body and its temporaries to the first access
+                Arena_builder builder(m_arena);
+                mat.m_lazy = builder.create<Lazy_body>(module, material_def);
+            } else {
+                IStatement_expression const *expr_stmt =
+                    cast<IStatement_expression>(mat_decl->get_body());
 
-            mat.set_body(dag_builder.expr_to_dag(expr_stmt->get_expression()));
+                mat.set_body(dag_builder.expr_to_dag(expr_stmt->get_expression()));
+            }
         }
     }
 
     // handle errors
     DAG_builder::Ref_vector const &errors = dag_builder.get_errors();
     if (!errors.empty()) {
-        for (size_t i = 0, n = errors.size(); i < n; ++i) {
-            // This material uses an unexported function call which is forbidden in
-            // the current context.
-            IExpression_reference const *ref      = errors[i];
-            IDefinition const           *call_def = ref->get_definition();
-            string msg(get_allocator());
-
-            msg += "Call to unexported function '";
-            msg += call_def->get_symbol()->get_name();
-            msg += "' is not allowed in this context (inside ";
-            msg += m_renderer_context_name;
-            msg += ")";
-            error(
-                FORBIDDEN_CALL_TO_UNEXPORTED_FUNCTION,
-                ref->access_position(),
-                msg.c_str());
-        }
+        report_forbidden_calls(m_messages, errors);
         // KILL the current material if errors were detected
     } else {
         m_materials.push_back(mat);
 
         // create temporaries based on CSE
-        build_material_temporaries(m_current_material_index);
+        if (mat.m_lazy == NULL) {
+            build_material_temporaries(m_current_material_index);
+        }
 
         ++m_current_material_index;
     }
 }
 
+// Report calls to unexported functions that are forbidden in the current context.
+void Generated_code_dag::report_forbidden_calls(
+    Messages_impl                                   &messages,
+    vector<IExpression_reference const *>::Type const &errors)
+{
+    for (size_t i = 0, n = errors.size(); i < n; ++i) {
+        // This material uses an unexported function call which is forbidden in
+        // the current context.
+        IExpression_reference const *ref      = errors[i];
+        IDefinition const           *call_def = ref->get_definition();
+        string msg(get_allocator());
+
+        msg += "Call to unexported function '";
+        msg += call_def->get_symbol()->get_name();
+        msg += "' is not allowed in this context (inside ";
+        msg += m_renderer_context_name;
+        msg += ")";
+        error(
+            messages,
+            FORBIDDEN_CALL_TO_UNEXPORTED_FUNCTION,
+            ref->access_position(),
+            msg.c_str());
+    }
+}
+
+// Report errors detected while building a lazy body.
+bool Generated_code_dag::report_lazy_body_errors(
+    DAG_builder       &dag_builder,
+    IDefinition const *def)
+{
+    DAG_builder::Ref_vector const &errors = dag_builder.get_errors();
+    bool failed = !errors.empty();
+    report_forbidden_calls(m_lazy_messages, errors);
+
+    if (dag_builder.error_state()) {
+        // an eager compilation would have dropped the whole DAG, see Code_generator_dag::compile()
+        string msg(get_allocator());
+
+        msg += "Internal error while building the body of '";
+        msg += def->get_symbol()->get_name();
+        msg += "'";
+
+        Position_impl zero(0, 0, 0, 0);
+        Position const *pos = def->get_position();
+        error(m_lazy_messages, LAZY_BODY_BUILD_FAILED, pos != NULL ? *pos : zero, msg.c_str());
+        failed = true;
+    }
+    return failed;
+}
+
+// Build the body and the temporaries of a material compiled with LAZY_BODIES.
+void Generated_code_dag::build_lazy_material_body(
+    int             mat_index,
+    Lazy_body const *lazy)
+{
+    IModule const     *module       = lazy->m_owner;
+    IDefinition const *material_def = lazy->m_def;
+
+    DAG_builder  dag_builder(get_allocator(), m_node_factory, m_mangler);
+    Module_scope scope(dag_builder, module);
+
+    // We are starting a new DAG. Ensure CSE will not find old expressions.
+    m_node_factory.identify_clear();
+
+    Target_material_model_mode_scope tmm_scope(
+        dag_builder, (m_options & TARGET_MATERIAL_MODEL_MODE) != 0);
+
+    IDefinition const *orig_mat_def = module->get_original_definition(material_def);
+    mi::base::Handle<IModule const> orig_module(module->get_owner_module(material_def));
+
+    IDeclaration_function const *mat_decl =
+        cast<IDeclaration_function>(orig_mat_def->get_declaration());
+
+    IDeclaration_function const *proto_decl =
+        cast<IDeclaration_function>(orig_mat_def->get_prototype_declaration());
+    if (proto_decl == NULL) {
+        proto_decl = mat_decl;
+    }
+
+    // start temporaries
+    dag_builder.reset();
+
+    // the body is converted in the module of the original material, see compile_material()
+    Module_scope orig_scope(dag_builder, orig_module.get());
+
+    for (size_t k = 0, n = proto_decl->get_parameter_count(); k < n; ++k) {
+        dag_builder.make_accessible(proto_decl->get_parameter(k));
+    }
+
+    // convert the material body
+    IStatement_expression const *expr_stmt =
+        cast<IStatement_expression>(mat_decl->get_body());
+
+    DAG_node const *body = dag_builder.expr_to_dag(expr_stmt->get_expression());
+
+    // errors are reported through the lazy messages, the body is dropped then
+    if (!report_lazy_body_errors(dag_builder, material_def)) {
+        m_materials[mat_index].set_body(body);
+
+        // create temporaries based on CSE
+        build_material_temporaries(mat_index);
+    }
+
+    m_node_factory.identify_clear();
+}
+
+// Ensure that a lazy body is built.
+void Generated_code_dag::ensure_body(
+    Lazy_body *lazy,
+    bool      is_material,
+    size_t    index) const
+{
+    if (lazy->m_state.load(std::memory_order_acquire) == Lazy_body::LS_DONE) {
+        return;
+    }
+
+    mi::base::Recursive_lock::Block block(&m_lazy_lock);
+
+    // the body might have been built by another thread in the meantime, or is currently built
+    // by this thread (the temporary creation accesses the body)
+    if (lazy->m_state.load(std::memory_order_relaxed) != Lazy_body::LS_PENDING) {
+        return;
+    }
+
+    lazy->m_state.store(Lazy_body::LS_BUILDING, std::memory_order_relaxed);
+
+    Generated_code_dag *self = const_cast<Generated_code_dag *>(this);
+    if (is_material) {
+        self->build_lazy_material_body(int(index), lazy);
+    } else {
+        self->build_lazy_function_body(int(index), lazy);
+    }
+
+    lazy->m_state.store(Lazy_body::LS_DONE, std::memory_order_release);
+}
+
+// Ensure that the body of a material is built.
+void Generated_code_dag::ensure_material_body(size_t material_index) const
+{
+    Material_info const *mat = get_material_info(material_index);
+    if (mat != NULL && mat->m_lazy != NULL) {
+        ensure_body(mat->m_lazy, /*is_material=*/true, material_index);
+    }
+}
+
+// Ensure that the body of a function is built.
+void Generated_code_dag::ensure_function_body(size_t function_index) const
+{
+    Function_info const *func = get_function_info(function_index);
+    if (func != NULL && func->m_lazy != NULL) {
+        ensure_body(func->m_lazy, /*is_material=*/false, function_index);
+    }
+}
+
+// Ensure that all material and function bodies are built.
+void Generated_code_dag::ensure_all_bodies() const
+{
+    if (!m_lazy_module) {
+        return;
+    }
+    for (size_t i = 0, n = m_functions.size(); i < n; ++i) {
+        ensure_function_body(i);
+    }
+    for (size_t i = 0, n = m_materials.size(); i < n; ++i) {
+        ensure_material_body(i);
+    }
+}
+
 // Compile a local material.
 void Generated_code_dag::compile_local_material(
     DAG_builder       &dag_builder,
@@ -2125,6 +2357,16 @@ void Generated_code_dag::compile(IModule const *module)
 {
     m_current_material_index = 0;
 
+    if ((m_options & LAZY_BODIES) != 0) {
+        // lazy bodies are built from the AST of the module, keep it and its import entries
+        if (module->restore_import_entries(NULL)) {
+            m_lazy_module = mi::base::make_handle_dup(module);
+        } else {
+            MDL_ASSERT(!"import entries of lazily compiled module not restored");
+            m_options &= ~LAZY_BODIES;
+        }
+    }
+
     m_node_factory.enable_cse(true);
 
     DAG_builder  dag_builder(get_allocator(), m_node_factory, m_mangler);
@@ -2185,6 +2427,7 @@ void Generated_code_dag::compile(IModule const *module)
     }
 
     // if the state must be imported, check if is was, else add it
+    // Note: lazy bodies can only require ::state through ::df, which imports it itself.
     if (m_node_factory.needs_state_import()) {
         add_import("::state");
     }
@@ -2459,9 +2702,19 @@ void Generated_code_dag::compile_constant(
 
 // Creates a new error message.
 void Generated_code_dag::error(int code, Err_location const &loc, char const *msg)
+{
+    error(m_messages, code, loc, msg);
+}
+
+// Creates a new error message in the given message list.
+void Generated_code_dag::error(
+    Messages_impl      &messages,
+    int                code,
+    Err_location const &loc,
+    char const         *msg)
 {
     size_t fname_id = 0; // always current file
-    m_messages.add_error_message(code, MESSAGE_CLASS, fname_id, loc.get_position(), msg);
+    messages.add_error_message(code, MESSAGE_CLASS, fname_id, loc.get_position(), msg);
 }
 
 // Check if the name for the given definition must get a signature suffix.
@@ -3115,6 +3368,7 @@ DAG_node const *Generated_code_dag::get_function_parameter_annotation(
 size_t Generated_code_dag::get_function_temporary_count(
     size_t function_index) const
 {
+    ensure_function_body(function_index);
     if (Function_info const *func = get_function_info(function_index)) {
         return func->get_temporary_count();
     }
@@ -3126,6 +3380,7 @@ DAG_node const *Generated_code_dag::get_function_temporary(
     size_t function_index,
     size_t temporary_index) const
 {
+    ensure_function_body(function_index);
     if (Function_info const *func = get_function_info(function_index)) {
         if (temporary_index < func->get_temporary_count()) {
             return func->get_temporary(temporary_index);
@@ -3139,6 +3394,7 @@ char const *Generated_code_dag::get_function_temporary_name(
     size_t function_index,
     size_t temporary_index) const
 {
+    ensure_function_body(function_index);
     if (Function_info const *func = get_function_info(function_index)) {
         if (temporary_index < func->get_temporary_count()) {
             return func->get_temporary_name(temporary_index);
@@ -3151,12 +3407,24 @@ char const *Generated_code_dag::get_function_temporary_name(
 DAG_node const *Generated_code_dag::get_function_body(
     size_t function_index) const
 {
+    ensure_function_body(function_index);
     if (Function_info const *func = get_function_info(function_index)) {
         return func->get_body();
     }
     return NULL;
 }
 
+// Check if the body of the function at function_index was not built yet.
+bool Generated_code_dag::is_function_body_pending(
+    size_t function_index) const
+{
+    if (Function_info const *func = get_function_info(function_index)) {
+        return func->m_lazy != NULL &&
+            func->m_lazy->m_state.load(std::memory_order_acquire) == Lazy_body::LS_PENDING;
+    }
+    return false;
+}
+
 // Get the number of annotations of the material at material_index.
 size_t Generated_code_dag::get_material_annotation_count(
     size_t material_index) const
@@ -3246,6 +3514,7 @@ DAG_node const *Generated_code_dag::get_material_parameter_annotation(
 size_t Generated_code_dag::get_material_temporary_count(
     size_t material_index) const
 {
+    ensure_material_body(material_index);
     if (Material_info const *mat = get_material_info(material_index)) {
         return mat->get_temporary_count();
     }
@@ -3257,6 +3526,7 @@ DAG_node const *Generated_code_dag::get_material_temporary(
     size_t material_index,
     size_t temporary_index) const
 {
+    ensure_material_body(material_index);
     if (Material_info const *mat = get_material_info(material_index)) {
         if (temporary_index < mat->get_temporary_count()) {
             return mat->get_temporary(temporary_index);
@@ -3270,6 +3540,7 @@ char const *Generated_code_dag::get_material_temporary_name(
     size_t material_index,
     size_t temporary_index) const
 {
+    ensure_material_body(material_index);
     if (Material_info const *mat = get_material_info(material_index)) {
         if (temporary_index < mat->get_temporary_count()) {
             return mat->get_temporary_name(temporary_index);
@@ -3282,12 +3553,24 @@ char const *Generated_code_dag::get_material_temporary_name(
 DAG_node const *Generated_code_dag::get_material_value(
     size_t material_index) const
 {
+    ensure_material_body(material_index);
     if (Material_info const *mat = get_material_info(material_index)) {
         return mat->get_body();
     }
     return NULL;
 }
 
+// Check if the value of the material at material_index was not built yet.
+bool Generated_code_dag::is_material_value_pending(
+    size_t material_index) const
+{
+    if (Material_info const *mat = get_material_info(material_index)) {
+        return mat->m_lazy != NULL &&
+            mat->m_lazy->m_state.load(std::memory_order_acquire) == Lazy_body::LS_PENDING;
+    }
+    return false;
+}
+
 // Get the export flags of the material at material_index.
 bool Generated_code_dag::get_material_exported(size_t material_index) const
 {
@@ -6398,6 +6681,7 @@ size_t Generated_code_dag::get_memory_size() const
 
     res += m_arena.get_chunks_size();
     res += dynamic_memory_consumption(m_messages);
+    res += dynamic_memory_consumption(m_lazy_messages);
     res += dynamic_memory_consumption(m_module_imports);
 
     res += dynamic_memory_consumption(m_module_annotations);
@@ -6714,6 +6998,9 @@ void Generated_code_dag::serialize(
     ISerializer           *serializer,
     MDL_binary_serializer *bin_serializer) const
 {
+    // the serialized DAG is always complete
+    ensure_all_bodies();
+
     DAG_serializer dag_serializer(get_allocator(), serializer, bin_serializer);
 
     // mark the start of the DAG
@@ -6732,7 +7019,19 @@ void Generated_code_dag::serialize(
     m_sym_tab.serialize(dag_serializer);
     m_type_factory.serialize(dag_serializer);
     m_value_factory.serialize(dag_serializer);
-    m_messages.serialize(dag_serializer);
+    {
+        mi::base::Recursive_lock::Block block(&m_lazy_lock);
+
+        if (m_lazy_messages.get_message_count() == 0) {
+            m_messages.serialize(dag_serializer);
+        } else {
+            // the errors of the lazy bodies are part of the messages of the complete DAG
+            Messages_impl messages(get_allocator(), m_messages.get_fname(0));
+            messages.copy_messages(m_messages);
+            messages.copy_messages(m_lazy_messages);
+            messages.serialize(dag_serializer);
+        }
+    }
 
     dag_serializer.serialize(m_module_imports);
 
@@ -6762,7 +7061,8 @@ void Generated_code_dag::serialize(
     // m_current_material_index
     // m_accesible_parameters
 
-    dag_serializer.write_unsigned(m_options);
+    // all bodies exist now, so the DAG is written like an eagerly compiled one
+    dag_serializer.write_unsigned(m_options & ~LAZY_BODIES);
 
     // serialize the resource table
     size_t n_entries = m_resource_tag_map.size();
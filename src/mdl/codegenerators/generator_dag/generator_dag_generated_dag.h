@@ -29,9 +29,11 @@
 #ifndef MDL_GENERATOR_DAG_GENERATED_DAG
 #define MDL_GENERATOR_DAG_GENERATED_DAG 1
 
+#include <atomic>
 #include <cstring>
 
 #include <mi/base/handle.h>
+#include <mi/base/lock.h>
 #include <mi/mdl/mdl_generated_dag.h>
 #include <mi/mdl/mdl_streams.h>
 #include <mi/mdl/mdl_printers.h>
@@ -129,6 +131,8 @@ public:
         EXPOSE_NAMES_OF_LET_EXPRESSIONS = 0x0010,
         /// If set, target material model compilation mode is used.
         TARGET_MATERIAL_MODEL_MODE      = 0x0020,
+        /// If set, material and function bodies are built on first access.
+        LAZY_BODIES                     = 0x0040,
     };
 
     /// Bit set of compile options.
@@ -141,6 +145,7 @@ public:
         FORBIDDEN_CALL_TO_UNEXPORTED_FUNCTION = DAG_ERROR_FIRST,
         DEPENDENCE_GRAPH_HAS_LOOPS,
         VARYING_ON_UNIFORM,
+        LAZY_BODY_BUILD_FAILED,
     };
 
     /// The type of vectors of DAG IR nodes.
@@ -234,6 +239,31 @@ public:
 
     typedef vector<Parameter_info>::Type Param_vector;
 
+    /// Helper class describing a material or function body that is built on first access.
+    struct Lazy_body {
+        /// The build state of a lazy body.
+        enum State {
+            LS_PENDING,   ///< The body was not built yet.
+            LS_BUILDING,  ///< The body is currently built.
+            LS_DONE       ///< The body and its temporaries are available.
+        };
+
+        /// Constructor.
+        ///
+        /// \param owner  the module the definition was compiled from
+        /// \param def    the definition of the material or function
+        Lazy_body(IModule const *owner, IDefinition const *def)
+        : m_owner(owner)
+        , m_def(def)
+        , m_state(LS_PENDING)
+        {
+        }
+
+        IModule const     *m_owner; ///< The owner module, kept alive by the compiled module.
+        IDefinition const *m_def;   ///< The definition of the material or function.
+        std::atomic<int>  m_state;  ///< The build state.
+    };
+
     /// Helper class describing one material.
     class Material_info {
         // Helper for dynamic memory consumption: Arena strings have no EXTRA memory allocated.
@@ -263,6 +293,7 @@ public:
         , m_temporaries(alloc)
         , m_temporary_names(alloc)
         , m_body(NULL)
+        , m_lazy(NULL)
         {
         }
 
@@ -349,6 +380,7 @@ public:
         Dag_vector     m_temporaries;     ///< The material temporaries.
         String_vector  m_temporary_names; ///< The material temporary names.
         DAG_node const *m_body;           ///< The IR body of the material.
+        Lazy_body      *m_lazy;           ///< If non-NULL, the body is built on first access.
     };
 
     typedef vector<Material_info>::Type Material_vector;
@@ -393,6 +425,7 @@ public:
         , m_temporaries(alloc)
         , m_temporary_names(alloc)
         , m_body(NULL)
+        , m_lazy(NULL)
         , m_refs(alloc)
         , m_hash()
         , m_properties(0u)
@@ -507,6 +540,7 @@ public:
         Dag_vector            m_temporaries;     ///< The function temporaries.
         String_vector         m_temporary_names; ///< The function temporary names.
         DAG_node const        *m_body;           ///< The IR body of the function.
+        Lazy_body             *m_lazy;           ///< If non-NULL, the body is built on access.
         String_vector         m_refs;            ///< The references of a function.
         DAG_hash              m_hash;            ///< The function hash value.
         unsigned              m_properties;      ///< The property flags of this function.
@@ -1655,6 +1689,9 @@ private:
         Compile_options options,
         char const      *renderer_context_name);
 
+    /// Destructor.
+    ~Generated_code_dag();
+
 public:
     /// Get the kind of code generated.
     /// \returns    The kind of generated code.
@@ -1992,6 +2029,13 @@ public:
     DAG_node const *get_function_body(
         size_t function_index) const MDL_FINAL;
 
+    /// Check if the body of the function at function_index was not built yet.
+    ///
+    /// \param function_index      The index of the function.
+    /// \returns                   True if the body will be built on first access.
+    bool is_function_body_pending(
+        size_t function_index) const MDL_FINAL;
+
     /// Get the number of annotations of the material at material_index.
     /// \param material_index      The index of the material.
     /// \returns                   The number of annotations.
@@ -2077,6 +2121,13 @@ public:
     DAG_node const *get_material_value(
         size_t material_index) const MDL_FINAL;
 
+    /// Check if the value of the material at material_index was not built yet.
+    ///
+    /// \param material_index  The index of the material.
+    /// \returns               True if the value will be built on first access.
+    bool is_material_value_pending(
+        size_t material_index) const MDL_FINAL;
+
     /// Get the export flags of the material at material_index.
     ///
     /// \param      material_index  The index of the material.
@@ -2567,6 +2618,18 @@ private:
     /// \param msg   the error message
     void error(int code, Err_location const &loc, char const *msg);
 
+    /// Creates a new error message in the given message list.
+    ///
+    /// \param messages  the message list
+    /// \param code      the error code
+    /// \param loc       the error location
+    /// \param msg       the error message
+    static void error(
+        Messages_impl      &messages,
+        int                code,
+        Err_location const &loc,
+        char const         *msg);
+
     /// Check if the name for the given definition must get a signature suffix.
     ///
     /// \param def   The definition.
@@ -2793,6 +2856,54 @@ private:
     /// \param func_index  the index of the processed function
     void build_function_temporaries(int func_index);
 
+    /// Report calls to unexported functions that are forbidden in the current context.
+    ///
+    /// \param messages  the message list receiving the errors
+    /// \param errors    the forbidden calls collected by the DAG builder
+    void report_forbidden_calls(
+        Messages_impl                                   &messages,
+        vector<IExpression_reference const *>::Type const &errors);
+
+    /// Report errors detected while building a lazy body.
+    ///
+    /// \param dag_builder  the DAG builder that built the body
+    /// \param def          the definition of the material or function
+    ///
+    /// \return true if errors were reported, the body must be dropped then
+    bool report_lazy_body_errors(DAG_builder &dag_builder, IDefinition const *def);
+
+    /// Build the body and the temporaries of a material compiled with LAZY_BODIES.
+    ///
+    /// \param mat_index  the index of the material
+    /// \param lazy       the lazy body description of the material
+    void build_lazy_material_body(int mat_index, Lazy_body const *lazy);
+
+    /// Build the body and the temporaries of a function compiled with LAZY_BODIES.
+    ///
+    /// \param func_index  the index of the function
+    /// \param lazy        the lazy body description of the function
+    void build_lazy_function_body(int func_index, Lazy_body const *lazy);
+
+    /// Ensure that a lazy body is built, builds it if necessary.
+    ///
+    /// \param lazy         the lazy body description
+    /// \param is_material  true, if the body belongs to a material, false for functions
+    /// \param index        the index of the material or function
+    void ensure_body(Lazy_body *lazy, bool is_material, size_t index) const;
+
+    /// Ensure that the body of a material is built.
+    ///
+    /// \param material_index  the index of the material
+    void ensure_material_body(size_t material_index) const;
+
+    /// Ensure that the body of a function is built.
+    ///
+    /// \param function_index  the index of the function
+    void ensure_function_body(size_t function_index) const;
+
+    /// Ensure that all material and function bodies are built.
+    void ensure_all_bodies() const;
+
     /// Add a material temporary.
     ///
     /// \param mat_index    The index of the material.
@@ -3096,6 +3207,17 @@ private:
     /// If true, an error was detected during construction.
     bool m_error_detected;
 
+    /// The compiled module, kept alive while bodies are built lazily. Its import entries are
+    /// retained, too.
+    mi::base::Handle<IModule const> m_lazy_module;
+
+    /// The errors detected while building lazy bodies. Kept apart from m_messages, which is
+    /// read without lock after compilation. Protected by m_lazy_lock.
+    Messages_impl m_lazy_messages;
+
+    /// The lock protecting the construction of lazy bodies.
+    mutable mi::base::Recursive_lock m_lazy_lock;
+
     typedef vector<Resource_tag_tuple>::Type Resource_tag_map;
 
     /// The resource tag map, mapping accessible resources to tags.
@@ -29,12 +29,150 @@
 #include "pch.h"
 
 #include "compilercore_code_cache.h"
+#include "compilercore_file_utils.h"
 
+#include <algorithm>
 #include <cstdint>
 
 namespace mi {
 namespace mdl {
 
+namespace {
+
+/// The magic of a disk tier file.
+char const disk_magic[8] = { 'M', 'D', 'L', 'C', 'O', 'D', 'E', 'C' };
+
+/// The version of the disk tier file format. Because it is written in native byte order,
+/// files written on a machine with a different endianness are rejected as well.
+uint32_t const disk_format_version = 1u;
+
+/// The extension of disk tier files.
+char const disk_extension[] = ".mdlcc";
+
+/// Temporary files older than this (in seconds) are considered left over by crashed writers.
+time_t const disk_stale_tmp_age = 60 * 60;
+
+/// Computes a 64bit FNV-1a hash over a memory block.
+uint64_t fnv1a_64(char const *data, size_t size)
+{
+    uint64_t h = 0xcbf29ce484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= (unsigned char)data[i];
+        h *= 0x100000001b3ull;
+    }
+    return h;
+}
+
+/// Helper to serialize a cache entry into a memory buffer.
+class Disk_writer {
+public:
+    /// Constructor.
+    explicit Disk_writer(IAllocator *alloc) : m_buf(alloc) {}
+
+    /// Write raw data.
+    void write(void const *data, size_t size) {
+        char const *p = static_cast<char const *>(data);
+        m_buf.insert(m_buf.end(), p, p + size);
+    }
+
+    /// Write an unsigned 32bit value.
+    void write_u32(uint32_t v) { write(&v, sizeof(v)); }
+
+    /// Write an unsigned 64bit value.
+    void write_u64(uint64_t v) { write(&v, sizeof(v)); }
+
+    /// Write a zero-terminated string.
+    void write_str(char const *s) { write(s, strlen(s) + 1); }
+
+    /// Get the written data.
+    char const *data() const { return m_buf.empty() ? NULL : &m_buf[0]; }
+
+    /// Get the size of the written data.
+    size_t size() const { return m_buf.size(); }
+
+private:
+    vector<char>::Type m_buf;
+};
+
+/// Helper to deserialize a cache entry from a memory buffer.
+///
+/// All read errors are sticky, so the result must only be checked once at the end.
+class Disk_reader {
+public:
+    /// Constructor.
+    Disk_reader(char const *data, size_t size)
+    : m_p(data), m_end(data + size), m_ok(true)
+    {
+    }
+
+    /// Read raw data.
+    char const *read(size_t size) {
+        if (!m_ok || size_t(m_end - m_p) < size) {
+            m_ok = false;
+            return NULL;
+        }
+        char const *res = m_p;
+        m_p += size;
+        return res;
+    }
+
+    /// Read an unsigned 32bit value.
+    uint32_t read_u32() {
+        uint32_t v = 0;
+        if (char const *p = read(sizeof(v)))
+            memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /// Read an unsigned 64bit value.
+    uint64_t read_u64() {
+        uint64_t v = 0;
+        if (char const *p = read(sizeof(v)))
+            memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    /// Read a zero-terminated string.
+    char const *read_str() {
+        if (m_ok) {
+            if (void const *z = memchr(m_p, 0, m_end - m_p)) {
+                char const *res = m_p;
+                m_p = static_cast<char const *>(z) + 1;
+                return res;
+            }
+        }
+        m_ok = false;
+        return "";
+    }
+
+    /// Returns true if no error occurred so far.
+    bool is_ok() const { return m_ok; }
+
+    /// Returns true if all data was consumed.
+    bool at_end() const { return m_p == m_end; }
+
+private:
+    char const *m_p;
+    char const *m_end;
+    bool       m_ok;
+};
+
+/// A file of the disk tier.
+struct Disk_file {
+    string name;
+    size_t size;
+    time_t mtime;
+};
+
+/// Orders disk files by modification time, which is also updated by disk hits.
+struct Disk_file_older {
+    bool operator()(Disk_file const &a, Disk_file const &b) const {
+        return a.mtime < b.mtime;
+    }
+};
+
+}  // anonymous
+
 // Constructor.
 Code_cache::Cache_entry::Cache_entry(
     IAllocator          *alloc,
@@ -45,6 +183,7 @@ Code_cache::Cache_entry::Cache_entry(
 , m_alloc(alloc)
 , m_prev(NULL)
 , m_next(NULL)
+, m_referenced(false)
 {
     Allocator_builder builder(alloc);
 
@@ -102,6 +241,7 @@ Code_cache::Cache_entry::Cache_entry(
             }
 
             cur_info->arg_block_index = entry.func_infos[i].arg_block_index;
+            cur_info->state_usage     = entry.func_infos[i].state_usage;
 
             cur_info->num_df_handles = entry.func_infos[i].num_df_handles;
             if (cur_info->num_df_handles == 0) {
@@ -143,57 +283,160 @@ Code_cache::Cache_entry::~Cache_entry()
 // Lookup a data blob.
 Code_cache::Entry const *Code_cache::lookup(unsigned char const key[16]) const
 {
-    mi::base::Lock::Block block(&m_cache_lock);
+    Shard &shard = get_shard(key);
+
+    {
+        mi::base::Lock::Block block(&shard.m_lock);
+
+        Search_map::const_iterator it = shard.m_search_map.find(Key(key));
+        if (it != shard.m_search_map.end()) {
+            // found, just mark it as recently used
+            Cache_entry *p = it->second;
+            p->m_referenced = true;
+            ++shard.m_hits;
+            return p;
+        }
+        if (m_disk_dir.empty()) {
+            ++shard.m_misses;
+            return NULL;
+        }
+    }
+
+    // not in memory, try the disk tier without holding the shard lock
+    Cache_entry *res = load_from_disk(key);
+    if (res == NULL) {
+        mi::base::Lock::Block block(&shard.m_lock);
+        ++shard.m_misses;
+        return NULL;
+    }
+
+    if (res->get_cache_data_size() > m_max_size) {
+        Allocator_builder builder(get_allocator());
+        builder.destroy(res);
 
-    Search_map::const_iterator it = m_search_map.find(Key(key));
-    if (it != m_search_map.end()) {
-        // found
-        Cache_entry *p = it->second;
-        to_front(*p);
-        return p;
+        mi::base::Lock::Block block(&shard.m_lock);
+        ++shard.m_misses;
+        return NULL;
     }
-    return NULL;
+
+    {
+        mi::base::Lock::Block block(&shard.m_lock);
+        ++shard.m_disk_hits;
+    }
+    return insert_entry(res);
 }
 
 // Enter a data blob.
 bool Code_cache::enter(unsigned char const key[16], Entry const &entry)
 {
-    mi::base::Lock::Block block(&m_cache_lock);
-
     // don't try to enter it if it doesn't fit into the cache at all
     if (entry.get_cache_data_size() > m_max_size)
         return false;
 
-    m_curr_size += entry.get_cache_data_size();
-    strip_size();
+    // copy the data outside the lock
+    Allocator_builder builder(get_allocator());
+    insert_entry(builder.create<Cache_entry>(get_allocator(), entry, key));
 
-    Cache_entry *res = new_entry(entry, key);
+    if (!m_disk_dir.empty())
+        store_to_disk(key, entry);
+    return true;
+}
+
+// Enable the persistent disk tier of this cache.
+bool Code_cache::enable_disk_tier(char const *directory, size_t max_size)
+{
+    IAllocator *alloc = get_allocator();
 
-    m_search_map.insert(Search_map::value_type(res->m_key, res));
+    if (directory == NULL || directory[0] == '\0' || max_size == 0)
+        return false;
+
+    // another process might create the directory concurrently, so check again on failure
+    if (!is_directory_utf8(alloc, directory) &&
+        !mkdir_utf8(alloc, directory) &&
+        !is_directory_utf8(alloc, directory))
+        return false;
+
+    mi::base::Lock::Block block(&m_disk_lock);
+
+    m_disk_dir      = directory;
+    m_disk_max_size = max_size;
+
+    // computes the current size and enforces the limit
+    strip_disk_size(max_size);
     return true;
 }
 
-// Create a new entry and put it in front.
-// Assumes that current size has already been updated.
-Code_cache::Cache_entry *Code_cache::new_entry(
-    mi::mdl::ICode_cache::Entry const &entry, unsigned char const key[16])
+// Set a stamp identifying the producer of the cached code.
+void Code_cache::set_disk_stamp(char const *stamp)
 {
-    Allocator_builder builder(get_allocator());
+    m_disk_stamp = stamp != NULL ? stamp : "";
+}
+
+// Retrieve the current statistics of this cache.
+void Code_cache::get_statistics(Statistics &stats) const
+{
+    memset(&stats, 0, sizeof(stats));
+
+    for (size_t i = 0; i < n_shards; ++i) {
+        Shard &shard = *m_shards[i];
+        mi::base::Lock::Block block(&shard.m_lock);
+
+        stats.hits      += shard.m_hits;
+        stats.disk_hits += shard.m_disk_hits;
+        stats.misses    += shard.m_misses;
+        stats.evictions += shard.m_evictions;
+        stats.entries   += shard.m_search_map.size();
+        stats.size      += shard.m_curr_size;
+    }
 
-    Cache_entry *res = builder.create<Cache_entry>(get_allocator(), entry, key);
+    mi::base::Lock::Block block(&m_disk_lock);
+    stats.disk_stores = m_disk_stores;
+}
+
+// Insert a new entry into the memory tier.
+Code_cache::Cache_entry *Code_cache::insert_entry(Cache_entry *entry) const
+{
+    Shard       &shard = get_shard(entry->m_key.m_key);
+    Cache_entry *dup   = NULL;
+
+    {
+        mi::base::Lock::Block block(&shard.m_lock);
+
+        std::pair<Search_map::iterator, bool> res =
+            shard.m_search_map.insert(Search_map::value_type(entry->m_key, entry));
+        if (res.second) {
+            size_t size = entry->get_cache_data_size();
+
+            // update the global size under the shard lock, so it never drops below zero
+            // due to a concurrent eviction of this entry
+            to_front(shard, *entry);
+            shard.m_curr_size += size;
+            m_curr_size       += size;
+        } else {
+            // entered by another thread in the meantime
+            dup   = entry;
+            entry = res.first->second;
+            entry->m_referenced = true;
+        }
+    }
 
-    to_front(*res);
+    if (dup != NULL) {
+        Allocator_builder builder(get_allocator());
+        builder.destroy(dup);
+        return entry;
+    }
 
-    return res;
+    strip_size(entry);
+    return entry;
 }
 
-// Remove an entry from the list.
-void Code_cache::remove_from_list(Cache_entry &entry) const
+// Remove an entry from the list of its shard.
+void Code_cache::remove_from_list(Shard &shard, Cache_entry &entry)
 {
-    if (m_head == &entry)
-        m_head = entry.m_next;
-    if (m_tail == &entry)
-        m_tail = entry.m_prev;
+    if (shard.m_head == &entry)
+        shard.m_head = entry.m_next;
+    if (shard.m_tail == &entry)
+        shard.m_tail = entry.m_prev;
 
     if (entry.m_next != NULL)
         entry.m_next->m_prev = entry.m_prev;
@@ -203,39 +446,352 @@ void Code_cache::remove_from_list(Cache_entry &entry) const
     entry.m_prev = entry.m_next = NULL;
 }
 
-// Move an entry to front.
-void Code_cache::to_front(Cache_entry &entry) const
+// Put an entry in front of the list of its shard.
+void Code_cache::to_front(Shard &shard, Cache_entry &entry)
 {
-    remove_from_list(entry);
+    remove_from_list(shard, entry);
 
-    entry.m_next = m_head;
+    entry.m_next = shard.m_head;
 
-    if (m_head != NULL)
-        m_head->m_prev = &entry;
+    if (shard.m_head != NULL)
+        shard.m_head->m_prev = &entry;
 
-    m_head = &entry;
+    shard.m_head = &entry;
 
-    if (m_tail == NULL)
-        m_tail = &entry;
+    if (shard.m_tail == NULL)
+        shard.m_tail = &entry;
 }
 
-// Drop entries from the end until size is reached.
-void Code_cache::strip_size()
+// Evict one entry from a shard using the CLOCK policy.
+size_t Code_cache::evict_one(Shard &shard, Cache_entry const *keep) const
 {
-    Allocator_builder builder(get_allocator());
-
-    Cache_entry *next = NULL;
-    for (Cache_entry *p = m_tail; p != NULL; p = next) {
-        if (m_curr_size < m_max_size)
+    // every entry is visited at most twice: once to clear its reference bit, once to evict it
+    for (size_t n = 2 * shard.m_search_map.size(); n > 0; --n) {
+        Cache_entry *p = shard.m_tail;
+        if (p == NULL)
             break;
 
-        next = p->m_prev;
+        if (p->m_referenced || p == keep) {
+            // second chance
+            p->m_referenced = false;
+            to_front(shard, *p);
+            continue;
+        }
+
+        size_t size = p->get_cache_data_size();
+
+        shard.m_curr_size -= size;
+        m_curr_size       -= size;
+        ++shard.m_evictions;
+        shard.m_search_map.erase(p->m_key);
+        remove_from_list(shard, *p);
 
-        m_curr_size -= p->get_cache_data_size();
-        m_search_map.erase(p->m_key);
-        remove_from_list(*p);
+        Allocator_builder builder(get_allocator());
         builder.destroy(p);
+        return size;
+    }
+    return 0;
+}
+
+// Drop entries until the maximum size is reached, starting with the shard of the
+// given entry.
+void Code_cache::strip_size(Cache_entry const *keep) const
+{
+    size_t const start = keep->m_key.m_key[0];
+
+    // evict round robin over all shards, so no single shard is drained first
+    while (m_curr_size > m_max_size) {
+        bool evicted = false;
+        for (size_t i = 0; i < n_shards && m_curr_size > m_max_size; ++i) {
+            Shard &shard = *m_shards[(start + i) & (n_shards - 1)];
+
+            mi::base::Lock::Block block(&shard.m_lock);
+            if (evict_one(shard, keep) != 0)
+                evicted = true;
+        }
+        if (!evicted) {
+            // everything else is gone already
+            break;
+        }
+    }
+}
+
+// Get the disk tier file name for the given key.
+string Code_cache::get_disk_file_name(unsigned char const key[16]) const
+{
+    static char const hex[] = "0123456789abcdef";
+
+    char name[2 * 16 + sizeof(disk_extension)];
+    for (size_t i = 0; i < 16; ++i) {
+        name[2 * i]     = hex[key[i] >> 4];
+        name[2 * i + 1] = hex[key[i] & 0xF];
+    }
+    memcpy(&name[2 * 16], disk_extension, sizeof(disk_extension));
+
+    return join_path(m_disk_dir, string(name, get_allocator()));
+}
+
+// Load an entry from the disk tier.
+Code_cache::Cache_entry *Code_cache::load_from_disk(unsigned char const key[16]) const
+{
+    IAllocator *alloc = get_allocator();
+
+    string fname(get_disk_file_name(key));
+    FILE *f = fopen_utf8(alloc, fname.c_str(), "rb");
+    if (f == NULL)
+        return NULL;
+
+    vector<char>::Type buf(alloc);
+    bool ok = fseek(f, 0, SEEK_END) == 0;
+    long file_size = ok ? ftell(f) : -1;
+    if (file_size > long(sizeof(uint64_t)) && fseek(f, 0, SEEK_SET) == 0) {
+        buf.resize(size_t(file_size));
+        ok = fread(&buf[0], 1, buf.size(), f) == buf.size();
+    } else {
+        ok = false;
+    }
+    fclose(f);
+    if (!ok)
+        return NULL;
+
+    // verify the trailing checksum first, so truncated or corrupted files are rejected
+    size_t data_size = buf.size() - sizeof(uint64_t);
+    uint64_t checksum = 0;
+    memcpy(&checksum, &buf[data_size], sizeof(checksum));
+    if (checksum != fnv1a_64(&buf[0], data_size))
+        return NULL;
+
+    Disk_reader r(&buf[0], data_size);
+
+    char const *magic = r.read(sizeof(disk_magic));
+    if (magic == NULL || memcmp(magic, disk_magic, sizeof(disk_magic)) != 0)
+        return NULL;
+    if (r.read_u32() != disk_format_version)
+        return NULL;
+    if (m_disk_stamp != r.read_str())
+        return NULL;
+    char const *file_key = r.read(16);
+    if (file_key == NULL || memcmp(file_key, key, 16) != 0)
+        return NULL;
+
+    unsigned render_state_usage = r.read_u32();
+
+    size_t code_size       = size_t(r.read_u64());
+    char const *code       = r.read(code_size);
+    size_t const_seg_size  = size_t(r.read_u64());
+    char const *const_seg  = r.read(const_seg_size);
+    size_t arg_layout_size = size_t(r.read_u64());
+    char const *arg_layout = r.read(arg_layout_size);
+
+    size_t n_mapped = size_t(r.read_u64());
+    vector<char const *>::Type mapped_strings(alloc);
+    for (size_t i = 0; i < n_mapped && r.is_ok(); ++i) {
+        mapped_strings.push_back(r.read_str());
+    }
+
+    size_t n_infos = size_t(r.read_u64());
+    vector<Entry::Func_info>::Type func_infos(alloc);
+    vector<char const *>::Type     df_handles(alloc);
+    vector<size_t>::Type           df_handle_starts(alloc);
+    for (size_t i = 0; i < n_infos && r.is_ok(); ++i) {
+        Entry::Func_info info;
+
+        info.name      = r.read_str();
+        info.dist_kind = IGenerated_code_executable::Distribution_kind(r.read_u32());
+        info.func_kind = IGenerated_code_executable::Function_kind(r.read_u32());
+        for (int j = 0; j < int(IGenerated_code_executable::PL_NUM_LANGUAGES); ++j) {
+            info.prototypes[j] = r.read_str();
+        }
+        info.arg_block_index = size_t(r.read_u64());
+        info.num_df_handles  = size_t(r.read_u64());
+        info.df_handles      = NULL;
+
+        df_handle_starts.push_back(df_handles.size());
+        for (size_t j = 0; j < info.num_df_handles && r.is_ok(); ++j) {
+            df_handles.push_back(r.read_str());
+        }
+        info.state_usage = IGenerated_code_executable::State_usage(r.read_u32());
+
+        func_infos.push_back(info);
+    }
+
+    if (!r.is_ok() || !r.at_end())
+        return NULL;
+
+    // the handle array is stable now, fix the pointers into it
+    for (size_t i = 0; i < n_infos; ++i) {
+        if (func_infos[i].num_df_handles != 0)
+            func_infos[i].df_handles = &df_handles[df_handle_starts[i]];
+    }
+
+    // the disk tier evicts the least recently used files first, so mark the file as used; if
+    // this fails, the file is just evicted earlier
+    touch_file_utf8(alloc, fname.c_str());
+
+    Entry entry(
+        code,
+        code_size,
+        const_seg,
+        const_seg_size,
+        arg_layout,
+        arg_layout_size,
+        n_mapped != 0 ? &mapped_strings[0] : NULL,
+        n_mapped,
+        render_state_usage,
+        n_infos != 0 ? &func_infos[0] : NULL,
+        n_infos);
+
+    Allocator_builder builder(alloc);
+    return builder.create<Cache_entry>(alloc, entry, key);
+}
+
+// Store an entry into the disk tier.
+void Code_cache::store_to_disk(unsigned char const key[16], Entry const &entry) const
+{
+    IAllocator *alloc = get_allocator();
+
+    string fname(get_disk_file_name(key));
+    if (is_file_utf8(alloc, fname.c_str())) {
+        // content-addressed: already written by us or by another process
+        return;
+    }
+
+    Disk_writer w(alloc);
+
+    w.write(disk_magic, sizeof(disk_magic));
+    w.write_u32(disk_format_version);
+    w.write_str(m_disk_stamp.c_str());
+    w.write(key, 16);
+
+    w.write_u32(entry.render_state_usage);
+
+    w.write_u64(entry.code_size);
+    w.write(entry.code, entry.code_size);
+    w.write_u64(entry.const_seg_size);
+    w.write(entry.const_seg, entry.const_seg_size);
+    w.write_u64(entry.arg_layout_size);
+    w.write(entry.arg_layout, entry.arg_layout_size);
+
+    w.write_u64(entry.mapped_string_size);
+    for (size_t i = 0; i < entry.mapped_string_size; ++i) {
+        w.write_str(entry.mapped_strings[i]);
+    }
+
+    w.write_u64(entry.func_info_size);
+    for (size_t i = 0; i < entry.func_info_size; ++i) {
+        Entry::Func_info const &info = entry.func_infos[i];
+
+        w.write_str(info.name);
+        w.write_u32(uint32_t(info.dist_kind));
+        w.write_u32(uint32_t(info.func_kind));
+        for (int j = 0; j < int(IGenerated_code_executable::PL_NUM_LANGUAGES); ++j) {
+            w.write_str(info.prototypes[j]);
+        }
+        w.write_u64(info.arg_block_index);
+        w.write_u64(info.num_df_handles);
+        for (size_t j = 0; j < info.num_df_handles; ++j) {
+            w.write_str(info.df_handles[j]);
+        }
+        w.write_u32(uint32_t(info.state_usage));
+    }
+
+    w.write_u64(fnv1a_64(w.data(), w.size()));
+
+    // write to a unique temporary file first and rename it afterwards, so readers
+    // in other processes never see a partially written entry
+    char suffix[64];
+    snprintf(
+        suffix, sizeof(suffix), ".tmp%u_%u_%p",
+        get_process_id(), unsigned(++m_disk_tmp_counter), (void const *)this);
+    string tmp_name(fname);
+    tmp_name += suffix;
+
+    FILE *f = fopen_utf8(alloc, tmp_name.c_str(), "wb");
+    if (f == NULL)
+        return;
+
+    bool ok = fwrite(w.data(), 1, w.size(), f) == w.size();
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || !rename_file_utf8(alloc, tmp_name.c_str(), fname.c_str())) {
+        remove_file_utf8(alloc, tmp_name.c_str());
+        return;
+    }
+
+    mi::base::Lock::Block block(&m_disk_lock);
+
+    ++m_disk_stores;
+    m_disk_curr_size += w.size();
+    if (m_disk_curr_size > m_disk_max_size) {
+        // strip to 3/4 of the maximum size to avoid rescanning the directory on every store
+        strip_disk_size(m_disk_max_size - m_disk_max_size / 4);
+    }
+}
+
+// Recompute the size of the disk tier and drop the least recently used files until it is
+// below the given limit.
+void Code_cache::strip_disk_size(size_t limit) const
+{
+    IAllocator *alloc = get_allocator();
+
+    Directory dir(alloc);
+    if (!dir.open(m_disk_dir.c_str()))
+        return;
+
+    size_t const ext_len = sizeof(disk_extension) - 1;
+    time_t const now     = time(NULL);
+
+    vector<Disk_file>::Type files(alloc);
+    size_t total = 0;
+    for (char const *name = dir.read(); name != NULL; name = dir.read()) {
+        size_t len = strlen(name);
+
+        bool is_entry = len > ext_len && strcmp(name + len - ext_len, disk_extension) == 0;
+        bool is_tmp   = !is_entry && strstr(name, ".tmp") != NULL &&
+            strstr(name, disk_extension) != NULL;
+        if (!is_entry && !is_tmp)
+            continue;
+
+        Disk_file file = { join_path(m_disk_dir, string(name, alloc)), 0, 0 };
+        if (!stat_file_utf8(alloc, file.name.c_str(), file.size, file.mtime))
+            continue;
+
+        if (is_tmp) {
+            // left over by a crashed writer
+            if (now - file.mtime > disk_stale_tmp_age)
+                remove_file_utf8(alloc, file.name.c_str());
+            continue;
+        }
+
+        total += file.size;
+        files.push_back(file);
     }
+    dir.close();
+
+    if (total > limit) {
+        std::sort(files.begin(), files.end(), Disk_file_older());
+
+        for (size_t i = 0, n = files.size(); i < n && total > limit; ++i) {
+            // if the removal fails, another process has probably removed it already
+            remove_file_utf8(alloc, files[i].name.c_str());
+            total -= files[i].size;
+        }
+    }
+    m_disk_curr_size = total;
+}
+
+// Constructor.
+Code_cache::Shard::Shard(IAllocator *alloc)
+: m_lock()
+, m_head(NULL)
+, m_tail(NULL)
+, m_search_map(0, Search_map::hasher(), Search_map::key_equal(), alloc)
+, m_curr_size(0)
+, m_hits(0)
+, m_disk_hits(0)
+, m_misses(0)
+, m_evictions(0)
+{
 }
 
 // Constructor.
@@ -243,13 +799,21 @@ Code_cache::Code_cache(
     IAllocator *alloc,
     size_t     max_size)
 : Base(alloc)
-, m_cache_lock()
-, m_head(NULL)
-, m_tail(NULL)
-, m_search_map(Search_map::key_compare(), alloc)
 , m_max_size(max_size)
 , m_curr_size(0)
+, m_disk_lock()
+, m_disk_dir(alloc)
+, m_disk_stamp(alloc)
+, m_disk_max_size(0)
+, m_disk_curr_size(0)
+, m_disk_stores(0)
+, m_disk_tmp_counter(0)
 {
+    Allocator_builder builder(alloc);
+
+    for (size_t i = 0; i < n_shards; ++i) {
+        m_shards[i] = builder.create<Shard>(alloc);
+    }
 }
 
 // Destructor.
@@ -257,10 +821,15 @@ Code_cache::~Code_cache()
 {
     Allocator_builder builder(get_allocator());
 
-    m_search_map.clear();
-    for (Cache_entry *n = NULL, *p = m_head; p != NULL; p = n) {
-        n = p->m_next;
-        builder.destroy(p);
+    for (size_t i = 0; i < n_shards; ++i) {
+        Shard *shard = m_shards[i];
+
+        shard->m_search_map.clear();
+        for (Cache_entry *n = NULL, *p = shard->m_head; p != NULL; p = n) {
+            n = p->m_next;
+            builder.destroy(p);
+        }
+        builder.destroy(shard);
     }
 }
 
@@ -29,8 +29,10 @@
 #ifndef MDL_COMPILERCORE_CODE_CACHE_H
 #define MDL_COMPILERCORE_CODE_CACHE_H 1
 
+#include <atomic>
 #include <cstring>
 
+#include <mi/base/atom.h>
 #include <mi/base/lock.h>
 #include <mi/mdl/mdl_code_generators.h>
 
@@ -41,10 +43,26 @@ namespace mi {
 namespace mdl {
 
 /// The code cache helper class.
+///
+/// The cache consists of an in-memory tier and an optional persistent tier on disk.
+///
+/// The memory tier is split into shards selected by the first key byte, each protected by
+/// its own lock, so concurrent lookups of different keys rarely contend. Replacement uses
+/// the CLOCK (second chance) approximation of LRU: a hit only sets the reference bit of the
+/// entry instead of relinking it, and eviction gives referenced entries a second chance.
+///
+/// Every entry of the disk tier is stored in its own content-addressed file, named after
+/// the hex-encoded cache key. Files are written to a temporary name first and then
+/// renamed, so concurrent processes sharing the same directory never observe partially
+/// written entries. The modification time of a file is updated on every disk hit, so the
+/// disk tier evicts the least recently used files first.
 class Code_cache : public Allocator_interface_implement<mi::mdl::ICode_cache>
 {
     typedef Allocator_interface_implement<mi::mdl::ICode_cache> Base;
 
+    /// The number of shards of the memory tier, must be a power of two.
+    static size_t const n_shards = 16;
+
     class Key {
         friend class Code_cache;
     public:
@@ -69,6 +87,18 @@ class Code_cache : public Allocator_interface_implement<mi::mdl::ICode_cache>
         unsigned char m_key[16];
     };
 
+    /// Hash functor for keys. The keys are already MD5 hashes, so just take some bytes
+    /// not used for the shard selection.
+    class Key_hash {
+    public:
+        size_t operator()(Key const &key) const
+        {
+            size_t h;
+            memcpy(&h, &key.m_key[1], sizeof(h));
+            return h;
+        }
+    };
+
     class Cache_entry : public mi::mdl::ICode_cache::Entry {
         typedef mi::mdl::ICode_cache::Entry Base;
         friend class Code_cache;
@@ -89,6 +119,9 @@ class Code_cache : public Allocator_interface_implement<mi::mdl::ICode_cache>
         IAllocator  *m_alloc;
         Cache_entry *m_prev;
         Cache_entry *m_next;
+
+        /// The CLOCK reference bit, set on every hit.
+        bool m_referenced;
     };
 
     class Cache_entry_less {
@@ -99,23 +132,92 @@ class Code_cache : public Allocator_interface_implement<mi::mdl::ICode_cache>
         }
     };
 
+    typedef hash_map<Key, Cache_entry *, Key_hash>::Type Search_map;
+
+    /// One shard of the memory tier.
+    ///
+    /// All members are protected by the shard lock.
+    struct Shard {
+        /// Constructor.
+        explicit Shard(IAllocator *alloc);
+
+        /// The shard lock.
+        mi::base::Lock m_lock;
+
+        /// The list of all entries, new entries are inserted at the head.
+        Cache_entry *m_head;
+        Cache_entry *m_tail;
+
+        /// The map of all cache entries of this shard to speed up searches.
+        Search_map m_search_map;
+
+        /// Current size of all entries of this shard.
+        size_t m_curr_size;
+
+        size_t m_hits;        ///< Number of lookups served from memory.
+        size_t m_disk_hits;   ///< Number of lookups served from the disk tier.
+        size_t m_misses;      ///< Number of failed lookups.
+        size_t m_evictions;   ///< Number of entries dropped from memory.
+    };
+
 public:
+    /// Statistics of the cache.
+    struct Statistics {
+        size_t hits;          ///< Number of lookups served from memory.
+        size_t disk_hits;     ///< Number of lookups served from the disk tier.
+        size_t misses;        ///< Number of failed lookups.
+        size_t evictions;     ///< Number of entries dropped from memory.
+        size_t disk_stores;   ///< Number of entries written to the disk tier.
+        size_t entries;       ///< Number of entries currently in memory.
+        size_t size;          ///< Current size of all entries in memory.
+    };
+
     // Lookup a data blob.
     Entry const *lookup(unsigned char const key[16]) const MDL_FINAL;
 
     // Enter a data blob.
     bool enter(unsigned char const key[16], Entry const &entry) MDL_FINAL;
 
+    /// Enable the persistent disk tier of this cache.
+    ///
+    /// \param directory  UTF8 encoded directory for the cache files, created if missing
+    /// \param max_size   maximum number of bytes the cache files may occupy on disk
+    ///
+    /// \return true on success, false if the directory cannot be used
+    bool enable_disk_tier(char const *directory, size_t max_size);
+
+    /// Set a stamp identifying the producer of the cached code.
+    ///
+    /// Disk entries written with a different stamp (for instance by a different version of
+    /// the code generators) are ignored on lookup.
+    ///
+    /// \param stamp  an arbitrary string, typically the build version
+    void set_disk_stamp(char const *stamp);
+
+    /// Retrieve the current statistics of this cache.
+    ///
+    /// \param stats  will be filled with the summed up statistics of all shards
+    void get_statistics(Statistics &stats) const;
+
 private:
-    /// Create a new entry and put it in front.
-    /// Assumes that current size has already been updated.
-    Cache_entry *new_entry(mi::mdl::ICode_cache::Entry const &entry, unsigned char const key[16]);
+    /// Get the shard responsible for the given key.
+    Shard &get_shard(unsigned char const key[16]) const
+    {
+        return *m_shards[key[0] & (n_shards - 1)];
+    }
 
-    /// Remove an entry from the list.
-    void remove_from_list(Cache_entry &entry) const;
+    /// Insert a new entry into the memory tier.
+    ///
+    /// \param entry  the new entry, will be destroyed if the key is already present
+    ///
+    /// \return the entry in the cache
+    Cache_entry *insert_entry(Cache_entry *entry) const;
 
-    /// Move an entry to front.
-    void to_front(Cache_entry &entry) const;
+    /// Remove an entry from the list of its shard.
+    static void remove_from_list(Shard &shard, Cache_entry &entry);
+
+    /// Put an entry in front of the list of its shard.
+    static void to_front(Shard &shard, Cache_entry &entry);
 
     /// Compare an entry with a key.
     static int cmp(Cache_entry const &entry, unsigned char const key[16])
@@ -123,8 +225,34 @@ private:
         return memcmp(entry.m_key.m_key, key, sizeof(entry.m_key));
     }
 
-    // Drop entries from the end until size is reached.
-    void strip_size();
+    /// Evict one entry from a shard using the CLOCK policy.
+    ///
+    /// \param shard  the shard, its lock must be held
+    /// \param keep   this entry is never evicted
+    ///
+    /// \return the size of the evicted entry or 0 if nothing could be evicted
+    size_t evict_one(Shard &shard, Cache_entry const *keep) const;
+
+    /// Drop entries until the maximum size is reached, starting with the shard of the
+    /// given entry.
+    ///
+    /// \param keep  the entry that was just inserted, it is never evicted
+    void strip_size(Cache_entry const *keep) const;
+
+    /// Get the disk tier file name for the given key.
+    string get_disk_file_name(unsigned char const key[16]) const;
+
+    /// Load an entry from the disk tier.
+    ///
+    /// \return the newly created entry or NULL if the key is not on disk or the file is invalid
+    Cache_entry *load_from_disk(unsigned char const key[16]) const;
+
+    /// Store an entry into the disk tier.
+    void store_to_disk(unsigned char const key[16], Entry const &entry) const;
+
+    /// Recompute the size of the disk tier and drop the least recently used files until it is
+    /// below the given limit.
+    void strip_disk_size(size_t limit) const;
 
 public:
     /// Constructor.
@@ -136,21 +264,35 @@ public:
     virtual ~Code_cache();
 
 private:
-    mutable mi::base::Lock m_cache_lock;
+    /// The shards of the memory tier.
+    Shard *m_shards[n_shards];
 
-    mutable Cache_entry *m_head;
-    mutable Cache_entry *m_tail;
+    /// Maximum size of this cache object.
+    size_t m_max_size;
 
-    typedef map<Key, Cache_entry *>::Type Search_map;
+    /// Current size of all shards.
+    mutable std::atomic<size_t> m_curr_size;
 
-    /// The map of all cache entry to speed up searches.
-    mutable Search_map m_search_map;
+    /// Lock for the disk tier bookkeeping.
+    mutable mi::base::Lock m_disk_lock;
 
-    /// Maximum size of this cache object.
-    size_t m_max_size;
+    /// The directory of the disk tier, empty if the disk tier is disabled.
+    string m_disk_dir;
+
+    /// The producer stamp of the disk tier.
+    string m_disk_stamp;
+
+    /// Maximum size of the disk tier.
+    size_t m_disk_max_size;
+
+    /// Current (estimated) size of the disk tier.
+    mutable size_t m_disk_curr_size;
+
+    /// Number of entries written to the disk tier.
+    mutable size_t m_disk_stores;
 
-    /// Current size.
-    size_t m_curr_size;
+    /// Counter to create unique temporary file names.
+    mutable mi::base::Atom32 m_disk_tmp_counter;
 };
 
 }  // mdl
@@ -50,6 +50,7 @@
 #include "compilercore_manifest.h"
 #include "compilercore_archiver.h"
 #include "compilercore_encapsulator.h"
+#include "compilercore_search_path_index.h"
 
 namespace mi {
 namespace mdl {
@@ -678,15 +679,12 @@ bool File_resolver::archive_contains(
     char const *archive_name,
     char const *file_name)
 {
-    bool res = false;
+    bool                         opened = false;
+    MDL_zip_container_error_code err    = EC_OK;
 
-    MDL_zip_container_error_code err = EC_OK;
-    if (MDL_zip_container_archive *archive = MDL_zip_container_archive::open(
-        m_alloc, archive_name, err, false))
-    {
-        res = archive->contains(file_name);
-        archive->close();
-    } else {
+    bool res = m_mdl.get_search_path_index().archive_contains(
+        archive_name, file_name, false, opened, err);
+    if (!opened) {
         if (err == EC_OK) {
             warning(
                 INVALID_MDL_ARCHIVE_DETECTED,
@@ -702,15 +700,12 @@ bool File_resolver::archive_contains_mask(
     char const *archive_name,
     char const *file_mask)
 {
-    bool res = false;
+    bool                         opened = false;
+    MDL_zip_container_error_code err    = EC_OK;
 
-    MDL_zip_container_error_code err = EC_OK;
-    if (MDL_zip_container_archive *archive = MDL_zip_container_archive::open(
-        m_alloc, archive_name, err, false))
-    {
-        res = archive->contains_mask(file_mask);
-        archive->close();
-    } else {
+    bool res = m_mdl.get_search_path_index().archive_contains(
+        archive_name, file_mask, true, opened, err);
+    if (!opened) {
         if (err == EC_OK) {
             warning(
                 INVALID_MDL_ARCHIVE_DETECTED,
@@ -1441,6 +1436,8 @@ string File_resolver::search_mdl_path(
 
     String_vec const &paths = in_resource_path ? m_resource_paths : m_paths;
 
+    Search_path_index &index = m_mdl.get_search_path_index();
+
     for (String_vec::const_iterator it(paths.begin()), end(paths.end()); it != end; ++it) {
         char const *path = it->c_str();
 
@@ -1448,8 +1445,8 @@ string File_resolver::search_mdl_path(
         m_killed_packages.clear();
 
         if (!in_resource_path) {
-            Directory dir(m_alloc);
-            if (!dir.open(path, "*.mdr")) {
+            String_vec archive_names(m_alloc);
+            if (!index.get_archives(path, archive_names)) {
                 // directory does not exist
                 continue;
             }
@@ -1457,19 +1454,11 @@ string File_resolver::search_mdl_path(
             String_map archives(String_map::key_compare(), get_allocator());
 
             // collect all archives first for the KILL test
-            for (char const *entry = dir.read(); entry != NULL; entry = dir.read()) {
-                string e(entry, m_alloc);
-                size_t l = e.size();
-
-                if (l < 5) {
-                    continue;
-                }
-                if (e[l - 4] != '.' || e[l - 3] != 'm' || e[l - 2] != 'd' || e[l - 1] != 'r') {
-                    continue;
-                }
+            for (size_t i = 0, n = archive_names.size(); i < n; ++i) {
+                string const &e = archive_names[i];
 
                 // remove .mdr
-                archives.insert(String_map::value_type(e.substr(0, l - 4), true));
+                archives.insert(String_map::value_type(e.substr(0, e.size() - 4), true));
             }
 
             // search for archives
@@ -1517,7 +1506,6 @@ string File_resolver::search_mdl_path(
                     }
                 }
             }
-            dir.close();
         }
 
         // no archives
@@ -1601,23 +1589,23 @@ bool File_resolver::file_exists(
         return is_file_utf8(m_alloc, fname);
     }
 
-    // open container, mdr or mdle
-    char const *container_file_name = NULL;
-    MDL_zip_container *container = NULL;
-    MDL_zip_container_error_code err = EC_OK;
-
     if (p_archive != NULL) {
-        string container_name = string(fname, p_archive + 4, m_alloc);
-        container_file_name = p_archive + 5;
-        container = MDL_zip_container_archive::open(m_alloc, container_name.c_str(), err, false);
-    }
+        // look into the cached manifest of the archive
+        string                       container_name(fname, p_archive + 4, m_alloc);
+        bool                         opened = false;
+        MDL_zip_container_error_code err    = EC_OK;
 
-    if (p_mdle != NULL) {
-        string container_name = string(fname, p_mdle + 5, m_alloc);
-        container_file_name = p_mdle + 6;
-        container = MDL_zip_container_mdle::open(m_alloc, container_name.c_str(), err);
+        return m_mdl.get_search_path_index().archive_contains(
+            container_name.c_str(), p_archive + 5, is_regex, opened, err);
     }
 
+    // open the MDLE container
+    string container_name = string(fname, p_mdle + 5, m_alloc);
+    char const *container_file_name = p_mdle + 6;
+    MDL_zip_container_error_code err = EC_OK;
+    MDL_zip_container *container =
+        MDL_zip_container_mdle::open(m_alloc, container_name.c_str(), err);
+
     // check if there is a corresponding file
     if (container != NULL) {
         bool res = is_regex ?
@@ -39,8 +39,12 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 
-#ifndef MI_PLATFORM_WINDOWS
+#ifdef MI_PLATFORM_WINDOWS
+#include <process.h>
+#include <sys/utime.h>
+#else
 #include <unistd.h>
+#include <utime.h>
 #include <dirent.h>
 #include <errno.h>
 #endif
@@ -277,6 +281,97 @@ bool mkdir_utf8(
     return true;
 }
 
+// Retrieve the size and the last modification time of a file.
+bool stat_file_utf8(
+    IAllocator *alloc,
+    char const *fname,
+    size_t     &size,
+    time_t     &mtime)
+{
+#ifdef MI_PLATFORM_WINDOWS
+    struct _stat64 st;
+
+    wstring path(alloc);
+    utf8_to_utf16(path, fname);
+
+    if (::_wstat64(path.c_str(), &st) != 0) {
+        return false;
+    }
+#else
+    struct stat st;
+
+    // assume native UTF8-support
+    if (::stat(fname, &st) != 0) {
+        return false;
+    }
+#endif
+    size  = size_t(st.st_size);
+    mtime = time_t(st.st_mtime);
+    return true;
+}
+
+// Atomically renames a file, replacing an existing destination if the OS supports this.
+bool rename_file_utf8(
+    IAllocator *alloc,
+    char const *from,
+    char const *to)
+{
+#ifdef MI_PLATFORM_WINDOWS
+    wstring f(alloc);
+    utf8_to_utf16(f, from);
+
+    wstring t(alloc);
+    utf8_to_utf16(t, to);
+
+    return ::MoveFileExW(f.c_str(), t.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    // assume native UTF8-support
+    return ::rename(from, to) == 0;
+#endif
+}
+
+// Removes a file from the file system.
+bool remove_file_utf8(
+    IAllocator *alloc,
+    char const *fname)
+{
+#ifdef MI_PLATFORM_WINDOWS
+    wstring path(alloc);
+    utf8_to_utf16(path, fname);
+
+    return ::_wremove(path.c_str()) == 0;
+#else
+    // assume native UTF8-support
+    return ::remove(fname) == 0;
+#endif
+}
+
+// Sets the last access and modification time of a file to the current time.
+bool touch_file_utf8(
+    IAllocator *alloc,
+    char const *fname)
+{
+#ifdef MI_PLATFORM_WINDOWS
+    wstring path(alloc);
+    utf8_to_utf16(path, fname);
+
+    return ::_wutime64(path.c_str(), NULL) == 0;
+#else
+    // assume native UTF8-support
+    return ::utime(fname, NULL) == 0;
+#endif
+}
+
+// Get the id of the current process.
+unsigned get_process_id()
+{
+#ifdef MI_PLATFORM_WINDOWS
+    return unsigned(_getpid());
+#else
+    return unsigned(getpid());
+#endif
+}
+
 // Get the current working directory
 string get_cwd(IAllocator *alloc)
 {
@@ -30,6 +30,7 @@
 #define MDL_COMPILERCORE_FILE_UTILS_H 1
 
 #include <cstdio>
+#include <ctime>
 
 #include "compilercore_allocator.h"
 
@@ -112,6 +113,49 @@ bool mkdir_utf8(
     IAllocator *alloc,
     char const *path);
 
+/// Retrieve the size and the last modification time of a file.
+///
+/// \param alloc   an allocator
+/// \param fname   an UTF8 encoded file name
+/// \param size    will be set to the file size in bytes
+/// \param mtime   will be set to the last modification time
+///
+/// \return true on success, false if the file does not exist
+bool stat_file_utf8(
+    IAllocator *alloc,
+    char const *fname,
+    size_t     &size,
+    time_t     &mtime);
+
+/// Atomically renames a file, replacing an existing destination if the OS supports this.
+///
+/// \param alloc  an allocator
+/// \param from   an UTF8 encoded file name of the existing file
+/// \param to     an UTF8 encoded file name of the new name
+bool rename_file_utf8(
+    IAllocator *alloc,
+    char const *from,
+    char const *to);
+
+/// Removes a file from the file system.
+///
+/// \param alloc  an allocator
+/// \param fname  an UTF8 encoded file name
+bool remove_file_utf8(
+    IAllocator *alloc,
+    char const *fname);
+
+/// Sets the last access and modification time of a file to the current time.
+///
+/// \param alloc  an allocator
+/// \param fname  an UTF8 encoded file name
+bool touch_file_utf8(
+    IAllocator *alloc,
+    char const *fname);
+
+/// Get the id of the current process, for instance to create unique temporary file names.
+unsigned get_process_id();
+
 /// Retrieve the current working directory.
 ///
 /// \param alloc  an allocator
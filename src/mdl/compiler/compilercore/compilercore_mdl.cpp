@@ -35,6 +35,8 @@
 
 #include <mi/mdl/mdl_translator_plugin.h>
 
+#include <base/system/version/i_version.h>
+
 #include "compilercore_cc_conf.h"
 #include "compilercore_mdl.h"
 #include "compilercore_allocator.h"
@@ -46,6 +48,7 @@
 #include "compilercore_modules.h"
 #include "compilercore_options.h"
 #include "compilercore_file_resolution.h"
+#include "compilercore_hash.h"
 #include "compilercore_printers.h"
 #include "compilercore_wchar_support.h"
 #include "compilercore_streams.h"
@@ -54,6 +57,7 @@
 #include "compilercore_errors.h"
 #include "compilercore_builder.h"
 #include "compilercore_serializer.h"
+#include "compilercore_stdlib_image.h"
 #include "compilercore_tools.h"
 #include "compilercore_archiver.h"
 #include "compilercore_comparator.h"
@@ -370,12 +374,119 @@ public:
     }
 };
 
+/// Implementation of the IModule_imports interface.
+class Module_imports MDL_FINAL : public Allocator_interface_implement<IModule_imports> {
+    typedef Allocator_interface_implement<IModule_imports> Base;
+public:
+    /// Get the absolute name of the importing module.
+    char const *get_module_name() const MDL_FINAL { return m_module_name.c_str(); }
+
+    /// Get the number of directly imported modules.
+    size_t get_import_count() const MDL_FINAL { return m_imports.size(); }
+
+    /// Get the absolute name of the i'th directly imported module.
+    char const *get_import_name(size_t i) const MDL_FINAL
+    {
+        return i < m_imports.size() ? m_imports[i].c_str() : NULL;
+    }
+
+    /// Add an imported module if not already added.
+    ///
+    /// \param abs_name  the absolute name of the imported module
+    void add_import(string const &abs_name)
+    {
+        if (abs_name == m_module_name) {
+            return;
+        }
+        for (size_t i = 0, n = m_imports.size(); i < n; ++i) {
+            if (m_imports[i] == abs_name) {
+                return;
+            }
+        }
+        m_imports.push_back(abs_name);
+    }
+
+    /// Constructor.
+    ///
+    /// \param alloc        the allocator
+    /// \param module_name  the absolute name of the importing module
+    Module_imports(IAllocator *alloc, char const *module_name)
+    : Base(alloc)
+    , m_module_name(module_name, alloc)
+    , m_imports(alloc)
+    {
+    }
+
+private:
+    /// The absolute name of the importing module.
+    string const m_module_name;
+
+    /// The absolute names of the directly imported modules.
+    vector<string>::Type m_imports;
+};
+
 #ifdef DEBUG
 
 dbg::DebugMallocAllocator dbgMallocAlloc;
 
 #endif  // DEBUG
 
+/// An embedded builtin module source.
+struct Builtin_module_source {
+    char const          *name;   ///< The absolute name of the module.
+    unsigned char const *data;   ///< The encoded source.
+    size_t              size;    ///< The size of the encoded source.
+    unsigned            flags;   ///< The module flags.
+};
+
+/// All builtin modules in load order.
+Builtin_module_source const builtin_module_sources[] = {
+    // state.mdl must be first due to dependencies of material structs to state::normal
+    { "::state",  mdl_module_state,  sizeof(mdl_module_state),  Module::MF_IS_STDLIB },
+    // tex.mdl next, this defines the gamma_mode enum
+    { "::tex",    mdl_module_tex,    sizeof(mdl_module_tex),    Module::MF_IS_STDLIB },
+    { "::limits", mdl_module_limits, sizeof(mdl_module_limits), Module::MF_IS_STDLIB },
+    { "::anno",   mdl_module_anno,   sizeof(mdl_module_anno),   Module::MF_IS_STDLIB },
+    { "::math",   mdl_module_math,   sizeof(mdl_module_math),   Module::MF_IS_STDLIB },
+    { "::df",     mdl_module_df,     sizeof(mdl_module_df),     Module::MF_IS_STDLIB },
+    { "::scene",  mdl_module_scene,  sizeof(mdl_module_scene),  Module::MF_IS_STDLIB },
+    { "::debug",  mdl_module_debug,  sizeof(mdl_module_debug),
+        Module::MF_IS_STDLIB | Module::MF_IS_DEBUG },
+    // std.mdl after all the above
+    { "::std",    mdl_module_std,    sizeof(mdl_module_std),    Module::MF_IS_STDLIB },
+    // finally builtins.mdl
+    { "::<builtins>", mdl_module_builtins, sizeof(mdl_module_builtins),
+        Module::MF_IS_STDLIB | Module::MF_IS_BUILTIN },
+    // nvidia::baking.mdl, which is NOT a stdlib module
+    { "::nvidia::baking", mdl_module_nvidia_baking, sizeof(mdl_module_nvidia_baking),
+        Module::MF_IS_STDLIB | Module::MF_IS_OWNED },
+    // currently base.mdl, this must be hashed
+    { "::base", mdl_module_base, sizeof(mdl_module_base),
+        Module::MF_IS_OWNED | Module::MF_IS_HASHED },
+};
+
+/// Compute the key of the standard library image of this compiler build.
+///
+/// The key covers the platform version, the serialization format version and the embedded
+/// module sources. The platform version ties images to the compiler release, because analysis
+/// results may change without any change to the serialization format.
+static void compute_stdlib_image_key(unsigned char key[16])
+{
+    MD5_hasher hasher;
+
+    hasher.update(MI::VERSION::get_platform_version());
+    hasher.update(mi::Uint32(MDL_BINARY_SERIALIZATION_VERSION));
+    hasher.update(mi::Uint32(sizeof(void *)));
+    for (size_t i = 0, n = dimension_of(builtin_module_sources); i < n; ++i) {
+        Builtin_module_source const &src = builtin_module_sources[i];
+
+        hasher.update(src.name);
+        hasher.update(mi::Uint32(src.flags));
+        hasher.update(src.data, src.size);
+    }
+    hasher.final(key);
+}
+
 /// Creates a new MDL compiler-
 static mi::mdl::MDL *create_mdl(IAllocator *alloc)
 {
@@ -402,6 +513,7 @@ MDL::MDL(IAllocator *alloc)
 , m_external_resolver()
 , m_global_lock()
 , m_search_path_lock()
+, m_search_path_index(alloc)
 , m_weak_module_lock()
 , m_predefined_types_build(false)
 , m_jitted_code(NULL)
@@ -413,150 +525,47 @@ MDL::MDL(IAllocator *alloc)
     // create built-in modules
     mi::base::Handle<Thread_context> ctx(create_thread_context());
 
-    // load state.mdl,
-    // must be first due to dependencies of material structs to state::normal
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_state, sizeof(mdl_module_state), ""));
-        Module *state_mod = load_module(
-            NULL, ctx.get(), "::state", s.get(), Module::MF_IS_STDLIB);
+    unsigned char key[16];
+    compute_stdlib_image_key(key);
 
-        // takes ownership
-        register_builtin_module(state_mod);
-    }
-
-    // load tex.mdl next, this defines the gamma_mode enum
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_tex, sizeof(mdl_module_tex), ""));
-        Module *tex_mod = load_module(
-            NULL, ctx.get(), "::tex", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(tex_mod);
-    }
-
-    // load limits.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_limits, sizeof(mdl_module_limits), ""));
-        Module *limits_mod = load_module(
-            NULL, ctx.get(), "::limits", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(limits_mod);
-    }
-
-    // load anno.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_anno, sizeof(mdl_module_anno), ""));
-        Module *anno_mod = load_module(
-            NULL, ctx.get(), "::anno", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(anno_mod);
-    }
-
-    // load math.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_math, sizeof(mdl_module_math), ""));
-        Module *math_mod = load_module(
-            NULL, ctx.get(), "::math", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(math_mod);
-    }
-
-    // load df.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_df, sizeof(mdl_module_df), ""));
-        Module *df_mod = load_module(
-            NULL, ctx.get(), "::df", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(df_mod);
-    }
-
-    // load scene.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_scene, sizeof(mdl_module_scene), ""));
-        Module *scene_mod = load_module(
-            NULL, ctx.get(), "::scene", s.get(), Module::MF_IS_STDLIB);
-
-        // takes ownership
-        register_builtin_module(scene_mod);
+    // use the image of this process if it has exactly the expected modules
+    size_t n_sources = dimension_of(builtin_module_sources);
+    Stdlib_image const *image = Stdlib_image::get(key);
+    if (image != NULL) {
+        bool matches = image->get_module_count() == n_sources;
+        for (size_t i = 0; matches && i < n_sources; ++i) {
+            matches = strcmp(image->get_module_name(i), builtin_module_sources[i].name) == 0;
+        }
+        if (!matches) {
+            image = NULL;
+        }
     }
 
-    // load debug.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_debug, sizeof(mdl_module_debug), ""));
-        Module *debug_mod = load_module(
-            NULL, ctx.get(), "::debug", s.get(), Module::MF_IS_STDLIB | Module::MF_IS_DEBUG);
+    // otherwise create one while parsing
+    Stdlib_image *new_image = image == NULL ? Stdlib_image::create(key) : NULL;
 
-        // takes ownership
-        register_builtin_module(debug_mod);
-    }
-
-    // load std.mdl after all the above
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_std, sizeof(mdl_module_std), ""));
-        Module *std_mod = load_module(
-            NULL, ctx.get(), "::std", s.get(), Module::MF_IS_STDLIB);
+    for (size_t i = 0; i < n_sources; ++i) {
+        Builtin_module_source const &src = builtin_module_sources[i];
 
-        // takes ownership
-        register_builtin_module(std_mod);
-    }
-    // finally load builtins.mdl
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_builtins, sizeof(mdl_module_builtins), ""));
-        Module *builtins_mod = load_module(
-            NULL, ctx.get(), "::<builtins>", s.get(),
-            Module::MF_IS_STDLIB | Module::MF_IS_BUILTIN);
-
-        // takes ownership
-        register_builtin_module(builtins_mod);
-    }
+        Module const *mod = NULL;
+        if (image != NULL) {
+            mod = deserialize_builtin_module(image->get_module_data(i), image->get_module_size(i));
+        } else {
+            mi::base::Handle<Buffer_Input_stream> s(
+                m_builder.create<Encoded_buffer_Input_stream>(
+                    m_builder.get_allocator(), src.data, src.size, ""));
+            mod = load_module(NULL, ctx.get(), src.name, s.get(), src.flags);
 
-    // now load nvidia::baking.mdl, which is NOT a stdlib module
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_nvidia_baking, sizeof(mdl_module_nvidia_baking), ""));
-        Module *baking_mod = load_module(
-            NULL, ctx.get(), "::nvidia::baking", s.get(),
-            Module::MF_IS_STDLIB | Module::MF_IS_OWNED);
+            // must be serialized before it is registered, otherwise only a reference is written
+            serialize_builtin_module(mod, *new_image);
+        }
 
         // takes ownership
-        register_builtin_module(baking_mod);
+        register_builtin_module(mod);
     }
 
-    // currently load base.mdl, this must be hashed
-    {
-        mi::base::Handle<Buffer_Input_stream> s(m_builder.create<Encoded_buffer_Input_stream>(
-            m_builder.get_allocator(),
-            mdl_module_base, sizeof(mdl_module_base), ""));
-        Module *base_mod = load_module(
-            NULL, ctx.get(), "::base", s.get(), Module::MF_IS_OWNED | Module::MF_IS_HASHED);
-
-        // takes ownership
-        register_builtin_module(base_mod);
+    if (new_image != NULL) {
+        Stdlib_image::publish(new_image);
     }
 }
 
@@ -625,6 +634,13 @@ void MDL::install_search_path(IMDL_search_path *search_path)
         search_path = m_builder.create<Empty_search_path>(get_allocator());
     }
     m_search_path = search_path;
+    m_search_path_index.invalidate();
+}
+
+// Drop all cached knowledge about the directories and archives on the search path.
+void MDL::invalidate_search_path_index()
+{
+    m_search_path_index.invalidate();
 }
 
 // Register built-in modules at a module cache.
@@ -1103,26 +1119,14 @@ void MDL::create_options()
 #undef STR
 }
 
-// Load a module from a stream.
-Module *MDL::load_module(
-    IModule_cache   *cache,
-    IThread_context *context,
-    char const      *module_name,
-    IInput_stream   *s,
-    unsigned        flags,
-    char const      *msg_name)
+// Parse a module from a stream without analyzing it.
+Module *MDL::parse_module(
+    Thread_context *ctx,
+    char const     *module_name,
+    IInput_stream  *s,
+    unsigned       flags,
+    char const     *msg_name)
 {
-    Thread_context *ctx = impl_cast<Thread_context>(context);
-
-    // make sure there is a waiting table entry in case the module needs loading
-    if (cache != NULL) {
-        mi::base::Handle<const mi::mdl::IModule> existing_module(cache->lookup(module_name, NULL));
-        if (existing_module) {
-            // the module is cached and we load it anyway
-            MDL_ASSERT(!"tried to load an already cached module");
-        }
-    }
-
     Module *mod =
         create_module(module_name, s->get_filename(), IMDL::MDL_DEFAULT_VERSION, flags);
     if (mod == NULL) {
@@ -1168,6 +1172,33 @@ Module *MDL::load_module(
             mod->m_is_mdle   = true;
         }
     }
+    return mod;
+}
+
+// Load a module from a stream.
+Module *MDL::load_module(
+    IModule_cache   *cache,
+    IThread_context *context,
+    char const      *module_name,
+    IInput_stream   *s,
+    unsigned        flags,
+    char const      *msg_name)
+{
+    Thread_context *ctx = impl_cast<Thread_context>(context);
+
+    // make sure there is a waiting table entry in case the module needs loading
+    if (cache != NULL) {
+        mi::base::Handle<const mi::mdl::IModule> existing_module(cache->lookup(module_name, NULL));
+        if (existing_module) {
+            // the module is cached and we load it anyway
+            MDL_ASSERT(!"tried to load an already cached module");
+        }
+    }
+
+    Module *mod = parse_module(ctx, module_name, s, flags, msg_name);
+    if (mod == NULL) {
+        return NULL;
+    }
 
     mod->analyze(cache, ctx);
     return mod;
@@ -1211,6 +1242,147 @@ Module const *MDL::load_module(
     return res;
 }
 
+// Discover the modules a module imports directly.
+IModule_imports const *MDL::get_module_imports(
+    IThread_context *context,
+    char const      *module_name,
+    IModule_cache   *cache)
+{
+    if (is_foreign_module(module_name) != NULL) {
+        return NULL;
+    }
+
+    mi::base::Handle<Thread_context> hctx;
+
+    Thread_context *ctx = impl_cast<Thread_context>(context);
+
+    if (ctx == NULL) {
+        // user does not pass a context, create a temporary one
+        hctx = mi::base::make_handle(create_thread_context());
+        ctx  = hctx.get();
+    }
+
+    // discovery is best-effort, any problem is reported by load_module() later
+    Messages_impl messages(get_allocator(), "");
+    File_resolver resolver(
+        *this,
+        cache,
+        m_external_resolver,
+        m_search_path,
+        m_search_path_lock,
+        messages,
+        ctx->get_front_path(),
+        ctx->get_virtual_root_package());
+
+    mi::base::Handle<IMDL_import_result> result(resolve_import(
+        resolver, module_name, /*owner_module=*/NULL, /*pos=*/NULL, ctx));
+    if (!result.is_valid_interface()) {
+        return NULL;
+    }
+
+    string abs_name(result->get_absolute_name(), get_allocator());
+    if (find_builtin_module(abs_name) != NULL) {
+        return NULL;
+    }
+
+    mi::base::Handle<IInput_stream> input(result->open(ctx));
+    if (!input.is_valid_interface()) {
+        return NULL;
+    }
+
+    mi::base::Handle<Module> mod(
+        parse_module(ctx, abs_name.c_str(), input.get(), Module::MF_STANDARD, NULL));
+    if (!mod.is_valid_interface()) {
+        return NULL;
+    }
+
+    Module_imports *imports =
+        m_builder.create<Module_imports>(get_allocator(), abs_name.c_str());
+
+    // namespace aliases are only known after analysis, skip imports using them
+    vector<ISymbol const *>::Type aliases(get_allocator());
+    for (int i = 0, n = mod->get_declaration_count(); i < n; ++i) {
+        IDeclaration const *decl = mod->get_declaration(i);
+        if (IDeclaration_namespace_alias const *alias_decl =
+                as<IDeclaration_namespace_alias>(decl)) {
+            aliases.push_back(alias_decl->get_alias()->get_symbol());
+        }
+    }
+
+    char const *fname = mod->get_filename();
+    bool weak_is_relative =
+        mod->get_mdl_version() >= IMDL::MDL_VERSION_1_6 || (fname != NULL && fname[0] != '\0');
+
+    for (int i = 0, n = mod->get_declaration_count(); i < n; ++i) {
+        IDeclaration_import const *import_decl = as<IDeclaration_import>(mod->get_declaration(i));
+        if (import_decl == NULL) {
+            continue;
+        }
+
+        // "using M import ..." imports from M, "import M::e" and "import M::*" from M
+        IQualified_name const *using_name = import_decl->get_module_name();
+        size_t n_names = using_name != NULL ? 1 : import_decl->get_name_count();
+
+        for (size_t k = 0; k < n_names; ++k) {
+            IQualified_name const *qname =
+                using_name != NULL ? using_name : import_decl->get_name(k);
+            size_t n_comps = qname->get_component_count();
+            if (using_name == NULL) {
+                if (n_comps < 2) {
+                    continue;
+                }
+                --n_comps;
+            }
+
+            string import_name(qname->is_absolute() ? "::" : "", get_allocator());
+            bool uses_alias = false;
+            for (size_t c = 0; c < n_comps; ++c) {
+                ISymbol const *sym = qname->get_component(c)->get_symbol();
+                for (size_t a = 0, m = aliases.size(); a < m; ++a) {
+                    if (aliases[a] == sym) {
+                        uses_alias = true;
+                    }
+                }
+                if (c > 0) {
+                    import_name += "::";
+                }
+                import_name += sym->get_name();
+            }
+            if (uses_alias) {
+                continue;
+            }
+
+            // weak imports are resolved like the analysis does
+            bool is_weak = !qname->is_absolute() && import_name[0] != '.';
+            if (is_weak) {
+                import_name = (weak_is_relative ? ".::" : "::") + import_name;
+            }
+
+            if (import_name[0] == ':' && is_foreign_module(import_name.c_str()) != NULL) {
+                continue;
+            }
+
+            mi::base::Handle<IMDL_import_result> imp_result(resolve_import(
+                resolver, import_name.c_str(), mod.get(), /*pos=*/NULL, ctx));
+            if (!imp_result.is_valid_interface() && is_weak && weak_is_relative) {
+                imp_result = mi::base::make_handle(resolve_import(
+                    resolver, import_name.c_str() + 1, mod.get(), /*pos=*/NULL, ctx));
+            }
+            messages.clear();
+
+            if (!imp_result.is_valid_interface()) {
+                continue;
+            }
+
+            string imp_name(imp_result->get_absolute_name(), get_allocator());
+            if (find_builtin_module(imp_name) == NULL) {
+                imports->add_import(imp_name);
+            }
+        }
+    }
+    return imports;
+}
+
 // Load a module with a given name from a given string.
 IModule const *MDL::load_module_from_string(
     IThread_context *context,
@@ -2346,6 +2518,33 @@ bool MDL::check_version(
     return false;
 }
 
+// Serialize a builtin module into the standard library image.
+void MDL::serialize_builtin_module(Module const *mod, Stdlib_image &image) const
+{
+    Buffer_serializer     buffer(get_allocator());
+    MDL_binary_serializer bin_serializer(get_allocator(), this, &buffer);
+    Module_serializer     mod_serializer(get_allocator(), &buffer, &bin_serializer);
+
+    mod->serialize(mod_serializer);
+
+    image.add_module(mod->get_name(), buffer.get_data(), buffer.get_size());
+}
+
+// Deserialize a builtin module from the standard library image.
+Module const *MDL::deserialize_builtin_module(unsigned char const *data, size_t size)
+{
+    Buffer_deserializer     buffer(get_allocator(), data, size);
+    MDL_binary_deserializer bin_deserializer(get_allocator(), &buffer, this);
+    Module_deserializer     mod_deserializer(
+        get_allocator(), &buffer, &bin_deserializer, this);
+
+    Tag_t t = bin_deserializer.read_section_tag();
+    MDL_ASSERT(t == Serializer::ST_MODULE_START);
+    (void)t;
+
+    return Module::deserialize(mod_deserializer);
+}
+
 // Register a builtin module and take ownership of it.
 void MDL::register_builtin_module(Module const *module)
 {
@@ -39,6 +39,7 @@
 #include "compilercore_modules.h"
 #include "compilercore_options.h"
 #include "compilercore_printers.h"
+#include "compilercore_search_path_index.h"
 #include "compilercore_cstring_hash.h"
 #include "compilercore_thread_context.h"
 
@@ -50,6 +51,7 @@ class IMDL_import_result;
 class File_resolver;
 class Jitted_code;
 class Messages_impl;
+class Stdlib_image;
 
 // Evaluates an intrinsic function called on constant arguments.
 extern IValue const *evaluate_intrinsic_function(
@@ -505,6 +507,22 @@ public:
     bool remove_foreign_module_translator(
         IMDL_foreign_module_translator *translator) MDL_FINAL;
 
+    /// Drop all cached knowledge about the directories and archives on the search path.
+    void invalidate_search_path_index() MDL_FINAL;
+
+    /// Discover the modules a module imports directly.
+    ///
+    /// \param context      the thread context for this operation
+    /// \param module_name  the absolute module name
+    /// \param cache        if non-NULL, a module cache
+    ///
+    /// \returns            the direct imports or NULL if the module could not be resolved or
+    ///                     opened, or is a builtin or foreign module
+    IModule_imports const *get_module_imports(
+        IThread_context *context,
+        char const      *module_name,
+        IModule_cache   *cache) MDL_FINAL;
+
     // ------------------- non interface methods ---------------------------
 
     /// Create an empty module.
@@ -744,6 +762,9 @@ public:
     /// Get the search path helper.
     mi::base::Handle<IMDL_search_path> const &get_search_path() const { return m_search_path; }
 
+    /// Get the search path index used by the file resolver.
+    Search_path_index &get_search_path_index() const { return m_search_path_index; }
+
     /// Get the external entity resolver.
     mi::base::Handle<IEntity_resolver> const &get_external_resolver() const {
         return m_external_resolver;
@@ -806,6 +827,20 @@ private:
     /// Create all options (and default values) of the compiler.
     void create_options();
 
+    /// Parse a module from a stream without analyzing it.
+    ///
+    /// \param ctx          the thread context or NULL
+    /// \param module_name  the absolute module name
+    /// \param s            the input stream of the module
+    /// \param flags        module property flags
+    /// \param msg_name     if non-NULL, use this name for reporting compiler messages
+    Module *parse_module(
+        Thread_context *ctx,
+        char const     *module_name,
+        IInput_stream  *s,
+        unsigned       flags,
+        char const     *msg_name);
+
     /// Load a module from a stream.
     ///
     /// \param cache        if non-NULL, a module cache of already loaded modules
@@ -822,6 +857,20 @@ private:
         unsigned        flags,
         char const      *msg_name = NULL);
 
+    /// Serialize a builtin module into the standard library image.
+    ///
+    /// \param mod    the analyzed builtin module, must not be registered yet
+    /// \param image  the image to add the module to
+    void serialize_builtin_module(Module const *mod, Stdlib_image &image) const;
+
+    /// Deserialize a builtin module from the standard library image.
+    ///
+    /// \param data  the serialized module
+    /// \param size  the size of the serialized module
+    ///
+    /// \note All builtin modules loaded before this one must be registered already.
+    Module const *deserialize_builtin_module(unsigned char const *data, size_t size);
+
     /// Serialize a module and all its imported modules in bottom-up order.
     ///
     /// \param module                the module to serialize
@@ -886,6 +935,9 @@ private:
     /// The search path lock for this compiler.
     mutable mi::base::Lock m_search_path_lock;
 
+    /// The cached directory contents and archive manifests of the search path.
+    mutable Search_path_index m_search_path_index;
+
     /// The shared lock for all module's weak import tables.
     mutable mi::base::Lock m_weak_module_lock;
 
@@ -3772,7 +3772,30 @@ Module const *Module::deserialize(Module_deserializer &deserializer)
     IMDL::MDL_version mdl_version = IMDL::MDL_version(deserializer.read_encoded_tag());
     DOUT(("version: %u\n", mdl_version));
 
-    Module *mod = deserializer.create_module(mdl_version, is_analyzed);
+    unsigned flags = MF_STANDARD;
+    if (is_stdlib) {
+        flags |= MF_IS_STDLIB;
+    }
+    if (is_builtins) {
+        flags |= MF_IS_BUILTIN;
+    }
+    if (is_compiler_owned) {
+        flags |= MF_IS_OWNED;
+    }
+    if (is_debug) {
+        flags |= MF_IS_DEBUG;
+    }
+    if (is_native) {
+        flags |= MF_IS_NATIVE;
+    }
+    if (is_hashed) {
+        flags |= MF_IS_HASHED;
+    }
+    if (is_mdle) {
+        flags |= MF_IS_MDLE;
+    }
+
+    Module *mod = deserializer.create_module(mdl_version, is_analyzed, abs_name.c_str(), flags);
     deserializer.register_module(t, mod);
 
     mod->set_filename(filename.c_str());
@@ -0,0 +1,285 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "pch.h"
+
+#include <cstring>
+
+#include "compilercore_search_path_index.h"
+#include "compilercore_file_utils.h"
+#include "compilercore_archiver.h"
+#include "compilercore_assert.h"
+
+namespace mi {
+namespace mdl {
+
+typedef hash_set<string, string_hash<string> >::Type Name_set;
+
+// Constructor.
+Search_path_index::Dir_entry::Dir_entry(IAllocator *alloc)
+: exists(false)
+, archives_listed(false)
+, mtime(0)
+, read_time(0)
+, archives(alloc)
+{
+}
+
+// Constructor.
+Search_path_index::Archive_entry::Archive_entry(IAllocator *alloc)
+: opened(false)
+, err(EC_OK)
+, size(0)
+, mtime(0)
+, read_time(0)
+, names(alloc)
+, name_set(0, Name_set::hasher(), Name_set::key_equal(), alloc)
+{
+}
+
+// Constructor.
+Search_path_index::Search_path_index(IAllocator *alloc)
+: m_builder(alloc)
+, m_lock()
+, m_dirs(0, Dir_map::hasher(), Dir_map::key_equal(), alloc)
+, m_archives(0, Archive_map::hasher(), Archive_map::key_equal(), alloc)
+, m_generation(0)
+{
+}
+
+// Destructor.
+Search_path_index::~Search_path_index()
+{
+    clear();
+}
+
+// Get the names of all MDL archives inside a directory.
+bool Search_path_index::get_archives(char const *dir, vector<string>::Type &archives)
+{
+    IAllocator *alloc = m_builder.get_allocator();
+
+    archives.clear();
+
+    mi::base::Lock::Block block(&m_lock);
+
+    Dir_entry *entry = get_dir_entry(string(dir, alloc), block);
+    if (!entry->exists) {
+        return false;
+    }
+
+    if (entry->archives_listed) {
+        archives = entry->archives;
+        return true;
+    }
+
+    unsigned generation = m_generation;
+    block.release();
+
+    Directory directory(alloc);
+    if (!directory.open(dir, "*.mdr")) {
+        return false;
+    }
+
+    // the filter is ignored on some platforms, so check the extension here
+    while (char const *name = directory.read()) {
+        size_t l = strlen(name);
+        if (l > 4 && strcmp(&name[l - 4], ".mdr") == 0) {
+            archives.push_back(string(name, alloc));
+        }
+    }
+    directory.close();
+
+    block.set(&m_lock);
+    if (generation == m_generation) {
+        entry->archives        = archives;
+        entry->archives_listed = true;
+    }
+    return true;
+}
+
+// Check whether an MDL archive contains a file or a file matching a mask.
+bool Search_path_index::archive_contains(
+    char const                   *archive_name,
+    char const                   *file_name,
+    bool                         is_mask,
+    bool                         &opened,
+    MDL_zip_container_error_code &err)
+{
+    IAllocator *alloc = m_builder.get_allocator();
+
+    // ZIP uses '/'
+    string forward(file_name, alloc);
+    forward = convert_os_separators_to_slashes(forward);
+
+    mi::base::Lock::Block block(&m_lock);
+
+    Archive_entry const *entry = get_archive_entry(string(archive_name, alloc), block);
+
+    opened = entry->opened;
+    err    = entry->err;
+    if (!opened) {
+        return false;
+    }
+
+    if (!is_mask) {
+        return entry->name_set.find(forward) != entry->name_set.end();
+    }
+
+    for (size_t i = 0, n = entry->names.size(); i < n; ++i) {
+        if (utf8_match(forward.c_str(), entry->names[i].c_str())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Drop all cached data.
+void Search_path_index::invalidate()
+{
+    mi::base::Lock::Block block(&m_lock);
+
+    clear();
+    ++m_generation;
+}
+
+// Get the up-to-date entry of a directory, creating or rereading it if necessary.
+Search_path_index::Dir_entry *Search_path_index::get_dir_entry(
+    string const          &dir,
+    mi::base::Lock::Block &block)
+{
+    time_t now = time(NULL);
+
+    block.release();
+
+    size_t size  = 0;
+    time_t mtime = 0;
+    bool exists = stat_file_utf8(m_builder.get_allocator(), dir.c_str(), size, mtime);
+
+    block.set(&m_lock);
+
+    Dir_entry *entry = NULL;
+
+    // the map might have changed while the lock was released
+    Dir_map::const_iterator it = m_dirs.find(dir);
+    if (it == m_dirs.end()) {
+        entry = m_builder.create<Dir_entry>(m_builder.get_allocator());
+        m_dirs.insert(Dir_map::value_type(dir, entry));
+        entry->read_time = now;
+    } else {
+        entry = it->second;
+        if (entry->exists != exists ||
+            entry->mtime != mtime ||
+            entry->mtime >= entry->read_time)
+        {
+            // changed, or modified in the same second the data was read
+            entry->archives_listed = false;
+            entry->archives.clear();
+            entry->read_time = now;
+            ++m_generation;
+        }
+    }
+    entry->exists = exists;
+    entry->mtime  = mtime;
+    return entry;
+}
+
+// Get the up-to-date entry of an archive, creating or rereading it if necessary.
+Search_path_index::Archive_entry *Search_path_index::get_archive_entry(
+    string const          &archive_name,
+    mi::base::Lock::Block &block)
+{
+    IAllocator *alloc = m_builder.get_allocator();
+    time_t     now    = time(NULL);
+
+    block.release();
+
+    size_t size  = 0;
+    time_t mtime = 0;
+    bool exists = stat_file_utf8(alloc, archive_name.c_str(), size, mtime);
+
+    block.set(&m_lock);
+
+    Archive_map::const_iterator it = m_archives.find(archive_name);
+    if (it != m_archives.end()) {
+        Archive_entry *entry = it->second;
+        if (exists && entry->size == size && entry->mtime == mtime &&
+            entry->mtime < entry->read_time)
+        {
+            return entry;
+        }
+    }
+
+    // (re)read the manifest without holding the lock
+    block.release();
+
+    Archive_entry *fresh = m_builder.create<Archive_entry>(alloc);
+    fresh->size      = size;
+    fresh->mtime     = mtime;
+    fresh->read_time = now;
+
+    if (MDL_zip_container_archive *archive = MDL_zip_container_archive::open(
+        alloc, archive_name.c_str(), fresh->err, false))
+    {
+        fresh->opened = true;
+        for (int i = 0, n = archive->get_num_entries(); i < n; ++i) {
+            if (char const *name = archive->get_entry_name(i)) {
+                string s(name, alloc);
+                fresh->names.push_back(s);
+                fresh->name_set.insert(s);
+            }
+        }
+        archive->close();
+    }
+
+    block.set(&m_lock);
+
+    it = m_archives.find(archive_name);
+    if (it != m_archives.end()) {
+        m_builder.destroy(it->second);
+        m_archives.erase(archive_name);
+    }
+    m_archives.insert(Archive_map::value_type(archive_name, fresh));
+    return fresh;
+}
+
+// Destroy all entries.
+void Search_path_index::clear()
+{
+    for (Dir_map::iterator it(m_dirs.begin()), end(m_dirs.end()); it != end; ++it) {
+        m_builder.destroy(it->second);
+    }
+    m_dirs.clear();
+
+    for (Archive_map::iterator it(m_archives.begin()), end(m_archives.end()); it != end; ++it) {
+        m_builder.destroy(it->second);
+    }
+    m_archives.clear();
+}
+
+}  // mdl
+}  // mi
@@ -0,0 +1,182 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef MDL_COMPILERCORE_SEARCH_PATH_INDEX_H
+#define MDL_COMPILERCORE_SEARCH_PATH_INDEX_H 1
+
+#include <ctime>
+
+#include <mi/base/lock.h>
+
+#include "compilercore_allocator.h"
+#include "compilercore_zip_utils.h"
+
+namespace mi {
+namespace mdl {
+
+/// A thread-safe index of the directories and MDL archives visited during file resolution.
+///
+/// Resolving an import or a resource lists every search root to find the archives in it and
+/// opens every archive whose name matches the searched entity. The index remembers the
+/// archive names of each directory and the file names inside each archive, so a lookup costs
+/// one stat of the directory or archive instead of a directory listing or a ZIP open.
+///
+/// Cached data is revalidated by the modification time (and size) of the directory or archive
+/// it was read from. Data read in the same second the source was modified is read again,
+/// because the file system timestamp cannot tell later changes in that second apart.
+///
+/// The lock is never held during file system accesses.
+class Search_path_index
+{
+public:
+    /// Constructor.
+    ///
+    /// \param alloc  the allocator
+    explicit Search_path_index(IAllocator *alloc);
+
+    /// Destructor.
+    ~Search_path_index();
+
+    /// Get the names of all MDL archives (including the ".mdr" extension) inside a directory.
+    ///
+    /// \param[in]  dir       the directory (UTF8 encoded)
+    /// \param[out] archives  the names of the archives found
+    ///
+    /// \return false if the directory does not exist
+    bool get_archives(char const *dir, vector<string>::Type &archives);
+
+    /// Check whether an MDL archive contains a file or a file matching a mask.
+    ///
+    /// \param[in]  archive_name  the file name of the archive (UTF8 encoded)
+    /// \param[in]  file_name     the file name or mask inside the archive
+    /// \param[in]  is_mask       true, if \p file_name is a mask
+    /// \param[out] opened        false, if the archive could not be opened
+    /// \param[out] err           the error code if the archive could not be opened
+    bool archive_contains(
+        char const                   *archive_name,
+        char const                   *file_name,
+        bool                         is_mask,
+        bool                         &opened,
+        MDL_zip_container_error_code &err);
+
+    /// Drop all cached data.
+    void invalidate();
+
+private:
+    /// Cached data of one directory.
+    struct Dir_entry {
+        /// Constructor.
+        explicit Dir_entry(IAllocator *alloc);
+
+        /// True, if the directory exists.
+        bool exists;
+
+        /// True, if the archive list was read.
+        bool archives_listed;
+
+        /// The modification time of the directory when its data was read.
+        time_t mtime;
+
+        /// The point in time when the data was read.
+        time_t read_time;
+
+        /// The archives inside the directory.
+        vector<string>::Type archives;
+    };
+
+    /// Cached manifest of one archive.
+    struct Archive_entry {
+        /// Constructor.
+        explicit Archive_entry(IAllocator *alloc);
+
+        /// True, if the archive could be opened.
+        bool opened;
+
+        /// The error code if the archive could not be opened.
+        MDL_zip_container_error_code err;
+
+        /// The size of the archive file when its manifest was read.
+        size_t size;
+
+        /// The modification time of the archive file when its manifest was read.
+        time_t mtime;
+
+        /// The point in time when the manifest was read.
+        time_t read_time;
+
+        /// The names of all files inside the archive, using '/' as separator.
+        vector<string>::Type names;
+
+        /// The same names, for fast lookup.
+        hash_set<string, string_hash<string> >::Type name_set;
+    };
+
+    typedef hash_map<string, Dir_entry *, string_hash<string> >::Type     Dir_map;
+    typedef hash_map<string, Archive_entry *, string_hash<string> >::Type Archive_map;
+
+    /// Get the up-to-date entry of a directory, creating or rereading it if necessary.
+    ///
+    /// \param dir  the directory
+    ///
+    /// \note Must be called with the lock held, releases it temporarily.
+    Dir_entry *get_dir_entry(string const &dir, mi::base::Lock::Block &block);
+
+    /// Get the up-to-date entry of an archive, creating or rereading it if necessary.
+    ///
+    /// \param archive_name  the file name of the archive
+    ///
+    /// \note Must be called with the lock held, releases it temporarily.
+    Archive_entry *get_archive_entry(
+        string const          &archive_name,
+        mi::base::Lock::Block &block);
+
+    /// Destroy all entries.
+    void clear();
+
+private:
+    /// The builder for entries.
+    mutable Allocator_builder m_builder;
+
+    /// The lock protecting the maps.
+    mi::base::Lock m_lock;
+
+    /// The directory entries.
+    Dir_map m_dirs;
+
+    /// The archive entries.
+    Archive_map m_archives;
+
+    /// Incremented whenever cached directory data is dropped, so results computed without
+    /// the lock are not stored into data that was reread in the meantime.
+    unsigned m_generation;
+};
+
+}  // mdl
+}  // mi
+
+#endif // MDL_COMPILERCORE_SEARCH_PATH_INDEX_H
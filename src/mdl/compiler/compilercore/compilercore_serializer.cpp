@@ -1633,6 +1633,28 @@ void Factory_serializer::write_type(IType const *type)
                 // a predefined type
                 write_bool(true);
                 write_encoded_tag(pid);
+
+                // the values of ::tex::gamma_mode are added when the ::tex module is analyzed,
+                // write them, so a compiler that deserializes its standard library can
+                // restore them
+                int n = e_type->get_value_count();
+                write_unsigned(n);
+
+                DOUT(("#values %d\n", n));
+                INC_SCOPE();
+
+                for (int i = 0; i < n; ++i) {
+                    ISymbol const *sym;
+                    int           code;
+
+                    e_type->get_value(i, sym, code);
+
+                    write_cstring(sym->get_name());
+                    write_int(code);
+
+                    DOUT(("value %s code %d\n", sym->get_name(), code));
+                }
+                DEC_SCOPE();
             }
         }
         break;
@@ -3029,6 +3051,28 @@ IType const *Factory_deserializer::read_type(Type_factory &tf)
                 // a predefined type
                 IType_enum::Predefined_id pid = IType_enum::Predefined_id(read_encoded_tag());
                 e_type = tf.get_predefined_enum(pid);
+
+                // add the values only if the predefined type has none yet, this happens
+                // when the standard library is deserialized instead of parsed
+                bool add_values = e_type->get_value_count() == 0;
+
+                int n = read_unsigned();
+
+                DOUT(("#values %d\n", n));
+                INC_SCOPE();
+
+                for (int i = 0; i < n; ++i) {
+                    char const *name = read_cstring();
+                    int        code  = read_int();
+
+                    if (add_values) {
+                        ISymbol const *sym = tf.get_symbol_table()->get_symbol(name);
+                        e_type->add_value(sym, code);
+                    }
+
+                    DOUT(("value %s code %d\n", name, code));
+                }
+                DEC_SCOPE();
             } else {
                 // a user defined type
 
@@ -3830,10 +3874,20 @@ void Module_deserializer::read_unreferenced_init_expressions(Module &mod)
 // Creates a new (empty) module.
 Module *Module_deserializer::create_module(
     IMDL::MDL_version mdl_version,
-    bool              analyzed)
+    bool              analyzed,
+    char const        *abs_name,
+    unsigned          flags)
 {
     // create an new empty module
-    Module *mod = m_compiler->create_module(/*context=*/NULL, /*module_name=*/NULL, mdl_version);
+    Module *mod = NULL;
+    if ((flags & Module::MF_IS_OWNED) != 0 &&
+        m_compiler->find_builtin_module(string(abs_name, get_allocator())) == NULL)
+    {
+        // a builtin module of a compiler under construction
+        mod = m_compiler->create_module(abs_name, /*file_name=*/NULL, mdl_version, flags);
+    } else {
+        mod = m_compiler->create_module(/*context=*/NULL, /*module_name=*/NULL, mdl_version);
+    }
 
     if (analyzed) {
         // analyze it, this will create all the predefined entities the deserializer needs
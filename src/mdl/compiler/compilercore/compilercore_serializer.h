@@ -77,6 +77,12 @@ class IArgument;
 class MDL;
 class Module;
 
+/// The version of the binary serialization format of modules.
+///
+/// Must be incremented with every change to the data written by the module serializer, because
+/// it is part of the key of persistent standard library images (see Stdlib_image).
+static const unsigned MDL_BINARY_SERIALIZATION_VERSION = 1;
+
 /// The tag type.
 typedef size_t Tag_t;
 
@@ -1642,11 +1648,19 @@ public:
     ///
     /// \param mdl_version  the MDL language level of the module
     /// \param analyzed     true, if an analyzed module will be deserialized
+    /// \param abs_name     the absolute name of the module
+    /// \param flags        the module property flags
     ///
     /// \return a new empty module
+    ///
+    /// \note The name and the flags are only used for compiler owned modules that are not
+    ///       registered yet, i.e. if a compiler deserializes its own builtin modules: their
+    ///       predefined entities must be entered exactly as for the parsed module.
     Module *create_module(
         IMDL::MDL_version mdl_version,
-        bool              analyzed);
+        bool              analyzed,
+        char const        *abs_name,
+        unsigned          flags);
 
     /// Constructor.
     ///
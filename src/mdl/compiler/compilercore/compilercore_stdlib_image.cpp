@@ -0,0 +1,328 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "pch.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <mi/base/lock.h>
+
+#include "compilercore_stdlib_image.h"
+#include "compilercore_assert.h"
+#include "compilercore_file_utils.h"
+#include "compilercore_hash.h"
+#include "compilercore_malloc_allocator.h"
+
+namespace mi {
+namespace mdl {
+
+namespace {
+
+/// The magic of an image file.
+char const image_magic[8] = { 'M', 'D', 'L', 'S', 'T', 'D', 'I', 'M' };
+
+/// The version of the image file format. Because it is written in native byte order,
+/// files written on a machine with a different endianness are rejected as well.
+mi::Uint32 const image_format_version = 1u;
+
+/// The name of the environment variable naming the image file.
+char const image_file_env[] = "MI_MDL_STDLIB_IMAGE";
+
+/// The published image of this process and its lock.
+class Image_registry {
+public:
+    /// Constructor.
+    Image_registry()
+    : m_lock()
+    , m_image(NULL)
+    , m_file_read(false)
+    {
+    }
+
+    /// Destructor, runs at process exit.
+    ~Image_registry()
+    {
+        delete m_image;
+    }
+
+    /// The lock protecting this registry.
+    mi::base::Lock m_lock;
+
+    /// The published image if any.
+    Stdlib_image *m_image;
+
+    /// True, if the image file was read already.
+    bool m_file_read;
+};
+
+Image_registry g_registry;
+
+/// Append raw data to a buffer.
+void append(vector<unsigned char>::Type &buf, void const *data, size_t size)
+{
+    unsigned char const *p = static_cast<unsigned char const *>(data);
+    buf.insert(buf.end(), p, p + size);
+}
+
+/// Read raw data from a buffer, returns NULL if the buffer is exhausted.
+unsigned char const *consume(unsigned char const *&p, unsigned char const *end, size_t size)
+{
+    if (size_t(end - p) < size) {
+        return NULL;
+    }
+    unsigned char const *res = p;
+    p += size;
+    return res;
+}
+
+}  // anonymous
+
+// Constructor.
+Stdlib_image::Stdlib_image(IAllocator *alloc, unsigned char const key[16])
+: m_alloc(alloc, mi::base::DUP_INTERFACE)
+, m_modules(alloc)
+{
+    memcpy(m_key, key, sizeof(m_key));
+}
+
+// Destructor.
+Stdlib_image::~Stdlib_image()
+{
+}
+
+// Get the image of this process.
+Stdlib_image const *Stdlib_image::get(unsigned char const key[16])
+{
+    mi::base::Lock::Block block(&g_registry.m_lock);
+
+    if (g_registry.m_image == NULL && !g_registry.m_file_read) {
+        g_registry.m_file_read = true;
+
+        if (char const *fname = getenv(image_file_env)) {
+            g_registry.m_image = read_file(fname, key);
+        }
+    }
+
+    Stdlib_image const *image = g_registry.m_image;
+    if (image != NULL && memcmp(image->m_key, key, sizeof(image->m_key)) != 0) {
+        // produced by another compiler build sharing this process
+        return NULL;
+    }
+    return image;
+}
+
+// Create a new empty image.
+Stdlib_image *Stdlib_image::create(unsigned char const key[16])
+{
+    // the image outlives the compiler that creates it, so it cannot use its allocator
+    mi::base::Handle<IAllocator> alloc(MallocAllocator::create_instance());
+
+    return new Stdlib_image(alloc.get(), key);
+}
+
+// Publish a complete image as the image of this process and write the image file.
+void Stdlib_image::publish(Stdlib_image *image)
+{
+    {
+        mi::base::Lock::Block block(&g_registry.m_lock);
+
+        if (g_registry.m_image != NULL) {
+            delete image;
+            return;
+        }
+        g_registry.m_image     = image;
+        g_registry.m_file_read = true;
+    }
+
+    // published images are immutable, so the lock is not needed for writing
+    if (char const *fname = getenv(image_file_env)) {
+        image->write_file(fname);
+    }
+}
+
+// Add a serialized module.
+void Stdlib_image::add_module(char const *name, unsigned char const *data, size_t size)
+{
+    Module_data mod(m_alloc.get());
+
+    mod.name = name;
+    mod.data.assign(data, data + size);
+    m_modules.push_back(mod);
+}
+
+// Read an image file.
+Stdlib_image *Stdlib_image::read_file(char const *fname, unsigned char const key[16])
+{
+    mi::base::Handle<IAllocator> alloc(MallocAllocator::create_instance());
+
+    FILE *f = fopen_utf8(alloc.get(), fname, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+
+    vector<unsigned char>::Type buf(alloc.get());
+    bool ok = fseek(f, 0, SEEK_END) == 0;
+    long file_size = ok ? ftell(f) : -1;
+    if (file_size > 16 && fseek(f, 0, SEEK_SET) == 0) {
+        buf.resize(size_t(file_size));
+        ok = fread(&buf[0], 1, buf.size(), f) == buf.size();
+    } else {
+        ok = false;
+    }
+    fclose(f);
+    if (!ok) {
+        return NULL;
+    }
+
+    // verify the trailing checksum first, so truncated or corrupted files are rejected
+    size_t data_size = buf.size() - 16;
+    unsigned char checksum[16];
+    MD5_hasher hasher;
+    hasher.update(&buf[0], data_size);
+    hasher.final(checksum);
+    if (memcmp(checksum, &buf[data_size], 16) != 0) {
+        return NULL;
+    }
+
+    unsigned char const *p   = &buf[0];
+    unsigned char const *end = p + data_size;
+
+    unsigned char const *magic = consume(p, end, sizeof(image_magic));
+    if (magic == NULL || memcmp(magic, image_magic, sizeof(image_magic)) != 0) {
+        return NULL;
+    }
+
+    mi::Uint32 version = 0;
+    if (unsigned char const *v = consume(p, end, sizeof(version))) {
+        memcpy(&version, v, sizeof(version));
+    }
+    if (version != image_format_version) {
+        return NULL;
+    }
+
+    unsigned char const *file_key = consume(p, end, 16);
+    if (file_key == NULL || memcmp(file_key, key, 16) != 0) {
+        // written by another compiler build
+        return NULL;
+    }
+
+    mi::Uint64 n_modules = 0;
+    if (unsigned char const *v = consume(p, end, sizeof(n_modules))) {
+        memcpy(&n_modules, v, sizeof(n_modules));
+    }
+
+    Stdlib_image *image = new Stdlib_image(alloc.get(), key);
+    for (mi::Uint64 i = 0; i < n_modules; ++i) {
+        mi::Uint64 name_size = 0, data_size = 0;
+
+        unsigned char const *v = consume(p, end, sizeof(name_size));
+        if (v != NULL) {
+            memcpy(&name_size, v, sizeof(name_size));
+        }
+        unsigned char const *name = consume(p, end, size_t(name_size));
+
+        v = consume(p, end, sizeof(data_size));
+        if (v != NULL) {
+            memcpy(&data_size, v, sizeof(data_size));
+        }
+        unsigned char const *data = consume(p, end, size_t(data_size));
+
+        if (name == NULL || data == NULL) {
+            delete image;
+            return NULL;
+        }
+        image->add_module(
+            string(reinterpret_cast<char const *>(name), size_t(name_size), alloc.get()).c_str(),
+            data,
+            size_t(data_size));
+    }
+
+    if (p != end) {
+        delete image;
+        return NULL;
+    }
+    return image;
+}
+
+// Write this image into a file.
+void Stdlib_image::write_file(char const *fname) const
+{
+    IAllocator *alloc = m_alloc.get();
+
+    vector<unsigned char>::Type buf(alloc);
+
+    append(buf, image_magic, sizeof(image_magic));
+    append(buf, &image_format_version, sizeof(image_format_version));
+    append(buf, m_key, sizeof(m_key));
+
+    mi::Uint64 n_modules = m_modules.size();
+    append(buf, &n_modules, sizeof(n_modules));
+    for (size_t i = 0, n = m_modules.size(); i < n; ++i) {
+        Module_data const &mod = m_modules[i];
+
+        mi::Uint64 name_size = mod.name.size();
+        append(buf, &name_size, sizeof(name_size));
+        append(buf, mod.name.c_str(), mod.name.size());
+
+        mi::Uint64 data_size = mod.data.size();
+        append(buf, &data_size, sizeof(data_size));
+        if (!mod.data.empty()) {
+            append(buf, &mod.data[0], mod.data.size());
+        }
+    }
+
+    unsigned char checksum[16];
+    MD5_hasher hasher;
+    hasher.update(&buf[0], buf.size());
+    hasher.final(checksum);
+    append(buf, checksum, sizeof(checksum));
+
+    // write to a unique temporary file first and rename it afterwards, so readers
+    // in other processes never see a partially written image
+    char suffix[32];
+    snprintf(suffix, sizeof(suffix), ".tmp%u", get_process_id());
+    string tmp_name(fname, alloc);
+    tmp_name += suffix;
+
+    FILE *f = fopen_utf8(alloc, tmp_name.c_str(), "wb");
+    if (f == NULL) {
+        return;
+    }
+
+    bool ok = fwrite(&buf[0], 1, buf.size(), f) == buf.size();
+    ok = fclose(f) == 0 && ok;
+
+    if (!ok || !rename_file_utf8(alloc, tmp_name.c_str(), fname)) {
+        remove_file_utf8(alloc, tmp_name.c_str());
+    }
+}
+
+}  // mdl
+}  // mi
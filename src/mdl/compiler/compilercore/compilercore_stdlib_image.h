@@ -0,0 +1,149 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#ifndef MDL_COMPILERCORE_STDLIB_IMAGE_H
+#define MDL_COMPILERCORE_STDLIB_IMAGE_H 1
+
+#include <mi/base/handle.h>
+
+#include "compilercore_allocator.h"
+
+namespace mi {
+namespace mdl {
+
+/// A serialized image of the analyzed builtin modules.
+///
+/// Creating a compiler parses and analyzes the embedded sources of all builtin modules. The
+/// first compiler of a process serializes every builtin module right after its analysis and
+/// publishes the result as the image of the process, later compilers deserialize the modules
+/// from it instead.
+///
+/// If the environment variable MI_MDL_STDLIB_IMAGE names a file, the image is read from that
+/// file on first use and written to it after it was created, so short-lived processes benefit
+/// as well. Every image carries a key computed from the platform version, the serialization
+/// format version (see MDL_BINARY_SERIALIZATION_VERSION) and the builtin module sources; images
+/// with a different key are ignored and the builtin modules are parsed again.
+class Stdlib_image
+{
+public:
+    /// Get the image of this process.
+    ///
+    /// On the first call, tries to read the image file.
+    ///
+    /// \param key  the key of the running compiler build
+    ///
+    /// \return the image or NULL if no image with this key is available
+    static Stdlib_image const *get(unsigned char const key[16]);
+
+    /// Create a new empty image.
+    ///
+    /// \param key  the key of the running compiler build
+    static Stdlib_image *create(unsigned char const key[16]);
+
+    /// Publish a complete image as the image of this process and write the image file.
+    ///
+    /// \param image  the image, takes ownership
+    ///
+    /// If another image was published already, \p image is dropped.
+    static void publish(Stdlib_image *image);
+
+    /// Add a serialized module.
+    ///
+    /// \param name  the absolute name of the module
+    /// \param data  the serialized module
+    /// \param size  the size of the serialized module
+    void add_module(char const *name, unsigned char const *data, size_t size);
+
+    /// Get the number of modules in this image.
+    size_t get_module_count() const { return m_modules.size(); }
+
+    /// Get the absolute name of the i'th module.
+    char const *get_module_name(size_t i) const { return m_modules[i].name.c_str(); }
+
+    /// Get the serialized data of the i'th module.
+    unsigned char const *get_module_data(size_t i) const {
+        return m_modules[i].data.empty() ? NULL : &m_modules[i].data[0];
+    }
+
+    /// Get the size of the serialized data of the i'th module.
+    size_t get_module_size(size_t i) const { return m_modules[i].data.size(); }
+
+    /// Destructor.
+    ~Stdlib_image();
+
+private:
+    /// Constructor.
+    ///
+    /// \param alloc  the allocator
+    /// \param key    the key of the compiler build
+    Stdlib_image(IAllocator *alloc, unsigned char const key[16]);
+
+    /// Read an image file.
+    ///
+    /// \param fname  the UTF8 encoded file name
+    /// \param key    the key of the running compiler build
+    ///
+    /// \return the image or NULL if the file does not exist, is damaged or has another key
+    static Stdlib_image *read_file(char const *fname, unsigned char const key[16]);
+
+    /// Write this image into a file.
+    ///
+    /// \param fname  the UTF8 encoded file name
+    void write_file(char const *fname) const;
+
+private:
+    /// One serialized module.
+    struct Module_data {
+        /// Constructor.
+        explicit Module_data(IAllocator *alloc)
+        : name(alloc)
+        , data(alloc)
+        {
+        }
+
+        /// The absolute name of the module.
+        string name;
+
+        /// The serialized module.
+        vector<unsigned char>::Type data;
+    };
+
+    /// The allocator, outlives all compilers.
+    mi::base::Handle<IAllocator> m_alloc;
+
+    /// The key of the compiler build that produced this image.
+    unsigned char m_key[16];
+
+    /// The serialized modules in load order.
+    vector<Module_data>::Type m_modules;
+};
+
+}  // mdl
+}  // mi
+
+#endif // MDL_COMPILERCORE_STDLIB_IMAGE_H
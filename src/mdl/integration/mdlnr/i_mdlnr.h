@@ -29,6 +29,7 @@
 #ifndef MDL_INTERGRATION_I_MDLNR_H
 #define MDL_INTERGRATION_I_MDLNR_H 1
 
+#include <mi/base/types.h>
 #include <base/system/main/i_module.h>
 
 namespace mi {
@@ -43,7 +44,7 @@ namespace mi {
 
 namespace MI {
 
-namespace MDL { class IType; class Mdl_module_wait_queue; }
+namespace MDL { class IType; class Mdl_compiled_material_cache; class Mdl_module_wait_queue; }
 namespace SYSTEM { class Module_registration_entry; }
 namespace SERIAL { class Deserializer; class Serializer; }
 
@@ -93,6 +94,13 @@ public:
     /// Get the MDL code cache.
     virtual mi::mdl::ICode_cache *get_code_cache() const = 0;
 
+    /// Returns a statistic of the MDL code cache.
+    ///
+    /// \param name  One of "hits", "disk_hits", "misses", "evictions", "disk_stores",
+    ///              "entries", or "size".
+    /// \return      The current value of the statistic, or 0 for unknown names.
+    virtual mi::Size get_code_cache_statistic(const char *name) const = 0;
+
     /// Configures, whether casts for compatible types should be inserted by the integration
     /// when needed.
     virtual void set_implicit_cast_enabled(bool value) = 0;
@@ -107,8 +115,23 @@ public:
     /// Indicates whether an attempt is made to expose names of let expressions.
     virtual bool get_expose_names_of_let_expressions() const = 0;
 
+    /// Defines whether the imports of a module are loaded in parallel before the module itself.
+    virtual void set_parallel_import_loading( bool value) = 0;
+
+    /// Indicates whether the imports of a module are loaded in parallel before the module itself.
+    virtual bool get_parallel_import_loading() const = 0;
+
     /// Returns the module wait queue.
     virtual MDL::Mdl_module_wait_queue* get_module_wait_queue() const = 0;
+
+    /// Returns the cache for compiled materials.
+    virtual MDL::Mdl_compiled_material_cache* get_compiled_material_cache() const = 0;
+
+    /// Returns a statistic of the cache for compiled materials.
+    ///
+    /// \param name  One of "hits", "misses", "evictions", "entries", or "size".
+    /// \return      The current value of the statistic, or 0 for unknown names.
+    virtual mi::Size get_compiled_material_cache_statistic(const char *name) const = 0;
 };
 
 } // namespace MDLC
@@ -28,6 +28,7 @@
 
 #include "pch.h"
 
+#include <cstring>
 #include <map>
 
 #include <mi/base/ilogger.h>
@@ -44,11 +45,13 @@
 #include <base/util/registry/i_config_registry.h>
 #include <base/data/serial/i_serializer.h>
 #include <base/system/stlext/i_stlext_no_unused_variable_warning.h>
+#include <base/system/version/i_version.h>
 
 #include "mdlnr.h"
 #include "mdlnr_search_path.h"
 #include "mdlnr_module.h"
 
+#include <io/scene/mdl_elements/i_mdl_elements_compiled_material.h>
 #include <io/scene/mdl_elements/i_mdl_elements_utilities.h>
 #include <mdl/compiler/compilercore/compilercore_assert.h>
 #include <mdl/compiler/compilercore/compilercore_fatal.h>
@@ -198,7 +201,9 @@ Mdlc_module_impl::Mdlc_module_impl()
   , m_code_cache(0)
   , m_implicit_cast_enabled(true)
   , m_expose_names_of_let_expressions(true)
+  , m_parallel_import_loading(true)
   , m_module_wait_queue(0)
+  , m_compiled_material_cache(0)
 {
 }
 
@@ -262,10 +267,37 @@ bool Mdlc_module_impl::init()
         cache_size = v;
     }
 
-    m_code_cache = builder.create<mi::mdl::Code_cache>(m_allocator.get(), cache_size);
+    mi::mdl::Code_cache *code_cache =
+        builder.create<mi::mdl::Code_cache>(m_allocator.get(), cache_size);
+
+    // optional persistent tier, shared between processes using the same directory
+    std::string cache_dir;
+    if (registry.get_value("mdl_target_code_cache_dir", cache_dir) && !cache_dir.empty()) {
+        // 256MB disk cache size by default
+        size_t disk_cache_size = 256*1024*1024;
+        if (registry.get_value("mdl_target_code_cache_disk_size", v)) {
+            disk_cache_size = v;
+        }
+
+        code_cache->set_disk_stamp(VERSION::get_platform_version());
+        if (!code_cache->enable_disk_tier(cache_dir.c_str(), disk_cache_size)) {
+            LOG::mod_log->warning(M_MDLC, LOG::Mod_log::C_COMPILER,
+                "Cannot use \"%s\" as directory for the persistent code cache, "
+                "falling back to in-memory caching only.", cache_dir.c_str());
+        }
+    }
+    m_code_cache = code_cache;
 
     m_module_wait_queue = new MDL::Mdl_module_wait_queue();
 
+    // 64MB compiled material cache size by default
+    size_t compiled_material_cache_size = 64*1024*1024;
+    if (registry.get_value("mdl_compiled_material_cache_size", v)) {
+        compiled_material_cache_size = v;
+    }
+    m_compiled_material_cache =
+        new MDL::Mdl_compiled_material_cache(compiled_material_cache_size);
+
 
     return true;
 }
@@ -286,6 +318,10 @@ void Mdlc_module_impl::exit()
         delete m_module_wait_queue;
         m_module_wait_queue = nullptr;
     }
+    if (m_compiled_material_cache) {
+        delete m_compiled_material_cache;
+        m_compiled_material_cache = nullptr;
+    }
 
 #ifdef USE_MDL_DEBUG_ALLOCATOR
     mi::mdl::dbg::DebugMallocAllocator* dbg_allocator = static_cast<mi::mdl::dbg::DebugMallocAllocator*>( m_allocator.get());
@@ -355,6 +391,31 @@ mi::mdl::ICode_cache *Mdlc_module_impl::get_code_cache() const
     return m_code_cache;
 }
 
+mi::Size Mdlc_module_impl::get_code_cache_statistic(const char *name) const
+{
+    if (!m_code_cache || !name)
+        return 0;
+
+    mi::mdl::Code_cache::Statistics stats;
+    m_code_cache->get_statistics(stats);
+
+    if (strcmp(name, "hits") == 0)
+        return stats.hits;
+    if (strcmp(name, "disk_hits") == 0)
+        return stats.disk_hits;
+    if (strcmp(name, "misses") == 0)
+        return stats.misses;
+    if (strcmp(name, "evictions") == 0)
+        return stats.evictions;
+    if (strcmp(name, "disk_stores") == 0)
+        return stats.disk_stores;
+    if (strcmp(name, "entries") == 0)
+        return stats.entries;
+    if (strcmp(name, "size") == 0)
+        return stats.size;
+    return 0;
+}
+
 void Mdlc_module_impl::set_implicit_cast_enabled(bool value)
 {
     m_implicit_cast_enabled = value;
@@ -375,11 +436,47 @@ bool Mdlc_module_impl::get_expose_names_of_let_expressions() const
     return m_expose_names_of_let_expressions;
 }
 
+void Mdlc_module_impl::set_parallel_import_loading(bool value)
+{
+    m_parallel_import_loading = value;
+}
+
+bool Mdlc_module_impl::get_parallel_import_loading() const
+{
+    return m_parallel_import_loading;
+}
+
 MDL::Mdl_module_wait_queue* Mdlc_module_impl::get_module_wait_queue() const
 {
     return m_module_wait_queue;
 }
 
+MDL::Mdl_compiled_material_cache* Mdlc_module_impl::get_compiled_material_cache() const
+{
+    return m_compiled_material_cache;
+}
+
+mi::Size Mdlc_module_impl::get_compiled_material_cache_statistic(const char *name) const
+{
+    if (!m_compiled_material_cache || !name)
+        return 0;
+
+    MDL::Mdl_compiled_material_cache::Statistics stats;
+    m_compiled_material_cache->get_statistics(stats);
+
+    if (strcmp(name, "hits") == 0)
+        return stats.hits;
+    if (strcmp(name, "misses") == 0)
+        return stats.misses;
+    if (strcmp(name, "evictions") == 0)
+        return stats.evictions;
+    if (strcmp(name, "entries") == 0)
+        return stats.entries;
+    if (strcmp(name, "size") == 0)
+        return stats.size;
+    return 0;
+}
+
 bool Mdlc_module_impl::is_valid_mdl_core_plugin(
     const char* type, const char* name, const char* filename)
 {
@@ -37,6 +37,7 @@
 #include <base/system/main/access_module.h>
 
 namespace mi { namespace base { class IAllocator; class IPlugin_descriptor; } }
+namespace mi { namespace mdl { class Code_cache; } }
 
 namespace MI {
 
@@ -77,6 +78,8 @@ public:
 
     mi::mdl::ICode_cache *get_code_cache() const;
 
+    mi::Size get_code_cache_statistic(const char *name) const;
+
     void set_implicit_cast_enabled(bool value);
 
     bool get_implicit_cast_enabled() const;
@@ -85,8 +88,16 @@ public:
 
     bool get_expose_names_of_let_expressions() const;
 
+    void set_parallel_import_loading(bool value);
+
+    bool get_parallel_import_loading() const;
+
     MDL::Mdl_module_wait_queue* get_module_wait_queue() const;
 
+    MDL::Mdl_compiled_material_cache* get_compiled_material_cache() const;
+
+    mi::Size get_compiled_material_cache_statistic(const char *name) const;
+
 private:
 
     /// Helper function to detect valid MDL core plugin type names.
@@ -111,7 +122,7 @@ private:
     mi::base::Handle<mi::base::IAllocator> m_allocator;
 
     /// The code cache used for JIT-generated source code.
-    mi::mdl::ICode_cache *m_code_cache;
+    mi::mdl::Code_cache *m_code_cache;
 
     /// Flag that indicates whether the integration should insert casts when needed (and possible).
     bool m_implicit_cast_enabled;
@@ -119,9 +130,15 @@ private:
     /// Flag that indicates whether the integration should insert casts when needed (and possible).
     bool m_expose_names_of_let_expressions;
 
+    /// Flag that indicates whether the imports of a module are loaded in parallel first.
+    bool m_parallel_import_loading;
+
     /// The module wait queue.
     MDL::Mdl_module_wait_queue *m_module_wait_queue;
 
+    /// The cache for compiled materials.
+    MDL::Mdl_compiled_material_cache *m_compiled_material_cache;
+
     /// Access to the PLUG module
     SYSTEM::Access_module<PLUG::Plug_module> m_plug_module;
 
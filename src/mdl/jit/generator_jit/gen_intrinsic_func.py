@@ -5992,6 +5992,10 @@ class SignatureParser:
 			for (size_t i = 0, n = dimension_of(m_internal_funcs); i < n; ++i) {
 				m_internal_funcs[i] = NULL;
 			}
+
+			m_native_tex_sample_2d       = NULL;
+			m_native_tex_lookup_2d       = NULL;
+			m_native_tex_lookup_deriv_2d = NULL;
 		}
 
 		"""
@@ -6442,6 +6446,26 @@ class SignatureParser:
 			Type_mapper::Tex_handler_vtable_index tex_func_idx,
 			llvm::Value *res_data,
 			llvm::Value *res_id);
+
+		/// Wrap a 2D texture lookup glue function, so that flat textures provided by the
+		/// resource handler are sampled inline and only the others call the glue function.
+		///
+		/// \param code  the runtime function code of the glue function
+		/// \param glue  the glue function
+		///
+		/// \\return the glue function itself if native inline lookups are disabled,
+		///         the wrapper function otherwise
+		llvm::Function *wrap_native_tex_lookup_2d(
+			Runtime_function code,
+			llvm::Function   *glue);
+
+		/// Get the function sampling one level of a flat 2D texture bilinearly.
+		llvm::Function *get_native_tex_sample_2d();
+
+		/// Get the function looking up a flat 2D texture.
+		///
+		/// \param with_derivs  if true, the coordinate has derivatives and a mip level is selected
+		llvm::Function *get_native_tex_lookup_2d(bool with_derivs);
 		"""
 		self.format_code(f, code)
 
@@ -6633,6 +6657,9 @@ class SignatureParser:
 		self.add_class_member("llvm::Function *",                     "m_runtime_funcs[RT_LAST + 1]", "Runtime functions.",           False)
 		self.add_class_member("llvm::Function *",                     "m_intrinsics[%d * 2]" % self.m_next_func_index, "Cache for intrinsic functions, with and without derivative returns.", False)
 		self.add_class_member("llvm::Function *",                     "m_internal_funcs[Internal_function::KI_NUM_INTERNAL_FUNCTIONS]", "Cache for internal functions.", False)
+		self.add_class_member("llvm::Function *",                     "m_native_tex_sample_2d",       "Cache for the inline flat 2D texture sampler.", False)
+		self.add_class_member("llvm::Function *",                     "m_native_tex_lookup_2d",       "Cache for the inline flat 2D texture lookup.", False)
+		self.add_class_member("llvm::Function *",                     "m_native_tex_lookup_deriv_2d", "Cache for the inline flat 2D texture lookup with derivatives.", False)
 
 		# start class
 		self.write(f, "class MDL_runtime_creator {\n")
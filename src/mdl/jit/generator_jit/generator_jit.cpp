@@ -28,9 +28,7 @@
 
 #include "pch.h"
 
-#ifdef PRINT_TIMINGS
 #include <chrono>
-#endif
 
 #include <mi/base/handle.h>
 
@@ -77,6 +75,10 @@ static void fill_default_cg_options(
         MDL_JIT_OPTION_OPT_LEVEL,
         "2",
         "The optimization level of the JIT code generator");
+    options.add_option(
+        MDL_JIT_OPTION_CODEGEN_THREADS,
+        "1",
+        "The number of threads used for PTX code generation of link units");
     options.add_option(
         MDL_JIT_OPTION_FAST_MATH,
         "true",
@@ -124,7 +126,7 @@ static void fill_default_cg_options(
     options.add_option(
         MDL_JIT_OPTION_TEX_LOOKUP_CALL_MODE,
         "vtable",
-        "The mode for texture lookup functions on GPU (vtable, direct_call or optix_cp)");
+        "The mode for texture lookup functions (vtable, direct_call, optix_cp or native_inline)");
     options.add_option(
         MDL_JIT_OPTION_LAMBDA_RETURN_MODE,
         "default",
@@ -356,6 +358,7 @@ Code_generator_thread_context::Code_generator_thread_context(
 : Base(alloc)
 , m_msg_list(alloc, /*owner_fname=*/"")
 , m_options(alloc, *options)
+, m_job_executor()
 {
 }
 
@@ -383,6 +386,12 @@ Options_impl &Code_generator_thread_context::access_options()
     return m_options;
 }
 
+// Set the executor used for parallel code generation in the next invocation.
+void Code_generator_thread_context::set_job_executor(ICode_generator_job_executor *executor)
+{
+    m_job_executor = mi::base::make_handle_dup(executor);
+}
+
 // Constructor.
 Code_generator_jit::Code_generator_jit(
     IAllocator  *alloc,
@@ -888,6 +897,7 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_const_function
 
         // copy the render state usage
         code->set_render_state_usage(code_gen.get_render_state_usage());
+        code->set_native_tex_lookups(code_gen.use_native_tex_lookups());
 
         // create the argument block layout if any arguments are captured
         if (code_gen.get_captured_arguments_llvm_type() != NULL) {
@@ -895,6 +905,9 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_const_function
                 builder.create<Generated_code_value_layout>(alloc, &code_gen));
             code->add_captured_arguments_layout(layout.get());
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code.get());
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling const function failed");
@@ -995,6 +1008,7 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_switch_functio
 
         // copy the render state usage
         code->set_render_state_usage(code_gen.get_render_state_usage());
+        code->set_native_tex_lookups(code_gen.use_native_tex_lookups());
 
         // create the argument block layout if any arguments are captured
         if (code_gen.get_captured_arguments_llvm_type() != NULL) {
@@ -1007,6 +1021,9 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_switch_functio
         for (size_t i = 0, n = code_gen.get_string_constant_count(); i < n; ++i) {
             code->add_mapped_string(code_gen.get_string_constant(i), i);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code);
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling switch function failed");
@@ -1094,7 +1111,10 @@ IGenerated_code_executable *Code_generator_jit::compile_into_switch_function_for
 
         hasher.final(cache_key);
 
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
         ICode_cache::Entry const *entry = code_cache->lookup(cache_key);
+        std::chrono::duration<double> et = std::chrono::steady_clock::now() - t1;
+        code->add_compile_phase_time(IGenerated_code_executable::CP_CACHE_LOOKUP, et.count());
 
         if (entry != NULL) {
             // found a hit
@@ -1168,6 +1188,9 @@ IGenerated_code_executable *Code_generator_jit::compile_into_switch_function_for
         if (code_cache != NULL) {
             enter_code_into_cache(code, code_cache, cache_key);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code);
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling GPU switch function failed");
@@ -1266,6 +1289,7 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_generic_functi
 
         // copy the render state usage
         code->set_render_state_usage(code_gen.get_render_state_usage());
+        code->set_native_tex_lookups(code_gen.use_native_tex_lookups());
 
         // create the argument block layout if any arguments are captured
         if (code_gen.get_captured_arguments_llvm_type() != NULL) {
@@ -1278,6 +1302,9 @@ IGenerated_code_lambda_function *Code_generator_jit::compile_into_generic_functi
         for (size_t i = 0, n = code_gen.get_string_constant_count(); i < n; ++i) {
             code->add_mapped_string(code_gen.get_string_constant(i), i);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code.get());
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(
@@ -1404,6 +1431,9 @@ IGenerated_code_executable *Code_generator_jit::compile_into_llvm_ir(
         for (size_t i = 0, n = code_gen.get_string_constant_count(); i < n; ++i) {
             code->add_mapped_string(code_gen.get_string_constant(i), i);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code);
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling lambda function into LLVM IR failed");
@@ -1488,6 +1518,7 @@ IGenerated_code_executable *Code_generator_jit::compile_distribution_function_cp
 
         // copy the render state usage
         code->set_render_state_usage(code_gen.get_render_state_usage());
+        code->set_native_tex_lookups(code_gen.use_native_tex_lookups());
 
         // create the argument block layout if any arguments are captured
         if (code_gen.get_captured_arguments_llvm_type() != NULL) {
@@ -1495,6 +1526,9 @@ IGenerated_code_executable *Code_generator_jit::compile_distribution_function_cp
                 builder.create<Generated_code_value_layout>(alloc, &code_gen));
             code->add_captured_arguments_layout(layout.get());
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code.get());
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling CPU DF function failed");
@@ -1653,6 +1687,9 @@ IGenerated_code_executable *Code_generator_jit::compile_distribution_function_gp
         for (size_t i = 0, n = code_gen.get_string_constant_count(); i < n; ++i) {
             code->add_mapped_string(code_gen.get_string_constant(i), i);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code);
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling GPU DF function failed");
@@ -1900,7 +1937,10 @@ IGenerated_code_executable *Code_generator_jit::compile_into_source(
 
         hasher.final(cache_key);
 
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
         ICode_cache::Entry const *entry = code_cache->lookup(cache_key);
+        std::chrono::duration<double> et = std::chrono::steady_clock::now() - t1;
+        code->add_compile_phase_time(IGenerated_code_executable::CP_CACHE_LOOKUP, et.count());
 
         if (entry != NULL) {
             // found a hit
@@ -2018,6 +2058,9 @@ IGenerated_code_executable *Code_generator_jit::compile_into_source(
         if (code_cache != NULL) {
             enter_code_into_cache(code, code_cache, cache_key);
         }
+
+        // store the compilation phase timings
+        code_gen.move_compile_phase_times(code);
     } else if (code->access_messages().get_error_message_count() == 0) {
         // on failure, ensure that the code contains an error message
         code_gen.error(INTERNAL_JIT_BACKEND_ERROR, "Compiling lambda function into source failed");
@@ -2146,22 +2189,10 @@ IGenerated_code_executable *Code_generator_jit::compile_unit(
     // pass the resource to tag map to the code generator
     unit->set_resource_tag_map(unit.get_resource_tag_map());
 
-#ifdef PRINT_TIMINGS
-    std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
-#endif
-
     // now finalize the module
     llvm::Module *llvm_module = unit.finalize_module(module_cache);
     mi::base::Handle<IGenerated_code_executable> code_obj(unit.get_code_object());
 
-#ifdef PRINT_TIMINGS
-    std::chrono::steady_clock::time_point t2 = std::chrono::steady_clock::now();
-    std::chrono::steady_clock::time_point t3 = t2;
-    std::chrono::steady_clock::time_point t4 = t2;
-    std::chrono::steady_clock::time_point t5 = t2;
-    std::chrono::steady_clock::time_point t6 = t2;
-#endif
-
     if (llvm_module == NULL) {
         // on failure, ensure that the code contains an error message
         if (unit->get_error_message_count() == 0) {
@@ -2172,30 +2203,19 @@ IGenerated_code_executable *Code_generator_jit::compile_unit(
         mi::base::Handle<Generated_code_lambda_function> code(
             code_obj->get_interface<mi::mdl::Generated_code_lambda_function>());
 
-#ifdef PRINT_TIMINGS
-        t3 = std::chrono::steady_clock::now();
-#endif
         MDL_JIT_module_key module_key = unit->jit_compile(llvm_module);
-#ifdef PRINT_TIMINGS
-        t4 = std::chrono::steady_clock::now();
-#endif
         code->set_llvm_module(module_key);
         unit->fill_function_info(code.get());
-#ifdef PRINT_TIMINGS
-        t5 = std::chrono::steady_clock::now();
-#endif
 
         // add all generated functions as entry points
         for (size_t i = 0; i < num_funcs; ++i) {
             char const *func_name = unit.get_function_name(i);
             code->add_entry_point(unit->get_entry_point(module_key, func_name));
         }
-#ifdef PRINT_TIMINGS
-        t6 = std::chrono::steady_clock::now();
-#endif
 
         // copy the render state usage
         code->set_render_state_usage(unit->get_render_state_usage());
+        code->set_native_tex_lookups(unit->use_native_tex_lookups());
 
         // add all argument block layouts
         for (size_t i = 0, num = unit.get_arg_block_layout_count(); i < num; ++i) {
@@ -2222,7 +2242,10 @@ IGenerated_code_executable *Code_generator_jit::compile_unit(
         } else {
             switch (target) {
             case ICode_generator::TL_PTX:
+                unit->set_job_executor(
+                    impl_cast<Code_generator_thread_context>(ctx)->get_job_executor());
                 unit->ptx_compile(llvm_module, code->access_src_code());
+                unit->set_job_executor(NULL);
                 break;
             case ICode_generator::TL_HLSL:
             case ICode_generator::TL_GLSL:
@@ -2261,30 +2284,13 @@ IGenerated_code_executable *Code_generator_jit::compile_unit(
         delete llvm_module;
     }
 
-#ifdef PRINT_TIMINGS
-    std::chrono::steady_clock::time_point t7 = std::chrono::steady_clock::now();
-
-    std::chrono::duration<double> et = t7 - t1;
-    printf("CU  |||| Total time                 : %f seconds.\n", et.count());
-
-    et = t2 - t1;
-    printf("CU  | Finalize module               : %f seconds.\n", et.count());
-
-    et = t3 - t2;
-    printf("CU  | Before jit_compile            : %f seconds.\n", et.count());
-
-    et = t4 - t3;
-    printf("CU  | jit_compile                   : %f seconds.\n", et.count());
-
-    et = t5 - t4;
-    printf("CU  | Before add entrypoints        : %f seconds.\n", et.count());
-
-    et = t6 - t5;
-    printf("CU  | Add entrypoints               : %f seconds.\n", et.count());
-
-    et = t7 - t6;
-    printf("CU  | Rest                          : %f seconds.\n", et.count());
-#endif
+    // store the compilation phase timings
+    if (unit.get_target_language() == ICode_generator::TL_NATIVE) {
+        unit->move_compile_phase_times(
+            static_cast<Generated_code_lambda_function *>(code_obj.get()));
+    } else {
+        unit->move_compile_phase_times(static_cast<Generated_code_source *>(code_obj.get()));
+    }
 
     code_obj->retain();
     return code_obj.get();
@@ -390,10 +390,16 @@ public:
     ///
     Options_impl &access_options() MDL_FINAL;
 
+    /// Set the executor used for parallel code generation in the next invocation.
+    void set_job_executor(ICode_generator_job_executor *executor) MDL_FINAL;
+
 public:
     /// Clear the compiler messages.
     void clear_messages() { m_msg_list.clear(); }
 
+    /// Get the executor used for parallel code generation, if any.
+    ICode_generator_job_executor *get_job_executor() const { return m_job_executor.get(); }
+
 private:
     /// Constructor.
     ///
@@ -409,6 +415,9 @@ private:
 
     /// Options.
     Options_impl m_options;
+
+    /// The executor used for parallel code generation, if any.
+    mi::base::Handle<ICode_generator_job_executor> m_job_executor;
 };
 
 ///
@@ -3294,6 +3294,8 @@ llvm::FunctionCallee Function_context::get_tex_lookup_func(
 #undef ARGS4
 
     switch (m_code_gen.get_tex_lookup_call_mode()) {
+    case TLCM_NATIVE_INLINE:
+        // only affects the built-in resource handler, user handlers are called via the vtable
     case TLCM_VTABLE:
         {
             // get the vtable from this
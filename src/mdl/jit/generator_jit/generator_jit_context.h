@@ -76,6 +76,7 @@ public:
         TLCM_VTABLE,   ///< get the tex_lookup() functions from a vtable access
         TLCM_DIRECT,   ///< call tex_lookup() functions directly
         TLCM_OPTIX_CP, ///< call tex_lookup() functions through an OptiX bindless callable program
+        TLCM_NATIVE_INLINE, ///< sample 2D textures of the built-in CPU runtime inline
     };
 
     /// RAII-like block scope handler.
@@ -824,6 +824,16 @@ char const *Generated_code_executable_base<I>::get_string_constant(size_t id) co
     return NULL;
 }
 
+// Get the time spent in a compilation phase while this code was generated.
+template <class I>
+double Generated_code_executable_base<I>::get_compile_phase_time(
+    IGenerated_code_executable::Compile_phase phase) const
+{
+    if (size_t(phase) <= IGenerated_code_executable::CP_LAST) {
+        return m_compile_phase_times[phase];
+    }
+    return 0.0;
+}
 
 // --------------------------------- Generated_code_source ----------------------------------
 
@@ -1068,6 +1078,7 @@ Generated_code_lambda_function::Generated_code_lambda_function(
 , m_render_state_usage(
     IGenerated_code_executable::SU_ALL_VARYING_MASK |
     IGenerated_code_executable::SU_ALL_UNIFORM_MASK)
+, m_native_tex_lookups(false)
 {
 }
 
@@ -1198,6 +1209,29 @@ void Generated_code_lambda_function::init(
             MDL_ASSERT(!"unexpected resource kind");
         }
     }
+
+    if (m_native_tex_lookups) {
+        // collect the flat 2D textures, the generated code falls back to the resource handler
+        // for all other entries
+        Res_data::Native_texture_2d const **native_textures =
+            reinterpret_cast<Res_data::Native_texture_2d const **>(
+                alloc->malloc(sizeof(native_textures[0]) * n_res_entries));
+
+        p = m_res_data.m_res_arr;
+        for (size_t i = 0; i < n_res_entries; ++i, p += m_res_data.m_obj_size) {
+            Resource_entry const     &entry = m_res_entries[i];
+            Resource_tag_tuple::Kind kind   = entry.get_kind();
+
+            native_textures[i] = NULL;
+            if ((kind == Resource_tag_tuple::RK_TEXTURE_GAMMA_DEFAULT ||
+                    kind == Resource_tag_tuple::RK_TEXTURE_GAMMA_LINEAR ||
+                    kind == Resource_tag_tuple::RK_TEXTURE_GAMMA_SRGB) &&
+                    entry.get_shape() == IType_texture::TS_2D) {
+                native_textures[i] = res_handler->tex_native_2d(p);
+            }
+        }
+        m_res_data.m_native_textures = native_textures;
+    }
 }
 
 // Terminates the resource handling.
@@ -1248,6 +1282,9 @@ void Generated_code_lambda_function::term()
 
         mi::mdl::IAllocator *alloc = m_jitted_code->get_allocator();
         alloc->free(m_res_data.m_res_arr);
+        if (m_res_data.m_native_textures != NULL) {
+            alloc->free(m_res_data.m_native_textures);
+        }
         m_res_data.clear();
     }
 }
@@ -1501,6 +1538,60 @@ bool Generated_code_lambda_function::run_generic(
     return false;
 }
 
+// Run the function on the current transaction for several states.
+bool Generated_code_lambda_function::run_generic_multi(
+    size_t                       index,
+    size_t                       count,
+    void                         *results,
+    size_t                       result_stride,
+    Shading_state_material const *states,
+    void                         *tex_data,
+    void const                   *cap_args)
+{
+    if (!m_aborted && index < m_jitted_funcs.size()) {
+        Exc_state     exc(m_exc_handler, m_aborted);
+        Res_data_pair pair(m_res_data, tex_data);
+
+        if (setjmp(exc.env) == 0) {
+            Gen_func *gen_func = reinterpret_cast<Gen_func *>(m_jitted_funcs[index]);
+            char     *result   = static_cast<char *>(results);
+            for (size_t i = 0; i < count; ++i, result += result_stride) {
+                gen_func(result, &states[i], pair, exc, cap_args);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Run the environment function on the current transaction for several states.
+bool Generated_code_lambda_function::run_environment_multi(
+    size_t                          index,
+    size_t                          count,
+    RGB_color                       *results,
+    Shading_state_environment const *states,
+    void                            *tex_data)
+{
+    if (!m_aborted && index < m_jitted_funcs.size()) {
+        Exc_state     exc(m_exc_handler, m_aborted);
+        Res_data_pair pair(m_res_data, tex_data);
+
+        if (setjmp(exc.env) == 0) {
+            Env_func *env_func = reinterpret_cast<Env_func *>(m_jitted_funcs[index]);
+            for (size_t i = 0; i < count; ++i) {
+                env_func(&results[i], &states[i], pair, exc, NULL);
+            }
+            return true;
+        }
+    }
+
+    // black for now
+    for (size_t i = 0; i < count; ++i) {
+        results[i].r = results[i].g = results[i].b = 0.0f;
+    }
+    return false;
+}
+
 // Run the init function on the current transaction.
 bool Generated_code_lambda_function::run_init(
     size_t                 index,
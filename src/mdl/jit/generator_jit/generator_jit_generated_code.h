@@ -129,11 +129,45 @@ struct Generated_code_function_info
 };
 
 
+///
+/// The time spent in the compilation phases of a generated code object.
+///
+class Compile_phase_times
+{
+public:
+    /// Constructor.
+    Compile_phase_times()
+    {
+        for (size_t i = 0; i <= IGenerated_code_executable::CP_LAST; ++i) {
+            m_compile_phase_times[i] = 0.0;
+        }
+    }
+
+    /// Add time spent in a compilation phase.
+    ///
+    /// \param phase    the compilation phase
+    /// \param seconds  the time in seconds to add
+    void add_compile_phase_time(
+        IGenerated_code_executable::Compile_phase phase,
+        double                                    seconds)
+    {
+        if (size_t(phase) <= IGenerated_code_executable::CP_LAST) {
+            m_compile_phase_times[phase] += seconds;
+        }
+    }
+
+protected:
+    /// The time in seconds spent in each compilation phase.
+    double m_compile_phase_times[IGenerated_code_executable::CP_LAST + 1];
+};
+
 ///
 /// Base class for classes implementing IGenerated_code_executable.
 ///
 template <class Interface>
-class Generated_code_executable_base : public Allocator_interface_implement<Interface>
+class Generated_code_executable_base
+: public Allocator_interface_implement<Interface>
+, public Compile_phase_times
 {
     typedef Allocator_interface_implement<Interface> Base;
 public:
@@ -145,7 +179,8 @@ public:
     , m_func_infos(alloc)
     , m_captured_arguments_layouts(alloc)
     , m_mappend_strings(alloc)
-    {}
+    {
+    }
 
     // ------------------- from IGenerated_code_executable -------------------
 
@@ -256,6 +291,14 @@ public:
     IGenerated_code_executable::State_usage get_function_state_usage(
         size_t func_index) const MDL_FINAL;
 
+    /// Get the time spent in a compilation phase while this code was generated.
+    ///
+    /// \param phase  the compilation phase
+    ///
+    /// \return the time in seconds or 0.0 if the phase was not executed
+    double get_compile_phase_time(
+        IGenerated_code_executable::Compile_phase phase) const MDL_FINAL;
+
     /// Get the number of captured argument block layouts.
     size_t get_captured_argument_layouts_count() const MDL_FINAL;
 
@@ -636,12 +679,16 @@ public:
     /// The resource data helper class.
     class Res_data {
         friend class Generated_code_lambda_function;
+        friend class Type_mapper;
     public:
+        typedef IResource_handler::Native_texture_2d Native_texture_2d;
+
         /// Default constructor.
         Res_data()
             : m_obj_size(0)
             , m_res_arr(NULL)
             , m_resource_handler(NULL)
+            , m_native_textures(NULL)
         {
         }
 
@@ -654,8 +701,15 @@ public:
         /// Get the current resource handler.
         IResource_handler const *get_resource_handler() const { return m_resource_handler; }
 
+        /// Get the flat 2D texture for the given resource index, if available.
+        Native_texture_2d const *get_native_texture(size_t idx) const {
+            return m_native_textures != NULL ? m_native_textures[idx] : NULL;
+        }
+
         // Clear the data.
-        void clear() { m_obj_size = 0; m_res_arr = NULL; m_resource_handler = NULL; }
+        void clear() {
+            m_obj_size = 0; m_res_arr = NULL; m_resource_handler = NULL; m_native_textures = NULL;
+        }
 
     private:
         /// The size of one resource_data entry.
@@ -666,6 +720,10 @@ public:
 
         /// The current resource handler.
         IResource_handler *m_resource_handler;
+
+        /// The flat 2D textures sampled inline by the generated code, indexed like the
+        /// resource_data blob, or NULL if no code was generated for inline sampling.
+        Native_texture_2d const **m_native_textures;
     };
 
     /// The resource data pair helper class.
@@ -940,6 +998,42 @@ public:
     /// \returns the resource index or 0 if the resource is unknown.
     unsigned get_known_resource_index(unsigned tag) const MDL_FINAL;
 
+    /// Run a compiled lambda function on the CPU for several states, one after the other.
+    ///
+    /// \param[in]  index          the index of the function to execute
+    /// \param[in]  count          the number of states
+    /// \param[out] results        the results will be written to, one per state
+    /// \param[in]  result_stride  the distance in bytes between two consecutive results
+    /// \param[in]  states         an array of \p count core states
+    /// \param[in]  tex_data       extra thread data for the texture handler
+    /// \param[in]  cap_args       the captured arguments block, if arguments were captured
+    ///
+    /// \returns false if execution was aborted by runtime error, true otherwise
+    bool run_generic_multi(
+        size_t                       index,
+        size_t                       count,
+        void                         *results,
+        size_t                       result_stride,
+        Shading_state_material const *states,
+        void                         *tex_data,
+        void const                   *cap_args) MDL_FINAL;
+
+    /// Run a compiled environment function on the CPU for several states, one after the other.
+    ///
+    /// \param[in]  index     the index of the function to execute
+    /// \param[in]  count     the number of states
+    /// \param[out] results   an array of \p count colors the results will be written to
+    /// \param[in]  states    an array of \p count environment states
+    /// \param[in]  tex_data  extra thread data for the texture handler
+    ///
+    /// \returns false if execution was aborted by runtime error, true otherwise
+    bool run_environment_multi(
+        size_t                          index,
+        size_t                          count,
+        RGB_color                       *results,
+        Shading_state_environment const *states,
+        void                            *tex_data) MDL_FINAL;
+
     // -------------------- non-interface methods --------------------
 
     /// Get the LLVM context.
@@ -966,6 +1060,12 @@ public:
         m_render_state_usage = usage;
     }
 
+    /// Set whether the generated code samples flat 2D textures inline.
+    void set_native_tex_lookups(bool enable)
+    {
+        m_native_tex_lookups = enable;
+    }
+
 private:
     /// Register a new non-texture resource tag.
     ///
@@ -1238,6 +1338,9 @@ private:
 
     /// The potential render state usage of the generated code.
     IGenerated_code_lambda_function::State_usage m_render_state_usage;
+
+    /// True, if the generated code samples flat 2D textures inline.
+    bool m_native_tex_lookups;
 };
 
 }  // mdl
@@ -91,13 +91,13 @@ std::unique_ptr<llvm::Module> LLVM_code_generator::load_libbsdf(
         return nullptr;
     }
 
-    std::unique_ptr<llvm::MemoryBuffer> mem(llvm::MemoryBuffer::getMemBuffer(
-        llvm::StringRef((char const *) bitcode, bitcode_size),
-        "libbsdf",
-        /*RequiresNullTerminator=*/ false));
-
-    auto mod = llvm::parseBitcodeFile(*mem.get(), llvm_context);
+    // only the templates of the used distribution functions are materialized while linking
+    auto mod = llvm::getLazyBitcodeModule(
+        llvm::MemoryBufferRef(
+            llvm::StringRef((char const *) bitcode, bitcode_size), "libbsdf"),
+        llvm_context);
     if (!mod) {
+        llvm::consumeError(mod.takeError());
         error(PARSING_LIBBSDF_MODULE_FAILED, Error_params(get_allocator()));
         MDL_ASSERT(!"Parsing libbsdf failed");
         return nullptr;
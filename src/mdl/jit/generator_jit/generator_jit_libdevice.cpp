@@ -97,12 +97,11 @@ std::unique_ptr<llvm::Module> LLVM_code_generator::load_libdevice(
 
     unsigned char const *data = get_libdevice(size, min_ptx_version);
 
-    std::unique_ptr<llvm::MemoryBuffer> mem(llvm::MemoryBuffer::getMemBuffer(
-        llvm::StringRef((char const *)data, size),
-        "libdevice",
-        /*RequiresNullTerminator=*/ false));
-    auto module = llvm::parseBitcodeFile(*mem.get(), llvm_context);
+    auto module = llvm::getLazyBitcodeModule(
+        llvm::MemoryBufferRef(llvm::StringRef((char const *)data, size), "libdevice"),
+        llvm_context);
     if (!module) {
+        llvm::consumeError(module.takeError());
         error(PARSING_LIBDEVICE_MODULE_FAILED, Error_params(get_allocator()));
         MDL_ASSERT(!"Parsing libdevice failed");
         return nullptr;
@@ -51,12 +51,13 @@ namespace mdl {
 std::unique_ptr<llvm::Module> LLVM_code_generator::load_libmdlrt(
     llvm::LLVMContext &llvm_context)
 {
-    std::unique_ptr<llvm::MemoryBuffer> mem(llvm::MemoryBuffer::getMemBuffer(
-        llvm::StringRef((char const *) libmdlrt_bitcode, dimension_of(libmdlrt_bitcode)),
-        "libmdlrt",
-        /*RequiresNullTerminator=*/ false));
-    auto mod = llvm::parseBitcodeFile(*mem.get(), llvm_context);
+    auto mod = llvm::getLazyBitcodeModule(
+        llvm::MemoryBufferRef(
+            llvm::StringRef((char const *) libmdlrt_bitcode, dimension_of(libmdlrt_bitcode)),
+            "libmdlrt"),
+        llvm_context);
     if (!mod) {
+        llvm::consumeError(mod.takeError());
         error(PARSING_LIBBSDF_MODULE_FAILED, Error_params(get_allocator()));
         MDL_ASSERT(!"Parsing libmdlrt failed");
         return nullptr;
@@ -70,7 +71,9 @@ bool LLVM_code_generator::load_and_link_libmdlrt(llvm::Module *llvm_module)
     Store<llvm::Module*> curr_mod(m_module, llvm_module);
 
     std::unique_ptr<llvm::Module> libmdlrt(load_libmdlrt(m_llvm_context));
-    MDL_ASSERT(libmdlrt != NULL);
+    if (!libmdlrt) {
+        return false;
+    }
 
     // clear target triple to avoid LLVM warning on console about mixing different targets
     // when linking libmdlrt ("x86_x64-pc-win32") with libdevice ("nvptx-unknown-unknown").
@@ -90,7 +93,10 @@ bool LLVM_code_generator::load_and_link_libmdlrt(llvm::Module *llvm_module)
             old_func_names.insert(string(f.getName().begin(), f.getName().end(), get_allocator()));
     }
 
-    if (llvm::Linker::linkModules(*llvm_module, std::move(libmdlrt))) {
+    // libmdlrt is loaded lazily, only materialize the functions really used
+    if (llvm::Linker::linkModules(
+            *llvm_module, std::move(libmdlrt), llvm::Linker::Flags::LinkOnlyNeeded))
+    {
         // true means linking has failed
         error(LINKING_LIBMDLRT_FAILED, "unknown linker error");
         MDL_ASSERT(!"Linking libmdlrt failed");
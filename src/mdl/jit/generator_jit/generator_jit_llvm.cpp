@@ -1427,6 +1427,10 @@ LLVM_code_generator::LLVM_code_generator(
 , m_link_libdevice(
     target_lang == ICode_generator::TL_PTX &&
     options.get_bool_option(MDL_JIT_OPTION_LINK_LIBDEVICE))
+, m_codegen_threads(std::max(1, options.get_int_option(MDL_JIT_OPTION_CODEGEN_THREADS)))
+, m_job_executor()
+, m_curr_compile_phase(-1)
+, m_compile_phase_start()
 , m_link_libmdlrt(false)
 , m_link_libbsdf_df_handle_slot_mode(parse_df_handle_slot_mode(
     options.get_string_option(MDL_JIT_OPTION_LINK_LIBBSDF_DF_HANDLE_SLOT_MODE)))
@@ -1444,6 +1448,8 @@ LLVM_code_generator::LLVM_code_generator(
     Instantiated_dfs(get_allocator()),
     get_allocator())
 , m_libbsdf_template_funcs(get_allocator())
+, m_libbsdf_linked_semantics(Df_semantics_set::key_compare(), get_allocator())
+, m_libbsdf_func_names(get_allocator())
 , m_enable_auxiliary(options.get_bool_option(MDL_JIT_OPTION_ENABLE_AUXILIARY))
 , m_enable_pdf(options.get_bool_option(MDL_JIT_OPTION_ENABLE_PDF))
 , m_warn_spectrum_conversion(options.get_bool_option(MDL_JIT_WARN_SPECTRUM_CONVERSION))
@@ -1508,6 +1514,10 @@ LLVM_code_generator::LLVM_code_generator(
     memset(m_tex_lookup_functions, 0, sizeof(m_tex_lookup_functions));
     memset(m_optix_cps,            0, sizeof(m_optix_cps));
 
+    for (size_t i = 0; i <= IGenerated_code_executable::CP_LAST; ++i) {
+        m_compile_phase_times[i] = 0.0;
+    }
+
     char const *s;
 
     s = getenv("MI_MDL_JIT_DEBUG_INFO");
@@ -1897,12 +1907,16 @@ static void AddFunctionInstCounterExtension(
 // Optimize an LLVM function.
 bool LLVM_code_generator::optimize(llvm::Function *func)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_OPTIMIZE);
+
     return m_func_pass_manager->run(*func);
 }
 
 // Optimize LLVM code.
 bool LLVM_code_generator::optimize(llvm::Module *module)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_OPTIMIZE);
+
     if (m_target_lang == ICode_generator::TL_PTX) {
         // already remove any unreferenced libDevice functions to avoid
         // LLVM optimizing them for nothing and mark uses ones as internal
@@ -2358,6 +2372,8 @@ llvm::Function  *LLVM_code_generator::compile_const_lambda(
     Float4_struct const        object_to_world[4],
     int                        object_id)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_DAG_TO_LLVM);
+
     IAllocator *alloc = m_arena.get_allocator();
 
     reset_lambda_state();
@@ -2557,6 +2573,8 @@ llvm::Function *LLVM_code_generator::compile_switch_lambda(
     ICall_name_resolver const *resolver,
     size_t                    next_arg_block_index)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_DAG_TO_LLVM);
+
     reset_lambda_state();
 
     // switch functions return a bool
@@ -2748,6 +2766,8 @@ llvm::Function *LLVM_code_generator::compile_lambda(
     ILambda_call_transformer  *transformer,
     size_t                    next_arg_block_index)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_DAG_TO_LLVM);
+
     IAllocator *alloc = m_arena.get_allocator();
 
     // we need to pass a DAG builder here. We could use a temporary object, but for now
@@ -2966,6 +2986,45 @@ void LLVM_code_generator::set_llvm_function_attributes(
     }
 }
 
+// Constructor, starts the phase.
+Compile_phase_timer::Compile_phase_timer(
+    LLVM_code_generator                       &code_gen,
+    IGenerated_code_executable::Compile_phase phase)
+: m_code_gen(code_gen)
+, m_prev_phase(code_gen.m_curr_compile_phase)
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    if (m_prev_phase >= 0) {
+        std::chrono::duration<double> et = now - code_gen.m_compile_phase_start;
+        code_gen.m_compile_phase_times[m_prev_phase] += et.count();
+    }
+    code_gen.m_curr_compile_phase  = phase;
+    code_gen.m_compile_phase_start = now;
+}
+
+// Destructor, ends the phase and resumes the previous one.
+Compile_phase_timer::~Compile_phase_timer()
+{
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::duration<double> et = now - m_code_gen.m_compile_phase_start;
+    m_code_gen.m_compile_phase_times[m_code_gen.m_curr_compile_phase] += et.count();
+
+    m_code_gen.m_curr_compile_phase  = m_prev_phase;
+    m_code_gen.m_compile_phase_start = now;
+}
+
+// Move the compilation phase timings collected so far into a generated code object.
+void LLVM_code_generator::move_compile_phase_times(Compile_phase_times *code)
+{
+    for (size_t i = 0; i <= IGenerated_code_executable::CP_LAST; ++i) {
+        if (m_compile_phase_times[i] > 0.0) {
+            code->add_compile_phase_time(IGenerated_code_executable::Compile_phase(i),
+                m_compile_phase_times[i]);
+            m_compile_phase_times[i] = 0.0;
+        }
+    }
+}
+
 // Declares an LLVM function from a MDL function instance.
 LLVM_context_data *LLVM_code_generator::declare_function(
     mi::mdl::IModule const  *owner,
@@ -9846,6 +9905,8 @@ bool LLVM_code_generator::load_and_link_renderer_module(llvm::Module *llvm_modul
 // Finalize compilation of the current module.
 llvm::Module *LLVM_code_generator::finalize_module()
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_DAG_TO_LLVM);
+
     // note: these functions could introduce new resource table accesses
     compile_waiting_functions();
 
@@ -9875,6 +9936,15 @@ llvm::Module *LLVM_code_generator::finalize_module()
 
     m_func_pass_manager->doFinalization();
 
+    // all libbsdf links are done, make the libbsdf functions internal to allow global dead
+    // code elimination
+    for (string const &name : m_libbsdf_func_names) {
+        if (llvm::Function *func = llvm_module->getFunction(name.c_str())) {
+            func->setLinkage(llvm::GlobalValue::InternalLinkage);
+        }
+    }
+    m_libbsdf_func_names.clear();
+
     // avoid optimizing unused functions
     for (llvm::Function *func : m_libbsdf_template_funcs) {
         // the "gen_black_bsdf/edf" functions are not cloned, but used directly -> don't remove
@@ -9912,7 +9982,11 @@ llvm::Module *LLVM_code_generator::finalize_module()
         if (m_link_libdevice) {
             std::unique_ptr<llvm::Module> libdevice(
                 load_libdevice(m_llvm_context, m_min_ptx_version));
-            MDL_ASSERT(libdevice);
+            if (!libdevice) {
+                // drop the module and give up
+                drop_llvm_module(llvm_module);
+                return NULL;
+            }
 
             // clear target triple to avoid taking 32-bit triple from libdevice
             libdevice->setTargetTriple("");
@@ -9925,7 +9999,10 @@ llvm::Module *LLVM_code_generator::finalize_module()
                 set_llvm_function_attributes(&func, /*mark_noinline=*/false);
             }
 
-            if (llvm::Linker::linkModules(*llvm_module, std::move(libdevice))) {
+            // libdevice is loaded lazily, only materialize the functions really used
+            if (llvm::Linker::linkModules(
+                    *llvm_module, std::move(libdevice), llvm::Linker::Flags::LinkOnlyNeeded))
+            {
                 // true means linking has failed
                 error(LINKING_LIBDEVICE_FAILED, "unknown linking error");
                 MDL_ASSERT(!"Linking libdevice failed");
@@ -9995,6 +10072,8 @@ llvm::Module *LLVM_code_generator::finalize_module()
 // JIT compile all functions of the given module.
 MDL_JIT_module_key LLVM_code_generator::jit_compile(llvm::Module *module)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_CODEGEN);
+
     // check that all functions exists
     for (auto &func : module->functions()) {
         if (func.isDeclaration() && !func.isIntrinsic()) {
@@ -10077,7 +10156,9 @@ void LLVM_code_generator::ptx_compile(
     llvm::Module *module,
     string       &code)
 {
-    {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_CODEGEN);
+
+    if (m_codegen_threads <= 1 || !ptx_compile_parallel(module, code)) {
         raw_string_ostream SOut(code);
         llvm::buffer_ostream Out(SOut);
 
@@ -10235,6 +10316,8 @@ void LLVM_code_generator::ptx_compile(
 // Compile the given module into LLVM-IR code.
 void LLVM_code_generator::llvm_ir_compile(llvm::Module *module, string &code)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_CODEGEN);
+
     raw_string_ostream SOut(code);
 
     // just print it
@@ -10244,6 +10327,8 @@ void LLVM_code_generator::llvm_ir_compile(llvm::Module *module, string &code)
 // Compile the given module into LLVM-BC code.
 void LLVM_code_generator::llvm_bc_compile(llvm::Module *module, string &code)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_CODEGEN);
+
     raw_string_ostream Out(code);
     llvm::WriteBitcodeToFile(*module, Out);
 }
@@ -10428,6 +10513,8 @@ void LLVM_code_generator::disable_function_instancing()
 // Get the address of a JIT compiled LLVM function.
 void *LLVM_code_generator::get_entry_point(MDL_JIT_module_key module_key, char const* func_name)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_MATERIALIZE);
+
     return m_jitted_code->jit_compile(module_key, func_name, *this);
 }
 
@@ -11044,6 +11131,8 @@ Function_context::Tex_lookup_call_mode LLVM_code_generator::parse_call_mode(char
         return Function_context::TLCM_DIRECT;
     } else if (strcmp(name, "optix_cp") == 0) {
         return Function_context::TLCM_OPTIX_CP;
+    } else if (strcmp(name, "native_inline") == 0) {
+        return Function_context::TLCM_NATIVE_INLINE;
     }
     return Function_context::TLCM_VTABLE;
 }
@@ -29,9 +29,13 @@
 #ifndef MDL_GENERATOR_JIT_LLVM_H
 #define MDL_GENERATOR_JIT_LLVM_H 1
 
+#include <chrono>
+
+#include <mi/base/handle.h>
 #include <mi/base/iinterface.h>
 #include <mi/base/lock.h>
 
+#include <mi/mdl/mdl_code_generators.h>
 #include <mi/mdl/mdl_declarations.h>
 #include <mi/mdl/mdl_generated_dag.h>
 #include <mi/mdl/mdl_types.h>
@@ -1226,6 +1230,31 @@ private:
     Remap_entry *m_first;
 };
 
+/// Helper class measuring the time spent in a compilation phase of a LLVM code generator.
+///
+/// Phases are exclusive: starting a phase pauses the currently running one until the inner
+/// phase ends, so nested phases are not counted twice.
+class Compile_phase_timer {
+public:
+    /// Constructor, starts the phase.
+    ///
+    /// \param code_gen  the code generator collecting the timings
+    /// \param phase     the compilation phase
+    Compile_phase_timer(
+        LLVM_code_generator                       &code_gen,
+        IGenerated_code_executable::Compile_phase phase);
+
+    /// Destructor, ends the phase and resumes the previous one.
+    ~Compile_phase_timer();
+
+private:
+    /// The code generator.
+    LLVM_code_generator &m_code_gen;
+
+    /// The phase that was running when this phase started or -1.
+    int m_prev_phase;
+};
+
 ///
 /// Implementation of the LLVM jit code generator.
 ///
@@ -1239,6 +1268,7 @@ class LLVM_code_generator
     friend class Df_component_info;
     friend class Derivative_infos;
     friend class State_usage_analysis;
+    friend class Compile_phase_timer;
 public:
     static char const MESSAGE_CLASS = 'J';
 
@@ -1250,6 +1280,7 @@ public:
     typedef vector<size_t>::Type Offset_vector;
     typedef vector<mi::mdl::IType const *>::Type Type_vector;
     typedef vector<llvm::Function *>::Type Function_vector;
+    typedef set<IDefinition::Semantics>::Type Df_semantics_set;
 
     ///
     /// The target language for the code generator.
@@ -1451,6 +1482,11 @@ public:
     /// Mark all exported functions as entry points.
     void mark_exported_funcs_as_entries() { m_exported_funcs_are_entries = true; }
 
+    /// Set the executor used for parallel PTX code generation, NULL disables it.
+    void set_job_executor(ICode_generator_job_executor *executor) {
+        m_job_executor = mi::base::make_handle_dup(executor);
+    }
+
     /// Get the layout data of the target machine.
     llvm::DataLayout const *get_target_layout_data() const;
 
@@ -1632,6 +1668,11 @@ public:
         return m_state_usage_analysis.get_module_state_usage();
     }
 
+    /// Move the compilation phase timings collected so far into a generated code object.
+    ///
+    /// \param code  the code object receiving the timings
+    void move_compile_phase_times(Compile_phase_times *code);
+
     /// Get the MDL types of the captured arguments if any.
     Type_vector const &get_captured_argument_mdl_types() const {
         return m_captured_args_mdl_types;
@@ -1876,6 +1917,23 @@ public:
         llvm::Module *module,
         string       &code);
 
+    /// Compile the given module into PTX code using several threads.
+    ///
+    /// The module is partitioned into a common part containing all global variables and all
+    /// functions used by more than one exported function, and clusters of exported functions
+    /// with their private callees. The parts are translated in parallel in separate LLVM contexts
+    /// by the job executor and their PTX code is concatenated in a fixed order (common part
+    /// first, then the clusters in module order).
+    ///
+    /// \param module       the LLVM module to compile, its local symbols might get renamed
+    /// \param code         will be filled with the PTX code
+    ///
+    /// \return false if there is no job executor or the module cannot be split, \p code is
+    ///         unchanged in that case
+    bool ptx_compile_parallel(
+        llvm::Module *module,
+        string       &code);
+
     /// Compile the given module into HLSL or GLSL code.
     ///
     /// \param mod       the LLVM module to JIT compile
@@ -2147,6 +2205,14 @@ public:
         return m_tex_calls_mode;
     }
 
+    /// Returns true, if lookups into 2D textures of the built-in CPU resource handler are
+    /// sampled inline.
+    bool use_native_tex_lookups() const {
+        return m_target_lang == ICode_generator::TL_NATIVE &&
+            m_has_res_handler &&
+            m_tex_calls_mode == Function_context::TLCM_NATIVE_INLINE;
+    }
+
     /// Get the option rt_callable_program_from_id(_64) function.
     llvm::Function *get_optix_cp_from_id();
 
@@ -3697,6 +3763,9 @@ private:
 
     /// Load libdevice.
     ///
+    /// The function bodies are loaded lazily, hence the module must be linked with
+    /// llvm::Linker::Flags::LinkOnlyNeeded.
+    ///
     /// \param[in]  llvm_context     the context for the loader
     /// \param[out] min_ptx_version  if non-zero, the minimum PTX version required for the library
     std::unique_ptr<llvm::Module> load_libdevice(
@@ -3720,6 +3789,9 @@ private:
 
     /// Load the libbsdf LLVM module.
     ///
+    /// The function bodies are loaded lazily, hence the module must be linked with
+    /// llvm::Linker::Flags::LinkOnlyNeeded.
+    ///
     /// \param llvm_context  the context for the loader
     /// \param hsm           df handle type to use, which will be used to select the libbsdf version
     std::unique_ptr<llvm::Module> load_libbsdf(
@@ -3728,6 +3800,9 @@ private:
 
     /// Load the libmdlrt LLVM module.
     ///
+    /// The function bodies are loaded lazily, hence the module must be linked with
+    /// llvm::Linker::Flags::LinkOnlyNeeded.
+    ///
     /// \param llvm_context  the context for the loader
     std::unique_ptr<llvm::Module> load_libmdlrt(llvm::LLVMContext &llvm_context);
 
@@ -3772,13 +3847,36 @@ private:
         int            df_param_idx,
         IType::Kind    kind);
 
+    /// Collect the semantics of all distribution functions used by a distribution function.
+    ///
+    /// \param dist_func  the distribution function
+    /// \param semantics  the set receiving the semantics
+    void collect_df_semantics(
+        Distribution_function const &dist_func,
+        Df_semantics_set            &semantics);
+
+    /// Check whether a libbsdf function is needed, if the given distribution functions are used.
+    ///
+    /// \param name       the name of the libbsdf function
+    /// \param semantics  the semantics of the used distribution functions
+    bool is_libbsdf_function_needed(
+        llvm::StringRef        name,
+        Df_semantics_set const &semantics);
+
     /// Load and link libbsdf into the current LLVM module.
     /// It maps the types from libbsdf to our types and resolves referenced API functions
     /// to our intrinsics.
-    /// \param hsm       df handle type to use, which will be used to select the libbsdf version
+    /// Only the templates of the distribution functions used by the given distribution function
+    /// are linked, the templates needed by later distribution functions of the same module are
+    /// linked on demand.
+    ///
+    /// \param hsm        df handle type to use, which will be used to select the libbsdf version
+    /// \param dist_func  the distribution function which will be compiled
     ///
     /// \returns false if there was any error.
-    bool load_and_link_libbsdf(mdl::Df_handle_slot_mode hsm);
+    bool load_and_link_libbsdf(
+        mdl::Df_handle_slot_mode    hsm,
+        Distribution_function const &dist_func);
 
     /// Returns the set of context data flags to use for functions used with distribution functions.
     LLVM_context_data::Flags get_df_function_flags(const llvm::Function *func);
@@ -4233,6 +4331,21 @@ private:
     /// If true, the libdevice is linked into PTX output.
     bool m_link_libdevice;
 
+    /// The number of threads used for PTX code generation.
+    unsigned m_codegen_threads;
+
+    /// The executor used for parallel PTX code generation, if any.
+    mi::base::Handle<ICode_generator_job_executor> m_job_executor;
+
+    /// The time in seconds spent in each compilation phase so far.
+    double m_compile_phase_times[IGenerated_code_executable::CP_LAST + 1];
+
+    /// The currently running compilation phase or -1.
+    int m_curr_compile_phase;
+
+    /// The point in time when the current compilation phase was started or resumed.
+    std::chrono::steady_clock::time_point m_compile_phase_start;
+
     /// If true, link libmdlrt.
     bool m_link_libmdlrt;
 
@@ -4310,6 +4423,12 @@ private:
     /// List of all libbsdf template functions which should be removed before optimizing.
     mi::mdl::vector<llvm::Function *>::Type m_libbsdf_template_funcs;
 
+    /// The semantics of all distribution functions whose libbsdf templates were linked.
+    Df_semantics_set m_libbsdf_linked_semantics;
+
+    /// The names of all functions linked from libbsdf, made internal in finalize_module().
+    hash_set<string, string_hash<string> >::Type m_libbsdf_func_names;
+
 
     /// If true, auxiliary functions are generated for DFs.
     bool m_enable_auxiliary;
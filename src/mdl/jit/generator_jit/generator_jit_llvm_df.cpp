@@ -1143,6 +1143,8 @@ llvm::Module *LLVM_code_generator::compile_distribution_function(
     size_t                      next_arg_block_index,
     size_t                      *main_function_indices)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_DAG_TO_LLVM);
+
     m_dist_func = &dist_func;
 
 #if 0
@@ -1182,10 +1184,9 @@ llvm::Module *LLVM_code_generator::compile_distribution_function(
         }
     }
 
-    // load libbsdf into the current module, if it was not initialized, yet
-    if (m_type_bsdf_sample_data == NULL &&
-        !load_and_link_libbsdf(m_link_libbsdf_df_handle_slot_mode))
-    {
+    // load the parts of libbsdf used by this distribution function into the current module,
+    // if they were not linked, yet
+    if (!load_and_link_libbsdf(m_link_libbsdf_df_handle_slot_mode, dist_func)) {
         // drop the module and give up
         drop_llvm_module(m_module);
         m_dist_func = NULL;
@@ -2227,11 +2228,99 @@ LLVM_context_data::Flags LLVM_code_generator::get_df_function_flags(const llvm::
     return flags;
 }
 
+// Collect the semantics of all distribution functions used by a distribution function.
+void LLVM_code_generator::collect_df_semantics(
+    Distribution_function const &dist_func,
+    Df_semantics_set            &semantics)
+{
+    IAllocator *alloc = get_allocator();
+
+    typedef ptr_hash_set<DAG_node const>::Type Node_set;
+    Node_set visited_nodes(0, Node_set::hasher(), Node_set::key_equal(), alloc);
+    vector<DAG_node const *>::Type worklist(alloc);
+
+    for (size_t i = 0, n = dist_func.get_main_function_count(); i < n; ++i) {
+        mi::base::Handle<ILambda_function> main_func(dist_func.get_main_function(i));
+        worklist.push_back(main_func->get_body());
+    }
+    for (size_t i = 0, n = dist_func.get_expr_lambda_count(); i < n; ++i) {
+        mi::base::Handle<ILambda_function> expr_lambda(dist_func.get_expr_lambda(i));
+        worklist.push_back(expr_lambda->get_body());
+    }
+
+    while (!worklist.empty()) {
+        DAG_node const *node = worklist.back();
+        worklist.pop_back();
+
+        if (node == NULL || !visited_nodes.insert(node).second) {
+            continue;
+        }
+
+        switch (node->get_kind()) {
+        case DAG_node::EK_TEMPORARY:
+            worklist.push_back(cast<DAG_temporary>(node)->get_expr());
+            break;
+        case DAG_node::EK_CALL:
+            {
+                DAG_call const *call = cast<DAG_call>(node);
+                IDefinition::Semantics sema = call->get_semantic();
+                if (is_df_semantics(sema)) {
+                    semantics.insert(sema);
+                }
+                for (int i = 0, n = call->get_argument_count(); i < n; ++i) {
+                    worklist.push_back(call->get_argument(i));
+                }
+            }
+            break;
+        case DAG_node::EK_CONSTANT:
+        case DAG_node::EK_PARAMETER:
+            break;
+        }
+    }
+}
+
+// Check whether a libbsdf function is needed, if the given distribution functions are used.
+bool LLVM_code_generator::is_libbsdf_function_needed(
+    llvm::StringRef        name,
+    Df_semantics_set const &semantics)
+{
+    IDefinition::Semantics sema = get_libbsdf_function_semantics(name);
+
+    // black_bsdf and black_edf replace all unsupported distribution functions
+    if (sema == IDefinition::DS_INVALID_REF_CONSTRUCTOR) {
+        return true;
+    }
+
+    // helper functions are linked, when they are referenced by a template
+    if (!is_df_semantics(sema) || semantics.count(sema) == 0) {
+        return false;
+    }
+
+    // the combined implementations of thin_film() and its argument are only used with thin_film()
+    if (name.startswith("thin_film_") && sema != IDefinition::DS_INTRINSIC_DF_THIN_FILM) {
+        return semantics.count(IDefinition::DS_INTRINSIC_DF_THIN_FILM) != 0;
+    }
+    return true;
+}
+
 // Load and link libbsdf into the current LLVM module.
-bool LLVM_code_generator::load_and_link_libbsdf(mdl::Df_handle_slot_mode hsm)
+bool LLVM_code_generator::load_and_link_libbsdf(
+    mdl::Df_handle_slot_mode    hsm,
+    Distribution_function const &dist_func)
 {
+    bool first_link = m_type_bsdf_sample_data == NULL;
+
+    Df_semantics_set semantics(m_libbsdf_linked_semantics);
+    collect_df_semantics(dist_func, semantics);
+    if (!first_link && semantics.size() == m_libbsdf_linked_semantics.size()) {
+        // all templates needed by this distribution function are already available
+        return true;
+    }
+
     std::unique_ptr<llvm::Module> libbsdf(load_libbsdf(m_llvm_context, hsm));
-    MDL_ASSERT(libbsdf != NULL);
+    if (!libbsdf) {
+        return false;
+    }
 
     // clear target triple to avoid LLVM warning on console about mixing different targets
     // when linking libbsdf ("x86_x64-pc-win32") with libdevice ("nvptx-unknown-unknown").
@@ -2252,37 +2341,61 @@ bool LLVM_code_generator::load_and_link_libbsdf(mdl::Df_handle_slot_mode hsm)
         }
     }
 
-    if (llvm::Linker::linkModules(*m_module, std::move(libbsdf))) {
+    // declare all needed functions, which were not linked before, so the linker materializes
+    // them together with everything they reference.
+    // note: the declarations get a placeholder type, otherwise the libbsdf types of a later link
+    //       would not be mapped to the already linked ones
+    llvm::FunctionType *placeholder_type = llvm::FunctionType::get(
+        llvm::Type::getVoidTy(m_llvm_context), /*isVarArg=*/false);
+    for (llvm::Function &f : libbsdf->functions()) {
+        if (f.isDeclaration() || f.hasLocalLinkage() ||
+                !is_libbsdf_function_needed(f.getName(), semantics) ||
+                (!first_link && is_libbsdf_function_needed(
+                    f.getName(), m_libbsdf_linked_semantics)))
+        {
+            continue;
+        }
+        m_module->getOrInsertFunction(f.getName(), placeholder_type);
+    }
+    m_libbsdf_linked_semantics.swap(semantics);
+
+    // libbsdf is loaded lazily, only materialize the functions really used
+    if (llvm::Linker::linkModules(
+            *m_module, std::move(libbsdf), llvm::Linker::Flags::LinkOnlyNeeded))
+    {
         // true means linking has failed
         error(LINKING_LIBBSDF_FAILED, "unknown linker error");
         MDL_ASSERT(!"Linking libbsdf failed");
         return false;
     }
 
-    m_float3_struct_type = llvm::StructType::getTypeByName(
-        m_llvm_context, "struct.float3");
-    if (m_float3_struct_type == NULL) {
-        // name was lost during linking? get it from
-        //    void @black_bsdf_sample(
-        //        %struct.BSDF_sample_data* nocapture %data,
-        //        %class.State* nocapture readnone %state,
-        //        %struct.float3* nocapture readnone %inherited_normal)
-
-        llvm::Function *func = m_module->getFunction("black_bsdf_sample");
-        MDL_ASSERT(func != NULL);
-        llvm::FunctionType *func_type = func->getFunctionType();
-        m_float3_struct_type = llvm::cast<llvm::StructType>(
-            func_type->getParamType(2)->getPointerElementType());
-        MDL_ASSERT(m_float3_struct_type != NULL);
-    }
+    // the libbsdf types are mapped to the ones of the first link on all later links
+    if (first_link) {
+        m_float3_struct_type = llvm::StructType::getTypeByName(
+            m_llvm_context, "struct.float3");
+        if (m_float3_struct_type == NULL) {
+            // name was lost during linking? get it from
+            //    void @black_bsdf_sample(
+            //        %struct.BSDF_sample_data* nocapture %data,
+            //        %class.State* nocapture readnone %state,
+            //        %struct.float3* nocapture readnone %inherited_normal)
+
+            llvm::Function *func = m_module->getFunction("black_bsdf_sample");
+            MDL_ASSERT(func != NULL);
+            llvm::FunctionType *func_type = func->getFunctionType();
+            m_float3_struct_type = llvm::cast<llvm::StructType>(
+                func_type->getParamType(2)->getPointerElementType());
+            MDL_ASSERT(m_float3_struct_type != NULL);
+        }
 
 
-    create_bsdf_function_types();
-    create_edf_function_types();
+        create_bsdf_function_types();
+        create_edf_function_types();
 
-    // get the unique IDs for two metadata we will use
-    m_bsdf_param_metadata_id = m_llvm_context.getMDKindID("libbsdf.bsdf_param");
-    m_edf_param_metadata_id  = m_llvm_context.getMDKindID("libbsdf.edf_param");
+        // get the unique IDs for two metadata we will use
+        m_bsdf_param_metadata_id = m_llvm_context.getMDKindID("libbsdf.bsdf_param");
+        m_edf_param_metadata_id  = m_llvm_context.getMDKindID("libbsdf.edf_param");
+    }
 
     llvm::Type *int_type = m_type_mapper.get_int_type();
     unsigned alloca_addr_space = m_module->getDataLayout().getAllocaAddrSpace();
@@ -2308,8 +2421,11 @@ bool LLVM_code_generator::load_and_link_libbsdf(mdl::Df_handle_slot_mode hsm)
         // for non-PTX backends
         func->removeFnAttr("target-features");
 
-        // make all functions from libbsdf internal to allow global dead code elimination
-        func->setLinkage(llvm::GlobalValue::InternalLinkage);
+        // remember all functions from libbsdf to make them internal in finalize_module() to
+        // allow global dead code elimination. They must stay external until then, otherwise
+        // later links of libbsdf would import a second copy instead of reusing them.
+        m_libbsdf_func_names.insert(
+            string(func->getName().begin(), func->getName().end(), get_allocator()));
 
         // translate all runtime calls
         {
@@ -2391,6 +2391,564 @@ llvm::Value *MDL_runtime_creator::call_attr_func(
     return res;
 }
 
+// Create the texel index remapping of one coordinate of a flat 2D texture lookup.
+// Matches texremapll() of the native texture runtime, including its handling of negative
+// coordinates.
+static llvm::Value *create_native_texremap(
+    Function_context &ctx,
+    llvm::Function   *floor_func,
+    llvm::Value      *t,
+    llvm::Value      *res,
+    llvm::Value      *ofs,
+    llvm::Value      *wrap)
+{
+    llvm::Type  *i32_type = ctx->getInt32Ty();
+    llvm::Type  *i64_type = ctx->getInt64Ty();
+    llvm::Value *res64    = ctx->CreateZExt(res, i64_type);
+    llvm::Value *ti       = ctx->CreateFPToSI(t, i64_type);
+    llvm::Value *tf       = ctx->CreateFPToSI(ctx->CreateCall(floor_func, t), i64_type);
+
+    // clamp and clip: clamp into [0, res - 1]
+    llvm::Value *max64   = ctx->CreateSub(res64, ctx->getInt64(1));
+    llvm::Value *clamped = ctx->CreateSelect(
+        ctx->CreateICmpSLT(ti, ctx->getInt64(0)), ctx->getInt64(0), ti);
+    clamped = ctx->CreateSelect(ctx->CreateICmpSGT(clamped, max64), max64, clamped);
+    clamped = ctx->CreateTrunc(clamped, i32_type);
+
+    // repeat and mirrored repeat
+    llvm::Value *s      = ctx->CreateLShr(ctx->CreateBitCast(t, i32_type), 31);
+    llvm::Value *d      = ctx->CreateTrunc(ctx->CreateSDiv(ti, res64), i32_type);
+    llvm::Value *r      = ctx->CreateTrunc(ctx->CreateSRem(ti, res64), i32_type);
+    llvm::Value *mirror = ctx->CreateZExt(
+        ctx->CreateICmpEQ(wrap, ctx.get_constant(int(stdlib::wrap_mirrored_repeat))),
+        i32_type);
+    llvm::Value *a      = ctx->CreateAnd(
+        ctx->CreateAnd(mirror, ctx->CreateXor(d, s)), ctx.get_constant(int(1)));
+
+    // if alternating, negative tex has to be flipped, otherwise padded back to positive
+    r = ctx->CreateSelect(ctx->CreateICmpNE(a, ctx.get_constant(int(0))), ctx->CreateNeg(r), r);
+    r = ctx->CreateSelect(
+        ctx->CreateICmpNE(s, a),
+        ctx->CreateAdd(r, ctx->CreateSub(res, ctx.get_constant(int(1)))),
+        r);
+
+    llvm::Value *is_clamp = ctx->CreateOr(
+        ctx->CreateICmpEQ(wrap, ctx.get_constant(int(stdlib::wrap_clamp))),
+        ctx->CreateICmpEQ(wrap, ctx.get_constant(int(stdlib::wrap_clip))));
+    llvm::Value *wrapped  = ctx->CreateSelect(is_clamp, clamped, r);
+
+    // the early out also catches the -1..0 case via the floor'ed coordinate
+    llvm::Value *in_range = ctx->CreateICmpULT(tf, res64);
+    llvm::Value *texi     = ctx->CreateSelect(in_range, ctx->CreateTrunc(ti, i32_type), wrapped);
+
+    // crop
+    return ctx->CreateAdd(texi, ofs);
+}
+
+// Create a saturate(f) operation.
+static llvm::Value *create_native_saturate(
+    Function_context &ctx,
+    llvm::Value      *f)
+{
+    llvm::Value *zero = ctx.get_constant(0.0f);
+    llvm::Value *one  = ctx.get_constant(1.0f);
+    llvm::Value *res  = ctx->CreateSelect(ctx->CreateFCmpOLT(f, one), f, one);
+    return ctx->CreateSelect(ctx->CreateFCmpOLT(zero, res), res, zero);
+}
+
+// Load one RGBA texel of a flat 2D texture level.
+static llvm::Value *create_native_texel_load(
+    Function_context &ctx,
+    llvm::Value      *texels,
+    llvm::Value      *width,
+    llvm::Value      *x,
+    llvm::Value      *y)
+{
+    llvm::Type  *i64_type = ctx->getInt64Ty();
+    llvm::Value *idx      = ctx->CreateAdd(
+        ctx->CreateMul(ctx->CreateZExt(y, i64_type), ctx->CreateZExt(width, i64_type)),
+        ctx->CreateZExt(x, i64_type));
+    llvm::Value *adr      = ctx->CreateInBoundsGEP(
+        texels, ctx->CreateMul(idx, ctx->getInt64(4)));
+
+    llvm::Type *float4_type = llvm::FixedVectorType::get(ctx->getFloatTy(), 4);
+    adr = ctx->CreateBitCast(adr, Type_mapper::get_ptr(float4_type));
+
+    // texels are only float aligned
+    llvm::LoadInst *texel = ctx->CreateLoad(adr);
+    texel->setAlignment(llvm::Align(4));
+    return texel;
+}
+
+// Get the function sampling one level of a flat 2D texture bilinearly.
+llvm::Function *MDL_runtime_creator::get_native_tex_sample_2d()
+{
+    if (m_native_tex_sample_2d != NULL) {
+        return m_native_tex_sample_2d;
+    }
+
+    Type_mapper &type_mapper = m_code_gen.m_type_mapper;
+    llvm::Type  *float_type  = type_mapper.get_float_type();
+    llvm::Type  *int_type    = type_mapper.get_int_type();
+    llvm::Type  *float4_type = llvm::FixedVectorType::get(float_type, 4);
+
+    llvm::Type *params[] = {
+        Type_mapper::get_ptr(type_mapper.get_native_texture_level_type()),  // level
+        float_type,  // u
+        float_type,  // v
+        int_type,    // wrap_u
+        int_type,    // wrap_v
+        float_type,  // crop offset u
+        float_type,  // crop size u
+        float_type,  // crop offset v
+        float_type   // crop size v
+    };
+    llvm::Function *func = llvm::Function::Create(
+        llvm::FunctionType::get(float4_type, params, /*isVarArg=*/false),
+        llvm::GlobalValue::InternalLinkage,
+        "mdl_native_tex_sample_2d",
+        m_code_gen.m_module);
+    m_code_gen.set_llvm_function_attributes(func, /*mark_noinline=*/false);
+    m_native_tex_sample_2d = func;
+
+    llvm::Function *floor_func = get_runtime_func(RT_FLOORF);
+
+    Function_instance inst(
+        m_alloc,
+        /*func_def=*/ nullptr,
+        /*return_derivs=*/ false,
+        m_code_gen.target_supports_storage_spaces());
+    Function_context ctx(m_alloc, m_code_gen, inst, func, LLVM_context_data::FL_NONE);
+
+    llvm::Function::arg_iterator arg_it = ctx.get_first_parameter();
+    llvm::Value *level       = arg_it++;
+    llvm::Value *u           = arg_it++;
+    llvm::Value *v           = arg_it++;
+    llvm::Value *wrap_u      = arg_it++;
+    llvm::Value *wrap_v      = arg_it++;
+    llvm::Value *crop_ofs_u  = arg_it++;
+    llvm::Value *crop_size_u = arg_it++;
+    llvm::Value *crop_ofs_v  = arg_it++;
+    llvm::Value *crop_size_v = arg_it;
+
+    llvm::Value *texels = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(level, Type_mapper::NTL_TEXELS));
+    llvm::Value *width  = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(level, Type_mapper::NTL_WIDTH));
+    llvm::Value *height = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(level, Type_mapper::NTL_HEIGHT));
+
+    llvm::BasicBlock *bb_zero  = ctx.create_bb("bb_zero");
+    llvm::BasicBlock *bb_remap = ctx.create_bb("bb_remap");
+    llvm::BasicBlock *bb_fetch = ctx.create_bb("bb_fetch");
+
+    llvm::Value *f_zero = ctx.get_constant(0.0f);
+    llvm::Value *f_one  = ctx.get_constant(1.0f);
+    llvm::Value *i_zero = ctx.get_constant(int(0));
+    llvm::Value *i_one  = ctx.get_constant(int(1));
+    llvm::Value *clip   = ctx.get_constant(int(stdlib::wrap_clip));
+
+    // empty level or clipped coordinate
+    llvm::Value *cond = ctx->CreateOr(
+        ctx->CreateICmpEQ(width, i_zero), ctx->CreateICmpEQ(height, i_zero));
+    cond = ctx->CreateOr(cond, ctx->CreateAnd(
+        ctx->CreateICmpEQ(wrap_u, clip),
+        ctx->CreateOr(ctx->CreateFCmpOLT(u, f_zero), ctx->CreateFCmpOGT(u, f_one))));
+    cond = ctx->CreateOr(cond, ctx->CreateAnd(
+        ctx->CreateICmpEQ(wrap_v, clip),
+        ctx->CreateOr(ctx->CreateFCmpOLT(v, f_zero), ctx->CreateFCmpOGT(v, f_one))));
+    ctx->CreateCondBr(cond, bb_zero, bb_remap);
+
+    ctx->SetInsertPoint(bb_zero);
+    ctx.create_return(llvm::Constant::getNullValue(float4_type));
+
+    ctx->SetInsertPoint(bb_remap);
+
+    llvm::Value *crop_x = ctx->CreateFPToSI(
+        ctx->CreateFMul(ctx->CreateUIToFP(ctx->CreateSub(width, i_one), float_type), crop_ofs_u),
+        int_type);
+    llvm::Value *crop_y = ctx->CreateFPToSI(
+        ctx->CreateFMul(ctx->CreateUIToFP(ctx->CreateSub(height, i_one), float_type), crop_ofs_v),
+        int_type);
+
+    llvm::Value *res_x = ctx->CreateFPToUI(
+        ctx->CreateFMul(ctx->CreateUIToFP(width, float_type), crop_size_u), int_type);
+    res_x = ctx->CreateSelect(ctx->CreateICmpEQ(res_x, i_zero), i_one, res_x);
+    llvm::Value *res_y = ctx->CreateFPToUI(
+        ctx->CreateFMul(ctx->CreateUIToFP(height, float_type), crop_size_v), int_type);
+    res_y = ctx->CreateSelect(ctx->CreateICmpEQ(res_y, i_zero), i_one, res_y);
+
+    llvm::Value *half  = ctx.get_constant(0.5f);
+    llvm::Value *tex_x = ctx->CreateFSub(
+        ctx->CreateFMul(u, ctx->CreateUIToFP(res_x, float_type)), half);
+    llvm::Value *tex_y = ctx->CreateFSub(
+        ctx->CreateFMul(v, ctx->CreateUIToFP(res_y, float_type)), half);
+
+    // check for LLONG_MAX as the remapping overflows otherwise
+    llvm::Value *abs_mask = ctx.get_constant(int(0x7FFFFFFF));
+    llvm::Value *limit    = ctx.get_constant(int(0x5F000000));
+    cond = ctx->CreateOr(
+        ctx->CreateICmpUGE(ctx->CreateAnd(ctx->CreateBitCast(tex_x, int_type), abs_mask), limit),
+        ctx->CreateICmpUGE(ctx->CreateAnd(ctx->CreateBitCast(tex_y, int_type), abs_mask), limit));
+    ctx->CreateCondBr(cond, bb_zero, bb_fetch);
+
+    ctx->SetInsertPoint(bb_fetch);
+
+    llvm::Value *x0 = create_native_texremap(ctx, floor_func, tex_x, res_x, crop_x, wrap_u);
+    llvm::Value *y0 = create_native_texremap(ctx, floor_func, tex_y, res_y, crop_y, wrap_v);
+    llvm::Value *x1 = create_native_texremap(
+        ctx, floor_func, ctx->CreateFAdd(tex_x, f_one), res_x, crop_x, wrap_u);
+    llvm::Value *y1 = create_native_texremap(
+        ctx, floor_func, ctx->CreateFAdd(tex_y, f_one), res_y, crop_y, wrap_v);
+
+    // smootherstep weights: l *= l * l * (l * (l * 6 - 15) + 10)
+    llvm::Value *lerp[2] = {
+        ctx->CreateFSub(tex_x, ctx->CreateCall(floor_func, tex_x)),
+        ctx->CreateFSub(tex_y, ctx->CreateCall(floor_func, tex_y))
+    };
+    for (size_t i = 0; i < 2; ++i) {
+        llvm::Value *l = lerp[i];
+        llvm::Value *p = ctx->CreateFSub(
+            ctx->CreateFMul(l, ctx.get_constant(6.0f)), ctx.get_constant(15.0f));
+        p = ctx->CreateFAdd(ctx->CreateFMul(l, p), ctx.get_constant(10.0f));
+        lerp[i] = ctx->CreateFMul(l, ctx->CreateFMul(ctx->CreateFMul(l, l), p));
+    }
+    llvm::Value *one_x = ctx->CreateFSub(f_one, lerp[0]);
+    llvm::Value *one_y = ctx->CreateFSub(f_one, lerp[1]);
+
+    llvm::Value *st[4] = {
+        ctx->CreateFMul(one_x,   one_y),
+        ctx->CreateFMul(lerp[0], one_y),
+        ctx->CreateFMul(one_x,   lerp[1]),
+        ctx->CreateFMul(lerp[0], lerp[1])
+    };
+    llvm::Value *c[4] = {
+        create_native_texel_load(ctx, texels, width, x0, y0),
+        create_native_texel_load(ctx, texels, width, x1, y0),
+        create_native_texel_load(ctx, texels, width, x0, y1),
+        create_native_texel_load(ctx, texels, width, x1, y1)
+    };
+
+    llvm::Value *res = ctx->CreateFMul(c[0], ctx->CreateVectorSplat(4, st[0]));
+    for (size_t i = 1; i < 4; ++i) {
+        res = ctx->CreateFAdd(res, ctx->CreateFMul(c[i], ctx->CreateVectorSplat(4, st[i])));
+    }
+    ctx.create_return(res);
+
+    return func;
+}
+
+// Get the function looking up a flat 2D texture.
+llvm::Function *MDL_runtime_creator::get_native_tex_lookup_2d(bool with_derivs)
+{
+    llvm::Function *&cache = with_derivs ? m_native_tex_lookup_deriv_2d : m_native_tex_lookup_2d;
+    if (cache != NULL) {
+        return cache;
+    }
+
+    Type_mapper &type_mapper = m_code_gen.m_type_mapper;
+    llvm::Type  *float_type  = type_mapper.get_float_type();
+    llvm::Type  *int_type    = type_mapper.get_int_type();
+    llvm::Type  *float4_type = llvm::FixedVectorType::get(float_type, 4);
+    llvm::Type  *coord_type  = with_derivs
+        ? static_cast<llvm::Type *>(type_mapper.get_deriv_arr_float_2_type())
+        : static_cast<llvm::Type *>(type_mapper.get_arr_float_2_type());
+    llvm::Type  *crop_type   = type_mapper.get_arr_float_2_type();
+
+    llvm::Type *params[] = {
+        Type_mapper::get_ptr(type_mapper.get_native_texture_2d_type()),  // texture
+        Type_mapper::get_ptr(coord_type),                                // coord
+        int_type,                                                        // wrap_u
+        int_type,                                                        // wrap_v
+        Type_mapper::get_ptr(crop_type),                                 // crop_u
+        Type_mapper::get_ptr(crop_type)                                  // crop_v
+    };
+    llvm::Function *func = llvm::Function::Create(
+        llvm::FunctionType::get(float4_type, params, /*isVarArg=*/false),
+        llvm::GlobalValue::InternalLinkage,
+        with_derivs ? "mdl_native_tex_lookup_deriv_2d" : "mdl_native_tex_lookup_2d",
+        m_code_gen.m_module);
+    m_code_gen.set_llvm_function_attributes(func, /*mark_noinline=*/false);
+    cache = func;
+
+    llvm::Function *sample_func = get_native_tex_sample_2d();
+    llvm::Function *floor_func  = get_runtime_func(RT_FLOORF);
+    llvm::Function *pow_func    = with_derivs ? NULL : get_runtime_func(RT_POWF);
+    llvm::Function *log2_func   = with_derivs ? get_runtime_func(RT_LOG2F) : NULL;
+
+    Function_instance inst(
+        m_alloc,
+        /*func_def=*/ nullptr,
+        /*return_derivs=*/ false,
+        m_code_gen.target_supports_storage_spaces());
+    Function_context ctx(m_alloc, m_code_gen, inst, func, LLVM_context_data::FL_NONE);
+
+    llvm::Function::arg_iterator arg_it = ctx.get_first_parameter();
+    llvm::Value *tex    = arg_it++;
+    llvm::Value *coord  = arg_it++;
+    llvm::Value *wrap_u = arg_it++;
+    llvm::Value *wrap_v = arg_it++;
+    llvm::Value *crop_u = arg_it++;
+    llvm::Value *crop_v = arg_it;
+
+    llvm::Value *f_zero = ctx.get_constant(0.0f);
+    llvm::Value *f_one  = ctx.get_constant(1.0f);
+
+    llvm::Value *val = with_derivs ? ctx.create_simple_gep_in_bounds(coord, 0u) : coord;
+    llvm::Value *u   = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(val, 0u));
+    llvm::Value *v   = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(val, 1u));
+
+    llvm::Value *crop_u0 = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(crop_u, 0u));
+    llvm::Value *crop_u1 = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(crop_u, 1u));
+    llvm::Value *crop_v0 = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(crop_v, 0u));
+    llvm::Value *crop_v1 = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(crop_v, 1u));
+
+    llvm::Value *levels = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(tex, Type_mapper::NT_LEVELS));
+
+    // same arguments for all levels, only the level itself differs
+    llvm::Value *args[] = {
+        levels,
+        u,
+        v,
+        wrap_u,
+        wrap_v,
+        create_native_saturate(ctx, crop_u0),
+        create_native_saturate(ctx, ctx->CreateFSub(crop_u1, crop_u0)),
+        create_native_saturate(ctx, crop_v0),
+        create_native_saturate(ctx, ctx->CreateFSub(crop_v1, crop_v0))
+    };
+
+    if (!with_derivs) {
+        llvm::Value *res   = ctx->CreateCall(sample_func, args);
+        llvm::Value *gamma = ctx->CreateLoad(
+            ctx.create_simple_gep_in_bounds(tex, Type_mapper::NT_GAMMA));
+
+        llvm::BasicBlock *bb_gamma = ctx.create_bb("bb_gamma");
+        llvm::BasicBlock *bb_end   = ctx.create_bb("bb_end");
+
+        ctx->CreateCondBr(ctx->CreateFCmpUNE(gamma, f_one), bb_gamma, bb_end);
+
+        ctx->SetInsertPoint(bb_gamma);
+        {
+            // gamma is applied after filtering: f <= 0 ? 0 : powf(f, gamma)
+            llvm::Value *g_res = res;
+            for (unsigned i = 0; i < 4; ++i) {
+                llvm::Value *f = ctx->CreateExtractElement(res, i);
+                llvm::Value *p = ctx->CreateCall(pow_func, { f, gamma });
+                g_res = ctx->CreateInsertElement(
+                    g_res, ctx->CreateSelect(ctx->CreateFCmpOLE(f, f_zero), f_zero, p), i);
+            }
+            ctx.create_return(g_res);
+        }
+
+        ctx->SetInsertPoint(bb_end);
+        ctx.create_return(res);
+        return func;
+    }
+
+    // isotropic filtering
+    llvm::Value *dx = ctx.create_simple_gep_in_bounds(coord, 1u);
+    llvm::Value *dy = ctx.create_simple_gep_in_bounds(coord, 2u);
+    llvm::Value *dx_u = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(dx, 0u));
+    llvm::Value *dx_v = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(dx, 1u));
+    llvm::Value *dy_u = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(dy, 0u));
+    llvm::Value *dy_v = ctx->CreateLoad(ctx.create_simple_gep_in_bounds(dy, 1u));
+
+    llvm::Value *dx_len_sqr = ctx->CreateFAdd(
+        ctx->CreateFMul(dx_u, dx_u), ctx->CreateFMul(dx_v, dx_v));
+    llvm::Value *dy_len_sqr = ctx->CreateFAdd(
+        ctx->CreateFMul(dy_u, dy_u), ctx->CreateFMul(dy_v, dy_v));
+    llvm::Value *len_sqr    = ctx->CreateSelect(
+        ctx->CreateFCmpOLT(dx_len_sqr, dy_len_sqr), dy_len_sqr, dx_len_sqr);
+    llvm::Value *min_len    = ctx.get_constant(1e-8f);
+    len_sqr = ctx->CreateSelect(ctx->CreateFCmpOLT(min_len, len_sqr), len_sqr, min_len);
+
+    llvm::Value *n_levels = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(tex, Type_mapper::NT_NUM_LEVELS));
+    llvm::Value *last     = ctx->CreateSub(n_levels, ctx.get_constant(int(1)));
+    llvm::Value *f_last   = ctx->CreateUIToFP(last, float_type);
+    llvm::Value *level    = ctx->CreateFAdd(
+        f_last,
+        ctx->CreateFMul(ctx.get_constant(0.5f), ctx->CreateCall(log2_func, len_sqr)));
+
+    llvm::BasicBlock *bb_finest    = ctx.create_bb("bb_finest");
+    llvm::BasicBlock *bb_not_fine  = ctx.create_bb("bb_not_finest");
+    llvm::BasicBlock *bb_coarsest  = ctx.create_bb("bb_coarsest");
+    llvm::BasicBlock *bb_trilinear = ctx.create_bb("bb_trilinear");
+
+    ctx->CreateCondBr(ctx->CreateFCmpOLT(level, f_zero), bb_finest, bb_not_fine);
+
+    ctx->SetInsertPoint(bb_finest);
+    ctx.create_return(ctx->CreateCall(sample_func, args));
+
+    ctx->SetInsertPoint(bb_not_fine);
+    ctx->CreateCondBr(ctx->CreateFCmpOGE(level, f_last), bb_coarsest, bb_trilinear);
+
+    ctx->SetInsertPoint(bb_coarsest);
+    {
+        // just read the single pixel of the smallest mipmap
+        llvm::Value *coarsest = ctx->CreateInBoundsGEP(
+            levels, ctx->CreateZExt(last, ctx->getInt64Ty()));
+        llvm::Value *texels   = ctx->CreateLoad(
+            ctx.create_simple_gep_in_bounds(coarsest, Type_mapper::NTL_TEXELS));
+        llvm::Value *zero     = ctx.get_constant(int(0));
+        ctx.create_return(create_native_texel_load(ctx, texels, zero, zero, zero));
+    }
+
+    ctx->SetInsertPoint(bb_trilinear);
+    {
+        // trilinear filtering between the two mipmap levels
+        llvm::Value *level_uint = ctx->CreateFPToUI(
+            ctx->CreateCall(floor_func, level), int_type);
+        llvm::Value *lerp       = ctx->CreateFSub(
+            level, ctx->CreateUIToFP(level_uint, float_type));
+        llvm::Value *idx        = ctx->CreateZExt(level_uint, ctx->getInt64Ty());
+
+        args[0] = ctx->CreateInBoundsGEP(levels, idx);
+        llvm::Value *rgba_0 = ctx->CreateCall(sample_func, args);
+        args[0] = ctx->CreateInBoundsGEP(levels, ctx->CreateAdd(idx, ctx->getInt64(1)));
+        llvm::Value *rgba_1 = ctx->CreateCall(sample_func, args);
+
+        llvm::Value *res = ctx->CreateFAdd(
+            ctx->CreateFMul(ctx->CreateVectorSplat(4, ctx->CreateFSub(f_one, lerp)), rgba_0),
+            ctx->CreateFMul(ctx->CreateVectorSplat(4, lerp), rgba_1));
+        ctx.create_return(res);
+    }
+    return func;
+}
+
+// Wrap a 2D texture lookup glue function for inline sampling of flat textures.
+llvm::Function *MDL_runtime_creator::wrap_native_tex_lookup_2d(
+    Runtime_function code,
+    llvm::Function   *glue)
+{
+    if (!m_code_gen.use_native_tex_lookups()) {
+        return glue;
+    }
+
+    bool     with_derivs = false;
+    unsigned n_comps     = 4;
+    switch (code) {
+    case RT_MDL_TEX_LOOKUP_DERIV_FLOAT_2D:
+        with_derivs = true;
+        // fall through
+    case RT_MDL_TEX_LOOKUP_FLOAT_2D:
+        n_comps = 1;
+        break;
+    case RT_MDL_TEX_LOOKUP_DERIV_FLOAT2_2D:
+        with_derivs = true;
+        // fall through
+    case RT_MDL_TEX_LOOKUP_FLOAT2_2D:
+        n_comps = 2;
+        break;
+    case RT_MDL_TEX_LOOKUP_DERIV_FLOAT3_2D:
+    case RT_MDL_TEX_LOOKUP_DERIV_COLOR_2D:
+        with_derivs = true;
+        // fall through
+    case RT_MDL_TEX_LOOKUP_FLOAT3_2D:
+    case RT_MDL_TEX_LOOKUP_COLOR_2D:
+        n_comps = 3;
+        break;
+    case RT_MDL_TEX_LOOKUP_DERIV_FLOAT4_2D:
+        with_derivs = true;
+        // fall through
+    case RT_MDL_TEX_LOOKUP_FLOAT4_2D:
+        n_comps = 4;
+        break;
+    default:
+        MDL_ASSERT(!"unexpected 2D texture lookup runtime function");
+        return glue;
+    }
+
+    llvm::Function *lookup_func = get_native_tex_lookup_2d(with_derivs);
+
+    llvm::Function *func = llvm::Function::Create(
+        glue->getFunctionType(),
+        llvm::GlobalValue::InternalLinkage,
+        glue->getName() + "_native",
+        m_code_gen.m_module);
+    m_code_gen.set_llvm_function_attributes(func, /*mark_noinline=*/false);
+    if (m_always_inline_rt) {
+        func->addFnAttr(llvm::Attribute::AlwaysInline);
+    }
+
+    Function_instance inst(
+        m_alloc,
+        /*func_def=*/ nullptr,
+        /*return_derivs=*/ false,
+        m_code_gen.target_supports_storage_spaces());
+    Function_context ctx(m_alloc, m_code_gen, inst, func, LLVM_context_data::FL_NONE);
+
+    // all but the float variants return their result through the first parameter
+    bool has_result_param = n_comps != 1;
+
+    llvm::SmallVector<llvm::Value *, 9> args;
+    for (llvm::Argument &arg : func->args()) {
+        args.push_back(&arg);
+    }
+    size_t      first    = has_result_param ? 1 : 0;
+    llvm::Value *res_data = args[first];
+    llvm::Value *tex_id   = args[first + 1];
+
+    llvm::BasicBlock *bb_check  = ctx.create_bb("bb_check");
+    llvm::BasicBlock *bb_native = ctx.create_bb("bb_native");
+    llvm::BasicBlock *bb_glue   = ctx.create_bb("bb_glue");
+
+    llvm::Value *shared = ctx->CreateBitCast(
+        ctx->CreateLoad(ctx.create_simple_gep_in_bounds(
+            res_data, ctx.get_constant(Type_mapper::RDP_SHARED_DATA))),
+        m_code_gen.m_type_mapper.get_res_data_ptr_type());
+    llvm::Value *textures = ctx->CreateLoad(
+        ctx.create_simple_gep_in_bounds(shared, Type_mapper::RD_NATIVE_TEXTURES));
+
+    llvm::Value *cond = ctx->CreateAnd(
+        ctx->CreateICmpNE(tex_id, ctx.get_constant(int(0))),
+        ctx->CreateIsNotNull(textures));
+    ctx->CreateCondBr(cond, bb_check, bb_glue);
+
+    // uv-tile and animated textures have no flat representation
+    ctx->SetInsertPoint(bb_check);
+    llvm::Value *idx = ctx->CreateZExt(
+        ctx->CreateSub(tex_id, ctx.get_constant(int(1))), ctx->getInt64Ty());
+    llvm::Value *tex = ctx->CreateLoad(ctx->CreateInBoundsGEP(textures, idx));
+    ctx->CreateCondBr(ctx->CreateIsNotNull(tex), bb_native, bb_glue);
+
+    ctx->SetInsertPoint(bb_native);
+    {
+        llvm::Value *lookup_args[] = {
+            tex,
+            args[first + 2],  // coord
+            args[first + 3],  // wrap_u
+            args[first + 4],  // wrap_v
+            args[first + 5],  // crop_u
+            args[first + 6]   // crop_v
+        };
+        llvm::Value *res = ctx->CreateCall(lookup_func, lookup_args);
+        if (has_result_param) {
+            for (unsigned i = 0; i < n_comps; ++i) {
+                ctx->CreateStore(
+                    ctx->CreateExtractElement(res, i),
+                    ctx.create_simple_gep_in_bounds(args[0], i));
+            }
+            ctx.create_void_return();
+        } else {
+            ctx.create_return(ctx->CreateExtractElement(res, uint64_t(0)));
+        }
+    }
+
+    ctx->SetInsertPoint(bb_glue);
+    {
+        llvm::Value *res = ctx->CreateCall(glue, args);
+        if (has_result_param) {
+            ctx.create_void_return();
+        } else {
+            ctx.create_return(res);
+        }
+    }
+    return func;
+}
+
 // Check if a given MDL runtime
 llvm::Function *MDL_runtime_creator::find_in_c_runtime(
     Runtime_function code,
@@ -2596,7 +3154,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(5, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_float_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_DERIV_FLOAT_2D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2607,7 +3165,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(5, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_deriv_float_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_FLOAT_3D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2648,7 +3206,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_float2_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_DERIV_FLOAT2_2D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2659,7 +3217,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_deriv_float2_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_FLOAT2_3D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2700,7 +3258,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_float3_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_DERIV_FLOAT3_2D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2711,7 +3269,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_deriv_float3_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_FLOAT3_3D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2752,7 +3310,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_float4_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_DERIV_FLOAT4_2D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2763,7 +3321,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_deriv_float4_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_FLOAT4_3D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2804,7 +3362,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_color_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_DERIV_COLOR_2D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -2815,7 +3373,7 @@ llvm::Function *MDL_runtime_creator::create_runtime_func(
         func->addParamAttr(6, llvm::Attribute::NoCapture); // crop_u
         func->addParamAttr(7, llvm::Attribute::NoCapture); // crop_v
         MARK_NATIVE(func);  // tex_lookup_deriv_color_2d
-        return func;
+        return wrap_native_tex_lookup_2d(code, func);
     case RT_MDL_TEX_LOOKUP_COLOR_3D:
         func->setDoesNotThrow();
         func->setWillReturn();
@@ -0,0 +1,505 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+#include "pch.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringSet.h>
+#include <llvm/Bitcode/BitcodeReader.h>
+#include <llvm/Bitcode/BitcodeWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/Function.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+
+#include "generator_jit_llvm.h"
+
+namespace mi {
+namespace mdl {
+
+namespace {
+
+/// Marker for functions not (yet) reached by any exported function.
+static size_t const NO_OWNER = ~size_t(0);
+
+/// Marker for functions reached by several exported functions or by global variables.
+static size_t const SHARED = ~size_t(0) - 1;
+
+/// Characters allowed in PTX identifiers.
+static char const PTX_IDENT_CHARS[] =
+    "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$%";
+
+/// Collects all functions referenced by the given constant.
+///
+/// Global variables are not followed, their initializers are handled separately.
+void collect_referenced_functions(
+    llvm::Constant const                          *c,
+    llvm::SmallPtrSetImpl<llvm::Constant const *> &visited,
+    std::vector<llvm::Function const *>           &funcs)
+{
+    if (!visited.insert(c).second) {
+        return;
+    }
+    if (llvm::Function const *f = llvm::dyn_cast<llvm::Function>(c)) {
+        funcs.push_back(f);
+        return;
+    }
+    if (llvm::isa<llvm::GlobalValue>(c)) {
+        return;
+    }
+    for (llvm::Value const *op : c->operands()) {
+        if (llvm::Constant const *op_c = llvm::dyn_cast<llvm::Constant>(op)) {
+            collect_referenced_functions(op_c, visited, funcs);
+        }
+    }
+}
+
+/// Gives a local symbol a name that is valid in PTX and unique in the module.
+///
+/// Characters not allowed in PTX identifiers are replaced in the same way as the NVPTX backend
+/// does for local symbols. The name is chosen before splitting, so all parts agree on it.
+void assign_valid_ptx_name(llvm::Module &module, llvm::GlobalValue &gv, unsigned &unnamed_id)
+{
+    std::string valid_name;
+    if (!gv.hasName()) {
+        // unnamed symbols would get per-module numbers in the PTX output
+        valid_name = "__mdl_unnamed";
+    } else {
+        llvm::StringRef name = gv.getName();
+        if (name.find_first_of(".@") == llvm::StringRef::npos) {
+            return;
+        }
+        for (char c : name) {
+            if (c == '.' || c == '@') {
+                valid_name += "_$_";
+            } else {
+                valid_name += c;
+            }
+        }
+    }
+
+    // avoid the ".N" suffix LLVM would append on a name clash
+    std::string unique_name = valid_name;
+    while (module.getNamedValue(unique_name) != NULL) {
+        unique_name = valid_name + "_" + std::to_string(unnamed_id++);
+    }
+    gv.setName(unique_name);
+}
+
+/// Compiles one part of a split module into PTX code.
+class Ptx_part_job : public ICode_generator_job
+{
+public:
+    /// Constructor.
+    ///
+    /// \param bitcode          the bitcode of the whole module
+    /// \param func_part        the part of every defined function
+    /// \param target_machines  one target machine per part
+    /// \param part_code        receives the PTX code of every part
+    /// \param part_failed      set to 1 for every part that could not be compiled
+    Ptx_part_job(
+        llvm::SmallString<0> const                          &bitcode,
+        llvm::StringMap<unsigned> const                     &func_part,
+        std::vector<std::unique_ptr<llvm::TargetMachine> >  &target_machines,
+        std::vector<std::string>                            &part_code,
+        std::vector<char>                                   &part_failed)
+    : m_bitcode(bitcode)
+    , m_func_part(func_part)
+    , m_target_machines(target_machines)
+    , m_part_code(part_code)
+    , m_part_failed(part_failed)
+    {
+    }
+
+    /// Compile the part \p index.
+    void execute_fragment(size_t index) MDL_FINAL
+    {
+        unsigned p = unsigned(index);
+
+        // The LLVM context is not thread-safe, so every part is compiled from a bitcode copy
+        // of the module in its own context.
+        llvm::LLVMContext context;
+        llvm::Expected<std::unique_ptr<llvm::Module> > mod_or_err =
+            llvm::parseBitcodeFile(
+                llvm::MemoryBufferRef(
+                    llvm::StringRef(m_bitcode.data(), m_bitcode.size()), "<ptx-part>"),
+                context);
+        if (!mod_or_err) {
+            llvm::consumeError(mod_or_err.takeError());
+            m_part_failed[p] = 1;
+            return;
+        }
+        std::unique_ptr<llvm::Module> mod(std::move(*mod_or_err));
+
+        // turn everything not belonging to this part into declarations
+        for (llvm::Function &func : mod->functions()) {
+            if (func.isDeclaration()) {
+                continue;
+            }
+            auto it = m_func_part.find(func.getName());
+            if (it == m_func_part.end() || it->second != p) {
+                func.deleteBody();
+                func.setComdat(NULL);
+            }
+        }
+        if (p != 0) {
+            for (llvm::GlobalVariable &gv : mod->globals()) {
+                if (!gv.hasInitializer() || gv.getName().startswith("llvm.")) {
+                    continue;
+                }
+                gv.setInitializer(NULL);
+                gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+                gv.setComdat(NULL);
+            }
+        }
+
+        llvm::raw_string_ostream s_out(m_part_code[p]);
+        {
+            llvm::buffer_ostream out(s_out);
+            llvm::legacy::PassManager pm;
+
+            if (m_target_machines[p]->addPassesToEmitFile(
+                    pm, out, nullptr, llvm::CodeGenFileType::CGFT_AssemblyFile)) {
+                m_part_failed[p] = 1;
+                return;
+            }
+            pm.run(*mod);
+        }
+        s_out.flush();
+    }
+
+private:
+    llvm::SmallString<0> const                         &m_bitcode;
+    llvm::StringMap<unsigned> const                    &m_func_part;
+    std::vector<std::unique_ptr<llvm::TargetMachine> > &m_target_machines;
+    std::vector<std::string>                           &m_part_code;
+    std::vector<char>                                  &m_part_failed;
+};
+
+/// Returns the name of the symbol declared by the given ".extern" PTX statement, or an empty
+/// string if the statement cannot be parsed.
+llvm::StringRef get_extern_symbol_name(llvm::StringRef stmt)
+{
+    llvm::StringRef rest = stmt.ltrim().drop_front(strlen(".extern")).ltrim();
+
+    if (rest.startswith(".func") || rest.startswith(".entry")) {
+        rest = rest.drop_front(rest.startswith(".func") ? 5 : 6).ltrim();
+        if (rest.startswith("(")) {
+            // skip the return value parameter
+            size_t close = rest.find(')');
+            if (close == llvm::StringRef::npos) {
+                return llvm::StringRef();
+            }
+            rest = rest.drop_front(close + 1).ltrim();
+        }
+        return rest.take_front(rest.find_first_not_of(PTX_IDENT_CHARS));
+    }
+
+    // variable declaration: the name precedes the array dimension or the terminating ';'
+    llvm::StringRef head = rest.take_front(rest.find_first_of("[;=")).rtrim();
+    size_t begin = head.find_last_not_of(PTX_IDENT_CHARS);
+    return begin == llvm::StringRef::npos ? head : head.drop_front(begin + 1);
+}
+
+}  // anonymous
+
+// Compile the given module into PTX code using several threads.
+bool LLVM_code_generator::ptx_compile_parallel(
+    llvm::Module *module,
+    string       &code)
+{
+    // the parts are compiled by the job executor of the caller
+    if (!m_job_executor.is_valid_interface()) {
+        return false;
+    }
+
+    // aliases are not supported by the NVPTX backend anyway, debug info cannot be split
+    if (!module->alias_empty() || module->getNamedMetadata("llvm.dbg.cu") != NULL) {
+        return false;
+    }
+
+    // collect the defined functions and their references in module order
+    std::vector<llvm::Function *> funcs;
+    llvm::DenseMap<llvm::Function const *, size_t> func_index;
+    for (llvm::Function &func : module->functions()) {
+        if (!func.isDeclaration()) {
+            func_index[&func] = funcs.size();
+            funcs.push_back(&func);
+        }
+    }
+
+    size_t n_funcs = funcs.size();
+    std::vector<std::vector<size_t> > callees(n_funcs);
+    std::vector<llvm::Function const *> refs;
+    for (size_t i = 0; i < n_funcs; ++i) {
+        refs.clear();
+        llvm::SmallPtrSet<llvm::Constant const *, 16> visited;
+        for (llvm::BasicBlock const &bb : *funcs[i]) {
+            for (llvm::Instruction const &inst : bb) {
+                for (llvm::Value const *op : inst.operands()) {
+                    if (llvm::Constant const *c = llvm::dyn_cast<llvm::Constant>(op)) {
+                        collect_referenced_functions(c, visited, refs);
+                    }
+                }
+            }
+        }
+        for (llvm::Function const *f : refs) {
+            auto it = func_index.find(f);
+            if (it != func_index.end() && it->second != i) {
+                callees[i].push_back(it->second);
+            }
+        }
+    }
+
+    // Functions referenced by global variables must be part of the common part, because all
+    // global variables are. Mark them and everything they reach as shared.
+    std::vector<size_t> owner(n_funcs, NO_OWNER);
+    std::vector<size_t> stack;
+    for (llvm::GlobalVariable const &gv : module->globals()) {
+        if (!gv.hasInitializer()) {
+            continue;
+        }
+        refs.clear();
+        llvm::SmallPtrSet<llvm::Constant const *, 16> visited;
+        collect_referenced_functions(gv.getInitializer(), visited, refs);
+        for (llvm::Function const *f : refs) {
+            auto it = func_index.find(f);
+            if (it != func_index.end()) {
+                stack.push_back(it->second);
+            }
+        }
+    }
+    while (!stack.empty()) {
+        size_t f = stack.back();
+        stack.pop_back();
+        if (owner[f] == SHARED) {
+            continue;
+        }
+        owner[f] = SHARED;
+        stack.insert(stack.end(), callees[f].begin(), callees[f].end());
+    }
+
+    // Every non-local function is a root. Functions reached by exactly one root belong to its
+    // cluster, functions reached by several roots (like the libbsdf and state helpers) are shared.
+    std::vector<size_t> roots;
+    for (size_t i = 0; i < n_funcs; ++i) {
+        if (!funcs[i]->hasLocalLinkage()) {
+            roots.push_back(i);
+        }
+    }
+
+    std::vector<size_t> visited_by(n_funcs, NO_OWNER);
+    for (size_t r = 0, n_roots = roots.size(); r < n_roots; ++r) {
+        stack.push_back(roots[r]);
+        while (!stack.empty()) {
+            size_t f = stack.back();
+            stack.pop_back();
+            if (visited_by[f] == r) {
+                continue;
+            }
+            visited_by[f] = r;
+
+            if (owner[f] == SHARED) {
+                // everything reachable from a shared function is already shared
+                continue;
+            }
+            owner[f] = owner[f] == NO_OWNER || owner[f] == r ? r : SHARED;
+            stack.insert(stack.end(), callees[f].begin(), callees[f].end());
+        }
+    }
+
+    // collect the clusters with their sizes in module order
+    std::vector<size_t> cluster_roots;
+    std::vector<size_t> cluster_weight(roots.size(), 0);
+    for (size_t r = 0, n_roots = roots.size(); r < n_roots; ++r) {
+        if (owner[roots[r]] == r) {
+            cluster_roots.push_back(r);
+        }
+    }
+    if (cluster_roots.size() < 2) {
+        return false;
+    }
+
+    size_t total_weight = 0;
+    for (size_t i = 0; i < n_funcs; ++i) {
+        if (owner[i] != SHARED && owner[i] != NO_OWNER) {
+            size_t weight = funcs[i]->getInstructionCount() + 1;
+            cluster_weight[owner[i]] += weight;
+            total_weight += weight;
+        }
+    }
+
+    // Distribute the clusters over contiguous, roughly equally sized parts. Part 0 is the common
+    // part, so the output order only depends on the module and the number of threads.
+    size_t n_cluster_parts = std::min(size_t(m_codegen_threads), cluster_roots.size());
+    std::vector<unsigned> root_part(roots.size(), 0);
+    unsigned part = 1;
+    size_t accumulated = 0;
+    for (size_t r : cluster_roots) {
+        root_part[r] = part;
+        accumulated += cluster_weight[r];
+        if (part < n_cluster_parts && accumulated * n_cluster_parts >= total_weight * part) {
+            ++part;
+        }
+    }
+    unsigned n_parts = root_part[cluster_roots.back()] + 1;
+
+    // NVPTX skips private globals unused in a part and prefixes private symbols, which breaks
+    // references from other parts: make the used ones internal. NVPTX also renames local symbols
+    // with invalid characters, do it before splitting, so all parts agree on the names.
+    unsigned unnamed_id = 0;
+    for (llvm::GlobalVariable &gv : module->globals()) {
+        if (gv.hasPrivateLinkage() && !gv.use_empty()) {
+            gv.setLinkage(llvm::GlobalValue::InternalLinkage);
+        }
+        if (gv.hasLocalLinkage() || !gv.hasName()) {
+            assign_valid_ptx_name(*module, gv, unnamed_id);
+        }
+    }
+    for (llvm::Function *func : funcs) {
+        if (func->hasPrivateLinkage()) {
+            func->setLinkage(llvm::GlobalValue::InternalLinkage);
+        }
+        if (func->hasLocalLinkage() || !func->hasName()) {
+            assign_valid_ptx_name(*module, *func, unnamed_id);
+        }
+    }
+
+    llvm::StringMap<unsigned> func_part;
+    llvm::StringSet<> common_symbols;
+    for (size_t i = 0; i < n_funcs; ++i) {
+        unsigned p = owner[i] == SHARED || owner[i] == NO_OWNER ? 0 : root_part[owner[i]];
+        func_part[funcs[i]->getName()] = p;
+        if (p == 0) {
+            common_symbols.insert(funcs[i]->getName());
+        }
+    }
+    for (llvm::GlobalVariable const &gv : module->globals()) {
+        if (gv.hasInitializer()) {
+            common_symbols.insert(gv.getName());
+        }
+    }
+
+    llvm::SmallString<0> bitcode;
+    {
+        llvm::raw_svector_ostream os(bitcode);
+        llvm::WriteBitcodeToFile(*module, os);
+    }
+
+    std::vector<std::unique_ptr<llvm::TargetMachine> > target_machines;
+    for (unsigned p = 0; p < n_parts; ++p) {
+        target_machines.push_back(create_ptx_target_machine());
+    }
+
+    std::vector<std::string> part_code(n_parts);
+    std::vector<char>        part_failed(n_parts, 0);
+    {
+        Ptx_part_job job(bitcode, func_part, target_machines, part_code, part_failed);
+        m_job_executor->execute(&job, n_parts);
+    }
+
+    for (unsigned p = 0; p < n_parts; ++p) {
+        if (part_failed[p]) {
+            return false;
+        }
+    }
+
+    // Concatenate the parts: keep only the header of the common part, drop the declarations of
+    // symbols defined in the common part, and declare external symbols only once.
+    string result(get_allocator());
+    llvm::StringSet<> declared;
+    for (unsigned p = 0; p < n_parts; ++p) {
+        llvm::StringRef text(part_code[p]);
+
+        // the header ends with the ".address_size" directive
+        size_t pos = text.find("\n.address_size");
+        if (pos != llvm::StringRef::npos) {
+            pos = text.find('\n', pos + 1);
+        }
+        if (pos == llvm::StringRef::npos) {
+            MDL_ASSERT(!"unexpected PTX header");
+            return false;
+        }
+
+        // keep only the header of the common part and mark the start of every part
+        if (p == 0) {
+            result.append(text.data(), pos + 1);
+        }
+        text = text.drop_front(pos + 1);
+
+        char marker[64];
+        snprintf(marker, sizeof(marker),
+            "//\n// Parallel code generation part %u of %u\n//\n", p + 1, n_parts);
+        result.append(marker);
+
+        while (!text.empty()) {
+            size_t len = text.find('\n');
+            len = len == llvm::StringRef::npos ? text.size() : len + 1;
+
+            if (text.take_front(len).ltrim().startswith(".extern")) {
+                // declarations span several lines up to the terminating ';'
+                size_t end = text.find(';');
+                if (end != llvm::StringRef::npos) {
+                    end = text.find('\n', end);
+                    len = end == llvm::StringRef::npos ? text.size() : end + 1;
+                }
+
+                llvm::StringRef stmt = text.take_front(len);
+                llvm::StringRef name = get_extern_symbol_name(stmt);
+                bool drop = !name.empty() &&
+                    (declared.count(name) != 0 || (p > 0 && common_symbols.count(name) != 0));
+                if (!drop) {
+                    result.append(stmt.data(), stmt.size());
+                    if (!name.empty()) {
+                        declared.insert(name);
+                    }
+                }
+            } else {
+                result.append(text.data(), len);
+            }
+            text = text.drop_front(len);
+        }
+    }
+
+    code.append(result.c_str(), result.size());
+    return true;
+}
+
+}  // mdl
+}  // mi
@@ -53,6 +53,8 @@ void LLVM_code_generator::sl_compile(
     Options_impl const    &options,
     Generated_code_source &code)
 {
+    Compile_phase_timer timer(*this, IGenerated_code_executable::CP_CODEGEN);
+
     std::unique_ptr<llvm::Module> loaded_module;
 
     char const *load_env  = nullptr;
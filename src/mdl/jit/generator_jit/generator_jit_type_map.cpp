@@ -164,6 +164,12 @@ Type_mapper::Type_mapper(
 , m_type_res_data_pair(NULL)
 , m_type_res_data_pair_ptr(NULL)
 
+// res_data and native texture types constructed later
+, m_type_res_data(NULL)
+, m_type_res_data_ptr(NULL)
+, m_type_native_texture_level(NULL)
+, m_type_native_texture_2d(NULL)
+
 // core texture handler type constructed later
 , m_type_core_tex_handler(NULL)
 , m_type_core_tex_handler_ptr(NULL)
@@ -317,6 +323,14 @@ Type_mapper::Type_mapper(
     m_type_res_data_pair         = construct_res_data_pair_type(context);
     m_type_res_data_pair_ptr     = get_ptr(m_type_res_data_pair);
 
+    if (target_supports_pointers()) {
+        m_type_native_texture_level = construct_native_texture_level_type(context);
+        m_type_native_texture_2d    = construct_native_texture_2d_type(
+            context, m_type_native_texture_level);
+        m_type_res_data             = construct_res_data_type(context, m_type_native_texture_2d);
+        m_type_res_data_ptr         = get_ptr(m_type_res_data);
+    }
+
     m_type_exec_ctx              = construct_exec_ctx_type(
         context,
         m_type_state_core_ptr,
@@ -1453,6 +1467,116 @@ llvm::StructType *Type_mapper::construct_res_data_pair_type(
     return res;
 }
 
+// Construct the Res_data type.
+llvm::StructType *Type_mapper::construct_res_data_type(
+    llvm::LLVMContext      &context,
+    llvm::StructType       *native_texture_2d_type)
+{
+    llvm::Type *members[] = {
+        m_type_size_t,                           // obj_size
+        m_type_void_ptr,                         // res_arr
+        m_type_void_ptr,                         // resource_handler
+        get_ptr(get_ptr(native_texture_2d_type)) // native_textures
+    };
+
+    llvm::StructType *res =
+        llvm::StructType::create(context, members, "Res_data", /*is_packed=*/false);
+
+#if defined(DEBUG) || defined(ENABLE_ASSERT)
+    {
+        // check struct layout offsets and size
+        // must match between LLVM layout and C++ layout from the native
+        // compiler
+
+        typedef mi::mdl::Generated_code_lambda_function::Res_data Data;
+        llvm::StructLayout const *sl = m_data_layout.getStructLayout(res);
+        MDL_ASSERT(sl->getSizeInBytes() ==
+            sizeof(Data));
+        MDL_ASSERT(sl->getElementOffset(RD_OBJ_SIZE) ==
+            offsetof(Data, m_obj_size));
+        MDL_ASSERT(sl->getElementOffset(RD_RES_ARR) ==
+            offsetof(Data, m_res_arr));
+        MDL_ASSERT(sl->getElementOffset(RD_RESOURCE_HANDLER) ==
+            offsetof(Data, m_resource_handler));
+        MDL_ASSERT(sl->getElementOffset(RD_NATIVE_TEXTURES) ==
+            offsetof(Data, m_native_textures));
+    }
+#endif
+
+    return res;
+}
+
+// Construct the Native_texture_level type.
+llvm::StructType *Type_mapper::construct_native_texture_level_type(
+    llvm::LLVMContext      &context)
+{
+    llvm::Type *members[] = {
+        get_ptr(m_type_float),  // texels
+        m_type_int,             // width
+        m_type_int              // height
+    };
+
+    llvm::StructType *res = llvm::StructType::create(
+        context, members, "Native_texture_level", /*is_packed=*/false);
+
+#if defined(DEBUG) || defined(ENABLE_ASSERT)
+    {
+        // check struct layout offsets and size
+        // must match between LLVM layout and C++ layout from the native
+        // compiler
+
+        typedef mi::mdl::IResource_handler::Native_texture_level Level;
+        llvm::StructLayout const *sl = m_data_layout.getStructLayout(res);
+        MDL_ASSERT(sl->getSizeInBytes() ==
+            sizeof(Level));
+        MDL_ASSERT(sl->getElementOffset(NTL_TEXELS) ==
+            offsetof(Level, texels));
+        MDL_ASSERT(sl->getElementOffset(NTL_WIDTH) ==
+            offsetof(Level, width));
+        MDL_ASSERT(sl->getElementOffset(NTL_HEIGHT) ==
+            offsetof(Level, height));
+    }
+#endif
+
+    return res;
+}
+
+// Construct the Native_texture_2d type.
+llvm::StructType *Type_mapper::construct_native_texture_2d_type(
+    llvm::LLVMContext      &context,
+    llvm::StructType       *level_type)
+{
+    llvm::Type *members[] = {
+        get_ptr(level_type),  // levels
+        m_type_int,           // num_levels
+        m_type_float          // gamma
+    };
+
+    llvm::StructType *res = llvm::StructType::create(
+        context, members, "Native_texture_2d", /*is_packed=*/false);
+
+#if defined(DEBUG) || defined(ENABLE_ASSERT)
+    {
+        // check struct layout offsets and size
+        // must match between LLVM layout and C++ layout from the native
+        // compiler
+
+        typedef mi::mdl::IResource_handler::Native_texture_2d Texture;
+        llvm::StructLayout const *sl = m_data_layout.getStructLayout(res);
+        MDL_ASSERT(sl->getSizeInBytes() ==
+            sizeof(Texture));
+        MDL_ASSERT(sl->getElementOffset(NT_LEVELS) ==
+            offsetof(Texture, levels));
+        MDL_ASSERT(sl->getElementOffset(NT_NUM_LEVELS) ==
+            offsetof(Texture, num_levels));
+        MDL_ASSERT(sl->getElementOffset(NT_GAMMA) ==
+            offsetof(Texture, gamma));
+    }
+#endif
+
+    return res;
+}
+
 llvm::StructType *Type_mapper::construct_exec_ctx_type(
     llvm::LLVMContext      &context,
     llvm::Type             *state_core_ptr_type,
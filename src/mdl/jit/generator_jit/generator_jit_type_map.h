@@ -167,6 +167,28 @@ public:
         RDP_THREAD_DATA = 1,  ///< The thread resource data.
     };
 
+    // Res_data access index.
+    enum Res_data_indexes {
+        RD_OBJ_SIZE         = 0,  ///< The size of one resource data entry.
+        RD_RES_ARR          = 1,  ///< The resource data entries.
+        RD_RESOURCE_HANDLER = 2,  ///< The resource handler.
+        RD_NATIVE_TEXTURES  = 3,  ///< The flat 2D textures, indexed by texture index - 1.
+    };
+
+    // Native_texture_2d access index.
+    enum Native_texture_2d_indexes {
+        NT_LEVELS     = 0,  ///< The mip levels.
+        NT_NUM_LEVELS = 1,  ///< The number of mip levels.
+        NT_GAMMA      = 2,  ///< The gamma applied after filtering level 0.
+    };
+
+    // Native_texture_level access index.
+    enum Native_texture_level_indexes {
+        NTL_TEXELS = 0,  ///< The RGBA texels.
+        NTL_WIDTH  = 1,  ///< The width of the level.
+        NTL_HEIGHT = 2,  ///< The height of the level.
+    };
+
     /// Texture handler vtable access index.
     enum Tex_handler_vtable_index {
         THV_tex_lookup_float4_2d,           ///< tex_lookup_float4_2d()
@@ -568,6 +590,17 @@ public:
     /// Get the LLVM Res_data_pair * type.
     llvm::PointerType *get_res_data_pair_ptr_type() const { return m_type_res_data_pair_ptr; }
 
+    /// Get the LLVM Res_data * type.
+    llvm::PointerType *get_res_data_ptr_type() const { return m_type_res_data_ptr; }
+
+    /// Get the LLVM Native_texture_2d type.
+    llvm::StructType *get_native_texture_2d_type() const { return m_type_native_texture_2d; }
+
+    /// Get the LLVM Native_texture_level type.
+    llvm::StructType *get_native_texture_level_type() const {
+        return m_type_native_texture_level;
+    }
+
     /// Get the LLVM core texture handler type.
     llvm::StructType *get_core_tex_handler_type() const { return m_type_core_tex_handler; }
 
@@ -678,6 +711,28 @@ private:
     llvm::StructType *construct_res_data_pair_type(
         llvm::LLVMContext      &context);
 
+    /// Construct the Res_data type.
+    ///
+    /// \param context                  the LLVM context this type is build belongs to
+    /// \param native_texture_2d_type   the Native_texture_2d type
+    llvm::StructType *construct_res_data_type(
+        llvm::LLVMContext      &context,
+        llvm::StructType       *native_texture_2d_type);
+
+    /// Construct the Native_texture_level type.
+    ///
+    /// \param context        the LLVM context this type is build belongs to
+    llvm::StructType *construct_native_texture_level_type(
+        llvm::LLVMContext      &context);
+
+    /// Construct the Native_texture_2d type.
+    ///
+    /// \param context        the LLVM context this type is build belongs to
+    /// \param level_type     the Native_texture_level type
+    llvm::StructType *construct_native_texture_2d_type(
+        llvm::LLVMContext      &context,
+        llvm::StructType       *level_type);
+
     /// Construct the exec_ctx type.
     static llvm::StructType *construct_exec_ctx_type(
         llvm::LLVMContext      &context,
@@ -800,6 +855,12 @@ private:
     llvm::StructType  *m_type_res_data_pair;
     llvm::PointerType *m_type_res_data_pair_ptr;
 
+    llvm::StructType  *m_type_res_data;
+    llvm::PointerType *m_type_res_data_ptr;
+
+    llvm::StructType  *m_type_native_texture_level;
+    llvm::StructType  *m_type_native_texture_2d;
+
     llvm::StructType  *m_type_exec_ctx;
     llvm::PointerType *m_type_exec_ctx_ptr;
 
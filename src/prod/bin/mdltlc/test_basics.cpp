@@ -34,12 +34,16 @@
 #include <base/system/test/i_test_auto_driver.h>
 #include <base/system/test/i_test_auto_case.h>
 #include <mi/mdl/mdl_mdl.h>
+#include <mi/mdl/mdl_modules.h>
+#include <mi/mdl/mdl_thread_context.h>
 
 #include <mdl/compiler/compilercore/compilercore_mdl.h>
 #include <mdl/compiler/compilercore/compilercore_assert.h>
 
 #include <sys/stat.h>
 
+#include <chrono>
+#include <cstdio>
 #include <fstream>
 
 #include <boost/filesystem.hpp>
@@ -220,6 +224,116 @@ static Expected_failure failure_files[] = {
                      failure_messages_10, sizeof(failure_messages_10) / sizeof(failure_messages_10[0]))
 };
 
+// Measure the compiler startup time. This must be the first test: only the first compiler
+// of the process parses the builtin modules, all later ones deserialize the standard library
+// image created by it.
+MI_TEST_AUTO_FUNCTION( test_compiler_startup )
+{
+    char const src[] =
+        "mdl 1.0;\n"
+        "import ::df::*;\n"
+        "import ::base::*;\n"
+        "import ::math::*;\n"
+        "export material m(color c = color(0.5)) = material(\n"
+        "    surface: material_surface(scattering: df::diffuse_reflection_bsdf(tint: c)));\n"
+        "export float f(float x) { return math::sin(x) + base::perlin_noise_texture().mono; }\n";
+
+    size_t const n_runs = 5;
+    double first_ms = 0.0, later_ms = 0.0;
+
+    for (size_t i = 0; i < n_runs; ++i) {
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        mi::base::Handle<mi::mdl::IMDL> imdl(mi::mdl::initialize());
+        std::chrono::steady_clock::time_point t1 = std::chrono::steady_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        if (i == 0) {
+            first_ms = ms;
+        } else {
+            later_ms += ms;
+        }
+
+        // the builtin modules must be usable, no matter where they came from
+        MI_CHECK(imdl->is_builtin_module("::df"));
+        MI_CHECK(imdl->is_builtin_module("::base"));
+
+        mi::base::Handle<mi::mdl::IThread_context> ctx(imdl->create_thread_context());
+        mi::base::Handle<mi::mdl::IModule const> mod(imdl->load_module_from_string(
+            ctx.get(), /*cache=*/NULL, "::startup_test", src, sizeof(src) - 1));
+        MI_CHECK(mod.is_valid_interface());
+        MI_CHECK(mod->is_valid());
+        MI_CHECK_EQUAL(mod->access_messages().get_error_message_count(), 0);
+    }
+
+    printf(
+        "compiler startup: first %.2f ms, later %.2f ms on average\n",
+        first_ms, later_ms / double(n_runs - 1));
+}
+
+/// A search path consisting of a single directory.
+class Single_search_path : public mi::base::Interface_implement<mi::mdl::IMDL_search_path>
+{
+public:
+    Single_search_path(std::string const &path) : m_path(path) {}
+
+    size_t get_search_path_count(Path_set set) const override {
+        return set == MDL_SEARCH_PATH ? 1 : 0;
+    }
+
+    char const *get_search_path(Path_set set, size_t i) const override {
+        return set == MDL_SEARCH_PATH && i == 0 ? m_path.c_str() : nullptr;
+    }
+
+private:
+    std::string m_path;
+};
+
+// Test the discovery of direct module imports.
+MI_TEST_AUTO_FUNCTION( test_module_imports )
+{
+    fs::path root = fs::path(DIR_PREFIX) / "module_imports";
+    fs::create_directories(root / "pkg");
+
+    std::ofstream((root / "pkg" / "a.mdl").string())
+        << "mdl 1.6;\n"
+        << "import ::df::*;\n"
+        << "import .::b::*;\n"
+        << "using ::c import g;\n"
+        << "import ::missing::*;\n"
+        << "export float f() { return g() + h(); }\n";
+    std::ofstream((root / "pkg" / "b.mdl").string())
+        << "mdl 1.6;\n"
+        << "export float h() { return 0.0; }\n";
+    std::ofstream((root / "c.mdl").string())
+        << "mdl 1.6;\n"
+        << "export float g() { return 1.0; }\n";
+
+    mi::base::Handle<mi::mdl::IMDL> imdl(mi::mdl::initialize());
+    imdl->install_search_path(new Single_search_path(fs::absolute(root).string()));
+
+    mi::base::Handle<mi::mdl::IThread_context> ctx(imdl->create_thread_context());
+
+    // the standard library and unresolvable modules are skipped
+    mi::base::Handle<mi::mdl::IModule_imports const> imports(
+        imdl->get_module_imports(ctx.get(), "::pkg::a", /*cache=*/NULL));
+    MI_CHECK(imports.is_valid_interface());
+    MI_CHECK_EQUAL(std::string(imports->get_module_name()), "::pkg::a");
+    MI_CHECK_EQUAL(imports->get_import_count(), 2u);
+    MI_CHECK_EQUAL(std::string(imports->get_import_name(0)), "::pkg::b");
+    MI_CHECK_EQUAL(std::string(imports->get_import_name(1)), "::c");
+    MI_CHECK(imports->get_import_name(2) == NULL);
+
+    imports = imdl->get_module_imports(ctx.get(), "::c", /*cache=*/NULL);
+    MI_CHECK(imports.is_valid_interface());
+    MI_CHECK_EQUAL(imports->get_import_count(), 0u);
+
+    imports = imdl->get_module_imports(ctx.get(), "::df", /*cache=*/NULL);
+    MI_CHECK(!imports.is_valid_interface());
+
+    imports = imdl->get_module_imports(ctx.get(), "::missing", /*cache=*/NULL);
+    MI_CHECK(!imports.is_valid_interface());
+}
+
 // Test the Compiler_options class.
 MI_TEST_AUTO_FUNCTION( test_compiler_options )
 {
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *****************************************************************************/
+
+/** \file
+ ** \brief
+ **/
+
+#include "pch.h"
+
+#define MI_TEST_AUTO_SUITE_NAME "Regression Test Suite for prod/lib/neuray"
+#define MI_TEST_IMPLEMENT_TEST_MAIN_INSTEAD_OF_MAIN
+
+#include <base/system/test/i_test_auto_driver.h>
+#include <base/system/test/i_test_auto_case.h>
+
+#include <mi/base/handle.h>
+#include <mi/base/interface_implement.h>
+
+#include <mi/neuraylib/imdl_configuration.h>
+#include <mi/neuraylib/imdl_discovery_api.h>
+#include <mi/neuraylib/ineuray.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+
+#include "test_shared.h"
+
+namespace fs = std::filesystem;
+
+/// A discovery result not created by the discovery API.
+class Foreign_discovery_result
+  : public mi::base::Interface_implement<mi::neuraylib::IMdl_discovery_result>
+{
+public:
+    const mi::neuraylib::IMdl_package_info* get_graph() const { return nullptr; }
+    mi::Size get_search_paths_count() const { return 0; }
+    const char* get_search_path( mi::Size index) const { return nullptr; }
+};
+
+/// Returns the simple names of the modules in the root package of \p result.
+std::set<std::string> get_modules( const mi::neuraylib::IMdl_discovery_result* result)
+{
+    std::set<std::string> modules;
+    MI_CHECK( result);
+    if( !result)
+        return modules;
+
+    mi::base::Handle<const mi::neuraylib::IMdl_package_info> root( result->get_graph());
+    for( mi::Size i = 0, n = root->get_child_count(); i < n; ++i) {
+        mi::base::Handle<const mi::neuraylib::IMdl_info> child( root->get_child( i));
+        if( child->get_kind() == mi::neuraylib::IMdl_info::DK_MODULE)
+            modules.insert( child->get_simple_name());
+    }
+    return modules;
+}
+
+/// Creates an MDL module in \p dir.
+void create_module( const fs::path& dir, const char* name)
+{
+    std::ofstream( dir / (std::string( name) + ".mdl")) << "mdl 1.0;" << std::endl;
+}
+
+void run_tests( mi::neuraylib::INeuray* neuray, const fs::path& dir)
+{
+    mi::base::Handle<mi::neuraylib::IMdl_discovery_api> discovery_api(
+        neuray->get_api_component<mi::neuraylib::IMdl_discovery_api>());
+
+    using Modules = std::set<std::string>;
+
+    // Modification times well before and after the discovery runs. A modification time after
+    // the start of a run is indistinguishable from a modification in the same second as the start.
+    const fs::file_time_type now    = fs::file_time_type::clock::now();
+    const fs::file_time_type past   = now - std::chrono::seconds( 100);
+    const fs::file_time_type future = now + std::chrono::seconds( 100);
+
+    create_module( dir, "a");
+    create_module( dir, "b");
+    fs::last_write_time( dir, past);
+
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result1(
+        discovery_api->discover());
+    MI_CHECK( get_modules( result1.get()) == Modules( { "a", "b" }));
+
+    // Added and removed files, "b" is unchanged.
+    fs::remove( dir / "a.mdl");
+    create_module( dir, "c");
+    fs::last_write_time( dir, past + std::chrono::seconds( 1));
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result2(
+        discovery_api->discover_incremental( result1.get()));
+    MI_CHECK( get_modules( result2.get()) == Modules( { "b", "c" }));
+
+    // An unchanged modification time reuses the previous listing, even if the directory was
+    // modified.
+    create_module( dir, "d");
+    fs::last_write_time( dir, past + std::chrono::seconds( 1));
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result3(
+        discovery_api->discover_incremental( result2.get()));
+    MI_CHECK( get_modules( result3.get()) == Modules( { "b", "c" }));
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result_full(
+        discovery_api->discover());
+    MI_CHECK( get_modules( result_full.get()) == Modules( { "b", "c", "d" }));
+
+    // A modification in the same second as the start of the previous run is detected, even if
+    // the modification time did not change since that run.
+    fs::last_write_time( dir, future);
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result4(
+        discovery_api->discover_incremental( result3.get()));
+    MI_CHECK( get_modules( result4.get()) == Modules( { "b", "c", "d" }));
+    create_module( dir, "e");
+    fs::last_write_time( dir, future);
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result5(
+        discovery_api->discover_incremental( result4.get()));
+    MI_CHECK( get_modules( result5.get()) == Modules( { "b", "c", "d", "e" }));
+
+    // Results not created by the discovery API lead to a full discovery.
+    create_module( dir, "f");
+    fs::last_write_time( dir, past + std::chrono::seconds( 2));
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result6(
+        discovery_api->discover_incremental( result5.get()));
+    MI_CHECK( get_modules( result6.get()) == Modules( { "b", "c", "d", "e", "f" }));
+    create_module( dir, "g");
+    fs::last_write_time( dir, past + std::chrono::seconds( 2));
+    mi::base::Handle<Foreign_discovery_result> foreign( new Foreign_discovery_result());
+    mi::base::Handle<const mi::neuraylib::IMdl_discovery_result> result7(
+        discovery_api->discover_incremental( foreign.get()));
+    MI_CHECK( get_modules( result7.get()) == Modules( { "b", "c", "d", "e", "f", "g" }));
+}
+
+MI_TEST_AUTO_FUNCTION( test_imdl_discovery_api )
+{
+    fs::path dir = fs::absolute( fs::path( "data") / "test_imdl_discovery_api");
+    fs::remove_all( dir);
+    fs::create_directories( dir);
+
+    mi::base::Handle<mi::neuraylib::INeuray> neuray( load_and_get_ineuray());
+    MI_CHECK( neuray.is_valid_interface());
+
+    {
+        mi::base::Handle<mi::neuraylib::IMdl_configuration> mdl_configuration(
+            neuray->get_api_component<mi::neuraylib::IMdl_configuration>());
+        MI_CHECK_EQUAL( 0, mdl_configuration->add_mdl_path( dir.string().c_str()));
+
+        MI_CHECK_EQUAL( 0, neuray->start());
+
+        run_tests( neuray.get(), dir);
+
+        MI_CHECK_EQUAL( 0, neuray->shutdown());
+    }
+
+    neuray = 0;
+    MI_CHECK( unload());
+
+    fs::remove_all( dir);
+}
+
+MI_TEST_MAIN_CALLING_TEST_MAIN();
+
@@ -60,6 +60,7 @@ int main() { return 0; }
 
 #include <mi/base/config.h>
 #include <mi/base/handle.h>
+#include <mi/base/ilogger.h>
 #include <mi/base/interface_implement.h>
 
 #include <mi/neuraylib/annotation_wrapper.h>
@@ -81,6 +82,7 @@ int main() { return 0; }
 #include <mi/neuraylib/iimage.h>
 #include <mi/neuraylib/iimage_api.h>
 #include <mi/neuraylib/ilightprofile.h>
+#include <mi/neuraylib/ilogging_configuration.h>
 #include <mi/neuraylib/imap.h>
 #include <mi/neuraylib/imaterial_instance.h>
 #include <mi/neuraylib/imatrix.h>
@@ -114,8 +116,14 @@ int main() { return 0; }
 #include <mi/neuraylib/imdl_compiler.h>
 
 #include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 #include <filesystem>
 #include <fstream>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -9074,6 +9082,617 @@ void check_module_references( mi::neuraylib::IDatabase* database)
     MI_CHECK_EQUAL( 0, transaction->commit());
 }
 
+// Instance-compiles the material \p definition_name with its parameter "t" set to the texture
+// \p texture_name.
+const mi::neuraylib::ICompiled_material* compile_with_texture(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_factory* mdl_factory,
+    const char* definition_name,
+    const char* texture_name)
+{
+    mi::base::Handle<mi::neuraylib::IType_factory> tf(
+        mdl_factory->create_type_factory( transaction));
+    mi::base::Handle<mi::neuraylib::IValue_factory> vf(
+        mdl_factory->create_value_factory( transaction));
+    mi::base::Handle<mi::neuraylib::IExpression_factory> ef(
+        mdl_factory->create_expression_factory( transaction));
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    mi::base::Handle<const mi::neuraylib::IType_texture> tex_type(
+        tf->create_texture( mi::neuraylib::IType_texture::TS_2D));
+    mi::base::Handle<mi::neuraylib::IValue_texture> tex_value(
+        vf->create_texture( tex_type.get(), texture_name));
+    mi::base::Handle<mi::neuraylib::IExpression_constant> tex_expr(
+        ef->create_constant( tex_value.get()));
+    mi::base::Handle<mi::neuraylib::IExpression_list> args( ef->create_expression_list());
+    MI_CHECK_EQUAL( 0, args->add_expression( "t", tex_expr.get()));
+
+    mi::base::Handle<const mi::neuraylib::IFunction_definition> md(
+        transaction->access<mi::neuraylib::IFunction_definition>( definition_name));
+    MI_CHECK( md);
+    mi::Sint32 result = -1;
+    mi::base::Handle<mi::neuraylib::IFunction_call> mi(
+        md->create_function_call( args.get(), &result));
+    MI_CHECK_EQUAL( 0, result);
+    mi::base::Handle<mi::neuraylib::IMaterial_instance> mi_mi(
+        mi->get_interface<mi::neuraylib::IMaterial_instance>());
+    const mi::neuraylib::ICompiled_material* cm = mi_mi->create_compiled_material(
+        mi::neuraylib::IMaterial_instance::DEFAULT_OPTIONS, context.get());
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( cm);
+    return cm;
+}
+
+// Translates the tint of the "md_cache" material with texture \p texture_name with the native
+// backend.
+const mi::neuraylib::ITarget_code* translate_cache_material(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_factory* mdl_factory,
+    mi::neuraylib::IMdl_backend* be_native,
+    const char* texture_name)
+{
+    mi::base::Handle<const mi::neuraylib::ICompiled_material> cm( compile_with_texture(
+        transaction, mdl_factory, "mdl::resource_cache::md_cache(texture_2d)", texture_name));
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    const mi::neuraylib::ITarget_code* code = be_native->translate_material_expression(
+        transaction, cm.get(), "surface.scattering.tint", "tint", context.get());
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( code);
+    MI_CHECK_EQUAL( 2, code->get_texture_count()); // invalid texture and texture_name
+    return code;
+}
+
+void check_runtime_resource_cache(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_configuration* mdl_configuration,
+    mi::neuraylib::IMdl_impexp_api* mdl_impexp_api,
+    mi::neuraylib::IMdl_backend_api* mdl_backend_api,
+    mi::neuraylib::IMdl_factory* mdl_factory)
+{
+    const char* data =
+        "mdl 1.6;\n"
+        "import ::df::*;\n"
+        "import ::tex::*;\n"
+        "export material md_cache(uniform texture_2d t = texture_2d())\n"
+        "= material(surface: material_surface(scattering: df::diffuse_reflection_bsdf(\n"
+        "    tint: color(tex::lookup_float3(t, float2(0.0f))))));\n";
+    MI_CHECK_EQUAL( 0,
+        mdl_impexp_api->load_module_from_string( transaction, "::resource_cache", data));
+
+    // Two textures sharing the same image, but with different gamma values.
+    std::string path = MI::TEST::mi_src_path( "io/scene/mdl_elements/resources/test.png");
+    mi::base::Handle<mi::neuraylib::IImage> image(
+        transaction->create<mi::neuraylib::IImage>( "Image"));
+    MI_CHECK_EQUAL( 0, image->reset_file( path.c_str()));
+    MI_CHECK_EQUAL( 0, transaction->store( image.get(), "resource_cache_image"));
+    mi::base::Handle<mi::neuraylib::ITexture> texture(
+        transaction->create<mi::neuraylib::ITexture>( "Texture"));
+    MI_CHECK_EQUAL( 0, texture->set_image( "resource_cache_image"));
+    texture->set_gamma( 1.0f);
+    MI_CHECK_EQUAL( 0, transaction->store( texture.get(), "resource_cache_texture_linear"));
+    texture = transaction->create<mi::neuraylib::ITexture>( "Texture");
+    MI_CHECK_EQUAL( 0, texture->set_image( "resource_cache_image"));
+    texture->set_gamma( 2.2f);
+    MI_CHECK_EQUAL( 0, transaction->store( texture.get(), "resource_cache_texture_srgb"));
+
+    mi::base::Handle<mi::neuraylib::IMdl_backend> be_native(
+        mdl_backend_api->get_backend( mi::neuraylib::IMdl_backend_api::MB_NATIVE));
+    MI_CHECK( be_native);
+    MI_CHECK_EQUAL( 0, be_native->set_option( "texture_runtime_with_derivs", "off"));
+
+    // Other tests might still hold target codes, hence check only differences.
+    auto get_statistic = [mdl_configuration]( const char* name) {
+        return mdl_configuration->get_runtime_resource_cache_statistic( name);
+    };
+    const mi::Size hits0    = get_statistic( "hits");
+    const mi::Size misses0  = get_statistic( "misses");
+    const mi::Size entries0 = get_statistic( "entries");
+    const mi::Size size0    = get_statistic( "size");
+
+    // The first target code prepares the texture, the second one shares it.
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code1( translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_linear"));
+    MI_CHECK_EQUAL( misses0 + 1, get_statistic( "misses"));
+    MI_CHECK_EQUAL( hits0, get_statistic( "hits"));
+    MI_CHECK_EQUAL( entries0 + 1, get_statistic( "entries"));
+    const mi::Size size1 = get_statistic( "size");
+    MI_CHECK( size1 > size0);
+
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code2( translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_linear"));
+    MI_CHECK_EQUAL( misses0 + 1, get_statistic( "misses"));
+    MI_CHECK_EQUAL( hits0 + 1, get_statistic( "hits"));
+    MI_CHECK_EQUAL( entries0 + 1, get_statistic( "entries"));
+    MI_CHECK_EQUAL( size1, get_statistic( "size"));
+
+    // A different gamma value requires a separate entry.
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code3( translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_srgb"));
+    MI_CHECK_EQUAL( misses0 + 2, get_statistic( "misses"));
+    MI_CHECK_EQUAL( entries0 + 2, get_statistic( "entries"));
+
+    // A different derivative mode requires a separate entry.
+    MI_CHECK_EQUAL( 0, be_native->set_option( "texture_runtime_with_derivs", "on"));
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code4( translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_linear"));
+    MI_CHECK_EQUAL( 0, be_native->set_option( "texture_runtime_with_derivs", "off"));
+    MI_CHECK_EQUAL( misses0 + 3, get_statistic( "misses"));
+    MI_CHECK_EQUAL( entries0 + 3, get_statistic( "entries"));
+
+    // A new tag version requires a separate entry. The entry for the old version stays alive as
+    // long as code1 and code2 use it.
+    {
+        mi::base::Handle<mi::neuraylib::ITexture> edited(
+            transaction->edit<mi::neuraylib::ITexture>( "resource_cache_texture_linear"));
+        edited->set_gamma( 1.0f);
+    }
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code5( translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_linear"));
+    MI_CHECK_EQUAL( misses0 + 4, get_statistic( "misses"));
+    MI_CHECK_EQUAL( hits0 + 1, get_statistic( "hits"));
+    MI_CHECK_EQUAL( entries0 + 4, get_statistic( "entries"));
+
+    // An entry expires with the last target code using it.
+    code1 = nullptr;
+    MI_CHECK_EQUAL( entries0 + 4, get_statistic( "entries"));
+    code2 = nullptr;
+    MI_CHECK_EQUAL( entries0 + 3, get_statistic( "entries"));
+    code3 = nullptr;
+    code4 = nullptr;
+    code5 = nullptr;
+    MI_CHECK_EQUAL( entries0, get_statistic( "entries"));
+    MI_CHECK_EQUAL( size0, get_statistic( "size"));
+
+    // Expired entries are prepared again.
+    code1 = translate_cache_material(
+        transaction, mdl_factory, be_native.get(), "resource_cache_texture_srgb");
+    MI_CHECK_EQUAL( misses0 + 5, get_statistic( "misses"));
+    MI_CHECK_EQUAL( entries0 + 1, get_statistic( "entries"));
+    code1 = nullptr;
+    MI_CHECK_EQUAL( entries0, get_statistic( "entries"));
+}
+
+// Evaluates the tint translated to \p code on a grid of texture coordinates that covers several
+// periods of the texture, and appends the results to \p results.
+void evaluate_native_tint(
+    const mi::neuraylib::ITarget_code* code, bool use_derivatives, std::vector<float>& results)
+{
+    mi::Float32_4_struct identity[4] = {
+        { 1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    mi::neuraylib::tct_deriv_float3 texture_coords[1] = {
+        { { 0.0f, 0.0f, 0.0f }, { 0.03f, 0.0f, 0.0f }, { 0.0f, 0.03f, 0.0f } } };
+    mi::neuraylib::tct_float3 texture_tangent_u[1] = { { 1.0f, 0.0f, 0.0f } };
+    mi::neuraylib::tct_float3 texture_tangent_v[1] = { { 0.0f, 1.0f, 0.0f } };
+
+    mi::neuraylib::Shading_state_material_with_derivs state_derivs = {
+        /*normal=*/                { 0.0f, 0.0f, 1.0f },
+        /*geom_normal=*/           { 0.0f, 0.0f, 1.0f },
+        /*position=*/
+        { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } },
+        /*animation_time=*/        0.0f,
+        /*texture_coords=*/        texture_coords,
+        /*tangent_u=*/             texture_tangent_u,
+        /*tangent_v=*/             texture_tangent_v,
+        /*text_results=*/          nullptr,
+        /*ro_data_segment=*/       nullptr,
+        /*world_to_object=*/       &identity[0],
+        /*object_to_world=*/       &identity[0],
+        /*object_id=*/             0,
+        /*meters_per_scene_unit=*/ 1.0f
+    };
+
+    mi::Float32_3_struct texture_coords_no_derivs[1] = { { 0.0f, 0.0f, 0.0f } };
+    mi::neuraylib::Shading_state_material state = {
+        /*normal=*/                { 0.0f, 0.0f, 1.0f },
+        /*geom_normal=*/           { 0.0f, 0.0f, 1.0f },
+        /*position=*/              { 0.0f, 0.0f, 0.0f },
+        /*animation_time=*/        0.0f,
+        /*texture_coords=*/        texture_coords_no_derivs,
+        /*tangent_u=*/             texture_tangent_u,
+        /*tangent_v=*/             texture_tangent_v,
+        /*text_results=*/          nullptr,
+        /*ro_data_segment=*/       nullptr,
+        /*world_to_object=*/       &identity[0],
+        /*object_to_world=*/       &identity[0],
+        /*object_id=*/             0,
+        /*meters_per_scene_unit=*/ 1.0f
+    };
+
+    for( int y = -20; y <= 36; ++y)
+        for( int x = -20; x <= 36; ++x) {
+            // Avoid texel centers and borders to test the filter weights.
+            const float u = (x + 0.3f) / 16.0f;
+            const float v = (y + 0.7f) / 16.0f;
+            mi::Float32_3_struct result = { 0.0f, 0.0f, 0.0f };
+            if( use_derivatives) {
+                texture_coords[0].val.x = u;
+                texture_coords[0].val.y = v;
+                MI_CHECK_EQUAL( 0, code->execute(
+                    0, reinterpret_cast<mi::neuraylib::Shading_state_material&>( state_derivs),
+                    nullptr, nullptr, &result));
+            } else {
+                texture_coords_no_derivs[0].x = u;
+                texture_coords_no_derivs[0].y = v;
+                MI_CHECK_EQUAL( 0, code->execute( 0, state, nullptr, nullptr, &result));
+            }
+            results.push_back( result.x);
+            results.push_back( result.y);
+            results.push_back( result.z);
+        }
+}
+
+// Checks that lookups in the "native_inline" texture lookup call mode return the same values as
+// lookups via the texture runtime ("vtable" mode).
+void check_native_inline_texture_lookups(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_impexp_api* mdl_impexp_api,
+    mi::neuraylib::IMdl_backend_api* mdl_backend_api,
+    mi::neuraylib::IMdl_factory* mdl_factory)
+{
+    // One material per combination of wrap and crop modes.
+    const char* materials[][3] = {
+        { "md_repeat", "tex::wrap_repeat",          "float2(0.0, 1.0)"   },
+        { "md_clamp",  "tex::wrap_clamp",           "float2(0.0, 1.0)"   },
+        { "md_mirror", "tex::wrap_mirrored_repeat", "float2(0.0, 1.0)"   },
+        { "md_clip",   "tex::wrap_clip",            "float2(0.0, 1.0)"   },
+        { "md_crop",   "tex::wrap_repeat",          "float2(0.25, 0.75)" },
+        { "md_crop_clamp", "tex::wrap_clamp",       "float2(0.25, 0.75)" },
+    };
+
+    std::string data =
+        "mdl 1.6;\n"
+        "import ::df::*;\n"
+        "import ::state::*;\n"
+        "import ::tex::*;\n"
+        "float3 lookup(uniform texture_2d t, uniform tex::wrap_mode wrap, uniform float2 crop) {\n"
+        "    float3 uvw = state::texture_coordinate(0);\n"
+        "    return tex::lookup_float3(t, float2(uvw.x, uvw.y), wrap, wrap, crop, crop);\n"
+        "}\n";
+    for( const auto& material: materials)
+        data += std::string( "export material ") + material[0]
+            + "(uniform texture_2d t = texture_2d())\n"
+            + "= material(surface: material_surface(scattering: df::diffuse_reflection_bsdf(\n"
+            + "    tint: color(lookup(t, " + material[1] + ", " + material[2] + ")))));\n";
+    MI_CHECK_EQUAL( 0,
+        mdl_impexp_api->load_module_from_string( transaction, "::native_inline", data.c_str()));
+
+    // Two textures sharing the same image, but with different gamma values.
+    std::string path = MI::TEST::mi_src_path( "io/image/image/tests/test_mipmap.png");
+    mi::base::Handle<mi::neuraylib::IImage> image(
+        transaction->create<mi::neuraylib::IImage>( "Image"));
+    MI_CHECK_EQUAL( 0, image->reset_file( path.c_str()));
+    MI_CHECK_EQUAL( 0, transaction->store( image.get(), "native_inline_image"));
+    const char* textures[] = { "native_inline_texture_linear", "native_inline_texture_srgb" };
+    for( int i = 0; i < 2; ++i) {
+        mi::base::Handle<mi::neuraylib::ITexture> texture(
+            transaction->create<mi::neuraylib::ITexture>( "Texture"));
+        MI_CHECK_EQUAL( 0, texture->set_image( "native_inline_image"));
+        texture->set_gamma( i == 0 ? 1.0f : 2.2f);
+        MI_CHECK_EQUAL( 0, transaction->store( texture.get(), textures[i]));
+    }
+
+    mi::base::Handle<mi::neuraylib::IMdl_backend> be_native(
+        mdl_backend_api->get_backend( mi::neuraylib::IMdl_backend_api::MB_NATIVE));
+    MI_CHECK( be_native);
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    for( const auto& material: materials) {
+        std::string definition_name
+            = std::string( "mdl::native_inline::") + material[0] + "(texture_2d)";
+
+        for( const char* texture: textures) {
+            mi::base::Handle<const mi::neuraylib::ICompiled_material> cm( compile_with_texture(
+                transaction, mdl_factory, definition_name.c_str(), texture));
+
+            // Bilinear filtering without derivatives, trilinear filtering with derivatives.
+            for( int use_derivatives = 0; use_derivatives <= 1; ++use_derivatives) {
+                MI_CHECK_EQUAL( 0, be_native->set_option(
+                    "texture_runtime_with_derivs", use_derivatives ? "on" : "off"));
+
+                std::vector<float> results[2];
+                const char* modes[] = { "vtable", "native_inline" };
+                for( int m = 0; m < 2; ++m) {
+                    MI_CHECK_EQUAL( 0, be_native->set_option( "tex_lookup_call_mode", modes[m]));
+                    mi::base::Handle<const mi::neuraylib::ITarget_code> code(
+                        be_native->translate_material_expression(
+                            transaction, cm.get(), "surface.scattering.tint", "tint",
+                            context.get()));
+                    MI_CHECK_CTX( context.get());
+                    MI_CHECK( code);
+                    evaluate_native_tint( code.get(), use_derivatives != 0, results[m]);
+                }
+
+                MI_CHECK_CLOSE_COLLECTIONS(
+                    results[0].begin(), results[0].end(),
+                    results[1].begin(), results[1].end(), 1e-5f);
+            }
+        }
+    }
+
+    MI_CHECK_EQUAL( 0, be_native->set_option( "tex_lookup_call_mode", "vtable"));
+    MI_CHECK_EQUAL( 0, be_native->set_option( "texture_runtime_with_derivs", "off"));
+}
+
+// Compiles the material instance of the parameterless material definition \p definition_name.
+const mi::neuraylib::ICompiled_material* compile_without_arguments(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_factory* mdl_factory,
+    const char* definition_name)
+{
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    mi::base::Handle<const mi::neuraylib::IFunction_definition> md(
+        transaction->access<mi::neuraylib::IFunction_definition>( definition_name));
+    MI_CHECK( md);
+    mi::Sint32 result = -1;
+    mi::base::Handle<mi::neuraylib::IFunction_call> mi(
+        md->create_function_call( nullptr, &result));
+    MI_CHECK_EQUAL( 0, result);
+    mi::base::Handle<mi::neuraylib::IMaterial_instance> mi_mi(
+        mi->get_interface<mi::neuraylib::IMaterial_instance>());
+    const mi::neuraylib::ICompiled_material* cm = mi_mi->create_compiled_material(
+        mi::neuraylib::IMaterial_instance::DEFAULT_OPTIONS, context.get());
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( cm);
+    return cm;
+}
+
+// Initializes and evaluates the BSDF \p base_fname translated to \p code for a fixed pair of
+// directions, and appends the diffuse and glossy parts and the PDF to \p results.
+void evaluate_native_bsdf(
+    const mi::neuraylib::ITarget_code* code, const char* base_fname, std::vector<float>& results)
+{
+    const std::string init_name = std::string( base_fname) + "_init";
+    mi::Size init_index = ~mi::Size( 0);
+    for( mi::Size i = 0, n = code->get_callable_function_count(); i < n; ++i)
+        if( init_name == code->get_callable_function( i))
+            init_index = i;
+    MI_CHECK( init_index != ~mi::Size( 0));
+
+    mi::Float32_4_struct identity[4] = {
+        { 1.0f, 0.0f, 0.0f, 0.0f },
+        { 0.0f, 1.0f, 0.0f, 0.0f },
+        { 0.0f, 0.0f, 1.0f, 0.0f },
+        { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    mi::neuraylib::tct_float4 text_results[32];
+    mi::neuraylib::tct_float3 texture_coords[1]    = { { 0.0f, 0.0f, 0.0f } };
+    mi::neuraylib::tct_float3 texture_tangent_u[1] = { { 1.0f, 0.0f, 0.0f } };
+    mi::neuraylib::tct_float3 texture_tangent_v[1] = { { 0.0f, 1.0f, 0.0f } };
+
+    mi::neuraylib::Shading_state_material state = {
+        /*normal=*/                { 0.0f, 0.0f, 1.0f },
+        /*geom_normal=*/           { 0.0f, 0.0f, 1.0f },
+        /*position=*/              { 0.0f, 0.0f, 0.0f },
+        /*animation_time=*/        0.0f,
+        /*texture_coords=*/        texture_coords,
+        /*tangent_u=*/             texture_tangent_u,
+        /*tangent_v=*/             texture_tangent_v,
+        /*text_results=*/          text_results,
+        /*ro_data_segment=*/       nullptr,
+        /*world_to_object=*/       &identity[0],
+        /*object_to_world=*/       &identity[0],
+        /*object_id=*/             0,
+        /*meters_per_scene_unit=*/ 1.0f
+    };
+    MI_CHECK_EQUAL( 0, code->execute_bsdf_init( init_index, state, nullptr, nullptr));
+
+    // The evaluate function follows the init and the sample function.
+    mi::neuraylib::Bsdf_evaluate_data<mi::neuraylib::DF_HSM_NONE> data;
+    data.ior1         = { 1.0f, 1.0f, 1.0f };
+    data.ior2         = { 1.5f, 1.5f, 1.5f };
+    data.k1           = { 0.0f, 0.6f, 0.8f };
+    data.k2           = { 0.6f, 0.0f, 0.8f };
+    data.bsdf_diffuse = { 0.0f, 0.0f, 0.0f };
+    data.bsdf_glossy  = { 0.0f, 0.0f, 0.0f };
+    data.pdf          = 0.0f;
+    MI_CHECK_EQUAL( 0,
+        code->execute_bsdf_evaluate( init_index + 2, &data, state, nullptr, nullptr));
+
+    results.push_back( data.bsdf_diffuse.x);
+    results.push_back( data.bsdf_diffuse.y);
+    results.push_back( data.bsdf_diffuse.z);
+    results.push_back( data.bsdf_glossy.x);
+    results.push_back( data.bsdf_glossy.y);
+    results.push_back( data.bsdf_glossy.z);
+    results.push_back( data.pdf);
+}
+
+// Materials using different BSDFs, the code generator links the libbsdf templates of each BSDF
+// only when the first distribution function using it is translated. The last material combines
+// BSDFs which were already linked for the previous materials with new ones.
+const char* libbsdf_linking_materials[] = { "md_diffuse", "md_glossy", "md_film", "md_layered" };
+
+// Checks that the distribution functions of a link unit, which need libbsdf templates not used by
+// the previous ones, evaluate like the separately translated distribution functions.
+void check_libbsdf_linking(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_impexp_api* mdl_impexp_api,
+    mi::neuraylib::IMdl_backend_api* mdl_backend_api,
+    mi::neuraylib::IMdl_factory* mdl_factory)
+{
+    const char* data =
+        "mdl 1.6;\n"
+        "import ::df::*;\n"
+        "export material md_diffuse()\n"
+        "= material(surface: material_surface(scattering: df::diffuse_reflection_bsdf(\n"
+        "    tint: color(0.5))));\n"
+        "export material md_glossy()\n"
+        "= material(surface: material_surface(scattering: df::simple_glossy_bsdf(\n"
+        "    roughness_u: 0.3, tint: color(0.7), mode: df::scatter_reflect)));\n"
+        "export material md_film()\n"
+        "= material(surface: material_surface(scattering: df::thin_film(\n"
+        "    thickness: 400.0, ior: color(1.8), base: df::simple_glossy_bsdf(\n"
+        "        roughness_u: 0.3, tint: color(0.7), mode: df::scatter_reflect))));\n"
+        "export material md_layered()\n"
+        "= material(surface: material_surface(scattering: df::fresnel_layer(\n"
+        "    ior: color(1.5),\n"
+        "    layer: df::simple_glossy_bsdf(\n"
+        "        roughness_u: 0.1, tint: color(1.0), mode: df::scatter_reflect),\n"
+        "    base: df::normalized_mix(df::bsdf_component[](\n"
+        "        df::bsdf_component(0.6, df::diffuse_reflection_bsdf(tint: color(0.5))),\n"
+        "        df::bsdf_component(0.4, df::sheen_bsdf(\n"
+        "            roughness: 0.2, tint: color(0.8), multiscatter_tint: color(0.0))))))));\n";
+    MI_CHECK_EQUAL( 0,
+        mdl_impexp_api->load_module_from_string( transaction, "::libbsdf_linking", data));
+
+    mi::base::Handle<mi::neuraylib::IMdl_backend> be_native(
+        mdl_backend_api->get_backend( mi::neuraylib::IMdl_backend_api::MB_NATIVE));
+    MI_CHECK( be_native);
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    mi::base::Handle<mi::neuraylib::ILink_unit> unit(
+        be_native->create_link_unit( transaction, context.get()));
+    MI_CHECK( unit);
+
+    std::vector<float> results_single;
+    std::vector<mi::base::Handle<const mi::neuraylib::ICompiled_material>> cms;
+    for( const char* material: libbsdf_linking_materials) {
+        std::string definition_name
+            = std::string( "mdl::libbsdf_linking::") + material + "()";
+        cms.emplace_back( compile_without_arguments(
+            transaction, mdl_factory, definition_name.c_str()));
+
+        mi::base::Handle<const mi::neuraylib::ITarget_code> code(
+            be_native->translate_material_df(
+                transaction, cms.back().get(), "surface.scattering", material, context.get()));
+        MI_CHECK_CTX( context.get());
+        MI_CHECK( code);
+        evaluate_native_bsdf( code.get(), material, results_single);
+
+        MI_CHECK_EQUAL( 0, unit->add_material_df(
+            cms.back().get(), "surface.scattering", material, context.get()));
+        MI_CHECK_CTX( context.get());
+    }
+
+    mi::base::Handle<const mi::neuraylib::ITarget_code> code_unit(
+        be_native->translate_link_unit( unit.get(), context.get()));
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( code_unit);
+    std::vector<float> results_unit;
+    for( const char* material: libbsdf_linking_materials)
+        evaluate_native_bsdf( code_unit.get(), material, results_unit);
+
+    MI_CHECK_CLOSE_COLLECTIONS(
+        results_single.begin(), results_single.end(),
+        results_unit.begin(), results_unit.end(), 1e-5f);
+
+    // A missing template would have been replaced by the black BSDF.
+    for( size_t i = 0; i < results_unit.size(); i += 7) {
+        float sum = 0.0f;
+        for( size_t j = 0; j < 6; ++j)
+            sum += results_unit[i + j];
+        MI_CHECK( sum > 0.0f);
+    }
+}
+
+/// Measures the time spent translating a simple distribution function, which is dominated by
+/// loading and linking the libbsdf templates.
+///
+/// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_libbsdf_linking(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_backend_api* mdl_backend_api,
+    mi::neuraylib::IMdl_factory* mdl_factory)
+{
+    const int translation_count = 50;
+
+    mi::base::Handle<mi::neuraylib::IMdl_backend> be_ptx(
+        mdl_backend_api->get_backend( mi::neuraylib::IMdl_backend_api::MB_CUDA_PTX));
+    MI_CHECK( be_ptx);
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    for( const char* material: libbsdf_linking_materials) {
+        std::string definition_name
+            = std::string( "mdl::libbsdf_linking::") + material + "()";
+        mi::base::Handle<const mi::neuraylib::ICompiled_material> cm( compile_without_arguments(
+            transaction, mdl_factory, definition_name.c_str()));
+
+        auto start = std::chrono::steady_clock::now();
+        for( int i = 0; i < translation_count; ++i) {
+            mi::base::Handle<const mi::neuraylib::ITarget_code> code(
+                be_ptx->translate_material_df(
+                    transaction, cm.get(), "surface.scattering", material, context.get()));
+            MI_CHECK( code);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        MI_CHECK_CTX( context.get());
+
+        double seconds = std::chrono::duration<double>( stop - start).count();
+        fprintf( stderr, "libbsdf linking benchmark: %s, %.2f ms per translation\n",
+            material, 1000.0 * seconds / translation_count);
+    }
+}
+
+/// The module-level symbols of PTX code.
+struct Ptx_symbols
+{
+    std::set<std::string> visible;   ///< Names of the visible definitions.
+    size_t n_definitions = 0;        ///< Number of definitions, including the visible ones.
+    std::set<std::string> externs;   ///< Names of the declarations.
+};
+
+/// Collects the module-level definitions and declarations of functions and variables.
+///
+/// Relies on the NVPTX output format: module-level statements start in the first column.
+Ptx_symbols get_ptx_symbols( const std::string& ptx)
+{
+    const char* ident_chars =
+        "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_$%";
+
+    Ptx_symbols symbols;
+    std::istringstream lines( ptx);
+    std::string line;
+    while( std::getline( lines, line)) {
+        bool is_visible = false;
+        bool is_extern = false;
+        for( const char* prefix: { ".visible ", ".weak ", ".extern "}) {
+            if( line.compare( 0, strlen( prefix), prefix) == 0) {
+                is_visible |= prefix[1] == 'v';
+                is_extern  |= prefix[1] == 'e';
+                line = line.substr( line.find_first_not_of( ' ', strlen( prefix)));
+            }
+        }
+
+        std::string name;
+        if( line.compare( 0, 5, ".func") == 0 || line.compare( 0, 6, ".entry") == 0) {
+            size_t pos = line.find_first_not_of( ' ', line.find( ' '));
+            if( pos != std::string::npos && line[pos] == '(')
+                pos = line.find_first_not_of( ' ', line.find( ')', pos) + 1);
+            if( pos == std::string::npos)
+                continue;
+            name = line.substr( pos, line.find_first_not_of( ident_chars, pos) - pos);
+        } else if( line.compare( 0, 7, ".global") == 0
+            || line.compare( 0, 6, ".const") == 0
+            || line.compare( 0, 7, ".shared") == 0) {
+            std::string head = line.substr( 0, line.find_first_of( "[;="));
+            head = head.substr( 0, head.find_last_not_of( ' ') + 1);
+            name = head.substr( head.find_last_not_of( ident_chars) + 1);
+        } else
+            continue;
+
+        if( is_extern)
+            symbols.externs.insert( name);
+        else {
+            ++symbols.n_definitions;
+            if( is_visible)
+                symbols.visible.insert( name);
+        }
+    }
+    return symbols;
+}
+
 void check_backends(
     mi::neuraylib::ITransaction* transaction,
     mi::neuraylib::IMdl_backend_api* mdl_backend_api,
@@ -9769,6 +10388,67 @@ void check_backends(
             MI_CHECK_EQUAL(3, code_ptx->get_string_constant_count());
             MI_CHECK_EQUAL_CSTR("something", code_ptx->get_string_constant(1));
             MI_CHECK_EQUAL_CSTR("abc",       code_ptx->get_string_constant(2));
+
+            // parallel code generation yields one PTX module with the same functions
+            MI_CHECK_EQUAL(-2, be_ptx->set_option("num_codegen_threads", "0"));
+            MI_CHECK_EQUAL(-2, be_ptx->set_option("num_codegen_threads", "many"));
+            MI_CHECK_EQUAL(0, be_ptx->set_option("num_codegen_threads", "4"));
+
+            mi::base::Handle<const mi::neuraylib::ITarget_code> code_ptx_parallel(
+                be_ptx->translate_link_unit(unit.get(), context.get()));
+            MI_CHECK(code_ptx_parallel.is_valid_interface());
+            MI_CHECK_EQUAL(context->get_error_messages_count(), 0);
+            MI_CHECK_EQUAL(0, be_ptx->set_option("num_codegen_threads", "1"));
+
+            std::string ptx(code_ptx_parallel->get_code(), code_ptx_parallel->get_code_size());
+            MI_CHECK_EQUAL(ptx.find(".version"), ptx.rfind(".version"));
+
+            // the parallel path was taken, it silently falls back to the serial one otherwise
+            size_t n_parts = 0;
+            for (size_t pos = ptx.find("// Parallel code generation part ");
+                    pos != std::string::npos;
+                    pos = ptx.find("// Parallel code generation part ", pos + 1))
+                ++n_parts;
+            MI_CHECK(n_parts >= 2);
+
+            // the joined PTX defines and declares the same symbols as the serial PTX, local
+            // symbols may be named differently
+            std::string ptx_serial(code_ptx->get_code(), code_ptx->get_code_size());
+            MI_CHECK_EQUAL(ptx_serial.find("// Parallel code generation part "), std::string::npos);
+            Ptx_symbols symbols_serial = get_ptx_symbols(ptx_serial);
+            Ptx_symbols symbols_parallel = get_ptx_symbols(ptx);
+            MI_CHECK(symbols_parallel.visible == symbols_serial.visible);
+            MI_CHECK_EQUAL(symbols_parallel.n_definitions, symbols_serial.n_definitions);
+            MI_CHECK(symbols_parallel.externs == symbols_serial.externs);
+            MI_CHECK_EQUAL(
+                code_ptx->get_callable_function_count(),
+                code_ptx_parallel->get_callable_function_count());
+            for (mi::Size i = 0, n = code_ptx->get_callable_function_count(); i < n; ++i) {
+                std::string name = code_ptx_parallel->get_callable_function(i);
+                MI_CHECK_EQUAL(name, code_ptx->get_callable_function(i));
+                std::string definition = ".visible .func ";
+                size_t pos = ptx.find(definition);
+                bool found = false;
+                while (pos != std::string::npos && !found) {
+                    size_t name_pos = ptx.find(name, pos);
+                    found = name_pos != std::string::npos && name_pos < ptx.find('\n', pos);
+                    pos = ptx.find(definition, pos + 1);
+                }
+                MI_CHECK(found);
+            }
+
+            // the phase timings are recorded on the target code
+            mi::Float64 total_time = 0.0;
+            for (mi::Uint32 i = mi::neuraylib::ITarget_code::CP_DAG_TO_LLVM;
+                    i <= mi::neuraylib::ITarget_code::CP_CACHE_LOOKUP; ++i) {
+                mi::Float64 t = code_ptx->get_compile_phase_time(
+                    mi::neuraylib::ITarget_code::Compile_phase(i));
+                MI_CHECK_GREATER_OR_EQUAL(t, 0.0);
+                total_time += t;
+            }
+            MI_CHECK_GREATER(total_time, 0.0);
+            MI_CHECK_EQUAL(0.0, code_ptx->get_compile_phase_time(
+                mi::neuraylib::ITarget_code::CP_FORCE_32_BIT));
         }
 
         // test link units: GLSL
@@ -10559,6 +11239,134 @@ void check_distiller(
 #endif // RESOLVE_RESOURCES_FALSE
 }
 
+// Measures the CPU baking throughput for square textures from 1K up to a maximum resolution.
+//
+// The maximum resolution defaults to 1K to keep the unit test fast. Set the environment variable
+// MI_TEST_BAKER_BENCHMARK_MAX_RESOLUTION (e.g. to 8192) to cover larger resolutions.
+//
+// Only run if the environment variable MI_TEST_RUN_BENCHMARKS is set.
+void benchmark_baker(
+    mi::base::ILogger* logger,
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_distiller_api* mdl_distiller_api,
+    mi::neuraylib::IMdl_factory* mdl_factory,
+    mi::neuraylib::IImage_api* image_api)
+{
+#ifndef RESOLVE_RESOURCES_FALSE
+    mi::Uint32 max_resolution = 1024;
+    const char* env = getenv( "MI_TEST_BAKER_BENCHMARK_MAX_RESOLUTION");
+    if( env)
+        max_resolution = static_cast<mi::Uint32>( strtoul( env, nullptr, 10));
+
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    mi::base::Handle<const mi::neuraylib::IMaterial_instance> mi(
+        transaction->access<mi::neuraylib::IMaterial_instance>( "mdl::" TEST_MDL "::mi_class_baking"));
+    mi::base::Handle<const mi::neuraylib::ICompiled_material> cm( mi->create_compiled_material(
+        mi::neuraylib::IMaterial_instance::DEFAULT_OPTIONS, context.get()));
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( cm);
+
+    mi::base::Handle<const mi::neuraylib::IBaker> baker( mdl_distiller_api->create_baker(
+        cm.get(), "surface.scattering.tint", mi::neuraylib::BAKE_ON_CPU));
+    MI_CHECK( baker);
+    const char* pixel_type = baker->get_pixel_type();
+
+    for( mi::Uint32 resolution = 1024; resolution <= max_resolution; resolution *= 2) {
+
+        mi::base::Handle<mi::neuraylib::ICanvas> canvas(
+            image_api->create_canvas( pixel_type, resolution, resolution));
+
+        auto start = std::chrono::steady_clock::now();
+        mi::Sint32 result = baker->bake_texture( canvas.get());
+        auto stop = std::chrono::steady_clock::now();
+        MI_CHECK_EQUAL( 0, result);
+
+        double seconds = std::chrono::duration<double>( stop - start).count();
+        double mpixels = static_cast<double>( resolution) * resolution / 1000000.0;
+        logger->printf( mi::base::MESSAGE_SEVERITY_INFO, "TEST:BAKER",
+            "Baker benchmark: %ux%u, %.3f s, %.1f Mpixel/s",
+            resolution, resolution, seconds, mpixels / seconds);
+    }
+#endif // RESOLVE_RESOURCES_FALSE
+}
+
+// Checks adaptive baking against uniform baking, and that constant expressions take fewer samples.
+void check_baker_adaptive(
+    mi::neuraylib::ITransaction* transaction,
+    mi::neuraylib::IMdl_distiller_api* mdl_distiller_api,
+    mi::neuraylib::IMdl_factory* mdl_factory,
+    mi::neuraylib::IImage_api* image_api)
+{
+#ifndef RESOLVE_RESOURCES_FALSE
+    const mi::Uint32 width = 64, height = 64;
+    const mi::Uint64 num_pixels = width * height;
+    const size_t num_image_floats = num_pixels * 3;
+
+    mi::base::Handle<mi::neuraylib::IMdl_execution_context> context(
+        mdl_factory->create_execution_context());
+
+    mi::base::Handle<const mi::neuraylib::IMaterial_instance> mi(
+        transaction->access<mi::neuraylib::IMaterial_instance>( "mdl::" TEST_MDL "::mi_class_baking"));
+    mi::base::Handle<const mi::neuraylib::ICompiled_material> cm( mi->create_compiled_material(
+        mi::neuraylib::IMaterial_instance::DEFAULT_OPTIONS, context.get()));
+    MI_CHECK_CTX( context.get());
+    MI_CHECK( cm);
+
+    // varying expression
+    mi::base::Handle<const mi::neuraylib::IBaker> baker( mdl_distiller_api->create_baker(
+        cm.get(), "surface.scattering.tint", mi::neuraylib::BAKE_ON_CPU));
+    MI_CHECK( baker);
+    MI_CHECK( !baker->is_uniform());
+    const char* pixel_type = baker->get_pixel_type();
+    MI_CHECK_EQUAL_CSTR( pixel_type, "Rgb_fp");
+
+    mi::base::Handle<mi::neuraylib::ICanvas> uniform(
+        image_api->create_canvas( pixel_type, width, height));
+    mi::base::Handle<mi::neuraylib::ICanvas> adaptive(
+        image_api->create_canvas( pixel_type, width, height));
+
+    // invalid parameters
+    MI_CHECK_EQUAL( -1, baker->bake_texture_adaptive( nullptr, 2, 16, 0.01f));
+    MI_CHECK_EQUAL( -1, baker->bake_texture_adaptive( adaptive.get(), 0, 16, 0.01f));
+    MI_CHECK_EQUAL( -1, baker->bake_texture_adaptive( adaptive.get(), 32, 16, 0.01f));
+    MI_CHECK_EQUAL( -1, baker->bake_texture_adaptive( adaptive.get(), 2, 16, -1.0f));
+
+    // without room for refinement, adaptive baking is uniform baking
+    mi::Uint64 num_samples = 0;
+    MI_CHECK_EQUAL( 0, baker->bake_texture( uniform.get(), 16));
+    MI_CHECK_EQUAL( 0, baker->bake_texture_adaptive( adaptive.get(), 16, 16, 0.01f, &num_samples));
+    MI_CHECK_EQUAL( 16 * num_pixels, num_samples);
+    MI_CHECK( check_canvas_nearly_equal( uniform.get(), adaptive.get(), num_image_floats));
+
+    // adaptive baking uses a different sample sequence, but converges to the same image
+    MI_CHECK_EQUAL( 0, baker->bake_texture_adaptive( adaptive.get(), 1, 16, 0.001f, &num_samples));
+    MI_CHECK_LESS_OR_EQUAL( 2 * num_pixels, num_samples);
+    MI_CHECK_LESS_OR_EQUAL( num_samples, 16 * num_pixels);
+    {
+        mi::base::Handle<const mi::neuraylib::ITile> tile_u( uniform->get_tile());
+        mi::base::Handle<const mi::neuraylib::ITile> tile_a( adaptive->get_tile());
+        const float* data_u = static_cast<const float*>( tile_u->get_data());
+        const float* data_a = static_cast<const float*>( tile_a->get_data());
+        double sum_sq = 0.0;
+        for( size_t i = 0; i < num_image_floats; ++i)
+            sum_sq += (data_u[i] - data_a[i]) * (data_u[i] - data_a[i]);
+        MI_CHECK_LESS( std::sqrt( sum_sq / num_image_floats), 0.02);
+    }
+
+    // constant expression: no pixel needs refinement
+    baker = mdl_distiller_api->create_baker( cm.get(), "ior", mi::neuraylib::BAKE_ON_CPU);
+    MI_CHECK( baker);
+    MI_CHECK( baker->is_uniform());
+    MI_CHECK_EQUAL_CSTR( baker->get_pixel_type(), "Rgb_fp");
+    MI_CHECK_EQUAL( 0, baker->bake_texture_adaptive( adaptive.get(), 2, 16, 0.001f, &num_samples));
+    MI_CHECK_EQUAL( 2 * num_pixels, num_samples);
+    MI_CHECK_EQUAL( 0, baker->bake_texture( uniform.get(), 16));
+    MI_CHECK( check_canvas_nearly_equal( uniform.get(), adaptive.get(), num_image_floats));
+#endif // RESOLVE_RESOURCES_FALSE
+}
+
 // This test invokes the distiller on several materials, distilling each
 // to all available targets in the mdl_distiller plugin. Then, the hashes
 // of all distilled materials are compared to make sure that they differ
@@ -11776,6 +12584,25 @@ void run_tests( mi::neuraylib::INeuray* neuray)
         check_uniform_auto_varying( transaction.get(), mdl_factory.get());
         check_export_flag( transaction.get(), mdl_factory.get());
         check_backends( transaction.get(), mdl_backend_api.get(), mdl_factory.get());
+        check_runtime_resource_cache( transaction.get(), mdl_configuration.get(),
+            mdl_impexp_api.get(), mdl_backend_api.get(), mdl_factory.get());
+        check_native_inline_texture_lookups(
+            transaction.get(), mdl_impexp_api.get(), mdl_backend_api.get(), mdl_factory.get());
+        check_libbsdf_linking(
+            transaction.get(), mdl_impexp_api.get(), mdl_backend_api.get(), mdl_factory.get());
+        if( getenv( "MI_TEST_RUN_BENCHMARKS"))
+            benchmark_libbsdf_linking(
+                transaction.get(), mdl_backend_api.get(), mdl_factory.get());
+        if( getenv( "MI_TEST_RUN_BENCHMARKS")) {
+            mi::base::Handle<mi::neuraylib::ILogging_configuration> logging_configuration(
+                neuray->get_api_component<mi::neuraylib::ILogging_configuration>());
+            mi::base::Handle<mi::base::ILogger> logger(
+                logging_configuration->get_forwarding_logger());
+            benchmark_baker( logger.get(), transaction.get(), mdl_distiller_api.get(),
+                mdl_factory.get(), image_api.get());
+        }
+        check_baker_adaptive(
+            transaction.get(), mdl_distiller_api.get(), mdl_factory.get(), image_api.get());
         check_create_archive( transaction.get(), mdl_configuration.get(), mdl_archive_api.get());
         check_extract_archive( mdl_archive_api.get());
         check_get_manifest( mdl_archive_api.get());
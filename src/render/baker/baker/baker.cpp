@@ -29,6 +29,7 @@
 #include "pch.h"
 
 
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -55,6 +56,7 @@
 #include <io/scene/dbimage/i_dbimage.h>
 #include <io/scene/texture/i_texture.h>
 #include <render/mdl/backends/backends_backends.h>
+#include <render/mdl/backends/backends_target_code.h>
 #include <base/hal/time/i_time.h>
 
 
@@ -83,6 +85,7 @@ inline Vector3 from_polar(
 }
 
 MI_FORCE_INLINE float radinv2(const unsigned int i/*, const unsigned int scramble = 0*/);
+MI_FORCE_INLINE float radinv3(unsigned int i);
 
 // ----------------------------------------------------------------------------
 // Baker_fragmented_job
@@ -90,10 +93,17 @@ MI_FORCE_INLINE float radinv2(const unsigned int i/*, const unsigned int scrambl
 class Baker_fragmented_job : public DB::Fragmented_job
 {
 public:
+    /// Constructor.
+    ///
+    /// If \p max_samples is larger than \p min_samples, pixels are sampled adaptively: all pixels
+    /// start with \p min_samples samples, and pixels whose estimated standard error is above
+    /// \p tolerance are refined until they converge or reach \p max_samples.
     Baker_fragmented_job(
         const mi::neuraylib::ITarget_code* target_code,
         mi::neuraylib::ICanvas* texture,
-        mi::Uint32 samples,
+        mi::Uint32 min_samples,
+        mi::Uint32 max_samples,
+        mi::Float32 tolerance,
         mi::Uint32 state_flags,
         bool is_environment);
 
@@ -105,38 +115,72 @@ public:
 
     bool successful() const { return m_failure == 0; }
 
+    /// Returns the total number of samples taken by all fragments.
+    mi::Uint64 get_num_samples() const { return m_num_samples; }
+
     mi::Size get_fragment_count() { return m_num_fragments; }
 
 protected:
-    mi::base::Handle<const mi::neuraylib::ITarget_code> m_target_code;
+    /// Maximum number of samples evaluated by a single call into the target code.
+    static const mi::Uint32 s_max_batch_size = 256;
+
+    /// Width and height of the square texture regions handled by one fragment.
+    static const mi::Uint32 s_tile_size = 64;
+
+    /// Stores a tile of accumulated pixels into the texture.
+    ///
+    /// \param buffer    The pixels, \p width times \p height, stored row by row.
+    /// \param x0        The first column of the tile in the texture.
+    /// \param y0        The first row of the tile in the texture.
+    /// \param width     The number of columns of the tile.
+    /// \param height    The number of rows of the tile.
+    void store_tile(
+        const mi::Float32_3* buffer,
+        mi::Uint32 x0,
+        mi::Uint32 y0,
+        mi::Uint32 width,
+        mi::Uint32 height);
+
+    mi::base::Handle<const BACKENDS::ITarget_code_multi_execution> m_target_code;
     mi::base::Handle<mi::neuraylib::ICanvas>            m_texture;
+    mi::base::Handle<mi::neuraylib::ITile>              m_tile;
 
+    IMAGE::Pixel_type m_pixel_type;
     mi::Uint32  m_tex_width;
     mi::Uint32  m_tex_height;
-    mi::Uint32  m_num_samples;
+    mi::Uint32  m_min_samples;
+    mi::Uint32  m_max_samples;
+    mi::Float32 m_tolerance;
+    bool        m_adaptive;
     mi::Uint32  m_state_flags;
     bool        m_is_environment;
     mi::Float32 m_du;
     mi::Float32 m_dv;
+    mi::Uint32  m_num_tiles_x;
     mi::Size    m_num_fragments;
-    mi::Size    m_num_rows_per_frag;
-    mi::Size    m_num_frags_with_extra_row;
 
     std::atomic_uint32_t m_failure;
+    std::atomic_uint64_t m_num_samples;
 };
 
 Baker_fragmented_job::Baker_fragmented_job(
     const mi::neuraylib::ITarget_code* target_code,
     mi::neuraylib::ICanvas* texture,
-    const mi::Uint32 samples,
+    const mi::Uint32 min_samples,
+    const mi::Uint32 max_samples,
+    const mi::Float32 tolerance,
     const mi::Uint32 state_flags,
     const bool is_environment)
-    : m_target_code(target_code, mi::base::DUP_INTERFACE)
+    : m_target_code(target_code->get_interface<BACKENDS::ITarget_code_multi_execution>())
     , m_texture(texture, mi::base::DUP_INTERFACE)
-    , m_num_samples(samples)
+    , m_min_samples(min_samples)
+    , m_max_samples(max_samples)
+    , m_tolerance(tolerance)
+    , m_adaptive(max_samples > min_samples)
     , m_state_flags(state_flags)
     , m_is_environment(is_environment)
     , m_failure(0)
+    , m_num_samples(0)
 {
     m_tex_width  = texture->get_resolution_x();
     m_tex_height = texture->get_resolution_y();
@@ -144,9 +188,58 @@ Baker_fragmented_job::Baker_fragmented_job(
     m_du = (mi::Float32)(1.0 / (mi::Float64)m_tex_width);
     m_dv = (mi::Float32)(1.0 / (mi::Float64)m_tex_height);
 
-    m_num_fragments = m_tex_height;
-    m_num_rows_per_frag = m_tex_height / m_num_fragments;
-    m_num_frags_with_extra_row = m_tex_height - m_num_rows_per_frag * m_num_fragments;
+    m_tile = texture->get_tile();
+    m_pixel_type = IMAGE::convert_pixel_type_string_to_enum(m_tile->get_type());
+
+    // one fragment per tile of s_tile_size x s_tile_size pixels
+    m_num_tiles_x = (m_tex_width + s_tile_size - 1) / s_tile_size;
+    const mi::Uint32 num_tiles_y = (m_tex_height + s_tile_size - 1) / s_tile_size;
+    m_num_fragments = mi::Size(m_num_tiles_x) * num_tiles_y;
+}
+
+void Baker_fragmented_job::store_tile(
+    const mi::Float32_3* buffer,
+    const mi::Uint32 x0,
+    const mi::Uint32 y0,
+    const mi::Uint32 width,
+    const mi::Uint32 height)
+{
+    // The pixel types produced by the baker are written directly into the tile data, anything
+    // else goes through the generic (and slow) set_pixel() conversion.
+    switch (m_pixel_type) {
+    case IMAGE::PT_FLOAT32:
+        {
+            mi::Float32* data = static_cast<mi::Float32*>(m_tile->get_data());
+            for (mi::Uint32 y = 0; y < height; ++y) {
+                mi::Float32* dest = data + mi::Size(y0 + y) * m_tex_width + x0;
+                const mi::Float32_3* src = buffer + mi::Size(y) * width;
+                for (mi::Uint32 x = 0; x < width; ++x)
+                    dest[x] = src[x].x;
+            }
+            return;
+        }
+    case IMAGE::PT_RGB_FP:
+    case IMAGE::PT_FLOAT32_3:
+        {
+            mi::Float32_3* data = static_cast<mi::Float32_3*>(m_tile->get_data());
+            for (mi::Uint32 y = 0; y < height; ++y)
+                memcpy(
+                    data + mi::Size(y0 + y) * m_tex_width + x0,
+                    buffer + mi::Size(y) * width,
+                    width * sizeof(mi::Float32_3));
+            return;
+        }
+    default:
+        {
+            for (mi::Uint32 y = 0; y < height; ++y)
+                for (mi::Uint32 x = 0; x < width; ++x) {
+                    const mi::Float32_3& src = buffer[mi::Size(y) * width + x];
+                    const mi::Float32_4 pixel(src.x, src.y, src.z, 1.0f);
+                    m_tile->set_pixel(x0 + x, y0 + y, &pixel.x);
+                }
+            return;
+        }
+    }
 }
 
 static mi::Float32_4_4 s_unity(1.0f);
@@ -210,75 +303,164 @@ void Baker_fragmented_job::execute_fragment(
     size_t           count,
     const mi::neuraylib::IJob_execution_context* context)
 {
-    mi::Uint32 start_row = mi::Uint32(
-        index * m_num_rows_per_frag +
-        ((index < m_num_frags_with_extra_row) ? index : m_num_frags_with_extra_row));
-
-    mi::Uint32 end_row = mi::Uint32(
-        start_row + m_num_rows_per_frag - 1 +
-        ((index < m_num_frags_with_extra_row) ? 1 : 0));
+    if (!m_target_code) {
+        // not native code of the MDL backends
+        m_failure = 1;
+        return;
+    }
 
-    mi::Uint32 start_col = 0;
-    mi::Uint32 end_col   = m_tex_width - 1;
+    const mi::Uint32 start_row = mi::Uint32(index / m_num_tiles_x) * s_tile_size;
+    const mi::Uint32 start_col = mi::Uint32(index % m_num_tiles_x) * s_tile_size;
+    const mi::Uint32 end_row   = std::min(start_row + s_tile_size, m_tex_height) - 1;
+    const mi::Uint32 end_col   = std::min(start_col + s_tile_size, m_tex_width) - 1;
+    const mi::Uint32 tile_width  = end_col - start_col + 1;
+    const mi::Uint32 tile_height = end_row - start_row + 1;
 
-    union {
-        mi::neuraylib::Shading_state_environment state_env;
-        mi::neuraylib::Shading_state_material state;
-    };
+    mi::neuraylib::Shading_state_environment state_env;
+    mi::neuraylib::Shading_state_material state;
 
-    mi::Float32_3 tex_coords;
+    mi::Float32_3 tex_coords_proto;
     mi::Float32_3 tangent_u;
     mi::Float32_3 tangent_v;
     prepare_cpu_state(
-        state_env, state, tex_coords, tangent_u, tangent_v, m_state_flags, m_is_environment);
+        state_env, state, tex_coords_proto, tangent_u, tangent_v, m_state_flags, m_is_environment);
+
+    // The samples of the pixels of a tile are evaluated with one call per batch of states to
+    // amortize the call overhead. Each state in the batch needs its own texture coordinates.
+    std::vector<mi::neuraylib::Shading_state_environment> states_env;
+    std::vector<mi::neuraylib::Shading_state_material> states_mat;
+    std::vector<mi::Float32_3> tex_coords(s_max_batch_size, mi::Float32_3(0.0f));
+    std::vector<mi::Float32_3> results(s_max_batch_size, mi::Float32_3(0.0f));
+    std::vector<mi::Uint32> batch_pixels(s_max_batch_size);
+    if (m_is_environment)
+        states_env.resize(s_max_batch_size, state_env);
+    else {
+        states_mat.resize(s_max_batch_size, state);
+        for (mi::Uint32 s = 0; s < s_max_batch_size; ++s)
+            states_mat[s].text_coords = &tex_coords[s];
+    }
+
+    // per-pixel sums of the samples (and their squares for adaptive sampling)
+    const mi::Uint32 num_pixels = tile_width * tile_height;
+    std::vector<mi::Float32_3> sums(num_pixels, mi::Float32_3(0.0f));
+    std::vector<mi::Float32_3> sums_sq(m_adaptive ? num_pixels : 0, mi::Float32_3(0.0f));
+    std::vector<mi::Uint32> num_taken(num_pixels, 0);
+
+    // Evaluates the first n states of the batch and accumulates the results.
+    auto evaluate_batch = [&](mi::Uint32 n) -> bool
+    {
+        if (n == 0)
+            return true;
+
+        mi::Sint32 result = m_is_environment
+            ? m_target_code->execute_environment_multi(
+                0, n, states_env.data(), nullptr,
+                reinterpret_cast<mi::Spectrum_struct*>(results.data()))
+            : m_target_code->execute_multi(
+                0, n, states_mat.data(), nullptr, nullptr,
+                results.data(), sizeof(mi::Float32_3));
+        if (result != 0)
+            return false;
+
+        for (mi::Uint32 s = 0; s < n; ++s) {
+            const mi::Float32_3& r = results[s];
+            sums[batch_pixels[s]] += r;
+            if (m_adaptive)
+                sums_sq[batch_pixels[s]] += r * r;
+        }
+        return true;
+    };
 
-    mi::base::Handle<mi::neuraylib::ITile> tile(m_texture->get_tile());
+    // Returns whether a pixel needs more samples.
+    const mi::Float32 tolerance_sq = m_tolerance * m_tolerance;
+    auto needs_refinement = [&](mi::Uint32 p) -> bool
+    {
+        const mi::Uint32 n = num_taken[p];
+        if (!m_adaptive || n >= m_max_samples)
+            return false;
+
+        // squared standard error of the mean, maximum over all channels
+        const mi::Float32 inv_n = 1.0f / (mi::Float32)n;
+        const mi::Float32_3 mean = sums[p] * inv_n;
+        const mi::Float32_3 variance = sums_sq[p] * inv_n - mean * mean;
+        const mi::Float32 error_sq =
+            std::max(std::max(variance.x, variance.y), variance.z) * inv_n;
+        return error_sq > tolerance_sq;
+    };
+
+    std::vector<mi::Uint32> active(num_pixels);
+    for (mi::Uint32 p = 0; p < num_pixels; ++p)
+        active[p] = p;
 
-    const float inv_spp = (float)(1.0 / (double)m_num_samples);
-    for (mi::Uint32 i = start_row; i <= end_row; i++)
+    const float inv_spp = (float)(1.0 / (double)m_max_samples);
+    while (!active.empty())
     {
-        for (mi::Uint32 j = start_col; j <= end_col; j++)
+        mi::Uint32 s = 0;
+        for (mi::Uint32 p : active)
         {
-            mi::Float32_3 pixel(0.0f);
-            mi::Float32_3 pixel_data = pixel;
+            const mi::Uint32 i = start_row + p / tile_width;
+            const mi::Uint32 j = start_col + p % tile_width;
 
-            for (mi::Uint32 k = 0; k < m_num_samples; k++) {
+            // the first round takes the minimum number of samples, later rounds double them
+            const mi::Uint32 k_begin = num_taken[p];
+            const mi::Uint32 k_end   = std::min(
+                k_begin + (k_begin == 0 ? m_min_samples : k_begin), m_max_samples);
+            num_taken[p] = k_end;
 
+            for (mi::Uint32 k = k_begin; k < k_end; k++) {
+
+                // without adaptive sampling the number of samples is known in advance and the
+                // samples are stratified in x, otherwise a progressive sequence is used
                 const mi::Float32 y = ((float)i + fractf(radinv2(k) + 0.5f)) * m_dv;
-                const mi::Float32 x = ((float)j + fractf((float)k * inv_spp + 0.5f)) * m_du;
+                const mi::Float32 x = ((float)j + fractf(
+                    (m_adaptive ? radinv3(k) : (float)k * inv_spp) + 0.5f)) * m_du;
 
                 if (m_is_environment) {
                     const float phi = x * (float)(2.0 * M_PI);
                     const float theta = y * (float)(M_PI);
-                    state_env.direction = from_polar(Vector2(theta, phi));
-
-                    if (m_target_code->execute_environment(
-                            0, state_env, nullptr, (mi::Spectrum_struct*)&pixel.x) != 0) {
-                        m_failure = 1;
-                        return;
-                    }
+                    states_env[s].direction = from_polar(Vector2(theta, phi));
                 } else {
                     if (m_state_flags & BAKER_STATE_POSITION_DIRECTION) {
                         const float phi = x * (float)(2.0 * M_PI);
                         const float theta = y * (float)(M_PI);
-                        state.position = from_polar(Vector2(theta, phi));
+                        states_mat[s].position = from_polar(Vector2(theta, phi));
                     } else {
-                        state.position = mi::Float32_3(x, y, 0.0f);
-                        tex_coords = mi::Float32_3(x, y, 0.0f);
+                        states_mat[s].position = mi::Float32_3(x, y, 0.0f);
+                        tex_coords[s] = mi::Float32_3(x, y, 0.0f);
                     }
+                }
+                batch_pixels[s] = p;
 
-                    if (m_target_code->execute(
-                            0, state, nullptr, nullptr, (mi::Float32*)&pixel.x) != 0) {
+                if (++s == s_max_batch_size) {
+                    if (!evaluate_batch(s)) {
                         m_failure = 1;
                         return;
                     }
+                    s = 0;
                 }
-                pixel_data += pixel;
             }
-            pixel_data /= m_num_samples;
-            tile->set_pixel(j, i, (mi::Float32*)&pixel_data.x);
         }
+        if (!evaluate_batch(s)) {
+            m_failure = 1;
+            return;
+        }
+
+        active.erase(
+            std::remove_if(active.begin(), active.end(),
+                [&](mi::Uint32 p) { return !needs_refinement(p); }),
+            active.end());
+    }
+
+    // the pixels of the tile are stored with a single store_tile() call
+    std::vector<mi::Float32_3> tile_buffer(num_pixels);
+    mi::Uint64 num_samples = 0;
+    for (mi::Uint32 p = 0; p < num_pixels; ++p) {
+        tile_buffer[p] = sums[p] / (mi::Float32)num_taken[p];
+        num_samples += num_taken[p];
     }
+    m_num_samples += num_samples;
+
+    store_tile(tile_buffer.data(), start_col, start_row, tile_width, tile_height);
 }
 
 
@@ -702,6 +884,20 @@ mi::Sint32 Baker_module_impl::bake_texture(
     mi::neuraylib::ICanvas* texture,
     const mi::Uint32 samples,
     const mi::Uint32 state_flags) const
+{
+    return bake_texture_adaptive(
+        transaction, baker_code, texture, samples, samples, 0.0f, state_flags, nullptr);
+}
+
+mi::Sint32 Baker_module_impl::bake_texture_adaptive(
+    DB::Transaction* transaction,
+    const IBaker_code* baker_code,
+    mi::neuraylib::ICanvas* texture,
+    const mi::Uint32 min_samples,
+    const mi::Uint32 max_samples,
+    const mi::Float32 tolerance,
+    const mi::Uint32 state_flags,
+    mi::Uint64* num_samples) const
 {
     mi::base::Handle<const mi::neuraylib::ITarget_code> cpu_code(
         baker_code->get_cpu_target_code());
@@ -709,10 +905,13 @@ mi::Sint32 Baker_module_impl::bake_texture(
 
     if (cpu_code) {
         const bool is_env = static_cast<Baker_code_impl const *>(baker_code)->is_environment();
-        Baker_fragmented_job job(cpu_code.get(), texture, samples, state_flags, is_env);
-        transaction->execute_fragmented(&job, texture->get_resolution_y());
+        Baker_fragmented_job job(
+            cpu_code.get(), texture, min_samples, max_samples, tolerance, state_flags, is_env);
+        transaction->execute_fragmented(&job, job.get_fragment_count());
         if (job.successful()) {
             // success
+            if (num_samples)
+                *num_samples = job.get_num_samples();
             return 0;
         }
     }
@@ -795,6 +994,15 @@ MI_FORCE_INLINE float radinv2(const unsigned int i/*, const unsigned int scrambl
     return (float)((__brev(i) /*^ scramble*/)>>8) * 0x1p-24f;
 }
 
+MI_FORCE_INLINE float radinv3(unsigned int i)
+{
+    float result = 0.0f;
+    float inv_base = 1.0f / 3.0f;
+    for (; i > 0; i /= 3, inv_base *= (1.0f / 3.0f))
+        result += (float)(i % 3) * inv_base;
+    return result;
+}
+
 } // namespace BAKER
 
 } // namespace MI
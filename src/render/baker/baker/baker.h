@@ -146,6 +146,16 @@ public:
         mi::Uint32 samples,
         mi::Uint32 state_flags) const;
 
+    mi::Sint32 bake_texture_adaptive(
+        DB::Transaction* transaction,
+        const IBaker_code* baker_code,
+        mi::neuraylib::ICanvas* texture,
+        mi::Uint32 min_samples,
+        mi::Uint32 max_samples,
+        mi::Float32 tolerance,
+        mi::Uint32 state_flags,
+        mi::Uint64* num_samples) const;
+
     mi::Sint32 bake_constant(
         DB::Transaction* transaction,
         const IBaker_code* baker_code,
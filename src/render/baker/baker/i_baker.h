@@ -107,6 +107,26 @@ public:
         mi::Uint32 samples,
         mi::Uint32 state_flags = 0) const = 0;
 
+    /// Bake a texture with adaptive sampling.
+    ///
+    /// Each pixel starts with \p min_samples samples. Pixels whose estimated standard error
+    /// (maximum over all channels) exceeds \p tolerance are refined until they converge or
+    /// reach \p max_samples samples. If \p min_samples equals \p max_samples, this is the same
+    /// as #bake_texture(). If \p num_samples is not \c NULL, the total number of samples taken is
+    /// stored there.
+    ///
+    /// \return  0  on success
+    /// \return -1  execution error
+    virtual mi::Sint32 bake_texture_adaptive(
+        DB::Transaction* transaction,
+        const IBaker_code* baker_code,
+        mi::neuraylib::ICanvas* texture,
+        mi::Uint32 min_samples,
+        mi::Uint32 max_samples,
+        mi::Float32 tolerance,
+        mi::Uint32 state_flags = 0,
+        mi::Uint64* num_samples = nullptr) const = 0;
+
     /// Bake a constant (aka constant texture).
     ///
     /// \return  0  on success
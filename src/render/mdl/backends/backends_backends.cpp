@@ -47,6 +47,8 @@ using namespace std::string_literals;
 #include <mi/mdl/mdl_types.h>
 #include <base/lib/log/i_log_logger.h>
 #include <base/data/db/i_db_access.h>
+#include <base/data/db/i_db_fragmented_job.h>
+#include <base/data/db/i_db_transaction.h>
 #include <io/image/image/i_image.h>
 #include <io/image/image/i_image_mipmap.h>
 #include <io/scene/mdl_elements/mdl_elements_detail.h> // DETAIL::Type_binder
@@ -3704,6 +3706,14 @@ mi::Sint32 Mdl_llvm_backend::set_option(
             jit_options.set_option(MDL_JIT_OPTION_TEX_LOOKUP_CALL_MODE, value);
             return 0;
         }
+        if (strcmp(name, "num_codegen_threads") == 0) {
+            unsigned v = 0;
+            if (sscanf(value, "%u", &v) != 1 || v < 1 || v > 64) {
+                return -2;
+            }
+            jit_options.set_option(MDL_JIT_OPTION_CODEGEN_THREADS, value);
+            return 0;
+        }
         break;
 
     case mi::neuraylib::IMdl_backend_api::MB_LLVM_IR:
@@ -3894,6 +3904,15 @@ mi::Sint32 Mdl_llvm_backend::set_option(
             jit_options.set_option(MDL_JIT_USE_BUILTIN_RESOURCE_HANDLER_CPU, value);
             return 0;
         }
+        if (strcmp(name, "tex_lookup_call_mode") == 0) {
+            if (strcmp(value, "vtable") == 0) {
+            } else if (strcmp(value, "native_inline") == 0) {
+            } else {
+                return -2;
+            }
+            jit_options.set_option(MDL_JIT_OPTION_TEX_LOOKUP_CALL_MODE, value);
+            return 0;
+        }
         break;
 
     case mi::neuraylib::IMdl_backend_api::MB_HLSL:
@@ -4460,6 +4479,58 @@ mi::mdl::ILink_unit *Mdl_llvm_backend::create_link_unit(
     return NULL;
 }
 
+namespace {
+
+/// Adapts a job of the code generator to a fragmented job of the database.
+class Code_generator_fragmented_job : public DB::Fragmented_job
+{
+public:
+    /// Constructor.
+    ///
+    /// \param job   The code generator job to execute.
+    explicit Code_generator_fragmented_job( mi::mdl::ICode_generator_job* job)
+      : m_job( job)
+    {
+    }
+
+    void execute_fragment(
+        DB::Transaction* transaction,
+        size_t index,
+        size_t count,
+        const mi::neuraylib::IJob_execution_context* context) override
+    {
+        m_job->execute_fragment( index);
+    }
+
+private:
+    mi::mdl::ICode_generator_job* m_job;
+};
+
+/// Executes jobs of the code generator on the thread pool of the SDK.
+class Code_generator_job_executor
+  : public mi::base::Interface_implement<mi::mdl::ICode_generator_job_executor>
+{
+public:
+    /// Constructor.
+    ///
+    /// \param transaction   The transaction used to execute the jobs.
+    explicit Code_generator_job_executor( DB::Transaction* transaction)
+      : m_transaction( transaction)
+    {
+    }
+
+    void execute( mi::mdl::ICode_generator_job* job, size_t count) override
+    {
+        Code_generator_fragmented_job fragmented_job( job);
+        m_transaction->execute_fragmented( &fragmented_job, count);
+    }
+
+private:
+    DB::Transaction* m_transaction;
+};
+
+} // namespace
+
 mi::neuraylib::ITarget_code const *Mdl_llvm_backend::translate_link_unit(
     Link_unit const *lu,
     MDL::Execution_context* context)
@@ -4469,6 +4540,10 @@ mi::neuraylib::ITarget_code const *Mdl_llvm_backend::translate_link_unit(
 
     update_jit_context_options(*cg_ctx.get(), lu->get_internal_space(), context);
 
+    // parallel PTX code generation runs on the thread pool of the SDK
+    cg_ctx->set_job_executor(
+        mi::base::make_handle(new Code_generator_job_executor(lu->get_transaction())).get());
+
     SYSTEM::Access_module<MDLC::Mdlc_module> mdlc_module(/*deferred=*/false);
     MDL::Module_cache module_cache(lu->get_transaction(), mdlc_module->get_module_wait_queue(), {});
 
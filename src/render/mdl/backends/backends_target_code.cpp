@@ -131,6 +131,8 @@ Target_code::Target_code()
     , m_string_args_mapped_to_ids(true)
     , m_use_builtin_resource_handler(false)
 {
+    for (size_t i = 0; i <= mi::mdl::IGenerated_code_executable::CP_LAST; ++i)
+        m_compile_phase_times[i] = 0.0;
 }
 
 // Constructor from executable code.
@@ -191,6 +193,10 @@ void Target_code::finalize(
         code->get_interface<mi::mdl::IGenerated_code_lambda_function>());
     m_render_state_usage = code->get_state_usage();
 
+    for (size_t i = 0; i <= mi::mdl::IGenerated_code_executable::CP_LAST; ++i)
+        m_compile_phase_times[i] = code->get_compile_phase_time(
+            mi::mdl::IGenerated_code_executable::Compile_phase(i));
+
     if (m_native_code.is_valid_interface()) {
         if(m_use_builtin_resource_handler)
             m_rh = new MDLRT::Resource_handler(use_derivatives);
@@ -686,6 +692,68 @@ mi::Sint32 Target_code::execute_environment(
         tex_handler) ? 0 : -1;
 }
 
+mi::Sint32 Target_code::execute_multi(
+    mi::Size index,
+    mi::Size count,
+    const mi::neuraylib::Shading_state_material* states,
+    mi::neuraylib::Texture_handler_base* tex_handler,
+    const mi::neuraylib::ITarget_argument_block *cap_args,
+    void* results,
+    mi::Size result_stride) const
+{
+    if (!m_native_code.is_valid_interface()) return -2;
+    if (index >= m_callable_function_infos.size()) return -2;
+    if (m_callable_function_infos[index].m_dist_kind != mi::neuraylib::ITarget_code::DK_NONE)
+        return -2;
+    if (m_callable_function_infos[index].m_kind != mi::neuraylib::ITarget_code::FK_LAMBDA)
+        return -2;
+
+    const char *args_data = NULL;
+    if (cap_args != NULL)
+        args_data = cap_args->get_data();
+    else
+    {
+        mi::Size block_index = get_callable_function_argument_block_index(index);
+        if (block_index != mi::Size(~0) &&
+            block_index < m_cap_arg_blocks.size() &&
+            m_cap_arg_blocks[block_index])
+        {
+            args_data = m_cap_arg_blocks[block_index]->get_data();
+        }
+    }
+
+    return m_native_code->run_generic_multi(
+        index,
+        count,
+        results,
+        result_stride,
+        // ugly cast necessary because the C++ I/F cannot handle the layout options
+        reinterpret_cast<const mi::mdl::Shading_state_material*>(states),
+        tex_handler,
+        args_data) ? 0 : -1;
+}
+
+mi::Sint32 Target_code::execute_environment_multi(
+    mi::Size index,
+    mi::Size count,
+    const mi::neuraylib::Shading_state_environment* states,
+    mi::neuraylib::Texture_handler_base* tex_handler,
+    mi::Spectrum_struct* results) const
+{
+    if (!m_native_code.is_valid_interface()) return -2;
+    if (index >= m_callable_function_infos.size()) return -2;
+    if (m_callable_function_infos[index].m_kind != FK_ENVIRONMENT) return -2;
+
+    return m_native_code->run_environment_multi(
+        index,
+        count,
+        // ugly cast necessary because the libmdl I/F uses RGB_color*
+        reinterpret_cast<mi::mdl::RGB_color*>(results),
+        // ugly cast necessary because the C++ I/F cannot handle the layout options
+        reinterpret_cast<const mi::mdl::Shading_state_environment*>(states),
+        tex_handler) ? 0 : -1;
+}
+
 mi::Sint32 Target_code::execute_bsdf_init(
     mi::Size index,
     mi::neuraylib::Shading_state_material& state,
@@ -1093,6 +1161,24 @@ mi::Uint32 Target_code::get_string_index(char const* string) const
     return 0u;
 }
 
+// Returns the time in seconds spent in a compilation phase while this code was generated.
+mi::Float64 Target_code::get_compile_phase_time(
+    mi::neuraylib::ITarget_code::Compile_phase phase) const
+{
+    static_assert(
+        int(mi::neuraylib::ITarget_code::CP_DAG_TO_LLVM) ==
+            int(mi::mdl::IGenerated_code_executable::CP_DAG_TO_LLVM) &&
+        int(mi::neuraylib::ITarget_code::CP_CACHE_LOOKUP) ==
+            int(mi::mdl::IGenerated_code_executable::CP_CACHE_LOOKUP) &&
+        int(mi::mdl::IGenerated_code_executable::CP_CACHE_LOOKUP) ==
+            int(mi::mdl::IGenerated_code_executable::CP_LAST),
+        "API and compiler compilation phases do not match");
+
+    if (size_t(phase) > mi::mdl::IGenerated_code_executable::CP_LAST)
+        return 0.0;
+    return m_compile_phase_times[phase];
+}
+
 const mi::Float32* Target_code::get_df_data_texture(
     mi::mdl::IValue_texture::Bsdf_data_kind kind,
     mi::Size &rx,
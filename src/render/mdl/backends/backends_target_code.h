@@ -129,8 +129,63 @@ public:
         MI::SERIAL::Deserializer* deserializer) override;
 };
 
+/// Internal interface of #Target_code to run native code for several states in one call.
+///
+/// Query it via get_interface() from an #mi::neuraylib::ITarget_code. The states are processed
+/// one after the other by the scalar generated code, only the function lookup, the captured
+/// arguments and the runtime exception handling are set up once per call.
+class ITarget_code_multi_execution : public
+    mi::base::Interface_declare<0x6814024c,0x4ff8,0x40ec,0x82,0xca,0xc1,0xd3,0x2f,0x45,0x8f,0x91>
+{
+public:
+    /// Run this code on the native CPU for several states.
+    ///
+    /// Equivalent to calling #mi::neuraylib::ITarget_code::execute() for each state.
+    ///
+    /// \param[in]  index          The index of the callable function.
+    /// \param[in]  count          The number of states.
+    /// \param[in]  states         An array of \p count core states.
+    /// \param[in]  tex_handler    Texture handler containing the vtable for the user-defined
+    ///                            texture lookup functions. Can be NULL if the built-in resource
+    ///                            handler is used.
+    /// \param[in]  cap_args       The captured arguments to use for the execution.
+    ///                            If \p cap_args is \c NULL, the captured arguments of this
+    ///                            \c ITarget_code object will be used, if any.
+    /// \param[out] results        The results will be written to, one per state.
+    /// \param[in]  result_stride  The distance in bytes between two consecutive results.
+    /// \return                    See #mi::neuraylib::ITarget_code::execute().
+    virtual mi::Sint32 execute_multi(
+        mi::Size index,
+        mi::Size count,
+        const mi::neuraylib::Shading_state_material* states,
+        mi::neuraylib::Texture_handler_base* tex_handler,
+        const mi::neuraylib::ITarget_argument_block *cap_args,
+        void* results,
+        mi::Size result_stride) const = 0;
+
+    /// Run this environment code on the native CPU for several states.
+    ///
+    /// Equivalent to calling #mi::neuraylib::ITarget_code::execute_environment() for each state.
+    ///
+    /// \param[in]  index       The index of the callable function.
+    /// \param[in]  count       The number of states.
+    /// \param[in]  states      An array of \p count environment states.
+    /// \param[in]  tex_handler Texture handler containing the vtable for the user-defined
+    ///                         texture lookup functions. Can be NULL if the built-in resource
+    ///                         handler is used.
+    /// \param[out] results     An array of \p count results.
+    /// \return                 See #mi::neuraylib::ITarget_code::execute_environment().
+    virtual mi::Sint32 execute_environment_multi(
+        mi::Size index,
+        mi::Size count,
+        const mi::neuraylib::Shading_state_environment* states,
+        mi::neuraylib::Texture_handler_base* tex_handler,
+        mi::Spectrum_struct* results) const = 0;
+};
+
 /// Implementation of #mi::neuraylib::ITarget_code.
-class Target_code : public mi::base::Interface_implement<mi::neuraylib::ITarget_code>
+class Target_code
+  : public mi::base::Interface_implement_2<mi::neuraylib::ITarget_code, ITarget_code_multi_execution>
 {
 public:
 
@@ -745,6 +800,27 @@ public:
         mi::neuraylib::Texture_handler_base* tex_handler,
         const mi::neuraylib::ITarget_argument_block *cap_args) const override;
 
+    mi::Float64 get_compile_phase_time(
+        mi::neuraylib::ITarget_code::Compile_phase phase) const override;
+
+    // methods of ITarget_code_multi_execution
+
+    mi::Sint32 execute_multi(
+        mi::Size index,
+        mi::Size count,
+        const mi::neuraylib::Shading_state_material* states,
+        mi::neuraylib::Texture_handler_base* tex_handler,
+        const mi::neuraylib::ITarget_argument_block *cap_args,
+        void* results,
+        mi::Size result_stride) const override;
+
+    mi::Sint32 execute_environment_multi(
+        mi::Size index,
+        mi::Size count,
+        const mi::neuraylib::Shading_state_environment* states,
+        mi::neuraylib::Texture_handler_base* tex_handler,
+        mi::Spectrum_struct* results) const override;
+
     // non-API methods.
 
     /// Adds a new callable function to this target code.
@@ -1164,6 +1240,9 @@ private:
 
     /// True, if the builtin resource handler is supposed to be used when running native code
     bool m_use_builtin_resource_handler;
+
+    /// The time in seconds spent in each compilation phase.
+    mi::Float64 m_compile_phase_times[mi::mdl::IGenerated_code_executable::CP_LAST + 1];
 };
 
 } // namespace BACKENDS
@@ -57,6 +57,9 @@ public:
 
     bool is_valid() const { return m_bsdf_measurement->is_valid(); }
 
+    // Returns the size of the evaluation and sampling data owned by this object.
+    size_t get_memory_usage() const;
+
     mi::Uint32_3 get_resolution(Mbsdf_part part) const;
 
     mi::Float32_3 evaluate(const mi::Float32_2& theta_phi_in,
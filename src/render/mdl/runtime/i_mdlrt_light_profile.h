@@ -60,6 +60,9 @@ public:
 
     bool is_valid() const { return m_light_profile->is_valid(); }
 
+    // Returns the size of the sampling data owned by this object.
+    size_t get_memory_usage() const;
+
     mi::Float32 evaluate(const mi::Float32_2& theta_phi) const;
     mi::Float32_3 sample(const mi::Float32_3& xi) const;
     mi::Float32 pdf(const mi::Float32_2& theta_phi) const;
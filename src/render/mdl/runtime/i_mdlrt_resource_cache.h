@@ -0,0 +1,164 @@
+/***************************************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************************************/
+///
+/// \file
+/// \brief Process-wide cache of prepared runtime resources shared by native target codes
+///
+
+#ifndef RENDER_MDL_RUNTIME_I_MDLRT_RESOURCE_CACHE_H
+#define RENDER_MDL_RUNTIME_I_MDLRT_RESOURCE_CACHE_H
+
+#include <mi/mdl/mdl_types.h>
+#include <mi/mdl/mdl_values.h>
+
+#include <base/data/db/i_db_tag.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace MI {
+
+namespace DB { class Transaction; }
+
+namespace MDLRT {
+
+class Bsdf_measurement;
+class Light_profile;
+class Texture;
+
+/// Cache of prepared runtime resources (textures, light profiles, BSDF measurements).
+///
+/// Preparing a resource for the native backend can be expensive, e.g., 2D textures are converted
+/// to linear gamma and get a full mipmap chain if derivatives are enabled. This cache shares the
+/// prepared objects between all resource handlers in the process. Entries are keyed by the kind
+/// of the resource, the tag versions of the involved DB elements, the gamma mode, and the
+/// derivative mode.
+///
+/// Entries are reference-counted: the cache itself holds only weak references, i.e., a prepared
+/// object is destroyed as soon as the last resource handler using it releases it. The cache keeps
+/// track of the memory used by all live entries.
+class Resource_cache
+{
+public:
+    /// Statistics of the cache.
+    struct Statistics
+    {
+        size_t m_entries = 0;  ///< Number of live entries.
+        size_t m_memory = 0;   ///< Memory used by the data of all live entries (in bytes).
+        size_t m_hits = 0;     ///< Number of requests answered from the cache.
+        size_t m_misses = 0;   ///< Number of requests that prepared a new object.
+    };
+
+    /// Returns the process-wide instance.
+    static Resource_cache& get_instance();
+
+    /// Returns the prepared texture for the given texture tag.
+    ///
+    /// \param shape            The texture shape. Determines the runtime type of the result.
+    /// \param tag              The tag of the texture.
+    /// \param gamma            The MDL declared gamma mode of the texture.
+    /// \param use_derivatives  Indicates whether derivatives are used (2D textures only).
+    /// \param transaction      The transaction used to access the texture. Without transaction
+    ///                         the cache is bypassed.
+    std::shared_ptr<const Texture> get_texture(
+        mi::mdl::IType_texture::Shape shape,
+        DB::Tag tag,
+        mi::mdl::IValue_texture::gamma_mode gamma,
+        bool use_derivatives,
+        DB::Transaction* transaction);
+
+    /// Returns the prepared light profile for the given light profile tag.
+    std::shared_ptr<const Light_profile> get_light_profile(
+        DB::Tag tag, DB::Transaction* transaction);
+
+    /// Returns the prepared BSDF measurement for the given BSDF measurement tag.
+    std::shared_ptr<const Bsdf_measurement> get_bsdf_measurement(
+        DB::Tag tag, DB::Transaction* transaction);
+
+    /// Returns the statistics of the cache.
+    void get_statistics( Statistics& statistics) const;
+
+private:
+    /// The kind of resources in the cache key. Texture shapes map to their shape value.
+    enum Kind {
+        KIND_LIGHT_PROFILE = mi::mdl::IType_texture::TS_BSDF_DATA + 1,
+        KIND_BSDF_MEASUREMENT
+    };
+
+    /// The cache key.
+    struct Key
+    {
+        int m_kind;                      ///< Texture shape or #Kind.
+        DB::Tag_version m_versions[3];   ///< Tag versions of the resource and its image/impl.
+        int m_gamma;                     ///< Gamma mode (textures only).
+        bool m_use_derivatives;          ///< Derivative mode (2D textures only).
+
+        bool operator<( const Key& other) const;
+    };
+
+    /// An entry of the cache.
+    struct Entry
+    {
+        std::weak_ptr<const void> m_object; ///< The prepared object.
+        const void* m_address = nullptr;    ///< Address of the prepared object.
+    };
+
+    /// Returns the object for \p key, or creates it via \p create.
+    ///
+    /// \param key        The key, or \c nullptr to bypass the cache.
+    /// \param create     Creates the prepared object and returns it together with its memory usage.
+    template <typename T>
+    std::shared_ptr<const T> get(
+        const Key* key, const std::function<std::pair<T*, size_t>()>& create);
+
+    /// Called when the last reference to \p object is released.
+    ///
+    /// Removes the entry for \p key unless it was already replaced by a newer object.
+    void release( const Key& key, const void* object, size_t memory);
+
+    /// Weak pointer to the instance itself. The deleters of the prepared objects hold strong
+    /// references such that the cache outlives all of them.
+    std::weak_ptr<Resource_cache> m_self;
+
+    /// Protects all members below.
+    mutable std::mutex m_mutex;
+
+    /// The entries.
+    std::map<Key, Entry> m_entries;
+
+    /// The statistics (except for the number of entries).
+    Statistics m_statistics;
+};
+
+} // namespace MDLRT
+
+} // namespace MI
+
+#endif // RENDER_MDL_RUNTIME_I_MDLRT_RESOURCE_CACHE_H
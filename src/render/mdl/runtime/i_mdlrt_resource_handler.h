@@ -80,6 +80,12 @@ public:
         void                          *data,
         mi::mdl::IType_texture::Shape shape) override;
 
+    /// Get the flat representation of a 2D texture for inline sampling.
+    ///
+    /// \param tex_data  the read-only shared texture data pointer
+    Native_texture_2d const *tex_native_2d(
+        void const    *tex_data) const override;
+
     /// Handle tex::width(texture_2d, int2, float) and tex::height(texture_2d, int2, float)
     void tex_resolution_2d(
         int           result[2],
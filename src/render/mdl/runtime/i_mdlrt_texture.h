@@ -33,6 +33,7 @@
 #define RENDER_MDL_RUNTIME_I_MDLRT_TEXTURE_H
 
 #include <mi/neuraylib/typedefs.h>
+#include <mi/mdl/mdl_generated_executable.h>
 #include <mi/mdl/mdl_stdlib_types.h>
 
 #include <io/scene/texture/i_texture.h>
@@ -40,6 +41,7 @@
 #include <io/image/image/i_image_access_canvas.h>
 
 #include <map>
+#include <mutex>
 #include <vector>
 
 namespace MI {
@@ -84,6 +86,10 @@ public:
         bool use_derivatives,
         DB::Transaction* transaction);
 
+    // Returns the size of the pixel data referenced by this texture (all frames, uvtiles, and
+    // mipmap levels).
+    size_t get_memory_usage() const;
+
     mi::Uint32_2 get_resolution(const mi::Sint32_2& uv_tile, mi::Float32 frame) const;
 
     float lookup_float(
@@ -147,6 +153,11 @@ public:
     mi::Spectrum texel_color(
         const mi::Sint32_2& coord, const mi::Sint32_2& uv_tile, mi::Float32 frame) const;
 
+    // Returns the flat RGBA float mip pyramid sampled inline by JIT compiled code, or \c nullptr
+    // for invalid, animated, and uvtile textures. The pyramid is created on first use. It holds a
+    // float4 copy of every texel of every mip level in addition to the canvases.
+    const mi::mdl::IResource_handler::Native_texture_2d* get_native_texture() const;
+
 private:
     // Used to implement lookup_float4(). Frame/UV IDs as parameters.
     mi::Float32_4 lookup_float4_frame(
@@ -190,6 +201,12 @@ private:
     };
 
     std::vector<Frame> m_frames;
+
+    // The flat representation returned by get_native_texture(), created on first use.
+    mutable std::once_flag m_native_once;
+    mutable std::vector<std::vector<float>> m_native_texels;
+    mutable std::vector<mi::mdl::IResource_handler::Native_texture_level> m_native_levels;
+    mutable mi::mdl::IResource_handler::Native_texture_2d m_native_texture{nullptr, 0, 1.0f};
 };
 
 // Textures with uvtiles are treated as invalid textures.
@@ -200,6 +217,9 @@ public:
         const DB::Typed_tag<TEXTURE::Texture>& tag,
         DB::Transaction* transaction);
 
+    // Returns the size of the pixel data referenced by this texture (all frames).
+    size_t get_memory_usage() const;
+
     mi::Uint32_3 get_resolution(mi::Float32 frame) const;
 
     float lookup_float(
@@ -277,6 +297,9 @@ public:
         const DB::Typed_tag<TEXTURE::Texture>& tag,
         DB::Transaction* transaction);
 
+    // Returns the size of the pixel data referenced by this texture.
+    size_t get_memory_usage() const;
+
     float lookup_float(const mi::Float32_3& coord) const;
     mi::Float32_2 lookup_float2(const mi::Float32_3& coord) const;
     mi::Float32_3 lookup_float3(const mi::Float32_3& coord) const;
@@ -297,6 +320,8 @@ public:
         const DB::Typed_tag<TEXTURE::Texture>& tag,
         DB::Transaction* transaction);
 
+    size_t get_memory_usage() const { return 0; }
+
     float lookup_float(int channel) const;
     mi::Float32_2 lookup_float2(int channel) const;
     mi::Float32_3 lookup_float3(int channel) const;
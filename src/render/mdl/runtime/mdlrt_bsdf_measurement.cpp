@@ -92,6 +92,23 @@ Bsdf_measurement::~Bsdf_measurement()
     }
 }
 
+size_t Bsdf_measurement::get_memory_usage() const
+{
+    size_t size = 0;
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        if (m_has_data[i] != 1u)
+            continue;
+
+        const mi::Uint32_2& res = m_angular_resolution[i];
+        const size_t cdf_theta_size = size_t(res.x) * res.x;
+        size += cdf_theta_size + cdf_theta_size * res.y;            // sample data
+        size += res.x;                                              // albedo data
+        size += size_t(m_num_channels[i]) * res.y * res.x * res.x;  // evaluation data
+    }
+    return size * sizeof(float);
+}
+
 void Bsdf_measurement::prepare_mbsdfs_part(Mbsdf_part part, 
                                            const mi::neuraylib::IBsdf_isotropic_data* dataset)
 {
@@ -134,6 +134,13 @@ Light_profile::~Light_profile()
         delete[] m_cdf_data;
 }
 
+size_t Light_profile::get_memory_usage() const
+{
+    if (!m_cdf_data)
+        return 0;
+    return ((m_res_t - 1) + (m_res_t - 1) * (m_res_p - 1)) * sizeof(float);
+}
+
 
 inline float lerp(float a, float b, float t)
 {
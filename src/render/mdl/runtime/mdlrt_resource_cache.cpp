@@ -0,0 +1,234 @@
+/***************************************************************************************************
+ * Copyright (c) 2024, NVIDIA CORPORATION. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *  * Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  * Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *  * Neither the name of NVIDIA CORPORATION nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS ``AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ * OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ **************************************************************************************************/
+///
+/// \file
+/// \brief Process-wide cache of prepared runtime resources shared by native target codes
+///
+
+#include "pch.h"
+#include "i_mdlrt_resource_cache.h"
+
+#include <render/mdl/runtime/i_mdlrt_texture.h>
+#include <render/mdl/runtime/i_mdlrt_light_profile.h>
+#include <render/mdl/runtime/i_mdlrt_bsdf_measurement.h>
+
+#include <base/data/db/i_db_access.h>
+#include <base/data/db/i_db_transaction.h>
+#include <io/scene/bsdf_measurement/i_bsdf_measurement.h>
+#include <io/scene/dbimage/i_dbimage.h>
+#include <io/scene/lightprofile/i_lightprofile.h>
+#include <io/scene/texture/i_texture.h>
+
+#include <tuple>
+
+namespace MI {
+namespace MDLRT {
+
+bool Resource_cache::Key::operator<(const Key& other) const
+{
+    return std::tie(
+            m_kind, m_versions[0], m_versions[1], m_versions[2], m_gamma, m_use_derivatives)
+        < std::tie(
+            other.m_kind, other.m_versions[0], other.m_versions[1], other.m_versions[2],
+            other.m_gamma, other.m_use_derivatives);
+}
+
+Resource_cache& Resource_cache::get_instance()
+{
+    static std::shared_ptr<Resource_cache> s_instance = []() {
+        std::shared_ptr<Resource_cache> instance(new Resource_cache);
+        instance->m_self = instance;
+        return instance;
+    }();
+    return *s_instance;
+}
+
+std::shared_ptr<const Texture> Resource_cache::get_texture(
+    mi::mdl::IType_texture::Shape       shape,
+    DB::Tag                             tag,
+    mi::mdl::IValue_texture::gamma_mode gamma,
+    bool                                use_derivatives,
+    DB::Transaction                    *transaction)
+{
+    // Derivatives are only relevant for 2D textures.
+    if (shape != mi::mdl::IType_texture::TS_2D)
+        use_derivatives = false;
+
+    // The prepared texture depends on the texture, its image, and the pixel data of the image.
+    Key key{shape, {}, gamma, use_derivatives};
+    if (transaction && tag) {
+        key.m_versions[0] = transaction->get_tag_version(tag);
+        DB::Access<TEXTURE::Texture> texture(tag, transaction);
+        DB::Tag image_tag = texture->get_image();
+        if (image_tag) {
+            key.m_versions[1] = transaction->get_tag_version(image_tag);
+            DB::Access<DBIMAGE::Image> image(image_tag, transaction);
+            DB::Tag impl_tag = image->get_impl_tag();
+            if (impl_tag)
+                key.m_versions[2] = transaction->get_tag_version(impl_tag);
+        }
+    }
+    const Key* key_ptr = transaction ? &key : nullptr;
+
+    DB::Typed_tag<TEXTURE::Texture> typed_tag(tag);
+
+    switch (shape) {
+    case mi::mdl::IType_texture::TS_2D:
+        return get<Texture_2d>(key_ptr, [&]() {
+            Texture_2d *o = new Texture_2d(typed_tag, use_derivatives, transaction);
+            return std::make_pair(o, o->get_memory_usage());
+        });
+    case mi::mdl::IType_texture::TS_3D:
+    case mi::mdl::IType_texture::TS_BSDF_DATA:
+        // handle BSDF data like 3D texture
+        return get<Texture_3d>(key_ptr, [&]() {
+            Texture_3d *o = new Texture_3d(typed_tag, transaction);
+            return std::make_pair(o, o->get_memory_usage());
+        });
+    case mi::mdl::IType_texture::TS_CUBE:
+        return get<Texture_cube>(key_ptr, [&]() {
+            Texture_cube *o = new Texture_cube(typed_tag, transaction);
+            return std::make_pair(o, o->get_memory_usage());
+        });
+    case mi::mdl::IType_texture::TS_PTEX:
+        return get<Texture_ptex>(key_ptr, [&]() {
+            Texture_ptex *o = new Texture_ptex(typed_tag, transaction);
+            return std::make_pair(o, o->get_memory_usage());
+        });
+    }
+
+    ASSERT(M_BACKENDS, !"unexpected texture shape");
+    return nullptr;
+}
+
+std::shared_ptr<const Light_profile> Resource_cache::get_light_profile(
+    DB::Tag          tag,
+    DB::Transaction *transaction)
+{
+    Key key{KIND_LIGHT_PROFILE, {}, 0, false};
+    if (transaction && tag) {
+        key.m_versions[0] = transaction->get_tag_version(tag);
+        DB::Access<LIGHTPROFILE::Lightprofile> light_profile(tag, transaction);
+        DB::Tag impl_tag = light_profile->get_impl_tag();
+        if (impl_tag)
+            key.m_versions[1] = transaction->get_tag_version(impl_tag);
+    }
+
+    DB::Typed_tag<LIGHTPROFILE::Lightprofile> typed_tag(tag);
+    return get<Light_profile>(transaction ? &key : nullptr, [&]() {
+        Light_profile *o = new Light_profile(typed_tag, transaction);
+        return std::make_pair(o, o->get_memory_usage());
+    });
+}
+
+std::shared_ptr<const Bsdf_measurement> Resource_cache::get_bsdf_measurement(
+    DB::Tag          tag,
+    DB::Transaction *transaction)
+{
+    Key key{KIND_BSDF_MEASUREMENT, {}, 0, false};
+    if (transaction && tag) {
+        key.m_versions[0] = transaction->get_tag_version(tag);
+        DB::Access<BSDFM::Bsdf_measurement> bsdf_measurement(tag, transaction);
+        DB::Tag impl_tag = bsdf_measurement->get_impl_tag();
+        if (impl_tag)
+            key.m_versions[1] = transaction->get_tag_version(impl_tag);
+    }
+
+    DB::Typed_tag<BSDFM::Bsdf_measurement> typed_tag(tag);
+    return get<Bsdf_measurement>(transaction ? &key : nullptr, [&]() {
+        Bsdf_measurement *o = new Bsdf_measurement(typed_tag, transaction);
+        return std::make_pair(o, o->get_memory_usage());
+    });
+}
+
+void Resource_cache::get_statistics(Statistics& statistics) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    statistics = m_statistics;
+    statistics.m_entries = m_entries.size();
+}
+
+template <typename T>
+std::shared_ptr<const T> Resource_cache::get(
+    const Key* key, const std::function<std::pair<T*, size_t>()>& create)
+{
+    if (!key) {
+        std::pair<T*, size_t> created = create();
+        return std::shared_ptr<const T>(created.first);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(*key);
+        if (it != m_entries.end()) {
+            std::shared_ptr<const void> object = it->second.m_object.lock();
+            if (object) {
+                ++m_statistics.m_hits;
+                return std::static_pointer_cast<const T>(object);
+            }
+        }
+    }
+
+    // Prepare the object without holding the lock. Concurrent requests for the same key might
+    // prepare it twice, but only the first one is kept.
+    std::pair<T*, size_t> created = create();
+    std::shared_ptr<Resource_cache> self = m_self.lock();
+    const Key key_copy = *key;
+    const size_t memory = created.second;
+    std::shared_ptr<const T> result(created.first, [self, key_copy, memory](const T *o) {
+        self->release(key_copy, o, memory);
+        delete o;
+    });
+
+    // Note that the lock is released before a superfluous result is destroyed.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics.m_memory += memory;
+    ++m_statistics.m_misses;
+
+    Entry& entry = m_entries[*key];
+    std::shared_ptr<const void> existing = entry.m_object.lock();
+    if (existing)
+        return std::static_pointer_cast<const T>(existing);
+
+    entry.m_object = result;
+    entry.m_address = result.get();
+    return result;
+}
+
+void Resource_cache::release(const Key& key, const void* object, size_t memory)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_statistics.m_memory -= memory;
+
+    auto it = m_entries.find(key);
+    if (it != m_entries.end() && it->second.m_address == object)
+        m_entries.erase(it);
+}
+
+}  // MDLRT
+}  // MI
@@ -36,23 +36,49 @@
 #include <render/mdl/runtime/i_mdlrt_texture.h>
 #include <render/mdl/runtime/i_mdlrt_light_profile.h>
 #include <render/mdl/runtime/i_mdlrt_bsdf_measurement.h>
+#include <render/mdl/runtime/i_mdlrt_resource_cache.h>
+
+#include <memory>
 
 namespace MI {
 namespace MDLRT {
 
+namespace {
+
+// The resource data objects only hold references to the prepared objects owned by the
+// process-wide Resource_cache.
+typedef std::shared_ptr<const Texture>          Texture_ref;
+typedef std::shared_ptr<const Light_profile>    Light_profile_ref;
+typedef std::shared_ptr<const Bsdf_measurement> Bsdf_measurement_ref;
+
+// Returns the texture referenced by the resource data object.
+template <typename T>
+T const *get_texture(void const *tex_data)
+{
+    return static_cast<T const *>(reinterpret_cast<Texture_ref const *>(tex_data)->get());
+}
+
+// Returns the light profile referenced by the resource data object.
+Light_profile const *get_light_profile(void const *lp_data)
+{
+    return reinterpret_cast<Light_profile_ref const *>(lp_data)->get();
+}
+
+// Returns the bsdf measurement referenced by the resource data object.
+Bsdf_measurement const *get_bsdf_measurement(void const *bm_data)
+{
+    return reinterpret_cast<Bsdf_measurement_ref const *>(bm_data)->get();
+}
+
+} // namespace
+
 size_t Resource_handler::get_data_size() const
 {
-    size_t size = sizeof(Texture_2d);
-    if (size < sizeof(Texture_3d))
-        size = sizeof(Texture_3d);
-    if (size < sizeof(Texture_cube))
-        size = sizeof(Texture_cube);
-    if (size < sizeof(Texture_ptex))
-        size = sizeof(Texture_ptex);
-    if (size < sizeof(Light_profile))
-        size = sizeof(Light_profile);
-    if (size < sizeof(Bsdf_measurement))
-        size = sizeof(Bsdf_measurement);
+    size_t size = sizeof(Texture_ref);
+    if (size < sizeof(Light_profile_ref))
+        size = sizeof(Light_profile_ref);
+    if (size < sizeof(Bsdf_measurement_ref))
+        size = sizeof(Bsdf_measurement_ref);
     return size;
 }
 
@@ -63,66 +89,23 @@ void Resource_handler::tex_init(
     mi::mdl::IValue_texture::gamma_mode gamma,
     void                               *ctx)
 {
-    DB::Tag                         tag(tag_v);
-    DB::Typed_tag<TEXTURE::Texture> typed_tag(tag);
-
-    switch (shape) {
-    case mi::mdl::IType_texture::TS_2D:
-        new (data) Texture_2d(typed_tag, m_use_derivatives, (DB::Transaction *)ctx);
-        break;
-    case mi::mdl::IType_texture::TS_3D:
-        new (data) Texture_3d(typed_tag, (DB::Transaction *)ctx);
-        break;
-    case mi::mdl::IType_texture::TS_CUBE:
-        new (data) Texture_cube(typed_tag, (DB::Transaction *)ctx);
-        break;
-    case mi::mdl::IType_texture::TS_PTEX:
-        new (data) Texture_ptex(typed_tag, (DB::Transaction *)ctx);
-        break;
-    case mi::mdl::IType_texture::TS_BSDF_DATA:
-        // handle like 3D texture
-        new (data) Texture_3d(typed_tag, (DB::Transaction *)ctx);
-        break;
-    }
+    new (data) Texture_ref(Resource_cache::get_instance().get_texture(
+        shape, DB::Tag(tag_v), gamma, m_use_derivatives, (DB::Transaction *)ctx));
 }
 
 void Resource_handler::tex_term(
     void                          *data,
-    mi::mdl::IType_texture::Shape shape)
-{
-    switch (shape) {
-    case mi::mdl::IType_texture::TS_2D:
-        {
-            Texture_2d *o = reinterpret_cast<Texture_2d *>(data);
-            o->~Texture_2d();
-            break;
-        }
-    case mi::mdl::IType_texture::TS_3D:
-        {
-            Texture_3d *o = reinterpret_cast<Texture_3d *>(data);
-            o->~Texture_3d();
-            break;
-        }
-    case mi::mdl::IType_texture::TS_CUBE:
-        {
-            Texture_cube *o = reinterpret_cast<Texture_cube *>(data);
-            o->~Texture_cube();
-            break;
-        }
-    case mi::mdl::IType_texture::TS_PTEX:
-        {
-            Texture_ptex *o = reinterpret_cast<Texture_ptex *>(data);
-            o->~Texture_ptex();
-            break;
-        }
-    case mi::mdl::IType_texture::TS_BSDF_DATA:
-        {
-            // handle like 3D texture
-            Texture_3d *o = reinterpret_cast<Texture_3d *>(data);
-            o->~Texture_3d();
-            break;
-        }
-    }
+    mi::mdl::IType_texture::Shape /*shape*/)
+{
+    Texture_ref *o = reinterpret_cast<Texture_ref *>(data);
+    o->~Texture_ref();
+}
+
+mi::mdl::IResource_handler::Native_texture_2d const *Resource_handler::tex_native_2d(
+    void const    *tex_data) const
+{
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
+    return o ? o->get_native_texture() : nullptr;
 }
 
 void Resource_handler::tex_resolution_2d(
@@ -131,7 +114,7 @@ void Resource_handler::tex_resolution_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
     mi::Uint32_2 res = o->get_resolution(*reinterpret_cast<mi::Sint32_2 const *>(uv_tile), frame);
     result[0] = res.x;
     result[1] = res.y;
@@ -142,7 +125,7 @@ void Resource_handler::tex_resolution_3d(
     void const    *tex_data,
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
     mi::Uint32_3 res = o->get_resolution(frame);
     result[0] = res.x;
     result[1] = res.y;
@@ -159,7 +142,7 @@ float Resource_handler::tex_lookup_float_2d(
     float const   crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     return o->lookup_float(
         *reinterpret_cast<mi::Float32_2 const *>(coord),
@@ -180,7 +163,7 @@ float Resource_handler::tex_lookup_deriv_float_2d(
     float const        crop_v[2],
     float              frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     return o->lookup_deriv_float4(
         *reinterpret_cast<mi::Float32_2 const *>(coord->val),
@@ -205,7 +188,7 @@ float Resource_handler::tex_lookup_float_3d(
     float const   crop_w[2],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     return o->lookup_float(
         *reinterpret_cast<mi::Float32_3 const *>(coord),
@@ -223,7 +206,7 @@ float Resource_handler::tex_lookup_float_cube(
     void          * /*thread_data*/,
     float const   coord[3]) const
 {
-    Texture_cube const *o = reinterpret_cast<Texture_cube const *>(tex_data);
+    Texture_cube const *o = get_texture<Texture_cube>(tex_data);
 
     return o->lookup_float(*reinterpret_cast<mi::Float32_3 const *>(coord));
 }
@@ -233,7 +216,7 @@ float Resource_handler::tex_lookup_float_ptex(
     void          * /*thread_data*/,
     int           channel) const
 {
-    Texture_ptex const *o = reinterpret_cast<Texture_ptex const *>(tex_data);
+    Texture_ptex const *o = get_texture<Texture_ptex>(tex_data);
 
     return o->lookup_float(channel);
 }
@@ -249,7 +232,7 @@ void Resource_handler::tex_lookup_float2_2d(
     float const   crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) =
         o->lookup_float2(
@@ -272,7 +255,7 @@ void Resource_handler::tex_lookup_deriv_float2_2d(
     float const        crop_v[2],
     float              frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     mi::Float32_4 res = o->lookup_deriv_float4(
         *reinterpret_cast<mi::Float32_2 const *>(coord->val),
@@ -301,7 +284,7 @@ void Resource_handler::tex_lookup_float2_3d(
     float const   crop_w[2],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) =
         o->lookup_float2(
@@ -321,7 +304,7 @@ void Resource_handler::tex_lookup_float2_cube(
     void          * /*thread_data*/,
     float const   coord[3]) const
 {
-    Texture_cube const *o = reinterpret_cast<Texture_cube const *>(tex_data);
+    Texture_cube const *o = get_texture<Texture_cube>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) =
         o->lookup_float2(*reinterpret_cast<mi::Float32_3 const *>(coord));
@@ -333,7 +316,7 @@ void Resource_handler::tex_lookup_float2_ptex(
     void          * /*thread_data*/,
     int           channel) const
 {
-    Texture_ptex const *o = reinterpret_cast<Texture_ptex const *>(tex_data);
+    Texture_ptex const *o = get_texture<Texture_ptex>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) = o->lookup_float2(channel);
 }
@@ -349,7 +332,7 @@ void Resource_handler::tex_lookup_float3_2d(
     float const   crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->lookup_float3(
@@ -372,7 +355,7 @@ void Resource_handler::tex_lookup_deriv_float3_2d(
     float const        crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     mi::Float32_4 res = o->lookup_deriv_float4(
         *reinterpret_cast<mi::Float32_2 const *>(coord->val),
@@ -401,7 +384,7 @@ void Resource_handler::tex_lookup_float3_3d(
     float const   crop_w[2],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->lookup_float3(
@@ -421,7 +404,7 @@ void Resource_handler::tex_lookup_float3_cube(
     void          * /*thread_data*/,
     float const   coord[3]) const
 {
-    Texture_cube const *o = reinterpret_cast<Texture_cube const *>(tex_data);
+    Texture_cube const *o = get_texture<Texture_cube>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->lookup_float3(*reinterpret_cast<mi::Float32_3 const *>(coord));
@@ -433,7 +416,7 @@ void Resource_handler::tex_lookup_float3_ptex(
     void          * /*thread_data*/,
     int           channel) const
 {
-    Texture_ptex const *o = reinterpret_cast<Texture_ptex const *>(tex_data);
+    Texture_ptex const *o = get_texture<Texture_ptex>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) = o->lookup_float3(channel);
 }
@@ -450,7 +433,7 @@ void Resource_handler::tex_lookup_float4_2d(
     float const   crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->lookup_float4(
@@ -473,7 +456,7 @@ void Resource_handler::tex_lookup_deriv_float4_2d(
     float const        crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->lookup_deriv_float4(
@@ -500,7 +483,7 @@ void Resource_handler::tex_lookup_float4_3d(
     float const   crop_w[2],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->lookup_float4(
@@ -520,7 +503,7 @@ void Resource_handler::tex_lookup_float4_cube(
     void          * /*thread_data*/,
     float const   coord[3]) const
 {
-    Texture_cube const *o = reinterpret_cast<Texture_cube const *>(tex_data);
+    Texture_cube const *o = get_texture<Texture_cube>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->lookup_float4(*reinterpret_cast<mi::Float32_3 const *>(coord));
@@ -532,7 +515,7 @@ void Resource_handler::tex_lookup_float4_ptex(
     void          * /*thread_data*/,
     int           channel) const
 {
-    Texture_ptex const *o = reinterpret_cast<Texture_ptex const *>(tex_data);
+    Texture_ptex const *o = get_texture<Texture_ptex>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) = o->lookup_float4(channel);
 }
@@ -548,7 +531,7 @@ void Resource_handler::tex_lookup_color_2d(
     float const   crop_v[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) =
         o->lookup_color(
@@ -571,7 +554,7 @@ void Resource_handler::tex_lookup_deriv_color_2d(
     float const        crop_v[2],
     float              frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     mi::Float32_4 res = o->lookup_deriv_float4(
         *reinterpret_cast<mi::Float32_2 const *>(coord->val),
@@ -600,7 +583,7 @@ void Resource_handler::tex_lookup_color_3d(
     float const   crop_w[2],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) =
         o->lookup_color(
@@ -620,7 +603,7 @@ void Resource_handler::tex_lookup_color_cube(
     void          * /*thread_data*/,
     float const   coord[3]) const
 {
-    Texture_cube const *o = reinterpret_cast<Texture_cube const *>(tex_data);
+    Texture_cube const *o = get_texture<Texture_cube>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) =
         o->lookup_color(*reinterpret_cast<mi::Float32_3 const *>(coord)).to_vector3();
@@ -632,7 +615,7 @@ void Resource_handler::tex_lookup_color_ptex(
     void          * /*thread_data*/,
     int           channel) const
 {
-    Texture_ptex const*o = reinterpret_cast<Texture_ptex const*>(tex_data);
+    Texture_ptex const*o = get_texture<Texture_ptex>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) = o->lookup_color(channel).to_vector3();
 }
@@ -644,7 +627,7 @@ float Resource_handler::tex_texel_float_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const*o = reinterpret_cast<Texture_2d const*>(tex_data);
+    Texture_2d const*o = get_texture<Texture_2d>(tex_data);
 
     return o->texel_float(
         *reinterpret_cast<mi::Sint32_2 const *>(coord),
@@ -660,7 +643,7 @@ void Resource_handler::tex_texel_float2_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const*o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const*o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) =
         o->texel_float2(
@@ -677,7 +660,7 @@ void Resource_handler::tex_texel_float3_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const*o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const*o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->texel_float3(
@@ -694,7 +677,7 @@ void Resource_handler::tex_texel_float4_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->texel_float4(
@@ -711,7 +694,7 @@ void Resource_handler::tex_texel_color_2d(
     int const     uv_tile[2],
     float         frame) const
 {
-    Texture_2d const *o = reinterpret_cast<Texture_2d const *>(tex_data);
+    Texture_2d const *o = get_texture<Texture_2d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) =
         o->texel_color(
@@ -726,7 +709,7 @@ float Resource_handler::tex_texel_float_3d(
     int const     coord[3],
     float         frame) const
 {
-    Texture_3d const*o = reinterpret_cast<Texture_3d const*>(tex_data);
+    Texture_3d const*o = get_texture<Texture_3d>(tex_data);
 
     return o->texel_float(*reinterpret_cast<mi::Sint32_3 const *>(coord), frame);
 }
@@ -738,7 +721,7 @@ void Resource_handler::tex_texel_float2_3d(
     int const     coord[3],
     float         frame) const
 {
-    Texture_3d const*o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const*o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_2_struct*>(result) =
         o->texel_float2(*reinterpret_cast<mi::Sint32_3 const *>(coord), frame);
@@ -751,7 +734,7 @@ void Resource_handler::tex_texel_float3_3d(
     int const     coord[3],
     float         frame) const
 {
-    Texture_3d const*o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const*o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->texel_float3(*reinterpret_cast<mi::Sint32_3 const *>(coord), frame);
@@ -764,7 +747,7 @@ void Resource_handler::tex_texel_float4_3d(
     int const     coord[3],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->texel_float4(*reinterpret_cast<mi::Sint32_3 const *>(coord), frame);
@@ -777,7 +760,7 @@ void Resource_handler::tex_texel_color_3d(
     int const     coord[3],
     float         frame) const
 {
-    Texture_3d const *o = reinterpret_cast<Texture_3d const *>(tex_data);
+    Texture_3d const *o = get_texture<Texture_3d>(tex_data);
 
     *reinterpret_cast<mi::Float32_3*>(rgb) =
         o->texel_color(*reinterpret_cast<mi::Sint32_3 const *>(coord), frame).to_vector3();
@@ -786,7 +769,7 @@ void Resource_handler::tex_texel_color_3d(
 bool Resource_handler::tex_isvalid(
     void const *tex_data) const
 {
-    Texture const *o = reinterpret_cast<Texture const *>(tex_data);
+    Texture const *o = get_texture<Texture>(tex_data);
     return o->is_valid();
 }
 
@@ -794,7 +777,7 @@ void Resource_handler::tex_frame(
     int        result[2],
     void const *tex_data) const
 {
-    Texture const *o = reinterpret_cast<Texture const *>(tex_data);
+    Texture const *o = get_texture<Texture>(tex_data);
     const mi::Uint32_2& res = o->get_first_last_frame();
     result[0] = res.x;
     result[1] = res.y;
@@ -806,17 +789,15 @@ void Resource_handler::lp_init(
     unsigned tag_v,
     void     *ctx)
 {
-    DB::Tag                                   tag(tag_v);
-    DB::Typed_tag<LIGHTPROFILE::Lightprofile> typed_tag(tag);
-
-    new (data) Light_profile(typed_tag, (DB::Transaction *)ctx);
+    new (data) Light_profile_ref(Resource_cache::get_instance().get_light_profile(
+        DB::Tag(tag_v), (DB::Transaction *)ctx));
 }
 
 // Terminate a light profile data helper object.
 void Resource_handler::lp_term(void *data)
 {
-    Light_profile const *o = reinterpret_cast<Light_profile const *>(data);
-    o->~Light_profile();
+    Light_profile_ref *o = reinterpret_cast<Light_profile_ref *>(data);
+    o->~Light_profile_ref();
 }
 
 // Get the light profile power value.
@@ -825,7 +806,7 @@ float Resource_handler::lp_power(
     void       *thread_data) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
     return o->get_power();
 }
 
@@ -835,7 +816,7 @@ float Resource_handler::lp_maximum(
     void       *thread_data) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
     return o->get_maximum();
 }
 
@@ -843,7 +824,7 @@ bool Resource_handler::lp_isvalid(
     void const *lp_data) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
     return o->is_valid();
 }
 
@@ -855,7 +836,7 @@ float Resource_handler::lp_evaluate(
     const float   theta_phi[2]) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
 
     return o->evaluate(*reinterpret_cast<mi::Float32_2 const *>(theta_phi));
 }
@@ -868,7 +849,7 @@ void Resource_handler::lp_sample(
     const float   xi[3]) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->sample(*reinterpret_cast<mi::Float32_3 const *>(xi));
@@ -881,7 +862,7 @@ float Resource_handler::lp_pdf(
     const float   theta_phi[2]) const
 {
     Light_profile const *o =
-        reinterpret_cast<Light_profile const *>(lp_data);
+        get_light_profile(lp_data);
 
     return o->pdf(*reinterpret_cast<mi::Float32_2 const *>(theta_phi));
 }
@@ -893,25 +874,22 @@ void Resource_handler::bm_init(
     unsigned tag_v,
     void     *ctx)
 {
-    DB::Tag                                tag(tag_v);
-    DB::Typed_tag<BSDFM::Bsdf_measurement> typed_tag(tag);
-
-    new (data) Bsdf_measurement(typed_tag, (DB::Transaction *)ctx);
+    new (data) Bsdf_measurement_ref(Resource_cache::get_instance().get_bsdf_measurement(
+        DB::Tag(tag_v), (DB::Transaction *)ctx));
 }
 
 // Terminate a bsdf measurement data helper object.
 void Resource_handler::bm_term(void *data)
 {
-    Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(data);
-    o->~Bsdf_measurement();
+    Bsdf_measurement_ref *o = reinterpret_cast<Bsdf_measurement_ref *>(data);
+    o->~Bsdf_measurement_ref();
 }
 
 bool Resource_handler::bm_isvalid(
     void const *bm_data) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
     return o->is_valid();
 }
 
@@ -921,7 +899,7 @@ void Resource_handler::bm_resolution(
     Mbsdf_part    part) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
 
     mi::Uint32_3 res = o->get_resolution(part);
     result[0] = res.x;
@@ -938,7 +916,7 @@ void Resource_handler::bm_evaluate(
     Mbsdf_part    part) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->evaluate(
@@ -958,7 +936,7 @@ void Resource_handler::bm_sample(
     Mbsdf_part    part) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
 
     *reinterpret_cast<mi::Float32_3_struct*>(result) =
         o->sample(
@@ -976,7 +954,7 @@ float Resource_handler::bm_pdf(
     Mbsdf_part    part) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
 
     return o->pdf(*reinterpret_cast<mi::Float32_2 const *>(theta_phi_in),
                   *reinterpret_cast<mi::Float32_2 const *>(theta_phi_out),
@@ -991,7 +969,7 @@ void Resource_handler::bm_albedos(
     const float   theta_phi[2]) const
 {
     Bsdf_measurement const *o =
-        reinterpret_cast<Bsdf_measurement const *>(bm_data);
+        get_bsdf_measurement(bm_data);
 
     *reinterpret_cast<mi::Float32_4_struct*>(result) =
         o->albedos(*reinterpret_cast<mi::Float32_2 const *>(theta_phi));
@@ -392,6 +392,19 @@ mi::neuraylib::ICanvas* convert_to_fp_type_with_linear_gamma(
     return result.get();
 }
 
+// Returns the size of the pixel data of the canvas.
+size_t get_memory_usage(const IMAGE::Access_canvas& access)
+{
+    const mi::neuraylib::ICanvas* canvas = access.get();
+    if (!canvas)
+        return 0;
+
+    const IMAGE::Pixel_type pixel_type =
+        IMAGE::convert_pixel_type_string_to_enum(canvas->get_type());
+    return size_t(canvas->get_resolution_x()) * canvas->get_resolution_y()
+        * canvas->get_layers_size() * IMAGE::get_bytes_per_pixel(pixel_type);
+}
+
 } // namespace
 
 //-------------------------------------------------------------------------------------------------
@@ -527,6 +540,59 @@ Texture_2d::Texture_2d(
     }
 }
 
+size_t Texture_2d::get_memory_usage() const
+{
+    size_t size = 0;
+    for (const Frame& frame : m_frames)
+        for (const Uvtile& uvtile : frame.m_uvtiles)
+            for (const IMAGE::Access_canvas& canvas : uvtile.m_canvas)
+                size += MDLRT::get_memory_usage(canvas);
+    return size;
+}
+
+const mi::mdl::IResource_handler::Native_texture_2d* Texture_2d::get_native_texture() const
+{
+    if (!m_is_valid || m_is_animated || m_is_uvtile
+        || m_frames.size() != 1 || m_frames[0].m_uvtiles.size() != 1)
+        return nullptr;
+
+    std::call_once(m_native_once, [this]() {
+        const Uvtile& uvtile = m_frames[0].m_uvtiles[0];
+        mi::Size n_levels = uvtile.m_canvas.size();
+
+        m_native_texels.resize(n_levels);
+        m_native_levels.resize(n_levels);
+        for (mi::Size k = 0; k < n_levels; ++k) {
+            const IMAGE::Access_canvas& canvas = uvtile.m_canvas[k];
+            const mi::Uint32_3& res = uvtile.m_resolution[k];
+
+            // Convert via lookup() to get exactly the texel values of the non-inline path.
+            std::vector<float>& texels = m_native_texels[k];
+            texels.resize(size_t(res.x) * res.y * 4);
+            float* p = texels.data();
+            mi::math::Color col;
+            for (mi::Uint32 y = 0; y < res.y; ++y)
+                for (mi::Uint32 x = 0; x < res.x; ++x, p += 4) {
+                    canvas.lookup(col, x, y);
+                    p[0] = col.r;
+                    p[1] = col.g;
+                    p[2] = col.b;
+                    p[3] = col.a;
+                }
+
+            m_native_levels[k].texels = texels.data();
+            m_native_levels[k].width  = static_cast<int>(res.x);
+            m_native_levels[k].height = static_cast<int>(res.y);
+        }
+
+        m_native_texture.levels     = m_native_levels.data();
+        m_native_texture.num_levels = static_cast<unsigned>(n_levels);
+        m_native_texture.gamma      = uvtile.m_gamma;
+    });
+
+    return &m_native_texture;
+}
+
 mi::Uint32_2 Texture_2d::get_resolution(const mi::Sint32_2& uv_tile, mi::Float32 frame_param) const
 {
     mi::Size frame_id = get_frame_id(frame_param);
@@ -986,6 +1052,14 @@ Texture_3d::Texture_3d(
     }
 }
 
+size_t Texture_3d::get_memory_usage() const
+{
+    size_t size = 0;
+    for (const Frame& frame : m_frames)
+        size += MDLRT::get_memory_usage(frame.m_canvas);
+    return size;
+}
+
 mi::Uint32_3 Texture_3d::get_resolution(mi::Float32 frame) const
 {
     mi::Size frame_id = get_frame_id(frame);
@@ -1224,6 +1298,11 @@ Texture_cube::Texture_cube(
         m_is_valid = false;
 }
 
+size_t Texture_cube::get_memory_usage() const
+{
+    return MDLRT::get_memory_usage(m_canvas);
+}
+
 float Texture_cube::lookup_float(const mi::Float32_3& direction) const
 {
     return lookup_float4(direction).x;